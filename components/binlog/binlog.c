@@ -0,0 +1,190 @@
+#include "binlog.h"
+
+#include "driver/uart.h"
+#include "driver/uart_vfs.h"
+#include "esp_attr.h"
+#include "esp_cpu.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "record_frame.h"
+#include "ring_buffer.h"
+#include "soc/soc_caps.h"
+#include <stdarg.h>
+#include <string.h>
+
+#define SENDER_STACK 3072
+#define SENDER_PRIORITY 1
+#define UART_TX_BUF 4096
+#define UART_RX_BUF 256 // muss größer als der Hardware-FIFO sein
+
+// Ein Ring pro Kern, statisch angelegt, damit schon vor binlog_start()
+// geloggt werden kann
+static uint8_t ring_mem[portNUM_PROCESSORS][BINLOG_RING_SIZE];
+static ring_buffer_t rings[portNUM_PROCESSORS] = {
+    {.buf = ring_mem[0], .size = BINLOG_RING_SIZE},
+#if portNUM_PROCESSORS > 1
+    {.buf = ring_mem[1], .size = BINLOG_RING_SIZE},
+#endif
+};
+static binlog_stats_t stats[portNUM_PROCESSORS];
+static uint32_t reported_drops[portNUM_PROCESSORS]; // nur die Sende-Task
+
+static int port = -1;
+
+static inline void put32(uint8_t *p, uint32_t v) {
+  p[0] = v;
+  p[1] = v >> 8;
+  p[2] = v >> 16;
+  p[3] = v >> 24;
+}
+
+// Läuft mit gesperrten Interrupts des eigenen Kerns: kein Wechsel des Kerns
+// und kein zweiter Schreiber auf diesem Ring während des Kopierens
+void IRAM_ATTR binlog_write(const binlog_desc_t *desc, ...) {
+  UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+  uint32_t start = esp_cpu_get_cycle_count();
+
+  uint8_t rec[BINLOG_MAX_RECORD];
+  size_t n = 1;
+  put32(&rec[n], (uint32_t)(uintptr_t)desc);
+  put32(&rec[n + 4], (uint32_t)esp_timer_get_time());
+  n += 8;
+
+  va_list ap;
+  va_start(ap, desc);
+  for (size_t i = 0; i < desc->nargs; i++) {
+    switch (desc->types[i]) {
+    case BINLOG_T_I64:
+    case BINLOG_T_F64: {
+      uint64_t v;
+      if (desc->types[i] == BINLOG_T_I64) {
+        v = va_arg(ap, uint64_t);
+      } else {
+        double d = va_arg(ap, double);
+        memcpy(&v, &d, sizeof(v));
+      }
+      put32(&rec[n], (uint32_t)v);
+      put32(&rec[n + 4], (uint32_t)(v >> 32));
+      n += 8;
+      break;
+    }
+    case BINLOG_T_F32: {
+      float f = (float)va_arg(ap, double); // float wird zu double erweitert
+      uint32_t v;
+      memcpy(&v, &f, sizeof(v));
+      put32(&rec[n], v);
+      n += 4;
+      break;
+    }
+    case BINLOG_T_STR: {
+      // Kürzen, so dass die restlichen Argumente sicher noch passen
+      const char *s = va_arg(ap, const char *);
+      size_t room = sizeof(rec) - n - 1 - 8 * (desc->nargs - 1 - i);
+      size_t len = s ? strnlen(s, BINLOG_MAX_STR) : 0;
+      if (len > room) {
+        len = room;
+      }
+      rec[n++] = len;
+      if (len) {
+        memcpy(&rec[n], s, len);
+      }
+      n += len;
+      break;
+    }
+    default:
+      put32(&rec[n], va_arg(ap, uint32_t));
+      n += 4;
+      break;
+    }
+  }
+  va_end(ap);
+  rec[0] = n - 1;
+
+  int core = esp_cpu_get_core_id();
+  binlog_stats_t *st = &stats[core];
+  if (ring_free(&rings[core]) >= n) {
+    ring_write(&rings[core], rec, n);
+  } else {
+    st->dropped++;
+  }
+  uint32_t cycles = esp_cpu_get_cycle_count() - start;
+  st->calls++;
+  st->cycles += cycles;
+  if (cycles > st->cycles_max) {
+    st->cycles_max = cycles;
+  }
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+}
+
+static record_frame_t out;
+
+static size_t send_uart(const void *data, size_t len, void *ctx) {
+  return uart_write_bytes(port, data, len);
+}
+
+static void put_lost(uint8_t *p, int core, uint32_t count) {
+  p[0] = BINLOG_DROP_LEN;
+  put32(&p[1], 0);
+  put32(&p[5], (uint32_t)esp_timer_get_time());
+  p[9] = core;
+  put32(&p[10], count);
+}
+
+static void sender(void *arg) {
+  TickType_t last_wake = xTaskGetTickCount();
+  while (1) {
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+      record_frame_drain(&out, &rings[core], core, stats[core].dropped,
+                         &reported_drops[core]);
+    }
+    record_frame_flush(&out);
+    vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(BINLOG_FLUSH_MS));
+  }
+}
+
+esp_err_t binlog_start(int uart_port) {
+  if (port >= 0) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  if (uart_port < 0 || uart_port >= SOC_UART_NUM) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (!uart_is_driver_installed(uart_port)) {
+    esp_err_t err = uart_driver_install(uart_port, UART_RX_BUF, UART_TX_BUF,
+                                        0, NULL, 0);
+    if (err != ESP_OK) {
+      return err;
+    }
+    if (uart_port == BINLOG_CONSOLE_UART) {
+      uart_vfs_dev_use_driver(uart_port);
+    }
+  }
+  record_frame_config_t config = {
+      .tag = RECORD_FRAME_NO_TAG,
+      .max_record = BINLOG_MAX_RECORD,
+      .lost_len = 1 + BINLOG_DROP_LEN,
+      .lost = put_lost,
+      .send = send_uart,
+  };
+  record_frame_init(&out, &config);
+  port = uart_port;
+  if (xTaskCreate(sender, "binlog", SENDER_STACK, NULL, SENDER_PRIORITY,
+                  NULL) != pdPASS) {
+    port = -1;
+    return ESP_ERR_NO_MEM;
+  }
+  return ESP_OK;
+}
+
+// Die Zähler des anderen Kerns können mitten in einer Aktualisierung
+// gelesen werden; für eine Statistik reicht das
+binlog_stats_t binlog_get_stats(int core) {
+  binlog_stats_t s = {0};
+  if (core >= 0 && core < portNUM_PROCESSORS) {
+    UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+    s = stats[core];
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+  }
+  return s;
+}
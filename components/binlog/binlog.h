@@ -0,0 +1,115 @@
+#pragma once
+
+#include "binlog_format.h"
+#include "esp_err.h"
+#include "sdkconfig.h"
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+Binärer Logger für heiße Pfade: statt den Text auf dem Gerät zu formatieren,
+speichert BINLOG() nur die Adresse eines konstanten Deskriptors (Format-
+String und Argumenttypen, liegt im Flash) und die rohen Argumente.
+binlog_decode (host/) setzt den Text mit Hilfe der ELF-Datei wieder
+zusammen. Format der Datensätze und Frames: binlog_format.h.
+
+  BINLOG("Gyro X=%d Y=%d Z=%d", x, y, z);
+
+Die Argumenttypen bestimmt _Generic beim Übersetzen. Höchstens
+BINLOG_MAX_ARGS Argumente, kein abschließendes "\n".
+
+Jeder Kern hat seinen eigenen Ring. Ein Aufruf sperrt nur die Interrupts
+des eigenen Kerns für die Dauer des Kopierens, es gibt keinen Spinlock
+zwischen den Kernen. Eine Task niedriger Priorität fasst die Datensätze zu
+Frames zusammen und sendet sie über die UART. Ist ein Ring voll, wird der
+Datensatz verworfen und später gemeldet. Die Kosten jedes Aufrufs in
+CPU-Takten zählt binlog_get_stats().
+
+BINLOG() ist aus ISRs erlaubt, aber nicht bei abgeschaltetem Flash-Cache
+(der Deskriptor liegt im Flash). Auf dem Linux-Target gibt BINLOG() den
+Text direkt mit printf aus.
+*/
+
+#define BINLOG_RING_SIZE 4096 // pro Kern, Zweierpotenz
+#define BINLOG_FLUSH_MS 10
+
+// UART der Konsole; ohne UART-Konsole (z.B. USB-Serial-JTAG) ist der Wert
+// negativ und binlog_start() schlägt fehl
+#ifdef CONFIG_ESP_CONSOLE_UART_NUM
+#define BINLOG_CONSOLE_UART CONFIG_ESP_CONSOLE_UART_NUM
+#else
+#define BINLOG_CONSOLE_UART 0
+#endif
+
+// Wird von binlog_decode aus der ELF-Datei gelesen; Aufbau nicht ändern
+typedef struct {
+  const char *fmt;
+  uint8_t nargs;
+  uint8_t types[BINLOG_MAX_ARGS];
+} binlog_desc_t;
+
+typedef struct {
+  uint32_t calls;
+  uint32_t dropped;
+  uint64_t cycles; // Summe über alle Aufrufe, CPU-Takte in binlog_write
+  uint32_t cycles_max;
+} binlog_stats_t;
+
+// Argumente zählen und einzeln abbilden (bis BINLOG_MAX_ARGS)
+#define BINLOG_CAT_(a, b) a##b
+#define BINLOG_CAT(a, b) BINLOG_CAT_(a, b)
+#define BINLOG_NARGS(...)                                                      \
+  BINLOG_NARGS_(_, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define BINLOG_NARGS_(_, a1, a2, a3, a4, a5, a6, a7, a8, n, ...) n
+#define BINLOG_MAP(f, ...)                                                     \
+  BINLOG_CAT(BINLOG_MAP_, BINLOG_NARGS(__VA_ARGS__))(f, ##__VA_ARGS__)
+#define BINLOG_MAP_0(f, ...)
+#define BINLOG_MAP_1(f, a) f(a)
+#define BINLOG_MAP_2(f, a, ...) f(a) BINLOG_MAP_1(f, __VA_ARGS__)
+#define BINLOG_MAP_3(f, a, ...) f(a) BINLOG_MAP_2(f, __VA_ARGS__)
+#define BINLOG_MAP_4(f, a, ...) f(a) BINLOG_MAP_3(f, __VA_ARGS__)
+#define BINLOG_MAP_5(f, a, ...) f(a) BINLOG_MAP_4(f, __VA_ARGS__)
+#define BINLOG_MAP_6(f, a, ...) f(a) BINLOG_MAP_5(f, __VA_ARGS__)
+#define BINLOG_MAP_7(f, a, ...) f(a) BINLOG_MAP_6(f, __VA_ARGS__)
+#define BINLOG_MAP_8(f, a, ...) f(a) BINLOG_MAP_7(f, __VA_ARGS__)
+
+#define BINLOG_TYPE(x)                                                         \
+  _Generic((x),                                                                \
+      float: BINLOG_T_F32,                                                     \
+      double: BINLOG_T_F64,                                                    \
+      long long: BINLOG_T_I64,                                                 \
+      unsigned long long: BINLOG_T_I64,                                        \
+      char *: BINLOG_T_STR,                                                    \
+      const char *: BINLOG_T_STR,                                              \
+      default: BINLOG_T_I32),
+
+#if CONFIG_IDF_TARGET_LINUX
+
+#define BINLOG(fmt, ...) printf(fmt "\n", ##__VA_ARGS__)
+
+static inline esp_err_t binlog_start(int uart_port) { return ESP_OK; }
+static inline binlog_stats_t binlog_get_stats(int core) {
+  return (binlog_stats_t){0};
+}
+
+#else
+
+#define BINLOG(fmt, ...)                                                       \
+  do {                                                                         \
+    static const binlog_desc_t binlog_desc_ = {                                \
+        fmt, BINLOG_NARGS(__VA_ARGS__),                                        \
+        {BINLOG_MAP(BINLOG_TYPE, ##__VA_ARGS__)}};                             \
+    binlog_write(&binlog_desc_, ##__VA_ARGS__);                                \
+  } while (0)
+
+// Startet die Sende-Task. Ist auf `uart_port` noch kein Treiber installiert,
+// wird er installiert; auf der Konsolen-UART läuft danach auch die
+// Textausgabe über den Treiber, damit Frames nicht zerrissen werden.
+esp_err_t binlog_start(int uart_port);
+
+// Zähler eines Kerns seit dem Start
+binlog_stats_t binlog_get_stats(int core);
+
+void binlog_write(const binlog_desc_t *desc, ...);
+
+#endif
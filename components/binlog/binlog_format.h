@@ -0,0 +1,45 @@
+#pragma once
+
+/*
+Leitungsformat von binlog.
+
+Ein Datensatz:
+
+  [len][id u32][t_us u32][arg ...]
+
+  len   Bytes nach len
+  id    Adresse des binlog_desc_t in der Firmware, 0 = Verlustmeldung
+  t_us  esp_timer_get_time(), untere 32 Bit
+
+Argumente nach dem Typ im Deskriptor, little endian:
+
+  BINLOG_T_I32  4 Byte (int und kleiner, long, Zeiger)
+  BINLOG_T_I64  8 Byte (long long)
+  BINLOG_T_F32  4 Byte float
+  BINLOG_T_F64  8 Byte double
+  BINLOG_T_STR  [len][bytes], höchstens BINLOG_MAX_STR Bytes
+
+Verlustmeldung (id 0): [core][anzahl u32] verworfene Datensätze des Kerns
+seit der letzten Meldung.
+
+Die Sende-Task packt Datensätze in Frames wie das SMS-Protokoll:
+
+  0x00 COBS([seq][datensatz ...][crc16 lo][crc16 hi]) 0x00
+
+seq zählt pro Frame hoch, crc16 ist CRC-16/CCITT über seq und Datensätze.
+Die Datei ist unabhängig von ESP-IDF und wird auch von binlog_decode
+benutzt.
+*/
+
+#define BINLOG_MAX_ARGS 8
+#define BINLOG_MAX_STR 32
+#define BINLOG_MAX_RECORD 128
+#define BINLOG_DROP_LEN 13 // len einer Verlustmeldung
+
+enum {
+  BINLOG_T_I32 = 1,
+  BINLOG_T_I64,
+  BINLOG_T_F32,
+  BINLOG_T_F64,
+  BINLOG_T_STR,
+};
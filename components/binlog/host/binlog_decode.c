@@ -0,0 +1,427 @@
+/*
+Dekoder für binlog: liest Frames von der UART (oder aus einer Datei bzw.
+stdin), sucht die Deskriptoren in der ELF-Datei der Firmware und gibt die
+Zeilen als Text aus. Alles, was kein gültiger Frame ist (normale
+Konsolenausgabe), wird unverändert durchgereicht.
+
+  gcc -O2 -Wall -I.. -I../../sms_proto -o binlog_decode binlog_decode.c \
+      ../../sms_proto/cobs.c ../../sms_proto/crc16.c
+  ./binlog_decode build/main.elf /dev/ttyUSB0 115200
+  ./binlog_decode build/main.elf mitschnitt.bin
+
+Ausgabe pro Datensatz: Zeit in Sekunden seit dem Start des Geräts, dann
+der Text. Datensätze der beiden Kerne stehen in der Reihenfolge, in der die
+Sende-Task sie abholt, die Zeitstempel können daher leicht springen.
+*/
+
+#define _DEFAULT_SOURCE // cfmakeraw
+
+#include "binlog_format.h"
+#include "cobs.h"
+#include "crc16.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#define CHUNK_MAX 4096
+#define TEXT_MAX 512
+
+// Belegter Adressbereich eines Abschnitts der ELF-Datei
+typedef struct {
+  uint32_t addr;
+  uint32_t size;
+  const uint8_t *data;
+} section_t;
+
+static uint8_t *elf;
+static section_t *sections;
+static size_t section_count;
+
+static uint32_t get16(const uint8_t *p) { return p[0] | p[1] << 8; }
+
+static uint32_t get32(const uint8_t *p) {
+  return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static uint64_t get64(const uint8_t *p) {
+  return get32(p) | (uint64_t)get32(p + 4) << 32;
+}
+
+// Nur 32-Bit little endian (Xtensa, RISC-V)
+static bool load_elf(const char *path) {
+  FILE *f = fopen(path, "rb");
+  if (!f) {
+    perror(path);
+    return false;
+  }
+  fseek(f, 0, SEEK_END);
+  long size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  elf = malloc(size);
+  if (!elf || fread(elf, 1, size, f) != (size_t)size) {
+    fclose(f);
+    return false;
+  }
+  fclose(f);
+  if (size < 52 || memcmp(elf, "\x7f" "ELF", 4) != 0 || elf[4] != 1 ||
+      elf[5] != 1) {
+    fprintf(stderr, "%s: keine 32-Bit-ELF-Datei (little endian)\n", path);
+    return false;
+  }
+  uint32_t shoff = get32(&elf[0x20]);
+  uint32_t shentsize = get16(&elf[0x2E]);
+  uint32_t shnum = get16(&elf[0x30]);
+  if (shoff + (uint64_t)shnum * shentsize > (uint64_t)size) {
+    fprintf(stderr, "%s: Abschnittstabelle beschädigt\n", path);
+    return false;
+  }
+  sections = calloc(shnum, sizeof(section_t));
+  for (uint32_t i = 0; i < shnum; i++) {
+    const uint8_t *sh = &elf[shoff + i * shentsize];
+    uint32_t type = get32(&sh[4]);
+    uint32_t flags = get32(&sh[8]);
+    uint32_t addr = get32(&sh[12]);
+    uint32_t offset = get32(&sh[16]);
+    uint32_t sz = get32(&sh[20]);
+    // SHF_ALLOC und Inhalt in der Datei (nicht SHT_NOBITS)
+    if ((flags & 0x2) && type != 8 && addr &&
+        offset + (uint64_t)sz <= (uint64_t)size) {
+      sections[section_count++] = (section_t){addr, sz, &elf[offset]};
+    }
+  }
+  return true;
+}
+
+// Zeiger auf `len` Bytes ab `addr`, NULL wenn sie in keinem Abschnitt liegen
+static const uint8_t *lookup(uint32_t addr, uint32_t len) {
+  for (size_t i = 0; i < section_count; i++) {
+    const section_t *s = &sections[i];
+    if (addr >= s->addr && addr - s->addr + (uint64_t)len <= s->size) {
+      return s->data + (addr - s->addr);
+    }
+  }
+  return NULL;
+}
+
+static const char *lookup_string(uint32_t addr) {
+  for (size_t i = 0; i < section_count; i++) {
+    const section_t *s = &sections[i];
+    if (addr >= s->addr && addr < s->addr + s->size) {
+      const char *p = (const char *)s->data + (addr - s->addr);
+      if (memchr(p, 0, s->size - (addr - s->addr))) {
+        return p;
+      }
+    }
+  }
+  return NULL;
+}
+
+typedef struct {
+  const char *fmt;
+  uint8_t nargs;
+  uint8_t types[BINLOG_MAX_ARGS];
+} desc_t;
+
+// Liest binlog_desc_t aus der ELF-Datei (fmt-Zeiger 4 Byte, dann nargs und
+// types)
+static bool load_desc(uint32_t id, desc_t *d) {
+  const uint8_t *p = lookup(id, 5 + BINLOG_MAX_ARGS);
+  if (!p || p[4] > BINLOG_MAX_ARGS) {
+    return false;
+  }
+  d->fmt = lookup_string(get32(p));
+  d->nargs = p[4];
+  memcpy(d->types, &p[5], BINLOG_MAX_ARGS);
+  for (int i = 0; i < d->nargs; i++) {
+    if (d->types[i] < BINLOG_T_I32 || d->types[i] > BINLOG_T_STR) {
+      return false;
+    }
+  }
+  return d->fmt != NULL;
+}
+
+typedef struct {
+  uint8_t type;
+  uint64_t u;
+  double f;
+  char s[BINLOG_MAX_STR + 1];
+} arg_t;
+
+// Argumente nach den Typen des Deskriptors lesen; false bei zu kurzen Daten
+static bool read_args(const desc_t *d, const uint8_t *p, size_t len,
+                      arg_t *args) {
+  size_t n = 0;
+  for (int i = 0; i < d->nargs; i++) {
+    arg_t *a = &args[i];
+    a->type = d->types[i];
+    switch (a->type) {
+    case BINLOG_T_I32:
+    case BINLOG_T_F32:
+      if (n + 4 > len) {
+        return false;
+      }
+      a->u = get32(&p[n]);
+      if (a->type == BINLOG_T_F32) {
+        float f;
+        uint32_t v = a->u;
+        memcpy(&f, &v, sizeof(f));
+        a->f = f;
+      }
+      n += 4;
+      break;
+    case BINLOG_T_I64:
+    case BINLOG_T_F64:
+      if (n + 8 > len) {
+        return false;
+      }
+      a->u = get64(&p[n]);
+      memcpy(&a->f, &a->u, sizeof(a->f));
+      n += 8;
+      break;
+    case BINLOG_T_STR: {
+      size_t sl = n < len ? p[n] : 0;
+      if (n + 1 + sl > len || sl > BINLOG_MAX_STR) {
+        return false;
+      }
+      memcpy(a->s, &p[n + 1], sl);
+      a->s[sl] = 0;
+      n += 1 + sl;
+      break;
+    }
+    }
+  }
+  return n == len;
+}
+
+// printf mit den Argumenten vom Gerät. Längenangaben im Format gelten für
+// das Gerät (long ist dort 32 Bit) und werden durch die passende Angabe für
+// den PC ersetzt; Typ und Umwandlung müssen zusammenpassen, sonst "<?>".
+static void format(char *out, size_t cap, const char *fmt, const arg_t *args,
+                   int nargs) {
+  size_t n = 0;
+  int next = 0;
+  char spec[32];
+  for (const char *p = fmt; *p && n + 1 < cap;) {
+    if (*p != '%') {
+      out[n++] = *p++;
+      continue;
+    }
+    if (p[1] == '%') {
+      out[n++] = '%';
+      p += 2;
+      continue;
+    }
+    // %[flags][width][.precision][length]conv
+    const char *start = p++;
+    p += strspn(p, "-+ #0");
+    p += strspn(p, "0123456789");
+    if (*p == '.') {
+      p++;
+      p += strspn(p, "0123456789");
+    }
+    size_t head = p - start;
+    p += strspn(p, "hlLqjzt");
+    char conv = *p ? *p++ : 0;
+    if (head + 4 > sizeof(spec) || !conv) {
+      break;
+    }
+    memcpy(spec, start, head);
+    spec[head] = 0;
+
+    int w = -1;
+    size_t room = cap - n;
+    const arg_t *a = next < nargs ? &args[next++] : NULL;
+    bool is_int = strchr("diuxXoc", conv) != NULL;
+    bool is_float = strchr("fFeEgGaA", conv) != NULL;
+    bool is_signed = conv == 'd' || conv == 'i';
+    if (!a) {
+      w = snprintf(out + n, room, "<?>");
+    } else if (is_int && a->type == BINLOG_T_I32) {
+      snprintf(spec + head, 4, "%c", conv);
+      w = is_signed ? snprintf(out + n, room, spec, (int)(int32_t)a->u)
+                    : snprintf(out + n, room, spec, (unsigned)a->u);
+    } else if (is_int && a->type == BINLOG_T_I64) {
+      snprintf(spec + head, 4, "ll%c", conv);
+      w = is_signed ? snprintf(out + n, room, spec, (long long)a->u)
+                    : snprintf(out + n, room, spec, (unsigned long long)a->u);
+    } else if (is_float &&
+               (a->type == BINLOG_T_F32 || a->type == BINLOG_T_F64)) {
+      snprintf(spec + head, 4, "%c", conv);
+      w = snprintf(out + n, room, spec, a->f);
+    } else if (conv == 's' && a->type == BINLOG_T_STR) {
+      snprintf(spec + head, 4, "s");
+      w = snprintf(out + n, room, spec, a->s);
+    } else if (conv == 'p' && a->type == BINLOG_T_I32) {
+      w = snprintf(out + n, room, "0x%08x", (unsigned)a->u);
+    } else {
+      w = snprintf(out + n, room, "<?>");
+    }
+    if (w < 0) {
+      break;
+    }
+    n += (size_t)w < room ? (size_t)w : room - 1;
+  }
+  out[n] = 0;
+}
+
+typedef struct {
+  bool have_seq;
+  uint8_t seq;
+  bool have_time;
+  int64_t time_us; // zuletzt gesehener Zeitstempel, ohne Überlauf
+  uint64_t records;
+  uint64_t unknown;
+  uint64_t lost_frames;
+  uint64_t dropped; // auf dem Gerät verworfen
+} decoder_t;
+
+static double unwrap(decoder_t *dec, uint32_t t) {
+  if (!dec->have_time) {
+    dec->time_us = t;
+    dec->have_time = true;
+  } else {
+    dec->time_us += (int32_t)(t - (uint32_t)dec->time_us);
+  }
+  return dec->time_us / 1e6;
+}
+
+// `in` bleibt unverändert, damit es bei Fehlern als Text ausgegeben werden
+// kann
+static bool decode_frame(decoder_t *dec, const uint8_t *in, size_t len) {
+  static uint8_t buf[CHUNK_MAX];
+  len = cobs_decode(in, len, buf);
+  if (len < 3 || crc16_ccitt(buf, len - 2) != get16(&buf[len - 2])) {
+    return false;
+  }
+  len -= 2;
+  if (dec->have_seq && buf[0] != (uint8_t)(dec->seq + 1)) {
+    uint8_t gap = buf[0] - dec->seq - 1;
+    dec->lost_frames += gap;
+    printf("--- %u Frame(s) verloren ---\n", gap);
+  }
+  dec->seq = buf[0];
+  dec->have_seq = true;
+
+  char text[TEXT_MAX];
+  arg_t args[BINLOG_MAX_ARGS];
+  for (size_t pos = 1; pos < len;) {
+    size_t rec_len = buf[pos];
+    const uint8_t *rec = &buf[pos + 1];
+    if (pos + 1 + rec_len > len || rec_len < 8) {
+      printf("--- Frame %u kaputt ---\n", buf[0]);
+      break;
+    }
+    pos += 1 + rec_len;
+    uint32_t id = get32(rec);
+    double t = unwrap(dec, get32(&rec[4]));
+    desc_t d;
+    if (id == 0 && rec_len == BINLOG_DROP_LEN) {
+      dec->dropped += get32(&rec[9]);
+      printf("%12.6f --- Kern %u: %u Datensätze verworfen ---\n", t, rec[8],
+             get32(&rec[9]));
+    } else if (load_desc(id, &d) &&
+               read_args(&d, rec + 8, rec_len - 8, args)) {
+      format(text, sizeof(text), d.fmt, args, d.nargs);
+      printf("%12.6f %s\n", t, text);
+      dec->records++;
+    } else {
+      printf("%12.6f <unbekannte id 0x%08x, passt die ELF-Datei?>\n", t, id);
+      dec->unknown++;
+    }
+  }
+  return true;
+}
+
+static speed_t baud_to_speed(int baud) {
+  switch (baud) {
+  case 115200:
+    return B115200;
+  case 230400:
+    return B230400;
+  case 460800:
+    return B460800;
+  case 921600:
+    return B921600;
+  case 2000000:
+    return B2000000;
+  default:
+    return B0;
+  }
+}
+
+static int open_input(const char *path, int baud) {
+  if (!path || strcmp(path, "-") == 0) {
+    return STDIN_FILENO;
+  }
+  int fd = open(path, O_RDONLY | O_NOCTTY | O_CLOEXEC);
+  if (fd < 0 || !isatty(fd)) {
+    return fd;
+  }
+  struct termios tio;
+  speed_t speed = baud_to_speed(baud);
+  if (speed == B0 || tcgetattr(fd, &tio) < 0) {
+    fprintf(stderr, "Baudrate %d nicht unterstützt\n", baud);
+    close(fd);
+    return -1;
+  }
+  cfmakeraw(&tio);
+  cfsetispeed(&tio, speed);
+  cfsetospeed(&tio, speed);
+  tcsetattr(fd, TCSANOW, &tio);
+  return fd;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "Aufruf: %s firmware.elf [gerät|datei|-] [baud]\n",
+            argv[0]);
+    return 2;
+  }
+  if (!load_elf(argv[1])) {
+    return 1;
+  }
+  int fd = open_input(argc > 2 ? argv[2] : NULL,
+                      argc > 3 ? atoi(argv[3]) : 115200);
+  if (fd < 0) {
+    perror(argv[2]);
+    return 1;
+  }
+
+  decoder_t dec = {0};
+  static uint8_t chunk[CHUNK_MAX];
+  size_t chunk_len = 0;
+  uint8_t buf[4096];
+  ssize_t got;
+  while ((got = read(fd, buf, sizeof(buf))) > 0 ||
+         (got < 0 && errno == EINTR)) {
+    for (ssize_t i = 0; i < got; i++) {
+      if (buf[i] != 0) {
+        if (chunk_len < CHUNK_MAX) {
+          chunk[chunk_len++] = buf[i];
+        }
+        continue;
+      }
+      // Zwischen zwei Trennern: Frame oder Text der Konsole
+      if (chunk_len && !decode_frame(&dec, chunk, chunk_len)) {
+        fwrite(chunk, 1, chunk_len, stdout);
+      }
+      chunk_len = 0;
+    }
+    fflush(stdout);
+  }
+  fwrite(chunk, 1, chunk_len, stdout);
+  fprintf(stderr,
+          "%llu Zeilen, %llu unbekannt, %llu Frames verloren, %llu auf dem "
+          "Gerät verworfen\n",
+          (unsigned long long)dec.records, (unsigned long long)dec.unknown,
+          (unsigned long long)dec.lost_frames,
+          (unsigned long long)dec.dropped);
+  return 0;
+}
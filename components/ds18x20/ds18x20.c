@@ -0,0 +1,327 @@
+#include "ds18x20.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "metrics.h"
+#include <inttypes.h>
+#include <string.h>
+
+#define CMD_MATCH_ROM 0x55
+#define CMD_SKIP_ROM 0xCC
+#define CMD_CONVERT_T 0x44
+#define CMD_WRITE_SCRATCHPAD 0x4E
+#define CMD_READ_SCRATCHPAD 0xBE
+#define CMD_READ_POWER_SUPPLY 0xB4
+
+#define SCRATCHPAD_LEN 9
+#define SCRATCHPAD_TH 2
+#define SCRATCHPAD_TL 3
+#define SCRATCHPAD_CONFIG 4
+#define SCRATCHPAD_COUNT_REMAIN 6
+#define SCRATCHPAD_COUNT_PER_C 7
+#define SCRATCHPAD_CRC 8
+
+// Zuschlag auf die Datenblatt-Wandlungszeit, bevor aufgegeben wird
+#define CONVERT_TIMEOUT_MARGIN_MS 20
+
+static const char *TAG = "ds18x20";
+
+// CRC8 über Nibble-Tabellen: 32 Bytes statt 256, ein Tabellenzugriff pro
+// Halbbyte statt acht Schiebeschritten pro Byte
+static const uint8_t crc_lo[16] = {0x00, 0x5E, 0xBC, 0xE2, 0x61, 0x3F,
+                                   0xDD, 0x83, 0xC2, 0x9C, 0x7E, 0x20,
+                                   0xA3, 0xFD, 0x1F, 0x41};
+static const uint8_t crc_hi[16] = {0x00, 0x9D, 0x23, 0xBE, 0x46, 0xDB,
+                                   0x65, 0xF8, 0x8C, 0x11, 0xAF, 0x32,
+                                   0xCA, 0x57, 0xE9, 0x74};
+
+uint8_t ds18x20_crc8(const uint8_t *data, size_t len) {
+  uint8_t crc = 0;
+  for (size_t i = 0; i < len; i++) {
+    uint8_t x = crc ^ data[i];
+    crc = crc_lo[x & 0x0F] ^ crc_hi[x >> 4];
+  }
+  return crc;
+}
+
+static bool is_ds18x20(onewire_device_address_t address) {
+  uint8_t family = address & 0xFF;
+  return family == DS18X20_FAMILY_DS18S20 ||
+         family == DS18X20_FAMILY_DS1822 || family == DS18X20_FAMILY_DS18B20;
+}
+
+static bool has_resolution_config(onewire_device_address_t address) {
+  return (address & 0xFF) != DS18X20_FAMILY_DS18S20;
+}
+
+// Reset + MATCH ROM + Befehl
+static esp_err_t select_device(ds18x20_t *ds, onewire_device_address_t addr,
+                               uint8_t command) {
+  uint8_t cmd[10] = {CMD_MATCH_ROM};
+  memcpy(&cmd[1], &addr, 8);
+  cmd[9] = command;
+
+  esp_err_t err = onewire_bus_reset(ds->bus);
+  if (err == ESP_OK) {
+    err = onewire_bus_write_bytes(ds->bus, cmd, sizeof(cmd));
+  }
+  return err;
+}
+
+// Liest den Scratchpad und prüft ihn. ESP_ERR_INVALID_CRC bei falscher
+// Prüfsumme, ESP_ERR_INVALID_RESPONSE wenn nur Nullen gelesen wurden (die
+// CRC über Nullen ist ebenfalls 0, z.B. bei kurzgeschlossenem Bus).
+static esp_err_t read_scratchpad(ds18x20_t *ds, onewire_device_address_t addr,
+                                 uint8_t *data) {
+  esp_err_t err = select_device(ds, addr, CMD_READ_SCRATCHPAD);
+  if (err == ESP_OK) {
+    err = onewire_bus_read_bytes(ds->bus, data, SCRATCHPAD_LEN);
+  }
+  if (err != ESP_OK) {
+    return err;
+  }
+
+  uint8_t any = 0;
+  for (int i = 0; i < SCRATCHPAD_LEN; i++) {
+    any |= data[i];
+  }
+  if (!any) {
+    return ESP_ERR_INVALID_RESPONSE;
+  }
+  if (ds18x20_crc8(data, SCRATCHPAD_LEN - 1) != data[SCRATCHPAD_CRC]) {
+    return ESP_ERR_INVALID_CRC;
+  }
+  return ESP_OK;
+}
+
+// Parasitär versorgte Sensoren ziehen den Bus bei READ POWER SUPPLY auf Low
+static esp_err_t check_power_supply(ds18x20_t *ds) {
+  uint8_t cmd[] = {CMD_SKIP_ROM, CMD_READ_POWER_SUPPLY};
+  uint8_t bit = 1;
+
+  esp_err_t err = onewire_bus_reset(ds->bus);
+  if (err == ESP_OK) {
+    err = onewire_bus_write_bytes(ds->bus, cmd, sizeof(cmd));
+  }
+  if (err == ESP_OK) {
+    err = onewire_bus_read_bit(ds->bus, &bit);
+  }
+  ds->parasite = bit == 0;
+  return err;
+}
+
+// Gemeinsam für alle Busse, die Registrierung liefert bei jedem Init
+// dieselben Messwerte
+static metric_t *m_convert_us, *m_read_us, *m_crc_errors, *m_bus_errors;
+
+esp_err_t ds18x20_init(ds18x20_t *ds, onewire_bus_handle_t bus) {
+  memset(ds, 0, sizeof(*ds));
+  ds->bus = bus;
+  m_convert_us = metrics_histogram("onewire.convert_us", "us");
+  m_read_us = metrics_histogram("onewire.read_us", "us");
+  m_crc_errors = metrics_counter("onewire.crc_errors", "");
+  m_bus_errors = metrics_counter("onewire.bus_errors", "");
+
+  onewire_device_iter_handle_t iter;
+  onewire_device_t dev;
+  ESP_ERROR_CHECK(onewire_new_device_iter(bus, &iter));
+  while (1) {
+    esp_err_t err = onewire_device_iter_get_next(iter, &dev);
+    if (err == ESP_ERR_INVALID_CRC) {
+      // Gestörte Adresse überspringen, die Suche läuft weiter
+      ESP_LOGW(TAG, "ROM-Code mit falscher CRC ignoriert");
+      metrics_inc(m_crc_errors);
+      continue;
+    }
+    if (err != ESP_OK) {
+      break;
+    }
+    if (!is_ds18x20(dev.address)) {
+      continue;
+    }
+    if (ds->count == DS18X20_MAX_SENSORS) {
+      ESP_LOGW(TAG, "Mehr als %d Sensoren, Rest wird ignoriert",
+               DS18X20_MAX_SENSORS);
+      break;
+    }
+    ds->sensors[ds->count++].address = dev.address;
+    ESP_LOGI(TAG, "Sensor %d: %016" PRIX64, (int)ds->count - 1, dev.address);
+  }
+  onewire_del_device_iter(iter);
+
+  if (ds->count == 0) {
+    return ESP_ERR_NOT_FOUND;
+  }
+
+  // Aktuelle Auflösung aus dem Konfigurationsregister übernehmen
+  for (size_t i = 0; i < ds->count; i++) {
+    ds18x20_sensor_t *s = &ds->sensors[i];
+    uint8_t data[SCRATCHPAD_LEN];
+    s->resolution = DS18X20_RESOLUTION_MAX;
+    if (!has_resolution_config(s->address)) {
+      s->resolution = DS18X20_RESOLUTION_MIN;
+    } else if (read_scratchpad(ds, s->address, data) == ESP_OK) {
+      s->resolution =
+          DS18X20_RESOLUTION_MIN + ((data[SCRATCHPAD_CONFIG] >> 5) & 0x03);
+    }
+  }
+
+  if (check_power_supply(ds) == ESP_OK && ds->parasite) {
+    ESP_LOGW(TAG, "Parasitäre Versorgung erkannt, warte feste Zeit");
+  }
+  return ESP_OK;
+}
+
+esp_err_t ds18x20_set_resolution(ds18x20_t *ds, size_t index, uint8_t bits) {
+  if (index >= ds->count || bits < DS18X20_RESOLUTION_MIN ||
+      bits > DS18X20_RESOLUTION_MAX) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  ds18x20_sensor_t *s = &ds->sensors[index];
+  if (!has_resolution_config(s->address)) {
+    return ESP_OK;
+  }
+
+  // TH/TL beibehalten, sie werden mit dem Konfigurationsregister geschrieben
+  uint8_t data[SCRATCHPAD_LEN];
+  esp_err_t err = read_scratchpad(ds, s->address, data);
+  if (err != ESP_OK) {
+    return err;
+  }
+  uint8_t regs[3] = {data[SCRATCHPAD_TH], data[SCRATCHPAD_TL],
+                     (uint8_t)(((bits - DS18X20_RESOLUTION_MIN) << 5) | 0x1F)};
+  err = select_device(ds, s->address, CMD_WRITE_SCRATCHPAD);
+  if (err == ESP_OK) {
+    err = onewire_bus_write_bytes(ds->bus, regs, sizeof(regs));
+  }
+  if (err == ESP_OK) {
+    s->resolution = bits;
+  }
+  return err;
+}
+
+esp_err_t ds18x20_set_resolution_all(ds18x20_t *ds, uint8_t bits) {
+  esp_err_t ret = ESP_OK;
+  for (size_t i = 0; i < ds->count; i++) {
+    esp_err_t err = ds18x20_set_resolution(ds, i, bits);
+    if (err != ESP_OK) {
+      ret = err;
+    }
+  }
+  return ret;
+}
+
+uint32_t ds18x20_conversion_ms(uint8_t resolution) {
+  // 93,75 ms << (bits - 9), aufgerundet
+  return (750u >> (DS18X20_RESOLUTION_MAX - resolution)) + 1;
+}
+
+esp_err_t ds18x20_convert_all(ds18x20_t *ds) {
+  int64_t start = esp_timer_get_time();
+  uint8_t cmd[] = {CMD_SKIP_ROM, CMD_CONVERT_T};
+
+  // Der langsamste Sensor bestimmt die maximale Wartezeit
+  uint8_t max_res = DS18X20_RESOLUTION_MIN;
+  for (size_t i = 0; i < ds->count; i++) {
+    if (ds->sensors[i].resolution > max_res) {
+      max_res = ds->sensors[i].resolution;
+    }
+  }
+  uint32_t max_ms = ds18x20_conversion_ms(max_res);
+
+  esp_err_t err = onewire_bus_reset(ds->bus);
+  if (err == ESP_OK) {
+    err = onewire_bus_write_bytes(ds->bus, cmd, sizeof(cmd));
+  }
+  if (err != ESP_OK) {
+    return err;
+  }
+
+  if (ds->parasite) {
+    // Ohne eigene Versorgung antworten die Sensoren nicht auf Lese-Slots
+    vTaskDelay(pdMS_TO_TICKS(max_ms));
+  } else {
+    // Solange noch ein Sensor wandelt, liest jeder Zeitschlitz eine 0
+    int64_t deadline = start + (max_ms + CONVERT_TIMEOUT_MARGIN_MS) * 1000LL;
+    uint8_t done = 0;
+    while (!done) {
+      vTaskDelay(1);
+      err = onewire_bus_read_bit(ds->bus, &done);
+      if (err != ESP_OK) {
+        return err;
+      }
+      if (!done && esp_timer_get_time() > deadline) {
+        return ESP_ERR_TIMEOUT;
+      }
+    }
+  }
+
+  ds->convert_us = esp_timer_get_time() - start;
+  metrics_record(m_convert_us, ds->convert_us);
+  return ESP_OK;
+}
+
+esp_err_t ds18x20_read_all(ds18x20_t *ds) {
+  esp_err_t ret = ESP_OK;
+
+  for (size_t i = 0; i < ds->count; i++) {
+    ds18x20_sensor_t *s = &ds->sensors[i];
+    uint8_t data[SCRATCHPAD_LEN];
+    esp_err_t err;
+
+    // Nur der fehlerhafte Sensor wird erneut gelesen; der Scratchpad bleibt
+    // bis zur nächsten Wandlung unverändert
+    int64_t start = esp_timer_get_time();
+    for (int attempt = 0;; attempt++) {
+      err = read_scratchpad(ds, s->address, data);
+      if (err == ESP_ERR_INVALID_CRC) {
+        s->crc_errors++;
+        metrics_inc(m_crc_errors);
+      } else if (err != ESP_OK) {
+        s->bus_errors++;
+        metrics_inc(m_bus_errors);
+      }
+      if (err == ESP_OK || attempt == DS18X20_MAX_RETRIES) {
+        break;
+      }
+      s->retries++;
+    }
+    s->read_latency_us = esp_timer_get_time() - start;
+    metrics_record(m_read_us, s->read_latency_us);
+    s->reads++;
+
+    s->valid = err == ESP_OK;
+    if (s->valid) {
+      s->temperature =
+          ds18x20_decode(s->address & 0xFF, s->resolution, data);
+    } else {
+      s->failures++;
+      ret = err;
+    }
+  }
+  return ret;
+}
+
+float ds18x20_decode(uint8_t family, uint8_t resolution,
+                     const uint8_t *scratchpad) {
+  int16_t raw = (scratchpad[1] << 8) | scratchpad[0];
+
+  if (family == DS18X20_FAMILY_DS18S20) {
+    // 0,5 °C pro LSB; mit COUNT_REMAIN lässt sich die Auflösung erhöhen:
+    // T = T_read - 0,25 + (COUNT_PER_C - COUNT_REMAIN) / COUNT_PER_C
+    uint8_t per_c = scratchpad[SCRATCHPAD_COUNT_PER_C];
+    if (per_c == 0) {
+      return raw / 2.0f;
+    }
+    float whole = (raw >> 1);
+    return whole - 0.25f +
+           (float)(per_c - scratchpad[SCRATCHPAD_COUNT_REMAIN]) / per_c;
+  }
+
+  // DS18B20/DS1822: 1/16 °C pro LSB, bei weniger als 12 bit sind die
+  // untersten Bits undefiniert
+  raw &= ~((1 << (DS18X20_RESOLUTION_MAX - resolution)) - 1);
+  return raw / 16.0f;
+}
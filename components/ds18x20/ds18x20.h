@@ -0,0 +1,88 @@
+#pragma once
+
+#include "esp_err.h"
+#include <onewire_bus.h>
+#include <onewire_device.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Treiber für mehrere DS18x20 an einem 1-Wire-Bus.
+//
+// Die ROM-Codes werden einmal beim Init gesucht und zwischengespeichert. Eine
+// Messung startet die Wandlung aller Sensoren gleichzeitig (SKIP ROM +
+// CONVERT T) und liest danach jeden Scratchpad gezielt per MATCH ROM. N
+// Sensoren kosten damit eine Wandlungszeit statt N.
+//
+// Statt fest 750 ms zu warten, wird nach CONVERT T mit Lese-Zeitschlitzen
+// abgefragt, ob alle Sensoren fertig sind (geht nur ohne parasitäre
+// Versorgung). Die Auflösung der DS18B20/DS1822 ist einstellbar, die Wandlung
+// dauert 93,75 ms bei 9 bit und verdoppelt sich pro zusätzlichem Bit.
+//
+// Wandlungs- und Lesezeiten sowie Bus- und CRC-Fehler aller Busse landen
+// zusätzlich in components/metrics (onewire.*).
+
+#define DS18X20_MAX_SENSORS 8
+
+#define DS18X20_FAMILY_DS18S20 0x10
+#define DS18X20_FAMILY_DS1822 0x22
+#define DS18X20_FAMILY_DS18B20 0x28
+
+// Wiederholungen pro Sensor, wenn die CRC des Scratchpads nicht stimmt
+#define DS18X20_MAX_RETRIES 2
+
+#define DS18X20_RESOLUTION_MIN 9
+#define DS18X20_RESOLUTION_MAX 12
+
+typedef struct {
+  onewire_device_address_t address;
+  uint8_t resolution;      // 9..12 bit (DS18S20 immer 9)
+  float temperature;       // °C, nur gültig wenn valid
+  bool valid;
+  int64_t read_latency_us; // Scratchpad lesen inkl. Wiederholungen
+
+  // Fehlerstatistik
+  uint32_t reads;      // Messungen insgesamt
+  uint32_t crc_errors; // Scratchpads mit falscher CRC
+  uint32_t bus_errors; // Fehler des Bustreibers oder leerer Scratchpad
+  uint32_t retries;    // zusätzliche Leseversuche
+  uint32_t failures;   // Messungen ohne gültigen Wert nach allen Versuchen
+} ds18x20_sensor_t;
+
+typedef struct {
+  onewire_bus_handle_t bus;
+  ds18x20_sensor_t sensors[DS18X20_MAX_SENSORS];
+  size_t count;
+  bool parasite;      // mindestens ein Sensor ohne eigene Versorgung
+  int64_t convert_us; // Dauer der letzten Wandlung inkl. Warten
+} ds18x20_t;
+
+// Sucht alle DS18x20 auf dem Bus und merkt sich ihre ROM-Codes
+esp_err_t ds18x20_init(ds18x20_t *ds, onewire_bus_handle_t bus);
+
+// Setzt die Auflösung (9..12 bit) eines Sensors. DS18S20 haben eine feste
+// Auflösung und werden übersprungen.
+esp_err_t ds18x20_set_resolution(ds18x20_t *ds, size_t index, uint8_t bits);
+
+// Dasselbe für alle Sensoren
+esp_err_t ds18x20_set_resolution_all(ds18x20_t *ds, uint8_t bits);
+
+// Startet die Wandlung auf allen Sensoren und wartet, bis sie fertig ist
+esp_err_t ds18x20_convert_all(ds18x20_t *ds);
+
+// Liest die Scratchpads aller Sensoren nacheinander. Stimmt die CRC nicht,
+// wird nur dieser Sensor erneut gelesen (bis zu DS18X20_MAX_RETRIES mal).
+esp_err_t ds18x20_read_all(ds18x20_t *ds);
+
+// Rechnet die Rohdaten des Scratchpads in °C um. Beim DS18S20 wird über
+// COUNT_REMAIN die erweiterte Auflösung berechnet, beim DS18B20/DS1822 werden
+// die bei der gewählten Auflösung undefinierten Bits ausgeblendet.
+float ds18x20_decode(uint8_t family, uint8_t resolution,
+                     const uint8_t *scratchpad);
+
+// Dallas/Maxim CRC8 (x^8 + x^5 + x^4 + 1). Über einen Scratchpad inklusive
+// CRC-Byte gerechnet ergibt sich 0.
+uint8_t ds18x20_crc8(const uint8_t *data, size_t len);
+
+// Wandlungszeit in ms für die gegebene Auflösung (aufgerundet)
+uint32_t ds18x20_conversion_ms(uint8_t resolution);
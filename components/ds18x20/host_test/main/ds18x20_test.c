@@ -0,0 +1,444 @@
+/*
+Host tests for ds18x20 on the simulated 1-Wire bus of hal_sim: reset and
+presence, SEARCH ROM over several devices, ROM and scratchpad CRC, the
+shared conversion (one SKIP ROM + CONVERT T for all sensors) and corrupted
+scratchpads (bad CRC, truncated, stray zero bytes) with selective retry.
+
+  cd components/ds18x20/host_test
+  idf.py --preview set-target linux
+  idf.py build
+  ./build/ds18x20_test.elf
+
+The sensors are minimal DS18B20 models attached to their own pins, so the
+test sees every function command a sensor receives. The default devices of
+hal_sim stay on GPIO 18 and are not used.
+*/
+
+#include "ds18x20.h"
+#include "hal_sim.h"
+
+#include <math.h>
+#include <onewire_bus.h>
+#include <onewire_device.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define EMPTY_GPIO 30
+#define SEARCH_GPIO 31
+#define FAULT_GPIO 32
+
+#define CMD_CONVERT_T 0x44
+#define CMD_WRITE_SCRATCHPAD 0x4E
+#define CMD_READ_SCRATCHPAD 0xBE
+
+typedef enum {
+  MODE_CMD,
+  MODE_READ,
+  MODE_WRITE,
+  MODE_CONVERTING,
+} fake_mode_t;
+
+// How a corrupted scratchpad read looks on the bus
+typedef enum {
+  FAULT_NONE,
+  FAULT_BAD_CRC,    // one bit flipped in the temperature LSB
+  FAULT_TRUNCATED,  // device stops after 4 bytes, the rest reads 0xFF
+  FAULT_ZEROS,      // bus shorted: every byte 0, CRC over it is 0 as well
+  FAULT_STRAY_ZERO, // a 0x00 slips in at byte 2, the rest shifts by one
+} fault_t;
+
+typedef struct {
+  hal_sim_onewire_dev_t ow;
+  uint8_t scratch[9];
+  fake_mode_t mode;
+  int pos;
+  int64_t convert_until;
+  float temp;
+  bool sensor;  // false: ignores function commands (e.g. DS2401)
+  int converts; // CONVERT T received
+  int reads;    // READ SCRATCHPAD received
+  fault_t fault;
+  int fault_reads; // number of following reads that are corrupted
+  bool corrupt;    // current read is corrupted
+} fake_ds_t;
+
+static int failures;
+
+static void check(int ok, const char *what) {
+  if (!ok) {
+    printf("FAIL %s\n", what);
+    failures++;
+  }
+}
+
+static uint64_t make_rom(uint8_t family, uint64_t serial) {
+  uint8_t rom[8] = {family};
+  for (int i = 1; i < 7; i++) {
+    rom[i] = (uint8_t)(serial >> (8 * (i - 1)));
+  }
+  rom[7] = hal_sim_onewire_crc8(rom, 7);
+  uint64_t address = 0;
+  for (int i = 0; i < 8; i++) {
+    address |= (uint64_t)rom[i] << (8 * i);
+  }
+  return address;
+}
+
+static int resolution(const fake_ds_t *d) {
+  return 9 + ((d->scratch[4] >> 5) & 3);
+}
+
+static void finish_conversion(fake_ds_t *d) {
+  if (d->mode != MODE_CONVERTING || hal_sim_now_ns() < d->convert_until) {
+    return;
+  }
+  int raw = (int)lroundf(d->temp * 16);
+  d->scratch[0] = (uint8_t)raw;
+  d->scratch[1] = (uint8_t)(raw >> 8);
+  d->scratch[8] = hal_sim_onewire_crc8(d->scratch, 8);
+  d->mode = MODE_CMD;
+}
+
+static void fake_reset(hal_sim_onewire_dev_t *dev) {
+  fake_ds_t *d = (fake_ds_t *)dev;
+  finish_conversion(d);
+  if (d->mode != MODE_CONVERTING) {
+    d->mode = MODE_CMD;
+  }
+}
+
+static void fake_write_byte(hal_sim_onewire_dev_t *dev, uint8_t byte) {
+  fake_ds_t *d = (fake_ds_t *)dev;
+  finish_conversion(d);
+  if (d->mode == MODE_WRITE) {
+    if (d->pos < 3) {
+      d->scratch[2 + d->pos++] = byte;
+      d->scratch[8] = hal_sim_onewire_crc8(d->scratch, 8);
+    }
+    return;
+  }
+  if (d->mode != MODE_CMD || !d->sensor) {
+    return;
+  }
+  d->pos = 0;
+  if (byte == CMD_CONVERT_T) {
+    d->converts++;
+    d->mode = MODE_CONVERTING;
+    d->convert_until =
+        hal_sim_now_ns() + (750000000LL >> (12 - resolution(d)));
+  } else if (byte == CMD_READ_SCRATCHPAD) {
+    d->reads++;
+    d->mode = MODE_READ;
+    d->corrupt = d->fault_reads > 0;
+    if (d->corrupt) {
+      d->fault_reads--;
+    }
+  } else if (byte == CMD_WRITE_SCRATCHPAD) {
+    d->mode = MODE_WRITE;
+  }
+}
+
+static uint8_t fake_read_byte(hal_sim_onewire_dev_t *dev) {
+  fake_ds_t *d = (fake_ds_t *)dev;
+  finish_conversion(d);
+  if (d->mode != MODE_READ || d->pos >= 9) {
+    return 0xFF;
+  }
+  int pos = d->pos++;
+  uint8_t byte = d->scratch[pos];
+  if (!d->corrupt) {
+    return byte;
+  }
+  switch (d->fault) {
+  case FAULT_BAD_CRC:
+    return pos == 0 ? byte ^ 0x01 : byte;
+  case FAULT_TRUNCATED:
+    return pos < 4 ? byte : 0xFF;
+  case FAULT_ZEROS:
+    return 0x00;
+  case FAULT_STRAY_ZERO:
+    return pos < 2 ? byte : pos == 2 ? 0x00 : d->scratch[pos - 1];
+  default:
+    return byte;
+  }
+}
+
+// While converting every read slot returns 0
+static uint8_t fake_read_bit(hal_sim_onewire_dev_t *dev) {
+  fake_ds_t *d = (fake_ds_t *)dev;
+  finish_conversion(d);
+  return d->mode != MODE_CONVERTING;
+}
+
+static void fake_attach(fake_ds_t *d, int gpio, uint64_t rom, float temp) {
+  uint8_t family = rom & 0xFF;
+  // Power-on state: 85 °C, 12 bit
+  static const uint8_t power_on[8] = {0x50, 0x05, 0x4B, 0x46,
+                                      0x7F, 0xFF, 0x0C, 0x10};
+  memset(d, 0, sizeof(*d));
+  memcpy(d->scratch, power_on, sizeof(power_on));
+  d->scratch[8] = hal_sim_onewire_crc8(d->scratch, 8);
+  d->temp = temp;
+  d->sensor = family == DS18X20_FAMILY_DS18B20 ||
+              family == DS18X20_FAMILY_DS1822;
+  d->ow.rom = rom;
+  d->ow.gpio = gpio;
+  d->ow.write_byte = fake_write_byte;
+  d->ow.read_byte = fake_read_byte;
+  d->ow.read_bit = fake_read_bit;
+  d->ow.reset = fake_reset;
+  hal_sim_onewire_attach(&d->ow);
+}
+
+static onewire_bus_handle_t new_bus(int gpio) {
+  onewire_bus_config_t cfg = {.bus_gpio_num = gpio};
+  onewire_bus_rmt_config_t rmt = {.max_rx_bytes = 10};
+  onewire_bus_handle_t bus = NULL;
+  check(onewire_new_bus_rmt(&cfg, &rmt, &bus) == ESP_OK, "new bus");
+  return bus;
+}
+
+static void test_crc8(void) {
+  uint8_t data[16];
+  srand(1);
+  for (int n = 0; n < 1000; n++) {
+    size_t len = 1 + rand() % sizeof(data);
+    for (size_t i = 0; i < len; i++) {
+      data[i] = (uint8_t)rand();
+    }
+    if (ds18x20_crc8(data, len) != hal_sim_onewire_crc8(data, len)) {
+      check(0, "nibble table matches bitwise CRC8");
+      return;
+    }
+  }
+  // Example from Maxim AN27: ROM 02 1C B8 01 00 00 00 A2
+  const uint8_t rom[8] = {0x02, 0x1C, 0xB8, 0x01, 0x00, 0x00, 0x00, 0xA2};
+  check(ds18x20_crc8(rom, 7) == 0xA2, "CRC8 of AN27 example");
+  check(ds18x20_crc8(rom, 8) == 0, "CRC8 including CRC byte is 0");
+}
+
+static void test_presence(void) {
+  onewire_bus_handle_t bus = new_bus(EMPTY_GPIO);
+  check(onewire_bus_reset(bus) == ESP_ERR_NOT_FOUND, "no presence pulse");
+
+  onewire_device_iter_handle_t iter;
+  onewire_device_t dev;
+  check(onewire_new_device_iter(bus, &iter) == ESP_OK, "iter on empty bus");
+  check(onewire_device_iter_get_next(iter, &dev) == ESP_ERR_NOT_FOUND,
+        "search on empty bus");
+  onewire_del_device_iter(iter);
+
+  ds18x20_t ds;
+  check(ds18x20_init(&ds, bus) == ESP_ERR_NOT_FOUND && ds.count == 0,
+        "init without sensors");
+  onewire_bus_del(bus);
+}
+
+// Addresses that branch early, late and in the top serial bit, a foreign
+// family and one foreign address whose CRC is wrong
+static fake_ds_t fakes[7];
+static uint64_t roms[7];
+#define SENSORS 5  // fakes[0..4] are DS18x20
+#define FOREIGN 5  // DS2401 serial number chip
+#define BAD_CRC 6
+
+static void attach_search_set(void) {
+  roms[0] = make_rom(DS18X20_FAMILY_DS18B20, 1);
+  roms[1] = make_rom(DS18X20_FAMILY_DS18B20, 2);
+  roms[2] = make_rom(DS18X20_FAMILY_DS18B20, 3);
+  roms[3] = make_rom(DS18X20_FAMILY_DS18B20, 0x800000000000);
+  roms[4] = make_rom(DS18X20_FAMILY_DS1822, 1);
+  roms[FOREIGN] = make_rom(0x01, 7);
+  roms[BAD_CRC] = make_rom(0x01, 9) ^ (1ULL << 56);
+  for (int i = 0; i < 7; i++) {
+    fake_attach(&fakes[i], SEARCH_GPIO, roms[i], 20.5f + i);
+  }
+}
+
+static void test_search(onewire_bus_handle_t bus) {
+  onewire_device_iter_handle_t iter;
+  onewire_device_t dev;
+  int seen[7] = {0};
+  int found = 0, crc_errors = 0;
+  esp_err_t err;
+
+  check(onewire_new_device_iter(bus, &iter) == ESP_OK, "new iter");
+  while ((err = onewire_device_iter_get_next(iter, &dev)) !=
+         ESP_ERR_NOT_FOUND) {
+    if (err == ESP_ERR_INVALID_CRC) {
+      crc_errors++;
+      continue;
+    }
+    check(err == ESP_OK, "search step");
+    found++;
+    for (int i = 0; i < 7; i++) {
+      seen[i] += dev.address == roms[i];
+    }
+    if (found > 10) {
+      check(0, "search terminates");
+      break;
+    }
+  }
+  onewire_del_device_iter(iter);
+
+  check(found == 6, "search finds every device with a valid ROM");
+  check(crc_errors == 1, "search reports the bad ROM CRC once");
+  for (int i = 0; i < BAD_CRC; i++) {
+    check(seen[i] == 1, "each device found exactly once");
+  }
+  check(seen[BAD_CRC] == 0, "bad ROM not returned");
+}
+
+static void test_shared_conversion(onewire_bus_handle_t bus) {
+  ds18x20_t ds;
+  check(ds18x20_init(&ds, bus) == ESP_OK, "init");
+  check(ds.count == SENSORS, "init keeps only DS18x20 families");
+  check(!ds.parasite, "externally powered");
+  for (size_t i = 0; i < ds.count; i++) {
+    check(ds.sensors[i].resolution == 12, "resolution from config register");
+  }
+
+  check(ds18x20_set_resolution_all(&ds, 9) == ESP_OK, "set 9 bit");
+  for (int i = 0; i < SENSORS; i++) {
+    check(resolution(&fakes[i]) == 9, "config register written");
+  }
+
+  int reads_before[SENSORS];
+  for (int i = 0; i < SENSORS; i++) {
+    reads_before[i] = fakes[i].reads;
+  }
+  check(ds18x20_convert_all(&ds) == ESP_OK, "convert");
+  check(ds18x20_read_all(&ds) == ESP_OK, "read");
+
+  // One conversion time (93.75 ms at 9 bit) for all five, not five
+  check(ds.convert_us >= 93750 && ds.convert_us < 2 * 93750,
+        "conversion time of one sensor");
+  for (size_t i = 0; i < ds.count; i++) {
+    ds18x20_sensor_t *s = &ds.sensors[i];
+    fake_ds_t *f = NULL;
+    for (int k = 0; k < SENSORS; k++) {
+      if (fakes[k].ow.rom == s->address) {
+        f = &fakes[k];
+      }
+    }
+    check(f != NULL, "sensor address belongs to a device");
+    if (!f) {
+      continue;
+    }
+    check(f->converts == 1, "one CONVERT T per sensor (SKIP ROM)");
+    check(f->reads - reads_before[f - fakes] == 1, "one scratchpad read");
+    check(s->valid && s->temperature == f->temp, "temperature");
+    check(s->read_latency_us > 0, "read latency reported");
+    check(s->reads == 1 && s->retries == 0 && s->failures == 0,
+          "no retries");
+  }
+  printf("%d sensors, conversion %lld us\n", (int)ds.count,
+         (long long)ds.convert_us);
+}
+
+static void clear_stats(ds18x20_t *ds) {
+  for (size_t i = 0; i < ds->count; i++) {
+    ds18x20_sensor_t *s = &ds->sensors[i];
+    s->reads = s->crc_errors = s->bus_errors = 0;
+    s->retries = s->failures = 0;
+  }
+}
+
+static const struct {
+  fault_t fault;
+  const char *name;
+  esp_err_t err; // what read_all reports when every retry fails
+  bool crc;      // counted as CRC error, otherwise as bus error
+} fault_cases[] = {
+    {FAULT_BAD_CRC, "bad CRC", ESP_ERR_INVALID_CRC, true},
+    {FAULT_TRUNCATED, "truncated", ESP_ERR_INVALID_CRC, true},
+    {FAULT_ZEROS, "all zero", ESP_ERR_INVALID_RESPONSE, false},
+    {FAULT_STRAY_ZERO, "stray zero", ESP_ERR_INVALID_CRC, true},
+};
+
+// Sensor 1 of three returns corrupted scratchpads. Once: one retry of that
+// sensor only. Every time: the sensor fails after DS18X20_MAX_RETRIES, the
+// others stay valid.
+static void test_corrupted_frames(void) {
+  static fake_ds_t chain[3];
+  for (int i = 0; i < 3; i++) {
+    fake_attach(&chain[i], FAULT_GPIO,
+                make_rom(DS18X20_FAMILY_DS18B20, 0x100 + i), 10.0f + i);
+  }
+  onewire_bus_handle_t bus = new_bus(FAULT_GPIO);
+  ds18x20_t ds;
+  check(ds18x20_init(&ds, bus) == ESP_OK && ds.count == 3, "init chain");
+  check(ds18x20_set_resolution_all(&ds, 9) == ESP_OK, "set 9 bit");
+  check(ds18x20_convert_all(&ds) == ESP_OK, "convert chain");
+
+  size_t bad = 0;
+  while (ds.sensors[bad].address != chain[1].ow.rom) {
+    bad++;
+  }
+  char what[96];
+  for (size_t c = 0; c < sizeof(fault_cases) / sizeof(fault_cases[0]);
+       c++) {
+    for (int persistent = 0; persistent < 2; persistent++) {
+      int reads_before[3];
+      for (int i = 0; i < 3; i++) {
+        reads_before[i] = chain[i].reads;
+      }
+      chain[1].fault = fault_cases[c].fault;
+      chain[1].fault_reads = persistent ? 100 : 1;
+      clear_stats(&ds);
+      esp_err_t err = ds18x20_read_all(&ds);
+      chain[1].fault_reads = 0;
+
+      ds18x20_sensor_t *s = &ds.sensors[bad];
+      uint32_t attempts = persistent ? DS18X20_MAX_RETRIES + 1 : 2;
+      uint32_t errors = s->crc_errors + s->bus_errors;
+      snprintf(what, sizeof(what), "%s, %s: ", fault_cases[c].name,
+               persistent ? "every read" : "once");
+      size_t n = strlen(what);
+
+      snprintf(what + n, sizeof(what) - n, "result");
+      check(err == (persistent ? fault_cases[c].err : ESP_OK), what);
+      snprintf(what + n, sizeof(what) - n, "valid/failures");
+      check(s->valid == !persistent && s->failures == (uint32_t)persistent,
+            what);
+      snprintf(what + n, sizeof(what) - n, "retries");
+      check(s->retries == attempts - 1 &&
+                chain[1].reads - reads_before[1] == (int)attempts,
+            what);
+      snprintf(what + n, sizeof(what) - n, "error counter");
+      check(errors == attempts - !persistent &&
+                (fault_cases[c].crc ? s->crc_errors : s->bus_errors) ==
+                    errors,
+            what);
+      if (!persistent) {
+        snprintf(what + n, sizeof(what) - n, "temperature after retry");
+        check(s->temperature == chain[1].temp, what);
+      }
+      for (int i = 0; i < 3; i++) {
+        if (i == 1) {
+          continue;
+        }
+        snprintf(what + n, sizeof(what) - n, "other sensors read once");
+        check(chain[i].reads - reads_before[i] == 1, what);
+      }
+    }
+  }
+  onewire_bus_del(bus);
+}
+
+void app_main(void) {
+  test_crc8();
+  test_presence();
+
+  attach_search_set();
+  onewire_bus_handle_t bus = new_bus(SEARCH_GPIO);
+  check(onewire_bus_reset(bus) == ESP_OK, "presence pulse");
+  test_search(bus);
+  test_shared_conversion(bus);
+  onewire_bus_del(bus);
+  test_corrupted_frames();
+
+  printf(failures ? "FAILED\n" : "ok\n");
+  exit(failures ? 1 : 0);
+}
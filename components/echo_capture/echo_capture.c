@@ -0,0 +1,104 @@
+#include "echo_capture.h"
+
+#include "esp_check.h"
+#include "esp_log.h"
+#include "evtrace.h"
+#include "metrics.h"
+
+static const char *TAG = "ECHO_CAPTURE";
+
+static mcpwm_cap_timer_handle_t timers[SOC_MCPWM_GROUPS];
+static size_t channel_count = 0;
+static uint32_t resolution_hz = 0;
+static metric_t *capture_edges;
+static metric_t *capture_overruns;
+
+static bool IRAM_ATTR on_capture(mcpwm_cap_channel_handle_t channel,
+                                 const mcpwm_capture_event_data_t *edata,
+                                 void *user_ctx) {
+  EVTRACE_ISR_ENTER("on_capture");
+  echo_channel_t *ch = user_ctx;
+  BaseType_t woken = pdFALSE;
+  metrics_inc(capture_edges);
+
+  if (edata->cap_edge == MCPWM_CAP_EDGE_POS) {
+    ch->rise_ticks = edata->cap_value;
+    ch->rise_seq =
+        atomic_load_explicit(&ch->armed_seq, memory_order_acquire);
+    ch->high = true;
+  } else if (ch->high) {
+    echo_pulse_t pulse = {
+        .sensor = ch->sensor,
+        .seq = ch->rise_seq,
+        .rise_ticks = ch->rise_ticks,
+        .fall_ticks = edata->cap_value,
+    };
+    ch->high = false;
+    if (xQueueSendFromISR(ch->queue, &pulse, &woken) != pdTRUE) {
+      ch->overruns++;
+      metrics_inc(capture_overruns);
+    }
+  }
+  EVTRACE_ISR_EXIT("on_capture");
+  return woken == pdTRUE;
+}
+
+// The capture timer of a group is created with its first channel
+static esp_err_t timer_for_group(int group, mcpwm_cap_timer_handle_t *out) {
+  if (timers[group] == NULL) {
+    mcpwm_capture_timer_config_t cfg = {
+        .group_id = group,
+        .clk_src = MCPWM_CAPTURE_CLK_SRC_DEFAULT,
+    };
+    ESP_RETURN_ON_ERROR(mcpwm_new_capture_timer(&cfg, &timers[group]), TAG,
+                        "capture timer");
+    ESP_RETURN_ON_ERROR(
+        mcpwm_capture_timer_get_resolution(timers[group], &resolution_hz),
+        TAG, "resolution");
+    ESP_RETURN_ON_ERROR(mcpwm_capture_timer_enable(timers[group]), TAG,
+                        "enable timer");
+    ESP_RETURN_ON_ERROR(mcpwm_capture_timer_start(timers[group]), TAG,
+                        "start timer");
+    ESP_LOGI(TAG, "group %d capture timer at %lu Hz", group,
+             (unsigned long)resolution_hz);
+  }
+  *out = timers[group];
+  return ESP_OK;
+}
+
+esp_err_t echo_capture_add(echo_channel_t *ch, gpio_num_t gpio, uint8_t sensor,
+                           QueueHandle_t queue) {
+  if (channel_count >= ECHO_CAPTURE_MAX_CHANNELS) {
+    return ESP_ERR_NO_MEM;
+  }
+  int group = channel_count / SOC_MCPWM_CAPTURE_CHANNELS_PER_TIMER;
+  capture_edges = metrics_counter("capture.edges", "");
+  capture_overruns = metrics_counter("capture.overruns", "");
+
+  mcpwm_cap_timer_handle_t timer;
+  ESP_RETURN_ON_ERROR(timer_for_group(group, &timer), TAG, "group %d", group);
+
+  *ch = (echo_channel_t){.queue = queue, .sensor = sensor};
+  atomic_init(&ch->armed_seq, 0);
+
+  mcpwm_capture_channel_config_t cfg = {
+      .gpio_num = gpio,
+      .prescale = 1,
+      .flags.pos_edge = true,
+      .flags.neg_edge = true,
+  };
+  ESP_RETURN_ON_ERROR(mcpwm_new_capture_channel(timer, &cfg, &ch->channel),
+                      TAG, "capture channel");
+
+  mcpwm_capture_event_callbacks_t cbs = {.on_cap = on_capture};
+  ESP_RETURN_ON_ERROR(
+      mcpwm_capture_channel_register_event_callbacks(ch->channel, &cbs, ch),
+      TAG, "callbacks");
+  ESP_RETURN_ON_ERROR(mcpwm_capture_channel_enable(ch->channel), TAG,
+                      "enable channel");
+
+  channel_count++;
+  return ESP_OK;
+}
+
+uint32_t echo_capture_resolution_hz(void) { return resolution_hz; }
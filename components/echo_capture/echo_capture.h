@@ -0,0 +1,73 @@
+#pragma once
+
+#include "driver/gpio.h"
+#include "driver/mcpwm_cap.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Hardware echo timing with the MCPWM capture unit.
+//
+// The capture timer runs from the 80 MHz APB clock. On each edge of the echo
+// pin the hardware latches the timer value, so the pulse width is exact to
+// 12.5 ns no matter how late the interrupt is served. The callback only
+// subtracts the two latched values and pushes the result into a queue.
+//
+// Each MCPWM group has one capture timer with three channels; channels are
+// spread over both groups, so up to ECHO_CAPTURE_MAX_CHANNELS sensors work.
+//
+// Before each trigger the task arms the channel with a new sequence number.
+// The rising edge latches it, and the falling edge publishes one complete
+// record (sequence, rise, fall) through the queue. A late echo of an earlier
+// ping therefore carries the old number and can be dropped by the task; no
+// state is shared between ISR and task apart from the queue and the armed
+// number.
+
+#define ECHO_CAPTURE_MAX_CHANNELS                                              \
+  (SOC_MCPWM_GROUPS * SOC_MCPWM_CAPTURE_CHANNELS_PER_TIMER)
+
+typedef struct {
+  uint8_t sensor;      // index passed to echo_capture_add
+  uint32_t seq;        // armed sequence number at the rising edge
+  uint32_t rise_ticks; // capture timer at the rising edge
+  uint32_t fall_ticks; // capture timer at the falling edge
+} echo_pulse_t;
+
+typedef struct {
+  mcpwm_cap_channel_handle_t channel;
+  QueueHandle_t queue; // receives echo_pulse_t
+  uint8_t sensor;
+  _Atomic uint32_t armed_seq; // written by the task, read by the ISR
+
+  // ISR only
+  bool high;           // rising edge seen, waiting for the falling one
+  uint32_t rise_seq;
+  uint32_t rise_ticks;
+  uint32_t overruns;   // queue full, pulse dropped
+} echo_channel_t;
+
+// Sets up capture on `gpio` and delivers every complete pulse to `queue`.
+// `ch` must stay valid for the lifetime of the program.
+esp_err_t echo_capture_add(echo_channel_t *ch, gpio_num_t gpio, uint8_t sensor,
+                           QueueHandle_t queue);
+
+// Tags the next echo with `seq`. Call before triggering the sensor.
+static inline void echo_capture_arm(echo_channel_t *ch, uint32_t seq) {
+  atomic_store_explicit(&ch->armed_seq, seq, memory_order_release);
+}
+
+// Echo high time in capture timer ticks; the unsigned subtraction handles the
+// 32-bit timer wrap (every ~53 s)
+static inline uint32_t echo_pulse_ticks(const echo_pulse_t *pulse) {
+  return pulse->fall_ticks - pulse->rise_ticks;
+}
+
+// Capture timer frequency in Hz (same for all groups)
+uint32_t echo_capture_resolution_hz(void);
+
+static inline float echo_ticks_to_us(uint32_t ticks) {
+  return ticks * (1e6f / echo_capture_resolution_hz());
+}
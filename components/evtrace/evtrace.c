@@ -0,0 +1,243 @@
+#include "evtrace.h"
+
+#include "driver/uart.h"
+#include "esp_attr.h"
+#include "esp_cpu.h"
+#include "esp_freertos_hooks.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "record_frame.h"
+#include "ring_buffer.h"
+#include "soc/soc_caps.h"
+#include <string.h>
+
+#define SENDER_STACK 3072
+#define SENDER_PRIORITY 1
+#define UART_TX_BUF 8192
+#define UART_RX_BUF 256 // muss größer als der Hardware-FIFO sein
+// Längster Datensatz im Ring (EVTRACE_TASK mit vollem Namen)
+#define MAX_RECORD (1 + EVTRACE_TASK_LEN(EVTRACE_MAX_NAME))
+// Tasks pro Kern, deren Name schon gemeldet wurde
+#define MAX_TASKS 32
+// Für die Umrechnung auf dem Host; mit Power-Management (DFS) stimmt der
+// Wert nur bei voller Frequenz
+#define CPU_HZ (CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ * 1000000)
+
+typedef struct {
+  ring_buffer_t ring;
+  uint8_t mem[EVTRACE_RING_SIZE];
+  TaskHandle_t seen[MAX_TASKS]; // nur mit gesperrten Interrupts des Kerns
+  size_t n_seen;
+  volatile bool forget; // Sender: Namen beim nächsten Wechsel neu melden
+  uint32_t sync_ticks; // Tick-Hook: Ticks bis zum nächsten EVTRACE_SYNC
+  evtrace_stats_t stats;
+  uint32_t reported_drops; // nur die Sende-Task
+} core_state_t;
+
+static core_state_t cores[portNUM_PROCESSORS];
+static volatile bool running;
+static int port = -1;
+
+static inline void IRAM_ATTR put32(uint8_t *p, uint32_t v) {
+  p[0] = v;
+  p[1] = v >> 8;
+  p[2] = v >> 16;
+  p[3] = v >> 24;
+}
+
+// Alle put_*-Funktionen laufen mit gesperrten Interrupts des eigenen Kerns:
+// kein zweiter Schreiber auf diesem Ring während des Kopierens
+static void IRAM_ATTR put(core_state_t *c, const uint8_t *rec, size_t n) {
+  if (ring_free(&c->ring) >= n) {
+    ring_write(&c->ring, rec, n);
+    c->stats.events++;
+    uint32_t fill = ring_used(&c->ring);
+    if (fill > c->stats.max_fill) {
+      c->stats.max_fill = fill;
+    }
+  } else {
+    c->stats.dropped++;
+  }
+}
+
+static void IRAM_ATTR put_event(int core, uint8_t type, uint32_t id,
+                                uint32_t arg) {
+  uint8_t rec[1 + EVTRACE_EVENT_LEN];
+  rec[0] = EVTRACE_EVENT_LEN;
+  rec[1] = type;
+  rec[2] = core;
+  put32(&rec[3], esp_cpu_get_cycle_count());
+  put32(&rec[7], id);
+  put32(&rec[11], arg);
+  put(&cores[core], rec, sizeof(rec));
+}
+
+// Name einer Task einmal pro Kern melden; bei vollem Ring bleibt sie
+// ungesehen und wird beim nächsten Wechsel erneut versucht
+static void IRAM_ATTR put_task(int core, TaskHandle_t task) {
+  core_state_t *c = &cores[core];
+  if (c->forget) {
+    c->n_seen = 0;
+    c->forget = false;
+  }
+  for (size_t i = 0; i < c->n_seen; i++) {
+    if (c->seen[i] == task) {
+      return;
+    }
+  }
+  const char *name = pcTaskGetName(task);
+  size_t len = strnlen(name, EVTRACE_MAX_NAME);
+  uint8_t rec[1 + EVTRACE_TASK_LEN(EVTRACE_MAX_NAME)];
+  rec[0] = EVTRACE_TASK_LEN(len);
+  rec[1] = EVTRACE_TASK;
+  rec[2] = core;
+  put32(&rec[3], (uint32_t)(uintptr_t)task);
+  memcpy(&rec[7], name, len);
+  uint32_t dropped = c->stats.dropped;
+  put(c, rec, 1 + rec[0]);
+  if (c->stats.dropped == dropped && c->n_seen < MAX_TASKS) {
+    c->seen[c->n_seen++] = task;
+  }
+}
+
+void IRAM_ATTR evtrace_event(uint8_t type, const char *name, uint32_t arg) {
+  if (!running) {
+    return;
+  }
+  UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+  put_event(esp_cpu_get_core_id(), type, (uint32_t)(uintptr_t)name, arg);
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+}
+
+void IRAM_ATTR evtrace_task_event(uint8_t type, const char *name) {
+  evtrace_event(type, name, (uint32_t)(uintptr_t)xTaskGetCurrentTaskHandle());
+}
+
+// vTaskSwitchContext läuft beim Verlassen einer ISR und bei portYIELD mit
+// gesperrten Interrupts. Je nach FreeRTOS-Konfiguration bekommt sie die
+// Kernnummer als Argument oder keines; das Register wird in beiden Fällen
+// unverändert weitergereicht.
+void __real_vTaskSwitchContext(BaseType_t core_id);
+
+void IRAM_ATTR __wrap_vTaskSwitchContext(BaseType_t core_id) {
+  TaskHandle_t prev = xTaskGetCurrentTaskHandle();
+  __real_vTaskSwitchContext(core_id);
+  TaskHandle_t next = xTaskGetCurrentTaskHandle();
+  if (!running || next == prev) {
+    return;
+  }
+  int core = esp_cpu_get_core_id();
+  put_task(core, next);
+  put_event(core, EVTRACE_SWITCH, (uint32_t)(uintptr_t)next,
+            (uint32_t)(uintptr_t)prev);
+}
+
+// Läuft im Tick-Interrupt jedes Kerns. Der erste Aufruf nach dem Start
+// schreibt sofort ein EVTRACE_SYNC, danach alle EVTRACE_SYNC_MS.
+static void IRAM_ATTR tick_hook(void) {
+  int core = esp_cpu_get_core_id();
+  core_state_t *c = &cores[core];
+  if (!running || c->sync_ticks-- > 0) {
+    return;
+  }
+  c->sync_ticks = pdMS_TO_TICKS(EVTRACE_SYNC_MS) - 1;
+  UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+  uint64_t now = esp_timer_get_time();
+  put_event(core, EVTRACE_SYNC, (uint32_t)now, (uint32_t)(now >> 32));
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+}
+
+static record_frame_t out;
+
+static size_t send_uart(const void *data, size_t len, void *ctx) {
+  return uart_write_bytes(port, data, len);
+}
+
+static void send_info(void) {
+  uint8_t *p = record_frame_reserve(&out, 1 + EVTRACE_INFO_LEN);
+  p[0] = EVTRACE_INFO_LEN;
+  p[1] = EVTRACE_INFO;
+  put32(&p[2], CPU_HZ);
+  p[6] = portNUM_PROCESSORS;
+}
+
+static void put_lost(uint8_t *p, int core, uint32_t count) {
+  p[0] = EVTRACE_LOST_LEN;
+  p[1] = EVTRACE_LOST;
+  p[2] = core;
+  put32(&p[3], count);
+}
+
+// Mit jedem SYNC-Abstand auch Tasknamen und Takt neu melden, damit ein
+// später gestarteter Host-Empfänger sie ebenfalls bekommt
+static void sender(void *arg) {
+  send_info();
+  TickType_t last_wake = xTaskGetTickCount();
+  TickType_t last_info = last_wake;
+  while (1) {
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+      core_state_t *c = &cores[core];
+      record_frame_drain(&out, &c->ring, core, c->stats.dropped,
+                         &c->reported_drops);
+    }
+    record_frame_flush(&out);
+    vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(EVTRACE_FLUSH_MS));
+    if (last_wake - last_info >= pdMS_TO_TICKS(EVTRACE_SYNC_MS)) {
+      last_info = last_wake;
+      for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        cores[core].forget = true;
+      }
+      send_info();
+    }
+  }
+}
+
+esp_err_t evtrace_start(int uart_port) {
+  if (port >= 0) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  if (uart_port < 0 || uart_port >= SOC_UART_NUM) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (!uart_is_driver_installed(uart_port)) {
+    esp_err_t err = uart_driver_install(uart_port, UART_RX_BUF, UART_TX_BUF,
+                                        0, NULL, 0);
+    if (err != ESP_OK) {
+      return err;
+    }
+  }
+  for (int core = 0; core < portNUM_PROCESSORS; core++) {
+    ring_init(&cores[core].ring, cores[core].mem, EVTRACE_RING_SIZE);
+    esp_err_t err = esp_register_freertos_tick_hook_for_cpu(tick_hook, core);
+    if (err != ESP_OK) {
+      return err;
+    }
+  }
+  record_frame_config_t config = {
+      .tag = EVTRACE_FRAME_TAG,
+      .max_record = MAX_RECORD,
+      .lost_len = 1 + EVTRACE_LOST_LEN,
+      .lost = put_lost,
+      .send = send_uart,
+  };
+  record_frame_init(&out, &config);
+  port = uart_port;
+  if (xTaskCreate(sender, "evtrace", SENDER_STACK, NULL, SENDER_PRIORITY,
+                  NULL) != pdPASS) {
+    port = -1;
+    return ESP_ERR_NO_MEM;
+  }
+  running = true;
+  return ESP_OK;
+}
+
+// Die Zähler des anderen Kerns können mitten in einer Aktualisierung
+// gelesen werden; für eine Statistik reicht das
+evtrace_stats_t evtrace_get_stats(int core) {
+  evtrace_stats_t s = {0};
+  if (core >= 0 && core < portNUM_PROCESSORS) {
+    s = cores[core].stats;
+  }
+  return s;
+}
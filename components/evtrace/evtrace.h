@@ -0,0 +1,86 @@
+#pragma once
+
+#include "esp_err.h"
+#include "evtrace_format.h"
+#include "sdkconfig.h"
+#include <stdint.h>
+
+/*
+Ereignis-Tracer für ISRs und Tasks mit Zeitstempeln aus dem Zykluszähler
+(CCOUNT, ein Takt Auflösung). Aufgezeichnet werden:
+
+  EVTRACE_ISR_ENTER/EXIT(name)   Beginn und Ende einer ISR oder einer
+                                 Funktion, die in einer ISR läuft
+  EVTRACE_BEGIN/END(name)        Abschnitt in einer Task
+  EVTRACE_MARK(name, wert)       einzelner Zeitpunkt
+  EVTRACE_VALUE(name, wert)      Verlauf eines Werts (z.B. Füllstand)
+  Kontextwechsel                 automatisch, über --wrap an
+                                 vTaskSwitchContext
+
+`name` muss ein String-Literal sein; gespeichert wird nur seine Adresse,
+host/evtrace_json liest den Text aus der ELF-Datei und schreibt JSON im
+Chrome-Trace-Format (Perfetto, chrome://tracing) sowie Dauer und Jitter
+jeder ISR.
+
+Jeder Kern hat seinen eigenen Ring. Ein Ereignis sperrt nur die Interrupts
+des eigenen Kerns für die Dauer des Kopierens (rund 50 Takte), ohne
+Spinlock zwischen den Kernen; die Makros dürfen daher in IRAM-ISRs stehen.
+Vor evtrace_start() kehren sie sofort zurück. Eine Task niedriger Priorität
+sendet die Ringe als Frames über eine UART, bei vollem Ring wird verworfen
+und später gemeldet.
+
+Eingeschaltet wird der Tracer mit CONFIG_EVTRACE_ENABLE (idf.py menuconfig,
+"Event-Trace (evtrace)"). Ohne die Option und auf dem Linux-Target sind die
+Makros leer und evtrace_start() meldet ESP_ERR_NOT_SUPPORTED.
+*/
+
+#define EVTRACE_RING_SIZE 8192 // pro Kern, Zweierpotenz
+#define EVTRACE_FLUSH_MS 20
+#define EVTRACE_SYNC_MS 1000 // Abstand der EVTRACE_SYNC-Ereignisse
+
+typedef struct {
+  uint32_t events;
+  uint32_t dropped; // Ring voll
+  uint32_t max_fill; // höchster Füllstand des Rings in Bytes
+} evtrace_stats_t;
+
+#if !CONFIG_EVTRACE_ENABLE
+
+#define EVTRACE_ISR_ENTER(name) ((void)0)
+#define EVTRACE_ISR_EXIT(name) ((void)0)
+#define EVTRACE_BEGIN(name) ((void)0)
+#define EVTRACE_END(name) ((void)0)
+#define EVTRACE_MARK(name, value) ((void)0)
+#define EVTRACE_VALUE(name, value) ((void)0)
+
+static inline esp_err_t evtrace_start(int uart_port) {
+  return ESP_ERR_NOT_SUPPORTED;
+}
+static inline evtrace_stats_t evtrace_get_stats(int core) {
+  return (evtrace_stats_t){0};
+}
+
+#else
+
+#define EVTRACE_ISR_ENTER(name) evtrace_event(EVTRACE_ISR_ENTER, name, 0)
+#define EVTRACE_ISR_EXIT(name) evtrace_event(EVTRACE_ISR_EXIT, name, 0)
+#define EVTRACE_BEGIN(name) evtrace_task_event(EVTRACE_BEGIN, name)
+#define EVTRACE_END(name) evtrace_task_event(EVTRACE_END, name)
+#define EVTRACE_MARK(name, value)                                              \
+  evtrace_event(EVTRACE_MARK, name, (uint32_t)(value))
+#define EVTRACE_VALUE(name, value)                                             \
+  evtrace_event(EVTRACE_VALUE, name, (uint32_t)(value))
+
+// Startet die Aufzeichnung und die Sende-Task. Ist auf `uart_port` noch kein
+// Treiber installiert, wird er installiert; Pins und Baudrate stellt der
+// Aufrufer ein. Die Konsolen-UART ist ungeeignet, dort mischen sich die
+// Frames mit Text.
+esp_err_t evtrace_start(int uart_port);
+
+// Zähler eines Kerns seit dem Start
+evtrace_stats_t evtrace_get_stats(int core);
+
+void evtrace_event(uint8_t type, const char *name, uint32_t arg);
+void evtrace_task_event(uint8_t type, const char *name);
+
+#endif
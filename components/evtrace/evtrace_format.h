@@ -0,0 +1,58 @@
+#pragma once
+
+/*
+Leitungsformat des Ereignis-Tracers, Rahmen wie beim Profiler.
+
+Ein Datensatz:
+
+  [len][type][payload]     len = Bytes nach len
+
+  Ereignisse   [core][ccount u32][id u32][arg u32]
+    EVTRACE_ISR_ENTER    id = Name
+    EVTRACE_ISR_EXIT     id = Name
+    EVTRACE_BEGIN        id = Name, arg = aufrufende Task
+    EVTRACE_END          id = Name, arg = aufrufende Task
+    EVTRACE_MARK         id = Name, arg = Wert
+    EVTRACE_VALUE        id = Name, arg = Wert (int32)
+    EVTRACE_SWITCH       id = neue Task, arg = vorherige Task
+    EVTRACE_SYNC         id, arg = esp_timer_get_time() (µs, low/high)
+
+  EVTRACE_TASK   [core][task u32][name ...]   Name zu einem TaskHandle_t
+  EVTRACE_LOST   [core][anzahl u32]           verworfene Datensätze seit
+                                              der letzten Meldung
+  EVTRACE_INFO   [cpu_hz u32][cores]
+
+ccount ist der Zykluszähler (CCOUNT) des Kerns. Die Zähler der Kerne laufen
+nicht synchron und laufen nach 2^32 Zyklen über; EVTRACE_SYNC verknüpft sie
+regelmäßig mit der gemeinsamen esp_timer-Zeit. Namen sind Adressen von
+String-Literalen in der Firmware, der Host liest sie aus der ELF-Datei.
+
+Werte little endian. Frames:
+
+  0x00 COBS([EVTRACE_FRAME_TAG][seq][datensatz ...][crc16 lo][crc16 hi]) 0x00
+
+Die Datei ist unabhängig von ESP-IDF und wird auch von host/evtrace_json
+benutzt.
+*/
+
+#define EVTRACE_FRAME_TAG 0xA6
+#define EVTRACE_MAX_NAME 16
+
+#define EVTRACE_EVENT_LEN 14
+#define EVTRACE_TASK_LEN(name_len) (6 + (name_len))
+#define EVTRACE_LOST_LEN 6
+#define EVTRACE_INFO_LEN 6
+
+enum {
+  EVTRACE_ISR_ENTER = 1,
+  EVTRACE_ISR_EXIT,
+  EVTRACE_BEGIN,
+  EVTRACE_END,
+  EVTRACE_MARK,
+  EVTRACE_VALUE,
+  EVTRACE_SWITCH,
+  EVTRACE_SYNC,
+  EVTRACE_TASK,
+  EVTRACE_LOST,
+  EVTRACE_INFO,
+};
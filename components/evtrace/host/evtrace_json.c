@@ -0,0 +1,593 @@
+/*
+Auswertung des Ereignis-Tracers: liest Frames von der UART (oder aus einer
+Datei bzw. stdin) bis Dateiende oder Ctrl-C, rechnet die Zykluszähler der
+Kerne über die SYNC-Ereignisse auf eine gemeinsame Zeitachse um und
+schreibt JSON im Chrome-Trace-Format, das Perfetto (ui.perfetto.dev) und
+chrome://tracing öffnen:
+
+  gcc -O2 -Wall -I.. -I../../sms_proto -o evtrace_json evtrace_json.c \
+      ../../sms_proto/cobs.c ../../sms_proto/crc16.c -lm
+  ./evtrace_json build/main.elf /dev/ttyUSB1 921600 > trace.json  (Ctrl-C)
+
+Spuren im JSON:
+
+  CPU / Kern n     laufende Task, darin geschachtelt die ISRs
+                   (EVTRACE_ISR_ENTER/EXIT), Marken und verworfene Ereignisse
+  Tasks / <name>   Abschnitte aus EVTRACE_BEGIN/END
+  Zähler           EVTRACE_VALUE
+
+Auf stderr steht pro ISR und Abschnitt die Anzahl, die Dauer (min/mittel/
+max) und der Abstand zwischen zwei Aufrufen samt Standardabweichung, also
+der Jitter einer periodischen ISR. Text und andere Frames auf derselben
+Leitung werden übersprungen.
+*/
+
+#define _DEFAULT_SOURCE // cfmakeraw
+
+#include "cobs.h"
+#include "crc16.h"
+#include "evtrace_format.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#define CHUNK_MAX 4096
+#define MAX_CORES 2
+#define MAX_TASKS 128
+#define MAX_DEPTH 16 // offene ISRs bzw. Abschnitte pro Spur
+#define MAX_STATS 256
+
+// Belegter Adressbereich eines Abschnitts der ELF-Datei
+typedef struct {
+  uint32_t addr;
+  uint32_t size;
+  const uint8_t *data;
+} section_t;
+
+typedef struct {
+  uint8_t type;
+  uint8_t core;
+  uint32_t ccount;
+  uint32_t id;
+  uint32_t arg;
+} event_t;
+
+typedef struct {
+  const char *name;
+  double start;
+} open_t;
+
+typedef struct {
+  uint32_t handle;
+  char name[EVTRACE_MAX_NAME + 1];
+  open_t open[MAX_DEPTH]; // offene EVTRACE_BEGIN
+  int depth;
+} task_t;
+
+typedef struct {
+  const char *name;
+  int core; // ISRs getrennt nach Kern, Abschnitte -1
+  uint64_t count;
+  double dur_sum, dur_min, dur_max;
+  double last_start;
+  uint64_t periods;
+  double per_sum, per_sq, per_min, per_max;
+} stat_t;
+
+static uint8_t *elf;
+static section_t *sections;
+static size_t section_count;
+static event_t *events;
+static size_t event_count, event_cap;
+static task_t tasks[MAX_TASKS];
+static size_t task_count;
+static stat_t stats[MAX_STATS];
+static size_t stat_count;
+static uint32_t cpu_hz;
+static uint64_t lost_frames;
+static volatile sig_atomic_t stop;
+
+static uint32_t get16(const uint8_t *p) { return p[0] | p[1] << 8; }
+
+static uint32_t get32(const uint8_t *p) {
+  return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+// Nur 32-Bit little endian (Xtensa, RISC-V)
+static bool load_elf(const char *path) {
+  FILE *f = fopen(path, "rb");
+  if (!f) {
+    perror(path);
+    return false;
+  }
+  fseek(f, 0, SEEK_END);
+  long size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  elf = malloc(size);
+  if (!elf || fread(elf, 1, size, f) != (size_t)size) {
+    fclose(f);
+    return false;
+  }
+  fclose(f);
+  if (size < 52 || memcmp(elf, "\x7f" "ELF", 4) != 0 || elf[4] != 1 ||
+      elf[5] != 1) {
+    fprintf(stderr, "%s: keine 32-Bit-ELF-Datei (little endian)\n", path);
+    return false;
+  }
+  uint32_t shoff = get32(&elf[0x20]);
+  uint32_t shentsize = get16(&elf[0x2E]);
+  uint32_t shnum = get16(&elf[0x30]);
+  if (shoff + (uint64_t)shnum * shentsize > (uint64_t)size) {
+    fprintf(stderr, "%s: Abschnittstabelle beschädigt\n", path);
+    return false;
+  }
+  sections = calloc(shnum, sizeof(section_t));
+  for (uint32_t i = 0; i < shnum; i++) {
+    const uint8_t *sh = &elf[shoff + i * shentsize];
+    uint32_t type = get32(&sh[4]);
+    uint32_t flags = get32(&sh[8]);
+    uint32_t addr = get32(&sh[12]);
+    uint32_t offset = get32(&sh[16]);
+    uint32_t sz = get32(&sh[20]);
+    // SHF_ALLOC und Inhalt in der Datei (nicht SHT_NOBITS)
+    if ((flags & 0x2) && type != 8 && addr &&
+        offset + (uint64_t)sz <= (uint64_t)size) {
+      sections[section_count++] = (section_t){addr, sz, &elf[offset]};
+    }
+  }
+  return true;
+}
+
+// Name zu einer Adresse aus der Firmware; unbekannte Adressen als Hex-Text,
+// der bis zum nächsten Aufruf gültig bleibt
+static const char *lookup_string(uint32_t addr) {
+  static char buf[16];
+  for (size_t i = 0; i < section_count; i++) {
+    const section_t *s = &sections[i];
+    if (addr >= s->addr && addr < s->addr + s->size) {
+      const char *p = (const char *)s->data + (addr - s->addr);
+      if (memchr(p, 0, s->size - (addr - s->addr))) {
+        return p;
+      }
+    }
+  }
+  snprintf(buf, sizeof(buf), "0x%08x", addr);
+  return buf;
+}
+
+static task_t *find_task(uint32_t handle, bool create) {
+  for (size_t i = 0; i < task_count; i++) {
+    if (tasks[i].handle == handle) {
+      return &tasks[i];
+    }
+  }
+  if (!create || task_count >= MAX_TASKS) {
+    return NULL;
+  }
+  task_t *t = &tasks[task_count++];
+  t->handle = handle;
+  snprintf(t->name, sizeof(t->name), "task_%08x", handle);
+  return t;
+}
+
+static const char *task_name(uint32_t handle) {
+  task_t *t = find_task(handle, true);
+  return t ? t->name : "?";
+}
+
+// Handles werden nach vTaskDelete wiederverwendet, der letzte Name gilt
+static void set_task_name(uint32_t handle, const uint8_t *name, size_t len) {
+  task_t *t = find_task(handle, true);
+  if (t) {
+    len = len < EVTRACE_MAX_NAME ? len : EVTRACE_MAX_NAME;
+    memcpy(t->name, name, len);
+    t->name[len] = 0;
+  }
+}
+
+static void add_event(const event_t *e) {
+  if (event_count == event_cap) {
+    event_cap = event_cap ? 2 * event_cap : 65536;
+    events = realloc(events, event_cap * sizeof(event_t));
+    if (!events) {
+      fprintf(stderr, "kein Speicher\n");
+      exit(1);
+    }
+  }
+  events[event_count++] = *e;
+}
+
+static void decode_record(const uint8_t *rec, size_t len) {
+  static uint32_t last_ccount[MAX_CORES];
+  switch (rec[0]) {
+  case EVTRACE_TASK:
+    if (len >= EVTRACE_TASK_LEN(0)) {
+      set_task_name(get32(&rec[2]), &rec[6], len - EVTRACE_TASK_LEN(0));
+    }
+    return;
+  case EVTRACE_INFO:
+    if (len == EVTRACE_INFO_LEN) {
+      cpu_hz = get32(&rec[1]);
+    }
+    return;
+  case EVTRACE_LOST:
+    // Als Marke zum Zeitpunkt des letzten Ereignisses des Kerns
+    if (len == EVTRACE_LOST_LEN && rec[1] < MAX_CORES) {
+      add_event(&(event_t){EVTRACE_LOST, rec[1], last_ccount[rec[1]], 0,
+                           get32(&rec[2])});
+    }
+    return;
+  }
+  if (len == EVTRACE_EVENT_LEN && rec[0] >= EVTRACE_ISR_ENTER &&
+      rec[0] <= EVTRACE_SYNC && rec[1] < MAX_CORES) {
+    event_t e = {rec[0], rec[1], get32(&rec[2]), get32(&rec[6]),
+                 get32(&rec[10])};
+    last_ccount[e.core] = e.ccount;
+    add_event(&e);
+  }
+}
+
+static bool decode_frame(bool *have_seq, uint8_t *seq, const uint8_t *in,
+                         size_t len) {
+  static uint8_t buf[CHUNK_MAX];
+  len = cobs_decode(in, len, buf);
+  if (len < 4 || buf[0] != EVTRACE_FRAME_TAG ||
+      crc16_ccitt(buf, len - 2) != get16(&buf[len - 2])) {
+    return false;
+  }
+  len -= 2;
+  if (*have_seq && buf[1] != (uint8_t)(*seq + 1)) {
+    lost_frames += (uint8_t)(buf[1] - *seq - 1);
+  }
+  *seq = buf[1];
+  *have_seq = true;
+  for (size_t pos = 2; pos < len;) {
+    size_t rec_len = buf[pos];
+    if (rec_len == 0 || pos + 1 + rec_len > len) {
+      break;
+    }
+    decode_record(&buf[pos + 1], rec_len);
+    pos += 1 + rec_len;
+  }
+  return true;
+}
+
+// JSON-String samt Anführungszeichen
+static void json_string(const char *s) {
+  putchar('"');
+  for (; *s; s++) {
+    if (*s == '"' || *s == '\\') {
+      printf("\\%c", *s);
+    } else if ((unsigned char)*s < 0x20) {
+      printf("\\u%04x", *s);
+    } else {
+      putchar(*s);
+    }
+  }
+  putchar('"');
+}
+
+static bool first_event = true;
+
+static void json_begin(const char *name, char ph, double ts, int pid,
+                       uint32_t tid) {
+  printf("%s\n{\"name\":", first_event ? "" : ",");
+  first_event = false;
+  json_string(name);
+  printf(",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":%d,\"tid\":%u", ph, ts, pid, tid);
+}
+
+static void json_meta(const char *what, int pid, uint32_t tid,
+                      const char *name) {
+  json_begin(what, 'M', 0, pid, tid);
+  printf(",\"args\":{\"name\":");
+  json_string(name);
+  printf("}}");
+}
+
+static void json_slice(const char *name, double start, double end, int pid,
+                       uint32_t tid) {
+  json_begin(name, 'X', start, pid, tid);
+  printf(",\"dur\":%.3f}", end - start);
+}
+
+static stat_t *find_stat(const char *name, int core) {
+  for (size_t i = 0; i < stat_count; i++) {
+    if (stats[i].core == core && strcmp(stats[i].name, name) == 0) {
+      return &stats[i];
+    }
+  }
+  if (stat_count >= MAX_STATS) {
+    return NULL;
+  }
+  stat_t *s = &stats[stat_count++];
+  *s = (stat_t){.name = name, .core = core};
+  return s;
+}
+
+static void stat_start(stat_t *s, double t) {
+  if (!s) {
+    return;
+  }
+  if (s->count) {
+    double p = t - s->last_start;
+    s->per_sum += p;
+    s->per_sq += p * p;
+    s->per_min = s->periods && s->per_min < p ? s->per_min : p;
+    s->per_max = s->per_max > p ? s->per_max : p;
+    s->periods++;
+  }
+  s->last_start = t;
+}
+
+static void stat_end(stat_t *s, double dur) {
+  if (!s) {
+    return;
+  }
+  s->dur_sum += dur;
+  s->dur_min = s->count && s->dur_min < dur ? s->dur_min : dur;
+  s->dur_max = s->dur_max > dur ? s->dur_max : dur;
+  s->count++;
+}
+
+typedef struct {
+  uint64_t cycles; // ohne Überlauf
+  double sync_us;  // Zeit des letzten SYNC
+  uint64_t sync_cycles;
+  bool have_sync;
+} core_clock_t;
+
+// Mikrosekunden auf der gemeinsamen Zeitachse. Vor dem ersten SYNC eines
+// Kerns gilt dessen erster SYNC rückwirkend, daher zwei Durchläufe.
+static double to_us(const core_clock_t *c, uint64_t cycles) {
+  double mhz = cpu_hz / 1e6;
+  return c->sync_us + ((double)cycles - (double)c->sync_cycles) / mhz;
+}
+
+static void convert_core(int core) {
+  core_clock_t clk = {0};
+  uint32_t prev = 0;
+  bool started = false;
+  // Erster SYNC als Bezugspunkt für die Ereignisse davor
+  for (size_t i = 0; i < event_count; i++) {
+    const event_t *e = &events[i];
+    if (e->core != core) {
+      continue;
+    }
+    clk.cycles += started ? (uint32_t)(e->ccount - prev) : 0;
+    prev = e->ccount;
+    started = true;
+    if (e->type == EVTRACE_SYNC) {
+      clk.sync_us = e->id | (uint64_t)e->arg << 32;
+      clk.sync_cycles = clk.cycles;
+      break;
+    }
+  }
+  if (!started) {
+    return;
+  }
+
+  json_meta("thread_name", 0, core, core ? "Kern 1" : "Kern 0");
+  open_t isr[MAX_DEPTH];
+  int depth = 0;
+  uint32_t task = 0;
+  double task_start = 0, t = 0;
+  clk.cycles = 0;
+  started = false;
+  for (size_t i = 0; i < event_count; i++) {
+    const event_t *e = &events[i];
+    if (e->core != core) {
+      continue;
+    }
+    clk.cycles += started ? (uint32_t)(e->ccount - prev) : 0;
+    prev = e->ccount;
+    started = true;
+    t = to_us(&clk, clk.cycles);
+    switch (e->type) {
+    case EVTRACE_SYNC:
+      clk.sync_us = e->id | (uint64_t)e->arg << 32;
+      clk.sync_cycles = clk.cycles;
+      break;
+    case EVTRACE_ISR_ENTER:
+      if (depth < MAX_DEPTH) {
+        const char *name = strdup(lookup_string(e->id));
+        isr[depth++] = (open_t){name, t};
+        stat_start(find_stat(name, core), t);
+      }
+      break;
+    case EVTRACE_ISR_EXIT: {
+      // Nicht beendete innere ISRs (verworfene Ereignisse) werden verworfen
+      const char *name = lookup_string(e->id);
+      for (int d = depth - 1; d >= 0; d--) {
+        if (strcmp(isr[d].name, name) == 0) {
+          json_slice(isr[d].name, isr[d].start, t, 0, core);
+          stat_end(find_stat(isr[d].name, core), t - isr[d].start);
+          depth = d;
+          break;
+        }
+      }
+      break;
+    }
+    case EVTRACE_SWITCH: {
+      if (task) {
+        json_slice(task_name(task), task_start, t, 0, core);
+      }
+      task = e->id;
+      task_start = t;
+      break;
+    }
+    case EVTRACE_BEGIN: {
+      task_t *tk = find_task(e->arg, true);
+      if (tk && tk->depth < MAX_DEPTH) {
+        const char *name = strdup(lookup_string(e->id));
+        tk->open[tk->depth++] = (open_t){name, t};
+        stat_start(find_stat(name, -1), t);
+      }
+      break;
+    }
+    case EVTRACE_END: {
+      task_t *tk = find_task(e->arg, true);
+      const char *name = lookup_string(e->id);
+      for (int d = tk ? tk->depth - 1 : -1; d >= 0; d--) {
+        if (strcmp(tk->open[d].name, name) == 0) {
+          json_slice(tk->open[d].name, tk->open[d].start, t, 1, tk->handle);
+          stat_end(find_stat(tk->open[d].name, -1),
+                   t - tk->open[d].start);
+          tk->depth = d;
+          break;
+        }
+      }
+      break;
+    }
+    case EVTRACE_MARK:
+      json_begin(lookup_string(e->id), 'i', t, 0, core);
+      printf(",\"s\":\"t\",\"args\":{\"value\":%u}}", e->arg);
+      break;
+    case EVTRACE_VALUE:
+      json_begin(lookup_string(e->id), 'C', t, 0, core);
+      printf(",\"args\":{\"value\":%d}}", (int32_t)e->arg);
+      break;
+    case EVTRACE_LOST:
+      json_begin("verworfen", 'i', t, 0, core);
+      printf(",\"s\":\"t\",\"args\":{\"count\":%u}}", e->arg);
+      break;
+    }
+  }
+  if (task) {
+    json_slice(task_name(task), task_start, t, 0, core);
+  }
+}
+
+static void print_stats(void) {
+  fprintf(stderr, "%-24s %8s %10s %10s %10s   %10s %10s %10s %10s\n",
+          "", "Anzahl", "Dauer min", "mittel", "max", "Abst. min", "mittel",
+          "max", "stddev");
+  for (size_t i = 0; i < stat_count; i++) {
+    const stat_t *s = &stats[i];
+    if (!s->count) {
+      continue;
+    }
+    double per_avg = s->periods ? s->per_sum / s->periods : 0;
+    double var = s->periods ? s->per_sq / s->periods - per_avg * per_avg : 0;
+    fprintf(stderr,
+            "%-20.20s %-3s %8llu %10.2f %10.2f %10.2f   %10.1f %10.1f "
+            "%10.1f %10.2f\n",
+            s->name, s->core < 0 ? "" : s->core ? "K1" : "K0",
+            (unsigned long long)s->count,
+            s->dur_min, s->dur_sum / s->count, s->dur_max, s->per_min,
+            per_avg, s->per_max, var > 0 ? sqrt(var) : 0);
+  }
+  fprintf(stderr, "Zeiten in µs, %zu Ereignisse, %llu Frames verloren\n",
+          event_count, (unsigned long long)lost_frames);
+}
+
+static speed_t baud_to_speed(int baud) {
+  switch (baud) {
+  case 115200:
+    return B115200;
+  case 230400:
+    return B230400;
+  case 460800:
+    return B460800;
+  case 921600:
+    return B921600;
+  case 2000000:
+    return B2000000;
+  default:
+    return B0;
+  }
+}
+
+static int open_input(const char *path, int baud) {
+  if (!path || strcmp(path, "-") == 0) {
+    return STDIN_FILENO;
+  }
+  int fd = open(path, O_RDONLY | O_NOCTTY | O_CLOEXEC);
+  if (fd < 0 || !isatty(fd)) {
+    return fd;
+  }
+  struct termios tio;
+  speed_t speed = baud_to_speed(baud);
+  if (speed == B0 || tcgetattr(fd, &tio) < 0) {
+    fprintf(stderr, "Baudrate %d nicht unterstützt\n", baud);
+    close(fd);
+    return -1;
+  }
+  cfmakeraw(&tio);
+  cfsetispeed(&tio, speed);
+  cfsetospeed(&tio, speed);
+  tcsetattr(fd, TCSANOW, &tio);
+  return fd;
+}
+
+static void on_signal(int sig) { stop = 1; }
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "Aufruf: %s firmware.elf [gerät|datei|-] [baud]\n",
+            argv[0]);
+    return 2;
+  }
+  if (!load_elf(argv[1])) {
+    return 1;
+  }
+  int fd = open_input(argc > 2 ? argv[2] : NULL,
+                      argc > 3 ? atoi(argv[3]) : 921600);
+  if (fd < 0) {
+    perror(argv[2]);
+    return 1;
+  }
+  // Von einer UART wird bis Ctrl-C gelesen, danach ausgewertet; ohne
+  // SA_RESTART bricht read() dabei ab
+  struct sigaction sa = {.sa_handler = on_signal};
+  sigaction(SIGINT, &sa, NULL);
+  sigaction(SIGTERM, &sa, NULL);
+
+  bool have_seq = false;
+  uint8_t seq = 0;
+  static uint8_t chunk[CHUNK_MAX];
+  size_t chunk_len = 0;
+  uint8_t buf[4096];
+  ssize_t got;
+  while (!stop && ((got = read(fd, buf, sizeof(buf))) > 0 ||
+                   (got < 0 && errno == EINTR))) {
+    for (ssize_t i = 0; i < got; i++) {
+      if (buf[i] != 0) {
+        if (chunk_len < CHUNK_MAX) {
+          chunk[chunk_len++] = buf[i];
+        }
+        continue;
+      }
+      if (chunk_len) {
+        decode_frame(&have_seq, &seq, chunk, chunk_len);
+      }
+      chunk_len = 0;
+    }
+  }
+  if (!cpu_hz) {
+    fprintf(stderr, "kein EVTRACE_INFO empfangen, nehme 240 MHz an\n");
+    cpu_hz = 240000000;
+  }
+
+  printf("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+  json_meta("process_name", 0, 0, "CPU");
+  json_meta("process_name", 1, 0, "Tasks");
+  for (int core = 0; core < MAX_CORES; core++) {
+    convert_core(core);
+  }
+  for (size_t i = 0; i < task_count; i++) {
+    json_meta("thread_name", 1, tasks[i].handle, tasks[i].name);
+  }
+  printf("\n]}\n");
+  print_stats();
+  return 0;
+}
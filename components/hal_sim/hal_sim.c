@@ -0,0 +1,261 @@
+#include "hal_sim.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include <errno.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Ohne Ereignis trotzdem so oft nachsehen, ob die Laufzeit abgelaufen ist
+#define IDLE_WAIT_MS 100
+#define IRQ_TASK_STACK 8192
+
+static const char *const stat_names[HAL_SIM_STAT_COUNT] = {
+    [HAL_SIM_STAT_I2C] = "i2c",         [HAL_SIM_STAT_GPIO] = "gpio",
+    [HAL_SIM_STAT_ONEWIRE] = "onewire", [HAL_SIM_STAT_LCD] = "lcd",
+    [HAL_SIM_STAT_TIMER] = "timer",     [HAL_SIM_STAT_IRQ] = "irq",
+};
+
+static atomic_int init_state; // 0 = nie, 1 = läuft, 2 = fertig
+static TaskHandle_t init_task; // Task, die gerade initialisiert
+static int64_t start_ns;
+static bool bus_delay = true;
+static int64_t duration_ns;
+static volatile sig_atomic_t stop_requested;
+
+static SemaphoreHandle_t event_lock;
+static hal_sim_event_t *events; // nach at_ns sortiert
+static TaskHandle_t irq_task_handle;
+static int64_t irq_time_ns = -1;
+
+static SemaphoreHandle_t stat_lock;
+static hal_sim_stat_t stats[HAL_SIM_STAT_COUNT];
+
+static int64_t monotonic_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+int64_t hal_sim_now_ns(void) {
+  if (irq_time_ns >= 0 && xTaskGetCurrentTaskHandle() == irq_task_handle) {
+    return irq_time_ns;
+  }
+  return monotonic_ns() - start_ns;
+}
+
+void hal_sim_irq_set_time(int64_t ns) { irq_time_ns = ns; }
+
+void hal_sim_bus_delay(int64_t ns) {
+  if (!bus_delay || ns <= 0) {
+    return;
+  }
+  // Aktives Warten wie ein blockierender Treiber; Signale des POSIX-Ports
+  // unterbrechen den Schlaf, daher bis zum Ziel wiederholen
+  int64_t until = monotonic_ns() + ns;
+  struct timespec ts = {.tv_sec = until / 1000000000LL,
+                        .tv_nsec = until % 1000000000LL};
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+  }
+}
+
+void hal_sim_stat_record(hal_sim_stat_id_t id, int64_t start, int64_t bus_ns,
+                         size_t bytes, bool error) {
+  int64_t elapsed = hal_sim_now_ns() - start;
+  if (bus_delay) {
+    elapsed -= bus_ns;
+  }
+  if (elapsed < 0) {
+    elapsed = 0;
+  }
+  xSemaphoreTake(stat_lock, portMAX_DELAY);
+  hal_sim_stat_t *s = &stats[id];
+  s->calls++;
+  s->errors += error;
+  s->bytes += bytes;
+  s->bus_ns += bus_ns;
+  s->host_ns += elapsed;
+  if (elapsed > s->max_ns) {
+    s->max_ns = elapsed;
+  }
+  xSemaphoreGive(stat_lock);
+}
+
+hal_sim_stat_t hal_sim_stat_get(hal_sim_stat_id_t id) {
+  xSemaphoreTake(stat_lock, portMAX_DELAY);
+  hal_sim_stat_t s = stats[id];
+  xSemaphoreGive(stat_lock);
+  return s;
+}
+
+void hal_sim_report(FILE *out) {
+  fprintf(out, "\nhal_sim nach %.3f s\n", hal_sim_now_ns() / 1e9);
+  fprintf(out, "%-8s %10s %7s %10s %10s %10s %9s %9s\n", "periph", "calls",
+          "errors", "bytes", "bus_ms", "host_ms", "avg_us", "max_us");
+  for (int i = 0; i < HAL_SIM_STAT_COUNT; i++) {
+    hal_sim_stat_t s = hal_sim_stat_get(i);
+    if (s.calls == 0) {
+      continue;
+    }
+    fprintf(out, "%-8s %10llu %7llu %10llu %10.3f %10.3f %9.2f %9.2f\n",
+            stat_names[i], (unsigned long long)s.calls,
+            (unsigned long long)s.errors, (unsigned long long)s.bytes,
+            s.bus_ns / 1e6, s.host_ns / 1e6,
+            (s.host_ns + (double)s.bus_ns) / s.calls / 1e3, s.max_ns / 1e3);
+  }
+  fprintf(out, "(irq: host_ms/max_us = Verspätung der Zustellung)\n");
+  hal_sim_replay_report(out);
+  fflush(out);
+}
+
+// Ereignisse
+
+static void insert_locked(hal_sim_event_t *ev) {
+  hal_sim_event_t **p = &events;
+  while (*p && (*p)->at_ns <= ev->at_ns) {
+    p = &(*p)->next;
+  }
+  ev->next = *p;
+  *p = ev;
+  ev->queued = true;
+}
+
+static void remove_locked(hal_sim_event_t *ev) {
+  for (hal_sim_event_t **p = &events; *p; p = &(*p)->next) {
+    if (*p == ev) {
+      *p = ev->next;
+      break;
+    }
+  }
+  ev->queued = false;
+}
+
+void hal_sim_event_schedule(hal_sim_event_t *ev, int64_t at_ns) {
+  hal_sim_init();
+  xSemaphoreTake(event_lock, portMAX_DELAY);
+  if (ev->queued) {
+    remove_locked(ev);
+  }
+  ev->at_ns = at_ns;
+  insert_locked(ev);
+  bool first = events == ev;
+  xSemaphoreGive(event_lock);
+
+  // Die Interrupt-Task schläft womöglich bis zu einem späteren Ereignis
+  if (first && xTaskGetCurrentTaskHandle() != irq_task_handle) {
+    xTaskNotifyGive(irq_task_handle);
+  }
+}
+
+void hal_sim_event_cancel(hal_sim_event_t *ev) {
+  if (!event_lock) {
+    return;
+  }
+  xSemaphoreTake(event_lock, portMAX_DELAY);
+  if (ev->queued) {
+    remove_locked(ev);
+  }
+  xSemaphoreGive(event_lock);
+}
+
+static void on_signal(int sig) { stop_requested = 1; }
+
+static void finish(void) {
+  hal_sim_lcd_dump();
+  hal_sim_report(stdout);
+}
+
+static void irq_task(void *arg) {
+  const int64_t tick_ns = 1000000000LL / configTICK_RATE_HZ;
+
+  while (1) {
+    // Immer nur ein Ereignis entnehmen: ein Callback darf andere Ereignisse
+    // neu planen oder abbrechen
+    int64_t now = hal_sim_now_ns();
+    xSemaphoreTake(event_lock, portMAX_DELAY);
+    hal_sim_event_t *ev = events;
+    if (ev && ev->at_ns <= now) {
+      remove_locked(ev);
+    } else {
+      ev = NULL;
+    }
+    int64_t next = events ? events->at_ns : -1;
+    xSemaphoreGive(event_lock);
+
+    if (ev) {
+      int64_t late = now - ev->at_ns;
+      ev->fn(ev, ev->at_ns);
+      irq_time_ns = -1;
+      xSemaphoreTake(stat_lock, portMAX_DELAY);
+      stats[HAL_SIM_STAT_IRQ].calls++;
+      stats[HAL_SIM_STAT_IRQ].host_ns += late;
+      if (late > stats[HAL_SIM_STAT_IRQ].max_ns) {
+        stats[HAL_SIM_STAT_IRQ].max_ns = late;
+      }
+      xSemaphoreGive(stat_lock);
+      continue;
+    }
+
+    if (stop_requested || (duration_ns > 0 && now >= duration_ns)) {
+      exit(0); // finish() läuft über atexit
+    }
+
+    int64_t wait_ns = IDLE_WAIT_MS * 1000000LL;
+    if (next >= 0 && next - now < wait_ns) {
+      wait_ns = next - now;
+    }
+    TickType_t ticks = (wait_ns + tick_ns - 1) / tick_ns;
+    ulTaskNotifyTake(pdTRUE, ticks > 0 ? ticks : 1);
+  }
+}
+
+void hal_sim_init(void) {
+  int expected = 0;
+  if (!atomic_compare_exchange_strong(&init_state, &expected, 1)) {
+    // Die Gerätemodelle melden sich beim Laden selbst bei den Treibern an
+    // und landen dabei wieder hier; nur andere Tasks warten, bis alle
+    // Geräte und der Mitschnitt geladen sind
+    if (init_task == xTaskGetCurrentTaskHandle()) {
+      return;
+    }
+    while (atomic_load(&init_state) != 2) {
+      vTaskDelay(1);
+    }
+    return;
+  }
+
+  init_task = xTaskGetCurrentTaskHandle();
+  start_ns = monotonic_ns();
+  const char *env = getenv("HAL_SIM_BUS_DELAY");
+  bus_delay = !env || atoi(env) != 0;
+  env = getenv("HAL_SIM_DURATION_S");
+  duration_ns = env ? (int64_t)(atof(env) * 1e9) : 0;
+
+  event_lock = xSemaphoreCreateMutex();
+  stat_lock = xSemaphoreCreateMutex();
+  xTaskCreate(irq_task, "hal_sim_irq", IRQ_TASK_STACK, NULL,
+              configMAX_PRIORITIES - 1, &irq_task_handle);
+  signal(SIGINT, on_signal);
+  signal(SIGTERM, on_signal);
+
+  // Im Replay liefert der Mitschnitt die Geräte; die eingebaute Vorgabe
+  // würde sonst z. B. zusätzliche Echos erzeugen
+  const char *replay = getenv("HAL_SIM_REPLAY");
+  const char *script = getenv("HAL_SIM_SCRIPT");
+  if ((!replay || script) && hal_sim_devices_load(script) != ESP_OK) {
+    fprintf(stderr, "hal_sim: Skript fehlerhaft, Abbruch\n");
+    exit(1);
+  }
+  if (replay && hal_sim_replay_load(replay) != ESP_OK) {
+    fprintf(stderr, "hal_sim: Mitschnitt nicht lesbar, Abbruch\n");
+    exit(1);
+  }
+
+  // Erst jetzt ist die Simulation vollständig; ein Abbruch oben gibt
+  // keinen Bericht über halb angelegte Geräte aus
+  atexit(finish);
+  atomic_store(&init_state, 2);
+}
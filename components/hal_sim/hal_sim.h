@@ -0,0 +1,193 @@
+#pragma once
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+Simulierte Peripherie für das ESP-IDF-Target "linux".
+
+Die Komponente ersetzt auf dem PC die Treiber, die es dort nicht gibt:
+driver/i2c.h (Legacy-API), driver/gpio.h, driver/gptimer.h,
+driver/mcpwm_cap.h, esp_timer.h, esp_cpu.h, den 1-Wire-Bus (onewire_bus.h)
+und die LCD-Panel-API (esp_lcd_*). Die Header unter include/ bilden nur den
+Teil der ESP-IDF-API nach, den die Projekte im Repo benutzen. Auf allen
+anderen Targets registriert sich die Komponente leer.
+
+Hinter den Treibern hängen virtuelle Geräte (EEPROM, MPU6050, DS18B20,
+HC-SR04, ILI9341), die über ein Skript konfiguriert werden:
+
+  HAL_SIM_SCRIPT=devices.txt   Gerätebeschreibung, ohne: eingebaute Vorgabe
+  HAL_SIM_DURATION_S=10        nach 10 s Bericht ausgeben und beenden
+  HAL_SIM_BUS_DELAY=0          Buszeiten nur zählen statt abwarten
+  HAL_SIM_REPLAY=trace.bin     Mitschnitt von periph_trace abspielen
+
+Pro Zeile ein Gerät mit key=value-Parametern, siehe hal_sim_devices.c.
+
+Im Replay beantworten die aufgezeichneten Transaktionen die Treiberaufrufe
+(siehe hal_sim_replay.c); Gerätemodelle gibt es dann nur mit
+HAL_SIM_SCRIPT, sie springen ein, wo der Mitschnitt nicht passt.
+
+Zeit ist die echte Zeit seit Programmstart in ns. Interrupts (GPIO-ISR,
+MCPWM-Capture, gptimer-Alarm) und esp_timer-Callbacks laufen in einer Task
+höchster Priorität. Sie wird nur im Takt des FreeRTOS-Ticks geweckt, ein
+Ereignis kommt also bis zu einem Tick zu spät an. Damit Messungen trotzdem
+stimmen, sieht ein simulierter Interrupt als aktuelle Zeit den Zeitpunkt
+des Ereignisses plus die eingestellte Interrupt-Latenz.
+
+Für jede Peripherie werden Aufrufe, übertragene Bytes, modellierte Buszeit
+und die Rechenzeit im Treiber gezählt und am Ende als Tabelle ausgegeben.
+*/
+
+typedef enum {
+  HAL_SIM_STAT_I2C,
+  HAL_SIM_STAT_GPIO,
+  HAL_SIM_STAT_ONEWIRE,
+  HAL_SIM_STAT_LCD,
+  HAL_SIM_STAT_TIMER,
+  HAL_SIM_STAT_IRQ, // Verspätung der Zustellung statt Rechenzeit
+  HAL_SIM_STAT_COUNT,
+} hal_sim_stat_id_t;
+
+typedef struct {
+  uint64_t calls;
+  uint64_t errors;
+  uint64_t bytes;
+  int64_t bus_ns;  // modellierte Zeit auf dem Bus
+  int64_t host_ns; // Rechenzeit im Treiber (ohne bus_ns)
+  int64_t max_ns;  // längste Rechenzeit eines einzelnen Aufrufs
+} hal_sim_stat_t;
+
+// Startet die Interrupt-Task und liest das Skript. Jeder Treiber ruft das
+// beim ersten Aufruf selbst auf.
+void hal_sim_init(void);
+
+int64_t hal_sim_now_ns(void);
+
+// Wartet die modellierte Buszeit ab (außer mit HAL_SIM_BUS_DELAY=0)
+void hal_sim_bus_delay(int64_t ns);
+
+// Zählt einen Treiberaufruf. `start_ns` ist hal_sim_now_ns() beim Eintritt,
+// die Buszeit wird von der gemessenen Dauer abgezogen.
+void hal_sim_stat_record(hal_sim_stat_id_t id, int64_t start_ns,
+                         int64_t bus_ns, size_t bytes, bool error);
+hal_sim_stat_t hal_sim_stat_get(hal_sim_stat_id_t id);
+void hal_sim_report(FILE *out);
+
+// Ereignisse im Interrupt-Kontext. Das Ereignis gehört dem Aufrufer und darf
+// jederzeit neu geplant oder abgebrochen werden.
+typedef struct hal_sim_event hal_sim_event_t;
+typedef void (*hal_sim_event_fn_t)(hal_sim_event_t *ev, int64_t at_ns);
+
+struct hal_sim_event {
+  hal_sim_event_fn_t fn;
+  void *arg;
+  int64_t at_ns;
+  bool queued;
+  hal_sim_event_t *next;
+};
+
+void hal_sim_event_schedule(hal_sim_event_t *ev, int64_t at_ns);
+void hal_sim_event_cancel(hal_sim_event_t *ev);
+
+// Während ein Ereignis zugestellt wird: Zeit, die hal_sim_now_ns() liefert
+// (-1 hebt die Überschreibung auf). Nur für Interrupt-Handler gedacht.
+void hal_sim_irq_set_time(int64_t ns);
+
+// GPIO: Zustand und Pegelwechsel
+
+#define HAL_SIM_GPIO_COUNT 64
+
+typedef void (*hal_sim_gpio_fn_t)(void *ctx, int gpio, int level,
+                                  int64_t at_ns);
+
+// Meldet jeden Pegelwechsel des Pins, egal ob die Anwendung ihn setzt oder
+// ein Gerät ihn treibt
+esp_err_t hal_sim_gpio_listen(int gpio, hal_sim_gpio_fn_t fn, void *ctx);
+
+// Ein Gerät treibt den Pin (im Interrupt-Kontext aufrufen)
+void hal_sim_gpio_drive(int gpio, int level, int64_t at_ns);
+int hal_sim_gpio_level(int gpio);
+
+// Latenz simulierter GPIO-Interrupts: fest plus gleichverteilt 0..jitter
+void hal_sim_gpio_set_latency(int64_t latency_ns, int64_t jitter_ns);
+
+// I2C: Geräte am (einzigen) simulierten Bus
+
+// Ein Schritt einer Kommandoliste, Reihenfolge wie PT_I2C_*
+typedef enum {
+  HAL_SIM_I2C_START,
+  HAL_SIM_I2C_STOP,
+  HAL_SIM_I2C_WRITE,
+  HAL_SIM_I2C_READ,
+} hal_sim_i2c_op_type_t;
+
+typedef struct {
+  hal_sim_i2c_op_type_t type;
+  uint8_t *data; // READ: Ziel der Anwendung, WRITE: eigene Kopie
+  size_t len;
+} hal_sim_i2c_op_t;
+
+typedef struct hal_sim_i2c_dev hal_sim_i2c_dev_t;
+struct hal_sim_i2c_dev {
+  uint8_t addr; // 7 Bit
+  // Eine Transaktion beginnt mit START und endet mit STOP. Dazwischen
+  // liefern write/read die Daten nach dem Adressbyte. ESP_FAIL heißt NACK.
+  void (*start)(hal_sim_i2c_dev_t *dev);
+  esp_err_t (*write)(hal_sim_i2c_dev_t *dev, const uint8_t *data, size_t len);
+  esp_err_t (*read)(hal_sim_i2c_dev_t *dev, uint8_t *data, size_t len);
+  void (*stop)(hal_sim_i2c_dev_t *dev);
+  hal_sim_i2c_dev_t *next;
+};
+
+void hal_sim_i2c_attach(hal_sim_i2c_dev_t *dev);
+hal_sim_i2c_dev_t *hal_sim_i2c_find(uint8_t addr);
+
+// 1-Wire: Geräte an einem Pin. ROM-Befehle erledigt der Bus, das Gerät
+// sieht nur die Funktionsbefehle und Daten, wenn es ausgewählt ist.
+
+typedef struct hal_sim_onewire_dev hal_sim_onewire_dev_t;
+struct hal_sim_onewire_dev {
+  uint64_t rom; // Familiencode im niederwertigsten Byte
+  void (*write_byte)(hal_sim_onewire_dev_t *dev, uint8_t byte);
+  uint8_t (*read_byte)(hal_sim_onewire_dev_t *dev);
+  uint8_t (*read_bit)(hal_sim_onewire_dev_t *dev);
+  void (*reset)(hal_sim_onewire_dev_t *dev);
+  int gpio;
+  hal_sim_onewire_dev_t *next;
+};
+
+void hal_sim_onewire_attach(hal_sim_onewire_dev_t *dev);
+hal_sim_onewire_dev_t *hal_sim_onewire_devices(int gpio);
+
+// Dallas/Maxim CRC8 (x^8 + x^5 + x^4 + 1) für ROM-Codes und Scratchpads
+uint8_t hal_sim_onewire_crc8(const uint8_t *data, size_t len);
+
+// LCD: letztes Bild als PPM sichern (Pfad aus dem Skript, NULL = aus)
+void hal_sim_lcd_set_dump(const char *path);
+void hal_sim_lcd_dump(void);
+
+// Gerätemodelle aus dem Skript anlegen (hal_sim_devices.c)
+esp_err_t hal_sim_devices_load(const char *script);
+
+// Replay eines periph_trace-Mitschnitts (hal_sim_replay.c). Die Treiber
+// fragen zuerst hier; true heißt, der Mitschnitt hat geantwortet und
+// *bus_ns ist die aufgezeichnete Dauer.
+esp_err_t hal_sim_replay_load(const char *path);
+bool hal_sim_replay_active(void);
+void hal_sim_replay_report(FILE *out);
+
+bool hal_sim_replay_i2c(int port, hal_sim_i2c_op_t *ops, size_t count,
+                        esp_err_t *err, int64_t *bus_ns);
+bool hal_sim_replay_ow_reset(esp_err_t *err, int64_t *bus_ns);
+bool hal_sim_replay_ow_write(const uint8_t *data, size_t len,
+                             int64_t *bus_ns);
+bool hal_sim_replay_ow_read(uint8_t *data, size_t len, int64_t *bus_ns);
+bool hal_sim_replay_ow_bit(uint8_t *bit, int64_t *bus_ns);
+bool hal_sim_replay_ow_search(bool *found, uint64_t *address);
+
+// Ein gpio_set_level der Anwendung; plant die Eingangsflanken, die im
+// Mitschnitt darauf folgten
+void hal_sim_replay_gpio_out(int gpio, int level, int64_t at_ns);
@@ -0,0 +1,618 @@
+#include "hal_sim.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+Gerätebeschreibung, eine Zeile pro Gerät, '#' leitet einen Kommentar ein:
+
+  eeprom  addr=0x50 size=256 page=8 write_ms=5 file=eeprom.bin
+  mpu6050 addr=0x68 accel=0,0,16384 gyro=0,0,0 swing=2000@0.5 noise=20
+          temp=25
+  ds18b20 gpio=18 serial=1 temp=21.5 ramp=0.01 noise=0.05 parasite=0
+  hcsr04  trig=1 echo=2 cm=80 swing=30@0.2 noise=0.3 temp=21.5
+  gpio    latency_us=2 jitter_us=1
+  lcd     dump=frame.ppm
+
+Zahlen dürfen dezimal oder mit 0x angegeben werden. swing=Amplitude@Hz
+überlagert eine Sinusbewegung, noise ist die Standardabweichung eines
+normalverteilten Rauschens, ramp eine Drift pro Sekunde. Ohne Skript gilt
+default_script, passend zu den Pins der Projekte im Repo.
+*/
+
+#define MAX_PARAMS 16
+#define SCRIPT_LINE_MAX 256
+
+static const char *const default_script =
+    "eeprom addr=0x50 size=256 page=8\n"
+    "mpu6050 addr=0x68 swing=2000@0.5 noise=20\n"
+    "ds18b20 gpio=18 temp=21.5 ramp=0.005 noise=0.03\n"
+    "hcsr04 trig=1 echo=2 cm=80 swing=30@0.2 noise=0.3 temp=21.5\n";
+
+typedef struct {
+  char *key;
+  char *value;
+  bool used;
+} param_t;
+
+typedef struct {
+  param_t p[MAX_PARAMS];
+  size_t count;
+} params_t;
+
+static param_t *find(params_t *ps, const char *key) {
+  for (size_t i = 0; i < ps->count; i++) {
+    if (strcmp(ps->p[i].key, key) == 0) {
+      ps->p[i].used = true;
+      return &ps->p[i];
+    }
+  }
+  return NULL;
+}
+
+static double get_num(params_t *ps, const char *key, double def) {
+  param_t *p = find(ps, key);
+  if (!p) {
+    return def;
+  }
+  return strtod(p->value, NULL); // versteht auch 0x...
+}
+
+static const char *get_str(params_t *ps, const char *key, const char *def) {
+  param_t *p = find(ps, key);
+  return p ? p->value : def;
+}
+
+// "a,b,c" in bis zu n Werte zerlegen
+static void get_vec(params_t *ps, const char *key, double *out, size_t n) {
+  param_t *p = find(ps, key);
+  if (!p) {
+    return;
+  }
+  char *s = p->value;
+  for (size_t i = 0; i < n && *s; i++) {
+    out[i] = strtod(s, &s);
+    if (*s == ',') {
+      s++;
+    }
+  }
+}
+
+// "Amplitude@Frequenz"
+static void get_swing(params_t *ps, double *amp, double *hz) {
+  param_t *p = find(ps, "swing");
+  if (!p) {
+    return;
+  }
+  char *s;
+  *amp = strtod(p->value, &s);
+  *hz = *s == '@' ? strtod(s + 1, NULL) : 0;
+}
+
+static double seconds(int64_t ns) { return ns / 1e9; }
+
+// Box-Muller; die Genauigkeit von rand() reicht für Sensorrauschen
+static double gauss(double sigma) {
+  if (sigma <= 0) {
+    return 0;
+  }
+  double u1 = (rand() + 1.0) / ((double)RAND_MAX + 2.0);
+  double u2 = rand() / ((double)RAND_MAX + 1.0);
+  return sigma * sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+static double sine(double amp, double hz, int64_t now_ns) {
+  return amp * sin(2.0 * M_PI * hz * seconds(now_ns));
+}
+
+// EEPROM (24Cxx): Adresszeiger mit Überlauf, Seitenschreiben mit
+// Umbruch innerhalb der Seite, NACK während des internen Schreibzyklus
+
+typedef struct {
+  hal_sim_i2c_dev_t i2c; // muss vorne stehen
+  uint8_t *mem;
+  size_t size;
+  size_t page;
+  size_t addr_bytes;
+  int64_t write_ns;
+  int64_t busy_until;
+  char *file;
+  size_t ptr;
+  size_t addr_seen; // Adressbytes dieser Transaktion
+  bool writing;
+  size_t page_base;
+  size_t written; // Datenbytes seit dem Adressbyte
+  uint8_t *page_buf; // Kopie der Seite, wird bei STOP übernommen
+} eeprom_t;
+
+static void eeprom_start(hal_sim_i2c_dev_t *dev) {
+  eeprom_t *e = (eeprom_t *)dev;
+  e->addr_seen = 0;
+  e->writing = false;
+}
+
+static esp_err_t eeprom_write(hal_sim_i2c_dev_t *dev, const uint8_t *data,
+                              size_t len) {
+  eeprom_t *e = (eeprom_t *)dev;
+  if (hal_sim_now_ns() < e->busy_until) {
+    return ESP_FAIL;
+  }
+  for (size_t i = 0; i < len; i++) {
+    if (e->addr_seen < e->addr_bytes) {
+      if (e->addr_seen == 0) {
+        e->ptr = 0;
+      }
+      e->ptr = (e->ptr << 8 | data[i]) % e->size;
+      e->addr_seen++;
+      continue;
+    }
+    if (!e->writing) {
+      e->writing = true;
+      e->page_base = e->ptr & ~(e->page - 1);
+      e->written = 0;
+      memcpy(e->page_buf, &e->mem[e->page_base], e->page);
+    }
+    // Mehr als eine Seite überschreibt den Anfang der Seite
+    e->page_buf[(e->ptr - e->page_base + e->written++) % e->page] = data[i];
+  }
+  return ESP_OK;
+}
+
+static esp_err_t eeprom_read(hal_sim_i2c_dev_t *dev, uint8_t *data,
+                             size_t len) {
+  eeprom_t *e = (eeprom_t *)dev;
+  if (hal_sim_now_ns() < e->busy_until) {
+    return ESP_FAIL;
+  }
+  for (size_t i = 0; i < len; i++) {
+    data[i] = e->mem[e->ptr];
+    e->ptr = (e->ptr + 1) % e->size;
+  }
+  return ESP_OK;
+}
+
+static void eeprom_save(const eeprom_t *e) {
+  if (!e->file) {
+    return;
+  }
+  FILE *f = fopen(e->file, "wb");
+  if (f) {
+    fwrite(e->mem, 1, e->size, f);
+    fclose(f);
+  }
+}
+
+// STOP startet den Schreibzyklus für die gesammelten Bytes
+static void eeprom_stop(hal_sim_i2c_dev_t *dev) {
+  eeprom_t *e = (eeprom_t *)dev;
+  if (!e->writing) {
+    return;
+  }
+  memcpy(&e->mem[e->page_base], e->page_buf, e->page);
+  e->ptr = e->page_base + (e->ptr - e->page_base + e->written) % e->page;
+  e->writing = false;
+  e->busy_until = hal_sim_now_ns() + e->write_ns;
+  eeprom_save(e);
+}
+
+static esp_err_t eeprom_create(params_t *ps) {
+  eeprom_t *e = calloc(1, sizeof(*e));
+  if (!e) {
+    return ESP_ERR_NO_MEM;
+  }
+  e->i2c.addr = (uint8_t)get_num(ps, "addr", 0x50);
+  e->size = (size_t)get_num(ps, "size", 256);
+  e->page = (size_t)get_num(ps, "page", 8);
+  e->write_ns = (int64_t)(get_num(ps, "write_ms", 5) * 1e6);
+  const char *file = get_str(ps, "file", NULL);
+  if (e->size == 0 || e->page == 0 || (e->page & (e->page - 1)) ||
+      e->size % e->page) {
+    free(e);
+    return ESP_ERR_INVALID_ARG;
+  }
+  e->addr_bytes = e->size > 256 ? 2 : 1;
+  e->mem = malloc(e->size);
+  e->page_buf = malloc(e->page);
+  if (!e->mem || !e->page_buf) {
+    free(e->mem);
+    free(e->page_buf);
+    free(e);
+    return ESP_ERR_NO_MEM;
+  }
+  memset(e->mem, 0xFF, e->size); // gelöschter Zustand
+  if (file) {
+    e->file = strdup(file);
+    FILE *f = fopen(file, "rb");
+    if (f) {
+      fread(e->mem, 1, e->size, f);
+      fclose(f);
+    }
+  }
+  e->i2c.start = eeprom_start;
+  e->i2c.write = eeprom_write;
+  e->i2c.read = eeprom_read;
+  e->i2c.stop = eeprom_stop;
+  hal_sim_i2c_attach(&e->i2c);
+  return ESP_OK;
+}
+
+// MPU6050: Registerzeiger mit Autoinkrement. Die Messwerte werden beim
+// Beginn eines Lesezugriffs einmal berechnet, damit ein Burst konsistent ist.
+
+#define MPU_REG_DATA 0x3B
+#define MPU_REG_DATA_END 0x49
+#define MPU_REG_PWR_MGMT_1 0x6B
+#define MPU_REG_WHO_AM_I 0x75
+#define MPU_SLEEP 0x40
+
+typedef struct {
+  hal_sim_i2c_dev_t i2c;
+  uint8_t regs[128];
+  uint8_t ptr;
+  bool ptr_set;
+  double accel[3];
+  double gyro[3];
+  double temp;
+  double amp, hz;
+  double noise;
+} mpu6050_t;
+
+static void put16(uint8_t *p, double v) {
+  long x = lround(v);
+  x = x > 32767 ? 32767 : x < -32768 ? -32768 : x;
+  p[0] = (uint8_t)((uint16_t)x >> 8);
+  p[1] = (uint8_t)x;
+}
+
+static void mpu_sample(mpu6050_t *m) {
+  if (m->regs[MPU_REG_PWR_MGMT_1] & MPU_SLEEP) {
+    return; // im Schlaf bleiben die letzten Werte stehen
+  }
+  double s = sine(m->amp, m->hz, hal_sim_now_ns());
+  uint8_t *d = &m->regs[MPU_REG_DATA];
+  for (int i = 0; i < 3; i++) {
+    put16(&d[2 * i], m->accel[i] + (i == 0 ? s : 0) + gauss(m->noise));
+    put16(&d[8 + 2 * i], m->gyro[i] + (i == 2 ? s : 0) + gauss(m->noise));
+  }
+  put16(&d[6], (m->temp - 36.53) * 340.0);
+}
+
+static void mpu_start(hal_sim_i2c_dev_t *dev) {
+  ((mpu6050_t *)dev)->ptr_set = false;
+}
+
+static esp_err_t mpu_write(hal_sim_i2c_dev_t *dev, const uint8_t *data,
+                           size_t len) {
+  mpu6050_t *m = (mpu6050_t *)dev;
+  for (size_t i = 0; i < len; i++) {
+    if (!m->ptr_set) {
+      m->ptr = data[i] & 0x7F;
+      m->ptr_set = true;
+    } else {
+      // Nur Konfigurationsregister sind beschreibbar
+      if (m->ptr < MPU_REG_DATA || m->ptr >= MPU_REG_DATA_END) {
+        m->regs[m->ptr] = data[i];
+      }
+      m->ptr = (m->ptr + 1) & 0x7F;
+    }
+  }
+  return ESP_OK;
+}
+
+static esp_err_t mpu_read(hal_sim_i2c_dev_t *dev, uint8_t *data, size_t len) {
+  mpu6050_t *m = (mpu6050_t *)dev;
+  mpu_sample(m);
+  for (size_t i = 0; i < len; i++) {
+    data[i] = m->regs[m->ptr];
+    m->ptr = (m->ptr + 1) & 0x7F;
+  }
+  return ESP_OK;
+}
+
+static esp_err_t mpu6050_create(params_t *ps) {
+  mpu6050_t *m = calloc(1, sizeof(*m));
+  if (!m) {
+    return ESP_ERR_NO_MEM;
+  }
+  m->i2c.addr = (uint8_t)get_num(ps, "addr", 0x68);
+  m->accel[2] = 16384; // 1 g bei ±2 g
+  get_vec(ps, "accel", m->accel, 3);
+  get_vec(ps, "gyro", m->gyro, 3);
+  get_swing(ps, &m->amp, &m->hz);
+  m->noise = get_num(ps, "noise", 0);
+  m->temp = get_num(ps, "temp", 25);
+  m->regs[MPU_REG_PWR_MGMT_1] = MPU_SLEEP;
+  m->regs[MPU_REG_WHO_AM_I] = 0x68;
+  m->i2c.start = mpu_start;
+  m->i2c.write = mpu_write;
+  m->i2c.read = mpu_read;
+  hal_sim_i2c_attach(&m->i2c);
+  return ESP_OK;
+}
+
+// DS18B20: Funktionsbefehle nach dem ROM-Befehl des Busses. Solange eine
+// Wandlung läuft, liest jeder Zeitschlitz eine 0.
+
+#define DS_CONVERT 0x44
+#define DS_WRITE_SCRATCHPAD 0x4E
+#define DS_READ_SCRATCHPAD 0xBE
+#define DS_READ_POWER 0xB4
+
+typedef enum { DS_CMD, DS_WRITE, DS_READ, DS_POWER, DS_CONVERTING } ds_mode_t;
+
+typedef struct {
+  hal_sim_onewire_dev_t ow;
+  uint8_t scratch[9];
+  ds_mode_t mode;
+  int pos;
+  int64_t convert_until;
+  double temp, ramp, noise;
+  bool parasite;
+} ds18b20_t;
+
+static int ds_resolution(const ds18b20_t *d) {
+  return 9 + ((d->scratch[4] >> 5) & 3);
+}
+
+static void ds_update_crc(ds18b20_t *d) {
+  d->scratch[8] = hal_sim_onewire_crc8(d->scratch, 8);
+}
+
+// Ergebnis der Wandlung übernehmen, sobald ihre Zeit abgelaufen ist
+static void ds_finish(ds18b20_t *d, int64_t now) {
+  if (d->mode != DS_CONVERTING || now < d->convert_until) {
+    return;
+  }
+  double t = d->temp + d->ramp * seconds(now) + gauss(d->noise);
+  int raw = (int)lround(t * 16.0);
+  raw &= ~((1 << (12 - ds_resolution(d))) - 1); // ungenutzte Bits sind 0
+  d->scratch[0] = (uint8_t)raw;
+  d->scratch[1] = (uint8_t)(raw >> 8);
+  ds_update_crc(d);
+  d->mode = DS_CMD;
+}
+
+static void ds_reset(hal_sim_onewire_dev_t *dev) {
+  ds18b20_t *d = (ds18b20_t *)dev;
+  ds_finish(d, hal_sim_now_ns());
+  if (d->mode != DS_CONVERTING) {
+    d->mode = DS_CMD;
+  }
+}
+
+static void ds_write_byte(hal_sim_onewire_dev_t *dev, uint8_t byte) {
+  ds18b20_t *d = (ds18b20_t *)dev;
+  int64_t now = hal_sim_now_ns();
+  ds_finish(d, now);
+  switch (d->mode) {
+  case DS_CMD:
+    d->pos = 0;
+    if (byte == DS_CONVERT) {
+      d->mode = DS_CONVERTING;
+      d->convert_until = now + (750000000LL >> (12 - ds_resolution(d)));
+    } else if (byte == DS_WRITE_SCRATCHPAD) {
+      d->mode = DS_WRITE;
+    } else if (byte == DS_READ_SCRATCHPAD) {
+      d->mode = DS_READ;
+    } else if (byte == DS_READ_POWER) {
+      d->mode = DS_POWER;
+    }
+    break;
+  case DS_WRITE:
+    // TH, TL, Konfiguration; die unteren Bits der Konfiguration sind 1
+    if (d->pos < 3) {
+      d->scratch[2 + d->pos] = d->pos == 2 ? (byte & 0x60) | 0x1F : byte;
+      d->pos++;
+      ds_update_crc(d);
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+static uint8_t ds_read_byte(hal_sim_onewire_dev_t *dev) {
+  ds18b20_t *d = (ds18b20_t *)dev;
+  ds_finish(d, hal_sim_now_ns());
+  if (d->mode == DS_READ && d->pos < 9) {
+    return d->scratch[d->pos++];
+  }
+  return 0xFF;
+}
+
+static uint8_t ds_read_bit(hal_sim_onewire_dev_t *dev) {
+  ds18b20_t *d = (ds18b20_t *)dev;
+  ds_finish(d, hal_sim_now_ns());
+  if (d->mode == DS_CONVERTING) {
+    return d->parasite ? 1 : 0; // parasitär versorgt antwortet er nicht
+  }
+  if (d->mode == DS_POWER) {
+    return d->parasite ? 0 : 1;
+  }
+  return 1;
+}
+
+static esp_err_t ds18b20_create(params_t *ps) {
+  static int next_serial = 1;
+  ds18b20_t *d = calloc(1, sizeof(*d));
+  if (!d) {
+    return ESP_ERR_NO_MEM;
+  }
+  d->ow.gpio = (int)get_num(ps, "gpio", 18);
+  uint64_t serial = (uint64_t)get_num(ps, "serial", next_serial++);
+  uint8_t rom[8] = {0x28};
+  for (int i = 1; i < 7; i++) {
+    rom[i] = (uint8_t)(serial >> (8 * (i - 1)));
+  }
+  rom[7] = hal_sim_onewire_crc8(rom, 7);
+  for (int i = 0; i < 8; i++) {
+    d->ow.rom |= (uint64_t)rom[i] << (8 * i);
+  }
+  d->temp = get_num(ps, "temp", 21.5);
+  d->ramp = get_num(ps, "ramp", 0);
+  d->noise = get_num(ps, "noise", 0);
+  d->parasite = get_num(ps, "parasite", 0) != 0;
+  // Einschaltzustand: 85 °C, TH/TL aus dem EEPROM, 12 Bit
+  const uint8_t power_on[8] = {0x50, 0x05, 0x4B, 0x46, 0x7F, 0xFF, 0x0C, 0x10};
+  memcpy(d->scratch, power_on, sizeof(power_on));
+  ds_update_crc(d);
+  d->ow.write_byte = ds_write_byte;
+  d->ow.read_byte = ds_read_byte;
+  d->ow.read_bit = ds_read_bit;
+  d->ow.reset = ds_reset;
+  hal_sim_onewire_attach(&d->ow);
+  return ESP_OK;
+}
+
+// HC-SR04: Nach einem Triggerpuls von mindestens 10 µs geht Echo nach dem
+// Burst auf High, für die Laufzeit hin und zurück. Ohne Echo bleibt der Pin
+// etwa 38 ms High. Während einer Messung werden Trigger ignoriert.
+
+#define SR04_MIN_TRIGGER_NS 10000
+#define SR04_BURST_NS 460000   // 8 Perioden 40 kHz plus interne Verzögerung
+#define SR04_TIMEOUT_NS 38000000
+#define SR04_MAX_CM 400.0
+
+typedef struct {
+  int trig, echo;
+  double cm, amp, hz, noise, temp;
+  int64_t trig_rise;
+  bool busy;
+  hal_sim_event_t rise;
+  hal_sim_event_t fall;
+} hcsr04_t;
+
+static void sr04_rise(hal_sim_event_t *ev, int64_t at_ns) {
+  hcsr04_t *s = ev->arg;
+  hal_sim_gpio_drive(s->echo, 1, at_ns);
+}
+
+static void sr04_fall(hal_sim_event_t *ev, int64_t at_ns) {
+  hcsr04_t *s = ev->arg;
+  hal_sim_gpio_drive(s->echo, 0, at_ns);
+  s->busy = false;
+}
+
+static void sr04_on_trigger(void *ctx, int gpio, int level, int64_t at_ns) {
+  hcsr04_t *s = ctx;
+  if (level) {
+    s->trig_rise = at_ns;
+    return;
+  }
+  if (s->busy || at_ns - s->trig_rise < SR04_MIN_TRIGGER_NS) {
+    return;
+  }
+  double cm = s->cm + sine(s->amp, s->hz, at_ns) + gauss(s->noise);
+  double speed = 331.3 + 0.606 * s->temp; // m/s
+  int64_t width = SR04_TIMEOUT_NS;
+  if (cm > 2.0 && cm <= SR04_MAX_CM) {
+    width = (int64_t)(2.0 * cm / 100.0 / speed * 1e9);
+  }
+  int64_t rise = at_ns + SR04_BURST_NS;
+  s->busy = true;
+  hal_sim_event_schedule(&s->rise, rise);
+  hal_sim_event_schedule(&s->fall, rise + width);
+}
+
+static esp_err_t hcsr04_create(params_t *ps) {
+  hcsr04_t *s = calloc(1, sizeof(*s));
+  if (!s) {
+    return ESP_ERR_NO_MEM;
+  }
+  s->trig = (int)get_num(ps, "trig", 1);
+  s->echo = (int)get_num(ps, "echo", 2);
+  s->cm = get_num(ps, "cm", 100);
+  get_swing(ps, &s->amp, &s->hz);
+  s->noise = get_num(ps, "noise", 0);
+  s->temp = get_num(ps, "temp", 20);
+  s->rise = (hal_sim_event_t){.fn = sr04_rise, .arg = s};
+  s->fall = (hal_sim_event_t){.fn = sr04_fall, .arg = s};
+  return hal_sim_gpio_listen(s->trig, sr04_on_trigger, s);
+}
+
+static esp_err_t gpio_create(params_t *ps) {
+  int64_t latency = (int64_t)(get_num(ps, "latency_us", 2) * 1000);
+  int64_t jitter = (int64_t)(get_num(ps, "jitter_us", 1) * 1000);
+  hal_sim_gpio_set_latency(latency, jitter);
+  return ESP_OK;
+}
+
+static esp_err_t lcd_create(params_t *ps) {
+  hal_sim_lcd_set_dump(get_str(ps, "dump", NULL));
+  return ESP_OK;
+}
+
+typedef struct {
+  const char *name;
+  esp_err_t (*create)(params_t *ps);
+} device_type_t;
+
+static const device_type_t types[] = {
+    {"eeprom", eeprom_create}, {"mpu6050", mpu6050_create},
+    {"ds18b20", ds18b20_create}, {"hcsr04", hcsr04_create},
+    {"gpio", gpio_create},       {"lcd", lcd_create},
+};
+
+static esp_err_t parse_line(char *line, int lineno) {
+  char *hash = strchr(line, '#');
+  if (hash) {
+    *hash = '\0';
+  }
+  char *save;
+  char *name = strtok_r(line, " \t\r\n", &save);
+  if (!name) {
+    return ESP_OK; // Leerzeile
+  }
+  params_t ps = {0};
+  char *tok;
+  while ((tok = strtok_r(NULL, " \t\r\n", &save))) {
+    char *eq = strchr(tok, '=');
+    if (!eq || ps.count == MAX_PARAMS) {
+      fprintf(stderr, "hal_sim: Zeile %d: '%s' ungültig\n", lineno, tok);
+      return ESP_ERR_INVALID_ARG;
+    }
+    *eq = '\0';
+    ps.p[ps.count++] = (param_t){tok, eq + 1, false};
+  }
+
+  for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++) {
+    if (strcmp(types[i].name, name) != 0) {
+      continue;
+    }
+    esp_err_t err = types[i].create(&ps);
+    if (err != ESP_OK) {
+      fprintf(stderr, "hal_sim: Zeile %d: %s nicht angelegt (%s)\n", lineno,
+              name, esp_err_to_name(err));
+      return err;
+    }
+    for (size_t k = 0; k < ps.count; k++) {
+      if (!ps.p[k].used) {
+        fprintf(stderr, "hal_sim: Zeile %d: unbekannter Parameter '%s'\n",
+                lineno, ps.p[k].key);
+        return ESP_ERR_INVALID_ARG;
+      }
+    }
+    return ESP_OK;
+  }
+  fprintf(stderr, "hal_sim: Zeile %d: unbekanntes Gerät '%s'\n", lineno, name);
+  return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t hal_sim_devices_load(const char *script) {
+  FILE *f = script ? fopen(script, "r")
+                   : fmemopen((void *)default_script, strlen(default_script),
+                              "r");
+  if (!f) {
+    perror(script ? script : "hal_sim");
+    return ESP_ERR_NOT_FOUND;
+  }
+  char line[SCRIPT_LINE_MAX];
+  int lineno = 0;
+  esp_err_t err = ESP_OK;
+  while (err == ESP_OK && fgets(line, sizeof(line), f)) {
+    err = parse_line(line, ++lineno);
+  }
+  fclose(f);
+  return err;
+}
@@ -0,0 +1,201 @@
+#include "driver/gpio.h"
+#include "hal_sim.h"
+
+#include <stdlib.h>
+
+#define MAX_LISTENERS 32
+
+typedef struct {
+  int gpio;
+  hal_sim_gpio_fn_t fn;
+  void *ctx;
+} listener_t;
+
+typedef struct {
+  int level;
+  gpio_mode_t mode;
+  gpio_int_type_t intr_type;
+  bool intr_enabled;
+  gpio_isr_t isr;
+  void *isr_arg;
+} pin_t;
+
+static pin_t pins[HAL_SIM_GPIO_COUNT];
+static listener_t listeners[MAX_LISTENERS];
+static size_t listener_count;
+static bool isr_service;
+static int64_t latency_ns = 2000;
+static int64_t jitter_ns = 1000;
+
+static bool valid(int gpio) { return gpio >= 0 && gpio < HAL_SIM_GPIO_COUNT; }
+
+static void notify(int gpio, int level, int64_t at_ns) {
+  for (size_t i = 0; i < listener_count; i++) {
+    if (listeners[i].gpio == gpio) {
+      listeners[i].fn(listeners[i].ctx, gpio, level, at_ns);
+    }
+  }
+}
+
+esp_err_t hal_sim_gpio_listen(int gpio, hal_sim_gpio_fn_t fn, void *ctx) {
+  if (!valid(gpio) || listener_count >= MAX_LISTENERS) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  listeners[listener_count++] = (listener_t){gpio, fn, ctx};
+  return ESP_OK;
+}
+
+void hal_sim_gpio_set_latency(int64_t latency, int64_t jitter) {
+  latency_ns = latency;
+  jitter_ns = jitter;
+}
+
+int hal_sim_gpio_level(int gpio) { return valid(gpio) ? pins[gpio].level : 0; }
+
+static bool edge_matches(gpio_int_type_t type, int level) {
+  switch (type) {
+  case GPIO_INTR_POSEDGE:
+  case GPIO_INTR_HIGH_LEVEL:
+    return level;
+  case GPIO_INTR_NEGEDGE:
+  case GPIO_INTR_LOW_LEVEL:
+    return !level;
+  case GPIO_INTR_ANYEDGE:
+    return true;
+  default:
+    return false;
+  }
+}
+
+void hal_sim_gpio_drive(int gpio, int level, int64_t at_ns) {
+  if (!valid(gpio) || pins[gpio].level == level) {
+    return;
+  }
+  pin_t *pin = &pins[gpio];
+  pin->level = level;
+  notify(gpio, level, at_ns);
+
+  if (isr_service && pin->isr && pin->intr_enabled &&
+      edge_matches(pin->intr_type, level)) {
+    // Der Handler sieht die Zeit, zu der er auf echter Hardware liefe
+    int64_t delay = latency_ns;
+    if (jitter_ns > 0) {
+      delay += rand() % (jitter_ns + 1);
+    }
+    int64_t start = hal_sim_now_ns();
+    hal_sim_irq_set_time(at_ns + delay);
+    pin->isr(pin->isr_arg);
+    hal_sim_irq_set_time(-1);
+    hal_sim_stat_record(HAL_SIM_STAT_GPIO, start, 0, 0, false);
+  }
+}
+
+esp_err_t gpio_config(const gpio_config_t *cfg) {
+  hal_sim_init();
+  if (cfg->pin_bit_mask >> GPIO_NUM_MAX) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  for (int gpio = 0; gpio < GPIO_NUM_MAX; gpio++) {
+    if (cfg->pin_bit_mask & (1ULL << gpio)) {
+      pins[gpio].mode = cfg->mode;
+      pins[gpio].intr_type = cfg->intr_type;
+      pins[gpio].intr_enabled = cfg->intr_type != GPIO_INTR_DISABLE;
+      // Pull-up als Ruhepegel für Eingänge, die kein Gerät treibt
+      if (cfg->pull_up_en && !(cfg->mode & GPIO_MODE_OUTPUT)) {
+        pins[gpio].level = 1;
+      }
+    }
+  }
+  return ESP_OK;
+}
+
+esp_err_t gpio_reset_pin(gpio_num_t gpio) {
+  if (!valid(gpio)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  pins[gpio].mode = GPIO_MODE_INPUT;
+  pins[gpio].intr_type = GPIO_INTR_DISABLE;
+  pins[gpio].intr_enabled = false;
+  return ESP_OK;
+}
+
+esp_err_t gpio_set_direction(gpio_num_t gpio, gpio_mode_t mode) {
+  hal_sim_init();
+  if (!valid(gpio)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  pins[gpio].mode = mode;
+  return ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio, uint32_t level) {
+  if (!valid(gpio)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  int64_t start = hal_sim_now_ns();
+  level = level ? 1 : 0;
+  if (pins[gpio].level != (int)level) {
+    pins[gpio].level = level;
+    notify(gpio, level, start);
+  }
+  hal_sim_replay_gpio_out(gpio, level, start);
+  hal_sim_stat_record(HAL_SIM_STAT_GPIO, start, 0, 0, false);
+  return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio) { return hal_sim_gpio_level(gpio); }
+
+esp_err_t gpio_set_intr_type(gpio_num_t gpio, gpio_int_type_t type) {
+  if (!valid(gpio)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  pins[gpio].intr_type = type;
+  return ESP_OK;
+}
+
+esp_err_t gpio_intr_enable(gpio_num_t gpio) {
+  if (!valid(gpio)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  pins[gpio].intr_enabled = true;
+  return ESP_OK;
+}
+
+esp_err_t gpio_intr_disable(gpio_num_t gpio) {
+  if (!valid(gpio)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  pins[gpio].intr_enabled = false;
+  return ESP_OK;
+}
+
+esp_err_t gpio_install_isr_service(int intr_alloc_flags) {
+  hal_sim_init();
+  if (isr_service) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  isr_service = true;
+  return ESP_OK;
+}
+
+void gpio_uninstall_isr_service(void) { isr_service = false; }
+
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio, gpio_isr_t isr, void *arg) {
+  if (!valid(gpio)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (!isr_service) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  pins[gpio].isr = isr;
+  pins[gpio].isr_arg = arg;
+  return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_remove(gpio_num_t gpio) {
+  if (!valid(gpio)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  pins[gpio].isr = NULL;
+  return ESP_OK;
+}
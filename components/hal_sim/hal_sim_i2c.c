@@ -0,0 +1,303 @@
+#include "driver/i2c.h"
+#include "hal_sim.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Bits auf dem Bus: START/STOP je etwa ein Bit, jedes Byte 8 Bit plus ACK
+#define BITS_PER_BYTE 9
+#define BITS_PER_CONDITION 1
+
+typedef struct {
+  hal_sim_i2c_op_t *ops;
+  size_t count;
+  size_t cap;
+} cmd_link_t;
+
+typedef struct {
+  bool installed;
+  uint32_t clk_speed;
+  int timeout;
+} port_t;
+
+static port_t ports[I2C_NUM_MAX];
+static hal_sim_i2c_dev_t *devices;
+
+void hal_sim_i2c_attach(hal_sim_i2c_dev_t *dev) {
+  dev->next = devices;
+  devices = dev;
+}
+
+hal_sim_i2c_dev_t *hal_sim_i2c_find(uint8_t addr) {
+  for (hal_sim_i2c_dev_t *d = devices; d; d = d->next) {
+    if (d->addr == addr) {
+      return d;
+    }
+  }
+  return NULL;
+}
+
+esp_err_t i2c_param_config(i2c_port_t port, const i2c_config_t *conf) {
+  hal_sim_init();
+  if (port < 0 || port >= I2C_NUM_MAX || conf->mode != I2C_MODE_MASTER ||
+      conf->master.clk_speed == 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  ports[port].clk_speed = conf->master.clk_speed;
+  return ESP_OK;
+}
+
+esp_err_t i2c_driver_install(i2c_port_t port, i2c_mode_t mode,
+                             size_t slv_rx_buf_len, size_t slv_tx_buf_len,
+                             int intr_alloc_flags) {
+  if (port < 0 || port >= I2C_NUM_MAX || mode != I2C_MODE_MASTER) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (ports[port].installed) {
+    return ESP_FAIL;
+  }
+  if (ports[port].clk_speed == 0) {
+    ports[port].clk_speed = 100000;
+  }
+  ports[port].installed = true;
+  return ESP_OK;
+}
+
+esp_err_t i2c_driver_delete(i2c_port_t port) {
+  if (port < 0 || port >= I2C_NUM_MAX || !ports[port].installed) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  ports[port].installed = false;
+  return ESP_OK;
+}
+
+esp_err_t i2c_set_timeout(i2c_port_t port, int timeout) {
+  if (port < 0 || port >= I2C_NUM_MAX) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  ports[port].timeout = timeout;
+  return ESP_OK;
+}
+
+esp_err_t i2c_get_timeout(i2c_port_t port, int *timeout) {
+  if (port < 0 || port >= I2C_NUM_MAX) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  *timeout = ports[port].timeout;
+  return ESP_OK;
+}
+
+// Kommandoliste
+
+i2c_cmd_handle_t i2c_cmd_link_create(void) {
+  return calloc(1, sizeof(cmd_link_t));
+}
+
+void i2c_cmd_link_delete(i2c_cmd_handle_t handle) {
+  cmd_link_t *cmd = handle;
+  if (!cmd) {
+    return;
+  }
+  for (size_t i = 0; i < cmd->count; i++) {
+    if (cmd->ops[i].type == HAL_SIM_I2C_WRITE) {
+      free(cmd->ops[i].data);
+    }
+  }
+  free(cmd->ops);
+  free(cmd);
+}
+
+static esp_err_t add_op(i2c_cmd_handle_t handle, hal_sim_i2c_op_type_t type,
+                        uint8_t *data, size_t len) {
+  cmd_link_t *cmd = handle;
+  if (!cmd) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (cmd->count == cmd->cap) {
+    size_t cap = cmd->cap ? 2 * cmd->cap : 8;
+    hal_sim_i2c_op_t *ops = realloc(cmd->ops, cap * sizeof(*ops));
+    if (!ops) {
+      return ESP_ERR_NO_MEM;
+    }
+    cmd->ops = ops;
+    cmd->cap = cap;
+  }
+  cmd->ops[cmd->count++] = (hal_sim_i2c_op_t){type, data, len};
+  return ESP_OK;
+}
+
+esp_err_t i2c_master_start(i2c_cmd_handle_t cmd) {
+  return add_op(cmd, HAL_SIM_I2C_START, NULL, 0);
+}
+
+esp_err_t i2c_master_stop(i2c_cmd_handle_t cmd) {
+  return add_op(cmd, HAL_SIM_I2C_STOP, NULL, 0);
+}
+
+esp_err_t i2c_master_write(i2c_cmd_handle_t cmd, const uint8_t *data,
+                           size_t data_len, bool ack_en) {
+  uint8_t *copy = malloc(data_len ? data_len : 1);
+  if (!copy) {
+    return ESP_ERR_NO_MEM;
+  }
+  memcpy(copy, data, data_len);
+  esp_err_t err = add_op(cmd, HAL_SIM_I2C_WRITE, copy, data_len);
+  if (err != ESP_OK) {
+    free(copy);
+  }
+  return err;
+}
+
+esp_err_t i2c_master_write_byte(i2c_cmd_handle_t cmd, uint8_t data,
+                                bool ack_en) {
+  return i2c_master_write(cmd, &data, 1, ack_en);
+}
+
+esp_err_t i2c_master_read(i2c_cmd_handle_t cmd, uint8_t *data,
+                          size_t data_len, i2c_ack_type_t ack) {
+  return add_op(cmd, HAL_SIM_I2C_READ, data, data_len);
+}
+
+esp_err_t i2c_master_read_byte(i2c_cmd_handle_t cmd, uint8_t *data,
+                               i2c_ack_type_t ack) {
+  return add_op(cmd, HAL_SIM_I2C_READ, data, 1);
+}
+
+// Spielt die Kommandoliste gegen die Geräte ab. Das erste Byte nach START
+// ist die Adresse; NACK bricht wie auf dem echten Bus mit ESP_FAIL ab.
+static esp_err_t execute(const cmd_link_t *cmd, size_t *bits, size_t *bytes) {
+  hal_sim_i2c_dev_t *dev = NULL;
+  bool need_addr = false;
+  bool reading = false;
+  esp_err_t err = ESP_OK;
+
+  for (size_t i = 0; i < cmd->count && err == ESP_OK; i++) {
+    const hal_sim_i2c_op_t *op = &cmd->ops[i];
+    switch (op->type) {
+    case HAL_SIM_I2C_START:
+      *bits += BITS_PER_CONDITION;
+      need_addr = true;
+      break;
+    case HAL_SIM_I2C_STOP:
+      *bits += BITS_PER_CONDITION;
+      if (dev && dev->stop) {
+        dev->stop(dev);
+      }
+      dev = NULL;
+      break;
+    case HAL_SIM_I2C_WRITE: {
+      const uint8_t *data = op->data;
+      size_t len = op->len;
+      *bits += len * BITS_PER_BYTE;
+      *bytes += len;
+      if (need_addr && len > 0) {
+        dev = hal_sim_i2c_find(data[0] >> 1);
+        reading = data[0] & 1;
+        need_addr = false;
+        if (!dev) {
+          err = ESP_FAIL;
+          break;
+        }
+        if (dev->start) {
+          dev->start(dev);
+        }
+        data++;
+        len--;
+      }
+      if (len > 0) {
+        err = dev && !reading ? dev->write(dev, data, len) : ESP_FAIL;
+      }
+      break;
+    }
+    case HAL_SIM_I2C_READ:
+      *bits += op->len * BITS_PER_BYTE;
+      *bytes += op->len;
+      err = dev && reading ? dev->read(dev, op->data, op->len) : ESP_FAIL;
+      break;
+    }
+  }
+  if (err != ESP_OK && dev && dev->stop) {
+    dev->stop(dev);
+  }
+  return err;
+}
+
+esp_err_t i2c_master_cmd_begin(i2c_port_t port, i2c_cmd_handle_t handle,
+                               TickType_t ticks_to_wait) {
+  if (port < 0 || port >= I2C_NUM_MAX || !handle) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (!ports[port].installed) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  int64_t start = hal_sim_now_ns();
+  size_t bits = 0;
+  size_t bytes = 0;
+  cmd_link_t *cmd = handle;
+  esp_err_t err;
+  int64_t bus_ns;
+  if (hal_sim_replay_i2c(port, cmd->ops, cmd->count, &err, &bus_ns)) {
+    for (size_t i = 0; i < cmd->count; i++) {
+      bytes += cmd->ops[i].len;
+    }
+  } else {
+    err = execute(cmd, &bits, &bytes);
+    bus_ns = (int64_t)bits * 1000000000LL / ports[port].clk_speed;
+  }
+  hal_sim_bus_delay(bus_ns);
+  hal_sim_stat_record(HAL_SIM_STAT_I2C, start, bus_ns, bytes, err != ESP_OK);
+  return err;
+}
+
+// Bequemlichkeitsfunktionen bauen eine Kommandoliste wie in ESP-IDF
+
+static esp_err_t transfer(i2c_port_t port, uint8_t addr, const uint8_t *wr,
+                          size_t wr_len, uint8_t *rd, size_t rd_len,
+                          TickType_t ticks_to_wait) {
+  i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+  if (!cmd) {
+    return ESP_ERR_NO_MEM;
+  }
+  esp_err_t err = ESP_OK;
+  if (wr_len) {
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, addr << 1 | I2C_MASTER_WRITE, true);
+    err = i2c_master_write(cmd, wr, wr_len, true);
+  }
+  if (err == ESP_OK && rd_len) {
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, addr << 1 | I2C_MASTER_READ, true);
+    err = i2c_master_read(cmd, rd, rd_len, I2C_MASTER_LAST_NACK);
+  }
+  if (err == ESP_OK) {
+    i2c_master_stop(cmd);
+    err = i2c_master_cmd_begin(port, cmd, ticks_to_wait);
+  }
+  i2c_cmd_link_delete(cmd);
+  return err;
+}
+
+esp_err_t i2c_master_write_to_device(i2c_port_t port, uint8_t device_address,
+                                     const uint8_t *write_buffer,
+                                     size_t write_size,
+                                     TickType_t ticks_to_wait) {
+  return transfer(port, device_address, write_buffer, write_size, NULL, 0,
+                  ticks_to_wait);
+}
+
+esp_err_t i2c_master_read_from_device(i2c_port_t port, uint8_t device_address,
+                                      uint8_t *read_buffer, size_t read_size,
+                                      TickType_t ticks_to_wait) {
+  return transfer(port, device_address, NULL, 0, read_buffer, read_size,
+                  ticks_to_wait);
+}
+
+esp_err_t i2c_master_write_read_device(i2c_port_t port,
+                                       uint8_t device_address,
+                                       const uint8_t *write_buffer,
+                                       size_t write_size,
+                                       uint8_t *read_buffer, size_t read_size,
+                                       TickType_t ticks_to_wait) {
+  return transfer(port, device_address, write_buffer, write_size, read_buffer,
+                  read_size, ticks_to_wait);
+}
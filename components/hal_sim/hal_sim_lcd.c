@@ -0,0 +1,372 @@
+#include "esp_lcd_ili9341.h"
+#include "esp_lcd_panel_ops.h"
+#include "hal_sim.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define LCD_W 240
+#define LCD_H 320
+
+// ILI9341-Befehle, die der Controller auswertet
+#define CMD_SWRESET 0x01
+#define CMD_SLPOUT 0x11
+#define CMD_INVOFF 0x20
+#define CMD_INVON 0x21
+#define CMD_DISPOFF 0x28
+#define CMD_DISPON 0x29
+#define CMD_CASET 0x2A
+#define CMD_PASET 0x2B
+#define CMD_RAMWR 0x2C
+#define CMD_RAMWRC 0x3C
+#define CMD_MADCTL 0x36
+#define CMD_COLMOD 0x3A
+
+#define MADCTL_MY 0x80
+#define MADCTL_MX 0x40
+#define MADCTL_MV 0x20
+#define MADCTL_BGR 0x08
+
+// Der Controller hinter dem Bus: Adressfenster, Schreibzeiger und GRAM
+typedef struct {
+  uint16_t gram[LCD_W * LCD_H];
+  uint8_t madctl;
+  bool display_on;
+  bool inverted;
+  uint16_t x0, x1, y0, y1; // Fenster in logischen Koordinaten
+  uint16_t x, y;           // nächstes Pixel
+} ili9341_t;
+
+struct esp_lcd_i80_bus_t {
+  size_t bus_width;
+  size_t max_transfer_bytes;
+};
+
+struct esp_lcd_panel_io_t {
+  esp_lcd_i80_bus_handle_t bus;
+  uint32_t pclk_hz;
+  bool swap_color_bytes;
+  esp_lcd_panel_io_color_trans_done_cb_t on_color_trans_done;
+  void *user_ctx;
+};
+
+struct esp_lcd_panel_t {
+  esp_lcd_panel_io_handle_t io;
+  uint8_t madctl;
+  int x_gap, y_gap;
+};
+
+static ili9341_t lcd;
+static char *dump_path;
+
+// Pixel in GRAM schreiben; MV/MX/MY bilden das logische Fenster auf die
+// Hochkant-Anordnung des Panels ab
+static void put_pixel(uint16_t color) {
+  int px = lcd.x;
+  int py = lcd.y;
+  if (lcd.madctl & MADCTL_MV) {
+    px = lcd.y;
+    py = lcd.x;
+  }
+  if (lcd.madctl & MADCTL_MX) {
+    px = LCD_W - 1 - px;
+  }
+  if (lcd.madctl & MADCTL_MY) {
+    py = LCD_H - 1 - py;
+  }
+  if (px >= 0 && px < LCD_W && py >= 0 && py < LCD_H) {
+    lcd.gram[py * LCD_W + px] = color;
+  }
+  if (lcd.x++ >= lcd.x1) {
+    lcd.x = lcd.x0;
+    if (lcd.y++ >= lcd.y1) {
+      lcd.y = lcd.y0;
+    }
+  }
+}
+
+static void controller_cmd(int cmd, const uint8_t *p, size_t len) {
+  switch (cmd) {
+  case CMD_SWRESET:
+    lcd.madctl = 0;
+    lcd.display_on = false;
+    lcd.inverted = false;
+    break;
+  case CMD_DISPON:
+  case CMD_DISPOFF:
+    lcd.display_on = cmd == CMD_DISPON;
+    break;
+  case CMD_INVON:
+  case CMD_INVOFF:
+    lcd.inverted = cmd == CMD_INVON;
+    break;
+  case CMD_MADCTL:
+    if (len >= 1) {
+      lcd.madctl = p[0];
+    }
+    break;
+  case CMD_CASET:
+    if (len >= 4) {
+      lcd.x0 = p[0] << 8 | p[1];
+      lcd.x1 = p[2] << 8 | p[3];
+    }
+    break;
+  case CMD_PASET:
+    if (len >= 4) {
+      lcd.y0 = p[0] << 8 | p[1];
+      lcd.y1 = p[2] << 8 | p[3];
+    }
+    break;
+  default:
+    break; // SLPOUT, COLMOD usw. ändern am Bild nichts
+  }
+}
+
+esp_err_t esp_lcd_new_i80_bus(const esp_lcd_i80_bus_config_t *bus_config,
+                              esp_lcd_i80_bus_handle_t *ret_bus) {
+  hal_sim_init();
+  if (!bus_config || !ret_bus ||
+      (bus_config->bus_width != 8 && bus_config->bus_width != 16)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  esp_lcd_i80_bus_handle_t bus = calloc(1, sizeof(*bus));
+  if (!bus) {
+    return ESP_ERR_NO_MEM;
+  }
+  bus->bus_width = bus_config->bus_width;
+  bus->max_transfer_bytes = bus_config->max_transfer_bytes;
+  *ret_bus = bus;
+  return ESP_OK;
+}
+
+esp_err_t esp_lcd_del_i80_bus(esp_lcd_i80_bus_handle_t bus) {
+  free(bus);
+  return ESP_OK;
+}
+
+esp_err_t
+esp_lcd_new_panel_io_i80(esp_lcd_i80_bus_handle_t bus,
+                         const esp_lcd_panel_io_i80_config_t *io_config,
+                         esp_lcd_panel_io_handle_t *ret_io) {
+  if (!bus || !io_config || !ret_io || io_config->pclk_hz == 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  esp_lcd_panel_io_handle_t io = calloc(1, sizeof(*io));
+  if (!io) {
+    return ESP_ERR_NO_MEM;
+  }
+  io->bus = bus;
+  io->pclk_hz = io_config->pclk_hz;
+  io->swap_color_bytes = io_config->flags.swap_color_bytes;
+  io->on_color_trans_done = io_config->on_color_trans_done;
+  io->user_ctx = io_config->user_ctx;
+  *ret_io = io;
+  return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_io_del(esp_lcd_panel_io_handle_t io) {
+  free(io);
+  return ESP_OK;
+}
+
+// Ein WR-Takt überträgt bus_width Bit
+static int64_t bus_time(esp_lcd_panel_io_handle_t io, size_t bytes) {
+  size_t cycles = io->bus->bus_width == 16 ? (bytes + 1) / 2 : bytes;
+  return (int64_t)cycles * 1000000000LL / io->pclk_hz;
+}
+
+esp_err_t esp_lcd_panel_io_tx_param(esp_lcd_panel_io_handle_t io, int lcd_cmd,
+                                    const void *param, size_t param_size) {
+  if (!io || (param_size && !param)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  int64_t start = hal_sim_now_ns();
+  controller_cmd(lcd_cmd, param, param_size);
+  int64_t bus_ns = bus_time(io, 1 + param_size);
+  hal_sim_bus_delay(bus_ns);
+  hal_sim_stat_record(HAL_SIM_STAT_LCD, start, bus_ns, 1 + param_size, false);
+  return ESP_OK;
+}
+
+// Pixel kommen wie auf dem Draht an: höherwertiges Byte zuerst, außer der
+// IO tauscht die Bytes (flags.swap_color_bytes)
+esp_err_t esp_lcd_panel_io_tx_color(esp_lcd_panel_io_handle_t io, int lcd_cmd,
+                                    const void *color, size_t color_size) {
+  if (!io || (color_size && !color)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (io->bus->max_transfer_bytes && color_size > io->bus->max_transfer_bytes) {
+    return ESP_ERR_INVALID_SIZE;
+  }
+  int64_t start = hal_sim_now_ns();
+  if (lcd_cmd == CMD_RAMWR) {
+    lcd.x = lcd.x0;
+    lcd.y = lcd.y0;
+  }
+  if (lcd_cmd == CMD_RAMWR || lcd_cmd == CMD_RAMWRC) {
+    const uint8_t *p = color;
+    for (size_t i = 0; i + 1 < color_size; i += 2) {
+      uint16_t c = io->swap_color_bytes ? (p[i + 1] << 8 | p[i])
+                                        : (p[i] << 8 | p[i + 1]);
+      put_pixel(c);
+    }
+  }
+  int64_t bus_ns = bus_time(io, 1 + color_size);
+  hal_sim_bus_delay(bus_ns);
+  hal_sim_stat_record(HAL_SIM_STAT_LCD, start, bus_ns, 1 + color_size,
+                      false);
+  if (io->on_color_trans_done) {
+    esp_lcd_panel_io_event_data_t edata = {0};
+    io->on_color_trans_done(io, &edata, io->user_ctx);
+  }
+  return ESP_OK;
+}
+
+// Panel-Treiber wie esp_lcd_ili9341: übersetzt die Panel-Operationen in
+// Controller-Befehle über den IO
+
+static esp_err_t tx_cmd(esp_lcd_panel_handle_t panel, int cmd,
+                        const uint8_t *param, size_t len) {
+  return esp_lcd_panel_io_tx_param(panel->io, cmd, param, len);
+}
+
+esp_err_t
+esp_lcd_new_panel_ili9341(const esp_lcd_panel_io_handle_t io,
+                          const esp_lcd_panel_dev_config_t *panel_dev_config,
+                          esp_lcd_panel_handle_t *ret_panel) {
+  if (!io || !panel_dev_config || !ret_panel ||
+      panel_dev_config->bits_per_pixel != 16) {
+    return ESP_ERR_INVALID_ARG; // nur RGB565 ist nachgebildet
+  }
+  esp_lcd_panel_handle_t panel = calloc(1, sizeof(*panel));
+  if (!panel) {
+    return ESP_ERR_NO_MEM;
+  }
+  panel->io = io;
+  if (panel_dev_config->rgb_endian == LCD_RGB_ENDIAN_BGR) {
+    panel->madctl |= MADCTL_BGR;
+  }
+  *ret_panel = panel;
+  return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_del(esp_lcd_panel_handle_t panel) {
+  free(panel);
+  return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_reset(esp_lcd_panel_handle_t panel) {
+  if (!panel) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  return tx_cmd(panel, CMD_SWRESET, NULL, 0);
+}
+
+esp_err_t esp_lcd_panel_init(esp_lcd_panel_handle_t panel) {
+  if (!panel) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  uint8_t colmod = 0x55; // 16 Bit pro Pixel
+  tx_cmd(panel, CMD_SLPOUT, NULL, 0);
+  tx_cmd(panel, CMD_MADCTL, &panel->madctl, 1);
+  return tx_cmd(panel, CMD_COLMOD, &colmod, 1);
+}
+
+esp_err_t esp_lcd_panel_draw_bitmap(esp_lcd_panel_handle_t panel, int x_start,
+                                    int y_start, int x_end, int y_end,
+                                    const void *color_data) {
+  if (!panel || x_start >= x_end || y_start >= y_end) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  x_start += panel->x_gap;
+  x_end += panel->x_gap;
+  y_start += panel->y_gap;
+  y_end += panel->y_gap;
+  uint8_t caset[4] = {x_start >> 8, x_start & 0xFF, (x_end - 1) >> 8,
+                      (x_end - 1) & 0xFF};
+  uint8_t paset[4] = {y_start >> 8, y_start & 0xFF, (y_end - 1) >> 8,
+                      (y_end - 1) & 0xFF};
+  tx_cmd(panel, CMD_CASET, caset, sizeof(caset));
+  tx_cmd(panel, CMD_PASET, paset, sizeof(paset));
+  size_t len = (size_t)(x_end - x_start) * (y_end - y_start) * 2;
+  return esp_lcd_panel_io_tx_color(panel->io, CMD_RAMWR, color_data, len);
+}
+
+static esp_err_t set_madctl(esp_lcd_panel_handle_t panel, uint8_t bits,
+                            bool on) {
+  if (!panel) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  panel->madctl = on ? panel->madctl | bits : panel->madctl & ~bits;
+  return tx_cmd(panel, CMD_MADCTL, &panel->madctl, 1);
+}
+
+esp_err_t esp_lcd_panel_mirror(esp_lcd_panel_handle_t panel, bool mirror_x,
+                               bool mirror_y) {
+  esp_err_t err = set_madctl(panel, MADCTL_MX, mirror_x);
+  return err == ESP_OK ? set_madctl(panel, MADCTL_MY, mirror_y) : err;
+}
+
+esp_err_t esp_lcd_panel_swap_xy(esp_lcd_panel_handle_t panel, bool swap_axes) {
+  return set_madctl(panel, MADCTL_MV, swap_axes);
+}
+
+esp_err_t esp_lcd_panel_set_gap(esp_lcd_panel_handle_t panel, int x_gap,
+                                int y_gap) {
+  if (!panel) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  panel->x_gap = x_gap;
+  panel->y_gap = y_gap;
+  return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_invert_color(esp_lcd_panel_handle_t panel,
+                                     bool invert_color_data) {
+  if (!panel) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  return tx_cmd(panel, invert_color_data ? CMD_INVON : CMD_INVOFF, NULL, 0);
+}
+
+esp_err_t esp_lcd_panel_disp_on_off(esp_lcd_panel_handle_t panel,
+                                    bool on_off) {
+  if (!panel) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  return tx_cmd(panel, on_off ? CMD_DISPON : CMD_DISPOFF, NULL, 0);
+}
+
+void hal_sim_lcd_set_dump(const char *path) {
+  free(dump_path);
+  dump_path = path ? strdup(path) : NULL;
+}
+
+// Schreibt den GRAM-Inhalt als PPM (P6), so wie das Panel ihn zeigen würde
+void hal_sim_lcd_dump(void) {
+  if (!dump_path) {
+    return;
+  }
+  FILE *f = fopen(dump_path, "wb");
+  if (!f) {
+    perror(dump_path);
+    return;
+  }
+  fprintf(f, "P6\n%d %d\n255\n", LCD_W, LCD_H);
+  for (size_t i = 0; i < LCD_W * LCD_H; i++) {
+    uint16_t c = lcd.display_on ? lcd.gram[i] : 0;
+    if (lcd.inverted) {
+      c = ~c;
+    }
+    uint8_t r = (c >> 11) << 3;
+    uint8_t g = ((c >> 5) & 0x3F) << 2;
+    uint8_t b = (c & 0x1F) << 3;
+    uint8_t rgb[3] = {r, g, b};
+    if (lcd.madctl & MADCTL_BGR) {
+      rgb[0] = b;
+      rgb[2] = r;
+    }
+    fwrite(rgb, 1, sizeof(rgb), f);
+  }
+  fclose(f);
+}
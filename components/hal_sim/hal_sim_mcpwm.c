@@ -0,0 +1,188 @@
+#include "driver/mcpwm_cap.h"
+#include "hal_sim.h"
+
+#include <stdlib.h>
+
+struct mcpwm_cap_timer_t {
+  int group_id;
+  bool enabled;
+  bool running;
+  size_t channels;
+};
+
+struct mcpwm_cap_channel_t {
+  mcpwm_cap_timer_handle_t timer;
+  int gpio;
+  bool pos_edge;
+  bool neg_edge;
+  bool invert;
+  bool enabled;
+  bool deleted; // GPIO-Listener lassen sich nicht abmelden
+  mcpwm_capture_event_cb_t on_cap;
+  void *user_ctx;
+};
+
+static mcpwm_cap_timer_handle_t timers[SOC_MCPWM_GROUPS];
+
+esp_err_t mcpwm_new_capture_timer(const mcpwm_capture_timer_config_t *config,
+                                  mcpwm_cap_timer_handle_t *ret_cap_timer) {
+  hal_sim_init();
+  if (!config || !ret_cap_timer || config->group_id < 0 ||
+      config->group_id >= SOC_MCPWM_GROUPS) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (timers[config->group_id]) {
+    return ESP_ERR_NOT_FOUND; // ein Capture-Timer pro Gruppe
+  }
+  mcpwm_cap_timer_handle_t t = calloc(1, sizeof(*t));
+  if (!t) {
+    return ESP_ERR_NO_MEM;
+  }
+  t->group_id = config->group_id;
+  timers[config->group_id] = t;
+  *ret_cap_timer = t;
+  return ESP_OK;
+}
+
+esp_err_t mcpwm_del_capture_timer(mcpwm_cap_timer_handle_t cap_timer) {
+  if (!cap_timer || cap_timer->enabled || cap_timer->channels) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  timers[cap_timer->group_id] = NULL;
+  free(cap_timer);
+  return ESP_OK;
+}
+
+esp_err_t mcpwm_capture_timer_enable(mcpwm_cap_timer_handle_t cap_timer) {
+  if (!cap_timer || cap_timer->enabled) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  cap_timer->enabled = true;
+  return ESP_OK;
+}
+
+esp_err_t mcpwm_capture_timer_disable(mcpwm_cap_timer_handle_t cap_timer) {
+  if (!cap_timer || !cap_timer->enabled) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  cap_timer->enabled = false;
+  return ESP_OK;
+}
+
+esp_err_t mcpwm_capture_timer_start(mcpwm_cap_timer_handle_t cap_timer) {
+  if (!cap_timer || !cap_timer->enabled) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  cap_timer->running = true;
+  return ESP_OK;
+}
+
+esp_err_t mcpwm_capture_timer_stop(mcpwm_cap_timer_handle_t cap_timer) {
+  if (!cap_timer || !cap_timer->enabled) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  cap_timer->running = false;
+  return ESP_OK;
+}
+
+esp_err_t mcpwm_capture_timer_get_resolution(mcpwm_cap_timer_handle_t cap_timer,
+                                             uint32_t *out_resolution) {
+  if (!cap_timer || !out_resolution) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  *out_resolution = HAL_SIM_MCPWM_CAPTURE_HZ;
+  return ESP_OK;
+}
+
+// Der Zählerstand wird von der Hardware bei der Flanke festgehalten, daher
+// der exakte Zeitpunkt statt der Zustellzeit
+static void on_edge(void *ctx, int gpio, int level, int64_t at_ns) {
+  mcpwm_cap_channel_handle_t ch = ctx;
+  if (ch->deleted || !ch->enabled || !ch->on_cap || !ch->timer->running) {
+    return;
+  }
+  bool rising = level != ch->invert;
+  if ((rising && !ch->pos_edge) || (!rising && !ch->neg_edge)) {
+    return;
+  }
+  int64_t start = hal_sim_now_ns();
+  mcpwm_capture_event_data_t edata = {
+      .cap_value =
+          (uint32_t)(at_ns * (HAL_SIM_MCPWM_CAPTURE_HZ / 1000000) / 1000),
+      .cap_edge = rising ? MCPWM_CAP_EDGE_POS : MCPWM_CAP_EDGE_NEG,
+  };
+  hal_sim_irq_set_time(at_ns);
+  ch->on_cap(ch, &edata, ch->user_ctx);
+  hal_sim_irq_set_time(-1);
+  hal_sim_stat_record(HAL_SIM_STAT_GPIO, start, 0, 0, false);
+}
+
+esp_err_t
+mcpwm_new_capture_channel(mcpwm_cap_timer_handle_t cap_timer,
+                          const mcpwm_capture_channel_config_t *config,
+                          mcpwm_cap_channel_handle_t *ret_cap_channel) {
+  if (!cap_timer || !config || !ret_cap_channel) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (cap_timer->channels >= SOC_MCPWM_CAPTURE_CHANNELS_PER_TIMER) {
+    return ESP_ERR_NOT_FOUND;
+  }
+  mcpwm_cap_channel_handle_t ch = calloc(1, sizeof(*ch));
+  if (!ch) {
+    return ESP_ERR_NO_MEM;
+  }
+  ch->timer = cap_timer;
+  ch->gpio = config->gpio_num;
+  ch->pos_edge = config->flags.pos_edge;
+  ch->neg_edge = config->flags.neg_edge;
+  ch->invert = config->flags.invert_cap_signal;
+  esp_err_t err = hal_sim_gpio_listen(ch->gpio, on_edge, ch);
+  if (err != ESP_OK) {
+    free(ch);
+    return err;
+  }
+  cap_timer->channels++;
+  *ret_cap_channel = ch;
+  return ESP_OK;
+}
+
+esp_err_t mcpwm_del_capture_channel(mcpwm_cap_channel_handle_t cap_channel) {
+  if (!cap_channel || cap_channel->enabled) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  // Bleibt als toter Listener stehen, daher nicht freigeben
+  cap_channel->deleted = true;
+  cap_channel->timer->channels--;
+  return ESP_OK;
+}
+
+esp_err_t mcpwm_capture_channel_enable(mcpwm_cap_channel_handle_t cap_channel) {
+  if (!cap_channel || cap_channel->enabled) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  cap_channel->enabled = true;
+  return ESP_OK;
+}
+
+esp_err_t
+mcpwm_capture_channel_disable(mcpwm_cap_channel_handle_t cap_channel) {
+  if (!cap_channel || !cap_channel->enabled) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  cap_channel->enabled = false;
+  return ESP_OK;
+}
+
+esp_err_t mcpwm_capture_channel_register_event_callbacks(
+    mcpwm_cap_channel_handle_t cap_channel,
+    const mcpwm_capture_event_callbacks_t *cbs, void *user_data) {
+  if (!cap_channel || !cbs) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (cap_channel->enabled) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  cap_channel->on_cap = cbs->on_cap;
+  cap_channel->user_ctx = user_data;
+  return ESP_OK;
+}
@@ -0,0 +1,363 @@
+#include "hal_sim.h"
+#include "onewire_bus.h"
+#include "onewire_device.h"
+
+#include <stdlib.h>
+
+// Standardgeschwindigkeit: Reset mit Presence etwa 960 µs, ein Bit 70 µs
+#define RESET_NS 960000
+#define SLOT_NS 70000
+
+#define CMD_READ_ROM 0x33
+#define CMD_MATCH_ROM 0x55
+#define CMD_SKIP_ROM 0xCC
+#define CMD_SEARCH_ROM 0xF0
+#define MAX_SELECTED 8
+
+typedef enum {
+  STATE_IDLE,     // kein Reset, der Bus ignoriert alles
+  STATE_ROM_CMD,  // nach dem Reset: ROM-Befehl erwartet
+  STATE_MATCH,    // MATCH ROM: 8 Adressbytes folgen
+  STATE_READ_ROM, // READ ROM: das einzige Gerät sendet seine Adresse
+  STATE_FUNCTION, // ausgewählte Geräte bekommen die Daten
+} state_t;
+
+struct onewire_bus_t {
+  int gpio;
+  state_t state;
+  uint64_t match;
+  int pos; // Byte in MATCH/READ ROM
+  hal_sim_onewire_dev_t *selected[MAX_SELECTED];
+  size_t selected_count;
+};
+
+// Zustand der SEARCH-ROM-Suche wie im Algorithmus aus Maxim AN187
+struct onewire_device_iter_t {
+  onewire_bus_handle_t bus;
+  uint64_t rom;          // zuletzt gefundene Adresse
+  int last_discrepancy;  // Bit der letzten offenen 0-Abzweigung, -1 = keine
+  bool last_device;
+};
+
+static hal_sim_onewire_dev_t *devices;
+
+// Polynom reflektiert 0x8C, bitweise reicht für die Simulation
+uint8_t hal_sim_onewire_crc8(const uint8_t *data, size_t len) {
+  uint8_t crc = 0;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (int b = 0; b < 8; b++) {
+      crc = crc & 1 ? (crc >> 1) ^ 0x8C : crc >> 1;
+    }
+  }
+  return crc;
+}
+
+void hal_sim_onewire_attach(hal_sim_onewire_dev_t *dev) {
+  dev->next = devices;
+  devices = dev;
+}
+
+hal_sim_onewire_dev_t *hal_sim_onewire_devices(int gpio) {
+  for (hal_sim_onewire_dev_t *d = devices; d; d = d->next) {
+    if (d->gpio == gpio) {
+      return d;
+    }
+  }
+  return NULL;
+}
+
+static hal_sim_onewire_dev_t *next_on_pin(hal_sim_onewire_dev_t *d, int gpio) {
+  for (d = d ? d->next : NULL; d; d = d->next) {
+    if (d->gpio == gpio) {
+      return d;
+    }
+  }
+  return NULL;
+}
+
+esp_err_t onewire_new_bus_rmt(const onewire_bus_config_t *bus_config,
+                              const onewire_bus_rmt_config_t *rmt_config,
+                              onewire_bus_handle_t *ret_bus) {
+  hal_sim_init();
+  if (!bus_config || !ret_bus || bus_config->bus_gpio_num < 0 ||
+      bus_config->bus_gpio_num >= HAL_SIM_GPIO_COUNT) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  onewire_bus_handle_t bus = calloc(1, sizeof(*bus));
+  if (!bus) {
+    return ESP_ERR_NO_MEM;
+  }
+  bus->gpio = bus_config->bus_gpio_num;
+  *ret_bus = bus;
+  return ESP_OK;
+}
+
+esp_err_t onewire_bus_del(onewire_bus_handle_t bus) {
+  free(bus);
+  return ESP_OK;
+}
+
+static void select_dev(onewire_bus_handle_t bus, hal_sim_onewire_dev_t *dev) {
+  if (bus->selected_count < MAX_SELECTED) {
+    bus->selected[bus->selected_count++] = dev;
+  }
+}
+
+esp_err_t onewire_bus_reset(onewire_bus_handle_t bus) {
+  if (!bus) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  int64_t start = hal_sim_now_ns();
+  esp_err_t err;
+  int64_t bus_ns;
+  if (hal_sim_replay_ow_reset(&err, &bus_ns)) {
+    hal_sim_bus_delay(bus_ns);
+    hal_sim_stat_record(HAL_SIM_STAT_ONEWIRE, start, bus_ns, 0,
+                        err != ESP_OK);
+    return err;
+  }
+  hal_sim_onewire_dev_t *first = hal_sim_onewire_devices(bus->gpio);
+  for (hal_sim_onewire_dev_t *d = first; d; d = next_on_pin(d, bus->gpio)) {
+    if (d->reset) {
+      d->reset(d);
+    }
+  }
+  bus->state = first ? STATE_ROM_CMD : STATE_IDLE;
+  bus->selected_count = 0;
+  hal_sim_bus_delay(RESET_NS);
+  hal_sim_stat_record(HAL_SIM_STAT_ONEWIRE, start, RESET_NS, 0, !first);
+  return first ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+static void write_byte(onewire_bus_handle_t bus, uint8_t byte) {
+  switch (bus->state) {
+  case STATE_IDLE:
+  case STATE_READ_ROM:
+    break;
+  case STATE_ROM_CMD:
+    if (byte == CMD_SKIP_ROM) {
+      hal_sim_onewire_dev_t *d = hal_sim_onewire_devices(bus->gpio);
+      for (; d; d = next_on_pin(d, bus->gpio)) {
+        select_dev(bus, d);
+      }
+      bus->state = STATE_FUNCTION;
+    } else if (byte == CMD_MATCH_ROM) {
+      bus->match = 0;
+      bus->pos = 0;
+      bus->state = STATE_MATCH;
+    } else if (byte == CMD_READ_ROM) {
+      bus->pos = 0;
+      bus->state = STATE_READ_ROM;
+    } else {
+      bus->state = STATE_IDLE; // SEARCH ROM übernimmt der Iterator
+    }
+    break;
+  case STATE_MATCH:
+    bus->match |= (uint64_t)byte << (8 * bus->pos);
+    if (++bus->pos == 8) {
+      hal_sim_onewire_dev_t *d = hal_sim_onewire_devices(bus->gpio);
+      for (; d; d = next_on_pin(d, bus->gpio)) {
+        if (d->rom == bus->match) {
+          select_dev(bus, d);
+        }
+      }
+      bus->state = bus->selected_count ? STATE_FUNCTION : STATE_IDLE;
+    }
+    break;
+  case STATE_FUNCTION:
+    for (size_t i = 0; i < bus->selected_count; i++) {
+      bus->selected[i]->write_byte(bus->selected[i], byte);
+    }
+    break;
+  }
+}
+
+// Offener Kollektor: ohne Gerät liest der Master 1, sonst das UND aller
+static uint8_t read_byte(onewire_bus_handle_t bus) {
+  if (bus->state == STATE_READ_ROM) {
+    hal_sim_onewire_dev_t *d = hal_sim_onewire_devices(bus->gpio);
+    return bus->pos < 8 ? (uint8_t)(d->rom >> (8 * bus->pos++)) : 0xFF;
+  }
+  uint8_t value = 0xFF;
+  if (bus->state == STATE_FUNCTION) {
+    for (size_t i = 0; i < bus->selected_count; i++) {
+      value &= bus->selected[i]->read_byte(bus->selected[i]);
+    }
+  }
+  return value;
+}
+
+esp_err_t onewire_bus_write_bytes(onewire_bus_handle_t bus,
+                                  const uint8_t *tx_data,
+                                  uint8_t tx_data_size) {
+  if (!bus || !tx_data) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  int64_t start = hal_sim_now_ns();
+  int64_t bus_ns;
+  if (!hal_sim_replay_ow_write(tx_data, tx_data_size, &bus_ns)) {
+    for (uint8_t i = 0; i < tx_data_size; i++) {
+      write_byte(bus, tx_data[i]);
+    }
+    bus_ns = (int64_t)tx_data_size * 8 * SLOT_NS;
+  }
+  hal_sim_bus_delay(bus_ns);
+  hal_sim_stat_record(HAL_SIM_STAT_ONEWIRE, start, bus_ns, tx_data_size,
+                      false);
+  return ESP_OK;
+}
+
+esp_err_t onewire_bus_read_bytes(onewire_bus_handle_t bus, uint8_t *rx_buf,
+                                 size_t rx_buf_size) {
+  if (!bus || !rx_buf) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  int64_t start = hal_sim_now_ns();
+  int64_t bus_ns;
+  if (!hal_sim_replay_ow_read(rx_buf, rx_buf_size, &bus_ns)) {
+    for (size_t i = 0; i < rx_buf_size; i++) {
+      rx_buf[i] = read_byte(bus);
+    }
+    bus_ns = (int64_t)rx_buf_size * 8 * SLOT_NS;
+  }
+  hal_sim_bus_delay(bus_ns);
+  hal_sim_stat_record(HAL_SIM_STAT_ONEWIRE, start, bus_ns, rx_buf_size,
+                      false);
+  return ESP_OK;
+}
+
+// Einzelne Bits schreibt im Repo niemand; sie kosten nur Buszeit
+esp_err_t onewire_bus_write_bit(onewire_bus_handle_t bus, uint8_t tx_bit) {
+  if (!bus) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  int64_t start = hal_sim_now_ns();
+  hal_sim_bus_delay(SLOT_NS);
+  hal_sim_stat_record(HAL_SIM_STAT_ONEWIRE, start, SLOT_NS, 0, false);
+  return ESP_OK;
+}
+
+esp_err_t onewire_bus_read_bit(onewire_bus_handle_t bus, uint8_t *rx_bit) {
+  if (!bus || !rx_bit) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  int64_t start = hal_sim_now_ns();
+  uint8_t bit = 1;
+  int64_t bus_ns = SLOT_NS;
+  if (!hal_sim_replay_ow_bit(&bit, &bus_ns) &&
+      bus->state == STATE_FUNCTION) {
+    for (size_t i = 0; i < bus->selected_count; i++) {
+      hal_sim_onewire_dev_t *d = bus->selected[i];
+      bit &= d->read_bit ? d->read_bit(d) : 1;
+    }
+  }
+  *rx_bit = bit;
+  hal_sim_bus_delay(bus_ns);
+  hal_sim_stat_record(HAL_SIM_STAT_ONEWIRE, start, bus_ns, 0, false);
+  return ESP_OK;
+}
+
+esp_err_t onewire_new_device_iter(onewire_bus_handle_t bus,
+                                  onewire_device_iter_handle_t *ret_iter) {
+  if (!bus || !ret_iter) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  onewire_device_iter_handle_t iter = calloc(1, sizeof(*iter));
+  if (!iter) {
+    return ESP_ERR_NO_MEM;
+  }
+  iter->bus = bus;
+  iter->last_discrepancy = -1;
+  *ret_iter = iter;
+  return ESP_OK;
+}
+
+// Ein Durchlauf von SEARCH ROM. Pro Bit senden alle noch beteiligten Geräte
+// ihr Adressbit und dessen Komplement (offener Kollektor: UND über alle),
+// der Master schreibt die gewählte Richtung zurück. Bei einem Konflikt geht
+// es erst in die 0, im nächsten Durchlauf ab der letzten offenen 0 in die 1.
+static bool search_rom(onewire_device_iter_handle_t iter, uint64_t *address) {
+  int gpio = iter->bus->gpio;
+  if (iter->last_device || !hal_sim_onewire_devices(gpio)) {
+    return false;
+  }
+  write_byte(iter->bus, CMD_SEARCH_ROM);
+
+  uint64_t rom = 0;
+  int last_zero = -1;
+  for (int i = 0; i < 64; i++) {
+    uint64_t chosen = i ? UINT64_MAX >> (64 - i) : 0;
+    uint8_t id_bit = 1, cmp_bit = 1;
+    hal_sim_onewire_dev_t *d = hal_sim_onewire_devices(gpio);
+    for (; d; d = next_on_pin(d, gpio)) {
+      if ((d->rom ^ rom) & chosen) {
+        continue; // an einer früheren Abzweigung ausgestiegen
+      }
+      uint8_t bit = (d->rom >> i) & 1;
+      id_bit &= bit;
+      cmp_bit &= !bit;
+    }
+    if (id_bit && cmp_bit) {
+      return false; // niemand mehr am Bus
+    }
+    uint8_t dir = id_bit;
+    if (!id_bit && !cmp_bit) {
+      if (i < iter->last_discrepancy) {
+        dir = (iter->rom >> i) & 1;
+      } else {
+        dir = i == iter->last_discrepancy;
+      }
+      if (!dir) {
+        last_zero = i;
+      }
+    }
+    rom |= (uint64_t)dir << i;
+  }
+
+  iter->rom = rom;
+  iter->last_discrepancy = last_zero;
+  iter->last_device = last_zero < 0;
+  *address = rom;
+  return true;
+}
+
+// Eine Suche kostet pro Gerät 64 Bitpositionen zu je drei Slots. Wie der
+// echte Treiber liefert get_next bei falscher ROM-CRC ESP_ERR_INVALID_CRC,
+// die Suche geht beim nächsten Aufruf trotzdem weiter.
+esp_err_t onewire_device_iter_get_next(onewire_device_iter_handle_t iter,
+                                       onewire_device_t *dev) {
+  if (!iter || !dev) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  int64_t start = hal_sim_now_ns();
+  int64_t bus_ns = RESET_NS + (8 + 64 * 3) * (int64_t)SLOT_NS;
+  bool found;
+  uint64_t address = 0;
+  if (!hal_sim_replay_ow_search(&found, &address)) {
+    found = onewire_bus_reset(iter->bus) == ESP_OK &&
+            search_rom(iter, &address);
+    bus_ns -= RESET_NS; // schon im Reset gezählt
+  }
+  if (!found) {
+    return ESP_ERR_NOT_FOUND;
+  }
+  uint8_t rom[8];
+  for (int i = 0; i < 8; i++) {
+    rom[i] = (uint8_t)(address >> (8 * i));
+  }
+  bool crc_ok = hal_sim_onewire_crc8(rom, 7) == rom[7];
+  hal_sim_bus_delay(bus_ns);
+  hal_sim_stat_record(HAL_SIM_STAT_ONEWIRE, start, bus_ns, 8, !crc_ok);
+  if (!crc_ok) {
+    return ESP_ERR_INVALID_CRC;
+  }
+  dev->bus = iter->bus;
+  dev->address = address;
+  return ESP_OK;
+}
+
+esp_err_t onewire_del_device_iter(onewire_device_iter_handle_t iter) {
+  free(iter);
+  return ESP_OK;
+}
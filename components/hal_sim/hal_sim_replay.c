@@ -0,0 +1,579 @@
+#include "hal_sim.h"
+#include "periph_trace_format.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+Replay eines periph_trace-Mitschnitts.
+
+Bus-Transaktionen werden je Klasse (I2C, 1-Wire, GPIO-Ausgang) der Reihe
+nach mit den Aufrufen der Anwendung abgeglichen. Ein Aufruf passt, wenn
+unter den nächsten WINDOW Datensätzen der Klasse einer mit gleichem Inhalt
+liegt (I2C: gleiche geschriebene Bytes und Leselängen, 1-Wire: gleicher
+Typ, beim Schreiben gleiche Daten); übersprungene Datensätze werden
+gezählt. Passt nichts, antworten die Gerätemodelle aus HAL_SIM_SCRIPT.
+
+Eingangsflanken (GPIO-ISR, MCPWM-Capture) hängen am letzten davor
+aufgezeichneten gpio_set_level. Sobald die Anwendung diesen Aufruf
+wiederholt, werden sie mit dem aufgezeichneten Abstand geplant; innerhalb
+einer Gruppe zählen für Capture-Flanken die exakten Zählerstände statt der
+Zeitstempel aus dem ISR. Ein Pin mit Capture-Flanken bekommt seine
+GPIO-ISR-Flanken nicht noch einmal, er wird nur einmal getrieben.
+*/
+
+#define WINDOW 16
+#define CANON_MAX 512
+#define NO_ANCHOR SIZE_MAX
+
+typedef enum { CLASS_NONE, CLASS_I2C, CLASS_OW, CLASS_GPIO } class_t;
+
+typedef struct {
+  uint8_t type;
+  int64_t t_us;
+  const uint8_t *payload;
+  size_t len;
+  bool used;
+  hal_sim_event_t event;
+} record_t;
+
+typedef struct {
+  size_t *idx; // Datensätze der Klasse in Dateireihenfolge
+  size_t count;
+  size_t pos;
+} cursor_t;
+
+typedef struct {
+  uint64_t matched;
+  uint64_t mismatched;
+  uint64_t skipped;
+  uint64_t edges;
+  uint64_t lost; // auf dem Gerät verworfene Datensätze
+} replay_stats_t;
+
+static uint8_t *file_data;
+static record_t *records;
+static size_t record_count;
+static uint32_t cap_hz;
+static cursor_t cursors[CLASS_GPIO + 1];
+static SemaphoreHandle_t lock;
+static replay_stats_t stats;
+static bool has_capture[HAL_SIM_GPIO_COUNT];
+
+bool hal_sim_replay_active(void) { return records != NULL; }
+
+static class_t class_of(uint8_t type) {
+  switch (type) {
+  case PT_I2C:
+    return CLASS_I2C;
+  case PT_OW_RESET:
+  case PT_OW_WRITE:
+  case PT_OW_READ:
+  case PT_OW_BIT:
+  case PT_OW_SEARCH:
+    return CLASS_OW;
+  case PT_GPIO_OUT:
+    return CLASS_GPIO;
+  default:
+    return CLASS_NONE;
+  }
+}
+
+// Länge des Payloads ab `p`, 0 bei unbekanntem Typ oder kaputten Daten
+static size_t payload_len(uint8_t type, const uint8_t *p, size_t len) {
+  uint64_t v;
+  size_t n = 0;
+  size_t k;
+  switch (type) {
+  case PT_GPIO_OUT:
+  case PT_GPIO_EDGE:
+    return len >= 2 ? 2 : 0;
+  case PT_CAP_EDGE:
+    return len >= 6 ? 6 : 0;
+  case PT_OW_RESET:
+  case PT_OW_BIT:
+    k = len > 1 ? pt_get_varint(p + 1, len - 1, &v) : 0;
+    return k ? 1 + k : 0;
+  case PT_OW_WRITE:
+  case PT_OW_READ:
+    if (!(k = pt_get_varint(p, len, &v))) {
+      return 0;
+    }
+    n = k;
+    if (!(k = pt_get_varint(p + n, len - n, &v)) || v > len - n - k) {
+      return 0;
+    }
+    return n + k + v;
+  case PT_OW_SEARCH:
+    return len >= 1 && (!p[0] || len >= 9) ? (p[0] ? 9 : 1) : 0;
+  case PT_LOST:
+    return pt_get_varint(p, len, &v);
+  case PT_I2C: {
+    uint64_t n_ops;
+    n = 1;
+    for (int i = 0; i < 3; i++) { // err, dur_us, n_ops
+      if (n >= len || !(k = pt_get_varint(p + n, len - n, &n_ops))) {
+        return 0;
+      }
+      n += k;
+    }
+    for (uint64_t i = 0; i < n_ops; i++) {
+      if (n >= len) {
+        return 0;
+      }
+      uint8_t op = p[n++];
+      if (op == PT_I2C_WRITE || op == PT_I2C_READ) {
+        if (!(k = pt_get_varint(p + n, len - n, &v)) || v > len - n - k) {
+          return 0;
+        }
+        n += k + v;
+      } else if (op > PT_I2C_READ) {
+        return 0;
+      }
+    }
+    return n;
+  }
+  default:
+    return 0;
+  }
+}
+
+static void fire_edge(hal_sim_event_t *ev, int64_t at_ns) {
+  const record_t *r = ev->arg;
+  int level = r->type == PT_CAP_EDGE ? r->payload[1] == 0 : r->payload[1];
+  hal_sim_gpio_drive(r->payload[0], level, at_ns);
+}
+
+static bool is_input(const record_t *r) {
+  int gpio = r->payload[0];
+  return gpio < HAL_SIM_GPIO_COUNT &&
+         (r->type == PT_CAP_EDGE ||
+          (r->type == PT_GPIO_EDGE && !has_capture[gpio]));
+}
+
+static uint32_t cap_value(const record_t *r) {
+  const uint8_t *p = &r->payload[2];
+  return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+// Plant die Eingangsflanken, die an `anchor` hängen; `host_ns` ist der
+// Zeitpunkt, zu dem der Anker auf dem PC erreicht wurde
+static void schedule_inputs(size_t anchor, int64_t host_ns) {
+  size_t first = anchor == NO_ANCHOR ? 0 : anchor + 1;
+  int64_t base_us = anchor == NO_ANCHOR ? records[0].t_us
+                                        : records[anchor].t_us;
+  const record_t *first_cap = NULL;
+  int64_t first_cap_ns = 0;
+  for (size_t i = first; i < record_count && records[i].type != PT_GPIO_OUT;
+       i++) {
+    record_t *r = &records[i];
+    if (!is_input(r)) {
+      continue;
+    }
+    int64_t at_ns = host_ns + (r->t_us - base_us) * 1000;
+    if (r->type == PT_CAP_EDGE && cap_hz) {
+      if (!first_cap) {
+        first_cap = r;
+        first_cap_ns = at_ns;
+      } else {
+        uint32_t ticks = cap_value(r) - cap_value(first_cap);
+        at_ns = first_cap_ns + (int64_t)ticks * 1000000000LL / cap_hz;
+      }
+    }
+    hal_sim_event_schedule(&r->event, at_ns);
+    stats.edges++;
+  }
+}
+
+esp_err_t hal_sim_replay_load(const char *path) {
+  FILE *f = fopen(path, "rb");
+  if (!f) {
+    perror(path);
+    return ESP_ERR_NOT_FOUND;
+  }
+  fseek(f, 0, SEEK_END);
+  long size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  file_data = malloc(size > 0 ? size : 1);
+  if (!file_data || fread(file_data, 1, size, f) != (size_t)size) {
+    fclose(f);
+    return ESP_FAIL;
+  }
+  fclose(f);
+
+  periph_trace_header_t header;
+  if ((size_t)size < sizeof(header)) {
+    return ESP_ERR_INVALID_SIZE;
+  }
+  memcpy(&header, file_data, sizeof(header));
+  if (header.magic != PT_MAGIC || header.version != PT_VERSION ||
+      header.time_hz != 1000000) {
+    fprintf(stderr, "%s: kein periph_trace-Mitschnitt\n", path);
+    return ESP_ERR_INVALID_VERSION;
+  }
+  cap_hz = header.cap_hz;
+
+  // Zwei Durchläufe: zählen, dann anlegen
+  const uint8_t *end = file_data + size;
+  for (int pass = 0; pass < 2; pass++) {
+    const uint8_t *p = file_data + sizeof(header);
+    int64_t t_us = 0;
+    size_t n = 0;
+    while (p < end) {
+      uint8_t type = *p++;
+      uint64_t dt;
+      size_t k = pt_get_varint(p, end - p, &dt);
+      size_t len = k ? payload_len(type, p + k, end - p - k) : 0;
+      if (!k || !len) {
+        // Abgeschnittenes Ende, etwa weil die UART-Aufnahme abbrach
+        if (pass == 0) {
+          fprintf(stderr, "%s: Datensatz %zu unlesbar, Rest ignoriert\n",
+                  path, n);
+        }
+        break;
+      }
+      p += k;
+      t_us += dt;
+      if (pass == 1) {
+        uint64_t lost;
+        if (type == PT_LOST && pt_get_varint(p, len, &lost)) {
+          stats.lost += lost;
+        }
+        records[n] = (record_t){
+            .type = type,
+            .t_us = t_us,
+            .payload = p,
+            .len = len,
+            .event = {.fn = fire_edge, .arg = &records[n]},
+        };
+        if (type == PT_CAP_EDGE && p[0] < HAL_SIM_GPIO_COUNT) {
+          has_capture[p[0]] = true;
+        }
+        class_t c = class_of(type);
+        if (c != CLASS_NONE) {
+          cursors[c].idx[cursors[c].count++] = n;
+        }
+      } else {
+        class_t c = class_of(type);
+        if (c != CLASS_NONE) {
+          cursors[c].count++;
+        }
+      }
+      p += len;
+      n++;
+    }
+    if (pass == 0) {
+      records = calloc(n ? n : 1, sizeof(record_t));
+      for (int c = 0; c <= CLASS_GPIO; c++) {
+        cursors[c].idx = calloc(cursors[c].count + 1, sizeof(size_t));
+        cursors[c].count = 0;
+      }
+      if (!records) {
+        return ESP_ERR_NO_MEM;
+      }
+    }
+    record_count = n;
+  }
+  lock = xSemaphoreCreateMutex();
+  if (record_count) {
+    schedule_inputs(NO_ANCHOR, hal_sim_now_ns());
+  }
+  printf("hal_sim: Replay von %s, %zu Datensätze über %.3f s\n", path,
+         record_count,
+         record_count ? (records[record_count - 1].t_us - records[0].t_us) / 1e6
+                      : 0.0);
+  return ESP_OK;
+}
+
+// Sucht im Fenster ab der Position der Klasse den ersten Datensatz, für den
+// `match` zutrifft, und verbraucht ihn
+static record_t *take(class_t c, bool (*match)(const record_t *r, void *arg),
+                      void *arg) {
+  cursor_t *cur = &cursors[c];
+  for (size_t i = cur->pos; i < cur->count && i < cur->pos + WINDOW; i++) {
+    record_t *r = &records[cur->idx[i]];
+    if (match(r, arg)) {
+      stats.skipped += i - cur->pos;
+      stats.matched++;
+      cur->pos = i + 1;
+      r->used = true;
+      return r;
+    }
+  }
+  stats.mismatched++;
+  return NULL;
+}
+
+// I2C: Kommandolisten in eine Normalform bringen, in der aufeinander
+// folgende WRITE bzw. READ zusammengefasst sind. Die Form enthält Port,
+// Art und Länge jedes Abschnitts sowie die geschriebenen Bytes, nicht aber
+// die gelesenen.
+
+typedef struct {
+  uint8_t bytes[CANON_MAX];
+  size_t len;
+  bool overflow;
+  int last;   // Art des offenen Abschnitts, -1 = keiner
+  size_t at;  // Position der Länge des offenen Abschnitts
+} canon_t;
+
+static void canon_put(canon_t *c, const void *data, size_t len) {
+  if (c->len + len > CANON_MAX) {
+    c->overflow = true;
+    return;
+  }
+  memcpy(&c->bytes[c->len], data, len);
+  c->len += len;
+}
+
+// Längen als 16 Bit, damit ein Abschnitt nachträglich wachsen kann
+static void canon_op(canon_t *c, int type, const uint8_t *data, size_t len) {
+  bool extend = (type == PT_I2C_WRITE || type == PT_I2C_READ) &&
+                c->last == type;
+  if (!extend) {
+    uint8_t t = type;
+    canon_put(c, &t, 1);
+    c->last = type;
+    if (type == PT_I2C_WRITE || type == PT_I2C_READ) {
+      c->at = c->len;
+      canon_put(c, (uint8_t[2]){0, 0}, 2);
+    }
+  }
+  if (type != PT_I2C_WRITE && type != PT_I2C_READ) {
+    return;
+  }
+  if (type == PT_I2C_WRITE) {
+    canon_put(c, data, len);
+  }
+  if (!c->overflow) {
+    size_t total = (c->bytes[c->at] | c->bytes[c->at + 1] << 8) + len;
+    c->bytes[c->at] = (uint8_t)total;
+    c->bytes[c->at + 1] = (uint8_t)(total >> 8);
+  }
+}
+
+typedef struct {
+  canon_t canon;
+  esp_err_t err;
+  int64_t dur_us;
+} i2c_match_t;
+
+// Normalform eines aufgezeichneten PT_I2C; `rd` bekommt die gelesenen
+// Bytes, wenn nicht NULL
+static void canon_record(const record_t *r, canon_t *c, i2c_match_t *m,
+                         uint8_t *rd, size_t rd_cap, size_t *rd_len) {
+  const uint8_t *p = r->payload;
+  uint64_t err = 0, dur = 0, n_ops = 0, len;
+  size_t n = 1;
+  n += pt_get_varint(p + n, r->len - n, &err);
+  n += pt_get_varint(p + n, r->len - n, &dur);
+  n += pt_get_varint(p + n, r->len - n, &n_ops);
+  *c = (canon_t){.last = -1};
+  canon_put(c, &p[0], 1);
+  if (m) {
+    m->err = (esp_err_t)pt_unzigzag(err);
+    m->dur_us = (int64_t)dur;
+  }
+  for (uint64_t i = 0; i < n_ops; i++) {
+    uint8_t op = p[n++];
+    len = 0;
+    if (op == PT_I2C_WRITE || op == PT_I2C_READ) {
+      n += pt_get_varint(p + n, r->len - n, &len);
+    }
+    canon_op(c, op, p + n, len);
+    if (op == PT_I2C_READ && rd) {
+      size_t k = len < rd_cap - *rd_len ? len : rd_cap - *rd_len;
+      memcpy(rd + *rd_len, p + n, k);
+      *rd_len += k;
+    }
+    if (op == PT_I2C_WRITE || op == PT_I2C_READ) {
+      n += len;
+    }
+  }
+}
+
+static bool match_i2c(const record_t *r, void *arg) {
+  const canon_t *want = arg;
+  canon_t got;
+  canon_record(r, &got, NULL, NULL, 0, NULL);
+  return !got.overflow && got.len == want->len &&
+         memcmp(got.bytes, want->bytes, got.len) == 0;
+}
+
+bool hal_sim_replay_i2c(int port, hal_sim_i2c_op_t *ops, size_t count,
+                        esp_err_t *err, int64_t *bus_ns) {
+  if (!hal_sim_replay_active()) {
+    return false;
+  }
+  canon_t want = {.last = -1};
+  uint8_t p = (uint8_t)port;
+  canon_put(&want, &p, 1);
+  for (size_t i = 0; i < count; i++) {
+    canon_op(&want, ops[i].type, ops[i].data, ops[i].len);
+  }
+  if (want.overflow) {
+    return false;
+  }
+  xSemaphoreTake(lock, portMAX_DELAY);
+  record_t *r = take(CLASS_I2C, match_i2c, &want);
+  if (r) {
+    // Gelesene Bytes der Reihe nach auf die READ-Schritte verteilen
+    uint8_t rd[CANON_MAX];
+    size_t rd_len = 0;
+    i2c_match_t m;
+    canon_record(r, &want, &m, rd, sizeof(rd), &rd_len);
+    size_t pos = 0;
+    for (size_t i = 0; i < count; i++) {
+      if (ops[i].type == HAL_SIM_I2C_READ) {
+        size_t k = ops[i].len < rd_len - pos ? ops[i].len : rd_len - pos;
+        memcpy(ops[i].data, rd + pos, k);
+        pos += k;
+      }
+    }
+    *err = m.err;
+    *bus_ns = m.dur_us * 1000;
+  }
+  xSemaphoreGive(lock);
+  return r != NULL;
+}
+
+// 1-Wire
+
+typedef struct {
+  uint8_t type;
+  const uint8_t *data; // nur PT_OW_WRITE
+  size_t len;
+} ow_want_t;
+
+// Payload ab dur_us: Dauer und ggf. Daten auslesen
+static const uint8_t *ow_data(const record_t *r, int64_t *dur_us,
+                              size_t *len) {
+  uint64_t dur = 0, n = 0;
+  size_t k = pt_get_varint(r->payload, r->len, &dur);
+  k += pt_get_varint(r->payload + k, r->len - k, &n);
+  *dur_us = (int64_t)dur;
+  *len = n;
+  return r->payload + k;
+}
+
+static bool match_ow(const record_t *r, void *arg) {
+  const ow_want_t *want = arg;
+  if (r->type != want->type) {
+    return false;
+  }
+  if (r->type != PT_OW_WRITE && r->type != PT_OW_READ) {
+    return true;
+  }
+  int64_t dur;
+  size_t len;
+  const uint8_t *data = ow_data(r, &dur, &len);
+  return len == want->len &&
+         (r->type == PT_OW_READ || memcmp(data, want->data, len) == 0);
+}
+
+static record_t *take_ow(uint8_t type, const uint8_t *data, size_t len) {
+  if (!hal_sim_replay_active()) {
+    return NULL;
+  }
+  ow_want_t want = {type, data, len};
+  xSemaphoreTake(lock, portMAX_DELAY);
+  record_t *r = take(CLASS_OW, match_ow, &want);
+  xSemaphoreGive(lock);
+  return r;
+}
+
+bool hal_sim_replay_ow_reset(esp_err_t *err, int64_t *bus_ns) {
+  record_t *r = take_ow(PT_OW_RESET, NULL, 0);
+  if (r) {
+    uint64_t dur = 0;
+    pt_get_varint(r->payload + 1, r->len - 1, &dur);
+    *err = r->payload[0] ? ESP_OK : ESP_ERR_NOT_FOUND;
+    *bus_ns = (int64_t)dur * 1000;
+  }
+  return r != NULL;
+}
+
+bool hal_sim_replay_ow_write(const uint8_t *data, size_t len,
+                             int64_t *bus_ns) {
+  record_t *r = take_ow(PT_OW_WRITE, data, len);
+  if (r) {
+    size_t n;
+    ow_data(r, bus_ns, &n);
+    *bus_ns *= 1000;
+  }
+  return r != NULL;
+}
+
+bool hal_sim_replay_ow_read(uint8_t *data, size_t len, int64_t *bus_ns) {
+  record_t *r = take_ow(PT_OW_READ, NULL, len);
+  if (r) {
+    size_t n;
+    memcpy(data, ow_data(r, bus_ns, &n), len);
+    *bus_ns *= 1000;
+  }
+  return r != NULL;
+}
+
+bool hal_sim_replay_ow_bit(uint8_t *bit, int64_t *bus_ns) {
+  record_t *r = take_ow(PT_OW_BIT, NULL, 0);
+  if (r) {
+    uint64_t dur = 0;
+    pt_get_varint(r->payload + 1, r->len - 1, &dur);
+    *bit = r->payload[0];
+    *bus_ns = (int64_t)dur * 1000;
+  }
+  return r != NULL;
+}
+
+bool hal_sim_replay_ow_search(bool *found, uint64_t *address) {
+  record_t *r = take_ow(PT_OW_SEARCH, NULL, 0);
+  if (r) {
+    *found = r->payload[0];
+    *address = 0;
+    for (int i = 0; *found && i < 8; i++) {
+      *address |= (uint64_t)r->payload[1 + i] << (8 * i);
+    }
+  }
+  return r != NULL;
+}
+
+// GPIO
+
+static bool match_gpio(const record_t *r, void *arg) {
+  const uint8_t *want = arg;
+  return r->payload[0] == want[0] && r->payload[1] == want[1];
+}
+
+void hal_sim_replay_gpio_out(int gpio, int level, int64_t at_ns) {
+  if (!hal_sim_replay_active()) {
+    return;
+  }
+  uint8_t want[2] = {(uint8_t)gpio, level ? 1 : 0};
+  xSemaphoreTake(lock, portMAX_DELAY);
+  record_t *r = take(CLASS_GPIO, match_gpio, want);
+  if (r) {
+    schedule_inputs(r - records, at_ns);
+  }
+  xSemaphoreGive(lock);
+}
+
+void hal_sim_replay_report(FILE *out) {
+  if (!hal_sim_replay_active()) {
+    return;
+  }
+  size_t unused = 0;
+  for (int c = CLASS_I2C; c <= CLASS_GPIO; c++) {
+    for (size_t i = 0; i < cursors[c].count; i++) {
+      unused += !records[cursors[c].idx[i]].used;
+    }
+  }
+  fprintf(out,
+          "replay: %" PRIu64 " passend, %" PRIu64 " abweichend, %" PRIu64
+          " übersprungen, %zu unbenutzt, %" PRIu64 " Flanken, %" PRIu64
+          " auf dem Gerät verloren\n",
+          stats.matched, stats.mismatched, stats.skipped, unused, stats.edges,
+          stats.lost);
+}
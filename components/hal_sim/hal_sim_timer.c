@@ -0,0 +1,316 @@
+#include "driver/gptimer.h"
+#include "esp_cpu.h"
+#include "esp_timer.h"
+#include "hal_sim.h"
+
+#include <stdlib.h>
+
+// esp_timer
+
+struct esp_timer {
+  hal_sim_event_t event;
+  esp_timer_cb_t callback;
+  void *arg;
+  uint64_t period_us; // 0 = einmalig
+};
+
+int64_t esp_timer_get_time(void) {
+  hal_sim_init();
+  return hal_sim_now_ns() / 1000;
+}
+
+esp_cpu_cycle_count_t esp_cpu_get_cycle_count(void) {
+  hal_sim_init();
+  return (esp_cpu_cycle_count_t)(hal_sim_now_ns() * (HAL_SIM_CPU_HZ / 1000000) /
+                                 1000);
+}
+
+static void esp_timer_fire(hal_sim_event_t *ev, int64_t at_ns) {
+  esp_timer_handle_t timer = ev->arg;
+  int64_t start = hal_sim_now_ns();
+  // Vor dem Callback neu planen, damit er den Timer stoppen kann
+  if (timer->period_us) {
+    hal_sim_event_schedule(ev, at_ns + timer->period_us * 1000);
+  }
+  timer->callback(timer->arg);
+  hal_sim_stat_record(HAL_SIM_STAT_TIMER, start, 0, 0, false);
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args,
+                           esp_timer_handle_t *out_handle) {
+  hal_sim_init();
+  if (!create_args || !create_args->callback || !out_handle) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  esp_timer_handle_t timer = calloc(1, sizeof(*timer));
+  if (!timer) {
+    return ESP_ERR_NO_MEM;
+  }
+  timer->event.fn = esp_timer_fire;
+  timer->event.arg = timer;
+  timer->callback = create_args->callback;
+  timer->arg = create_args->arg;
+  *out_handle = timer;
+  return ESP_OK;
+}
+
+static esp_err_t start(esp_timer_handle_t timer, uint64_t timeout_us,
+                       uint64_t period_us) {
+  if (!timer) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (timer->event.queued) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  timer->period_us = period_us;
+  hal_sim_event_schedule(&timer->event,
+                         hal_sim_now_ns() + (int64_t)timeout_us * 1000);
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+  return start(timer, timeout_us, 0);
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer,
+                                   uint64_t period) {
+  if (period == 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  return start(timer, period, period);
+}
+
+esp_err_t esp_timer_restart(esp_timer_handle_t timer, uint64_t timeout_us) {
+  if (!timer || !timer->event.queued) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  hal_sim_event_cancel(&timer->event);
+  if (timer->period_us) {
+    timer->period_us = timeout_us;
+  }
+  return start(timer, timeout_us, timer->period_us);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+  if (!timer) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (!timer->event.queued) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  timer->period_us = 0;
+  hal_sim_event_cancel(&timer->event);
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+  if (!timer) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (timer->event.queued) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  free(timer);
+  return ESP_OK;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer) {
+  return timer && timer->event.queued;
+}
+
+// gptimer: Zählerstand = Stand beim letzten Start/Setzen plus verstrichene
+// Zeit in Zählertakten
+
+struct gptimer_t {
+  hal_sim_event_t event;
+  uint32_t resolution_hz;
+  bool up;
+  bool enabled;
+  bool running;
+  uint64_t base_count;
+  int64_t base_ns; // Simulationszeit zu base_count
+  gptimer_alarm_cb_t on_alarm;
+  void *user_ctx;
+  bool alarm_set;
+  gptimer_alarm_config_t alarm;
+};
+
+static uint64_t ticks_between(const struct gptimer_t *t, int64_t from_ns,
+                              int64_t to_ns) {
+  return (uint64_t)(to_ns - from_ns) * t->resolution_hz / 1000000000ULL;
+}
+
+static uint64_t count_at(const struct gptimer_t *t, int64_t now_ns) {
+  if (!t->running) {
+    return t->base_count;
+  }
+  uint64_t d = ticks_between(t, t->base_ns, now_ns);
+  return t->up ? t->base_count + d : t->base_count - d;
+}
+
+// Plant den nächsten Alarm, falls er erreichbar ist
+static void arm_alarm(struct gptimer_t *t) {
+  hal_sim_event_cancel(&t->event);
+  if (!t->running || !t->alarm_set || !t->enabled) {
+    return;
+  }
+  uint64_t target = t->alarm.alarm_count;
+  uint64_t now = t->base_count;
+  uint64_t distance = t->up ? target - now : now - target;
+  if ((t->up && target < now) || (!t->up && target > now)) {
+    return; // erst nach einem Überlauf, praktisch nie
+  }
+  int64_t ns = (int64_t)(distance * 1000000000ULL / t->resolution_hz);
+  hal_sim_event_schedule(&t->event, t->base_ns + ns);
+}
+
+static void gptimer_fire(hal_sim_event_t *ev, int64_t at_ns) {
+  struct gptimer_t *t = ev->arg;
+  int64_t start = hal_sim_now_ns();
+  gptimer_alarm_event_data_t edata = {
+      .count_value = t->alarm.alarm_count,
+      .alarm_value = t->alarm.alarm_count,
+  };
+  t->base_count = t->alarm.alarm_count;
+  t->base_ns = at_ns;
+  if (t->alarm.flags.auto_reload_on_alarm) {
+    t->base_count = t->alarm.reload_count;
+  }
+
+  hal_sim_irq_set_time(at_ns);
+  if (t->on_alarm) {
+    t->on_alarm(t, &edata, t->user_ctx);
+  }
+  hal_sim_irq_set_time(-1);
+  // Der Callback darf den Timer gestoppt oder umkonfiguriert haben
+  if (t->alarm.flags.auto_reload_on_alarm && !t->event.queued) {
+    arm_alarm(t);
+  }
+  hal_sim_stat_record(HAL_SIM_STAT_TIMER, start, 0, 0, false);
+}
+
+esp_err_t gptimer_new_timer(const gptimer_config_t *config,
+                            gptimer_handle_t *ret_timer) {
+  hal_sim_init();
+  if (!config || !ret_timer || config->resolution_hz == 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  struct gptimer_t *t = calloc(1, sizeof(*t));
+  if (!t) {
+    return ESP_ERR_NO_MEM;
+  }
+  t->event.fn = gptimer_fire;
+  t->event.arg = t;
+  t->resolution_hz = config->resolution_hz;
+  t->up = config->direction == GPTIMER_COUNT_UP;
+  *ret_timer = t;
+  return ESP_OK;
+}
+
+esp_err_t gptimer_del_timer(gptimer_handle_t timer) {
+  if (!timer || timer->enabled) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  hal_sim_event_cancel(&timer->event);
+  free(timer);
+  return ESP_OK;
+}
+
+esp_err_t gptimer_set_raw_count(gptimer_handle_t timer, uint64_t value) {
+  if (!timer) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  timer->base_count = value;
+  timer->base_ns = hal_sim_now_ns();
+  arm_alarm(timer);
+  return ESP_OK;
+}
+
+esp_err_t gptimer_get_raw_count(gptimer_handle_t timer, uint64_t *value) {
+  if (!timer || !value) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  *value = count_at(timer, hal_sim_now_ns());
+  return ESP_OK;
+}
+
+esp_err_t gptimer_get_resolution(gptimer_handle_t timer,
+                                 uint32_t *out_resolution) {
+  if (!timer || !out_resolution) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  *out_resolution = timer->resolution_hz;
+  return ESP_OK;
+}
+
+esp_err_t gptimer_register_event_callbacks(gptimer_handle_t timer,
+                                           const gptimer_event_callbacks_t *cbs,
+                                           void *user_data) {
+  if (!timer || !cbs) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (timer->enabled) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  timer->on_alarm = cbs->on_alarm;
+  timer->user_ctx = user_data;
+  return ESP_OK;
+}
+
+esp_err_t gptimer_set_alarm_action(gptimer_handle_t timer,
+                                   const gptimer_alarm_config_t *config) {
+  if (!timer) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  // Zählerstand festhalten, damit die Alarmzeit ab jetzt gerechnet wird
+  int64_t now = hal_sim_now_ns();
+  timer->base_count = count_at(timer, now);
+  timer->base_ns = now;
+  timer->alarm_set = config != NULL;
+  if (config) {
+    timer->alarm = *config;
+  }
+  arm_alarm(timer);
+  return ESP_OK;
+}
+
+esp_err_t gptimer_enable(gptimer_handle_t timer) {
+  if (!timer || timer->enabled) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  timer->enabled = true;
+  return ESP_OK;
+}
+
+esp_err_t gptimer_disable(gptimer_handle_t timer) {
+  if (!timer || !timer->enabled) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  timer->enabled = false;
+  hal_sim_event_cancel(&timer->event);
+  return ESP_OK;
+}
+
+esp_err_t gptimer_start(gptimer_handle_t timer) {
+  if (!timer || !timer->enabled) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  if (!timer->running) {
+    timer->running = true;
+    timer->base_ns = hal_sim_now_ns();
+    arm_alarm(timer);
+  }
+  return ESP_OK;
+}
+
+esp_err_t gptimer_stop(gptimer_handle_t timer) {
+  if (!timer || !timer->enabled) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  if (timer->running) {
+    timer->base_count = count_at(timer, hal_sim_now_ns());
+    timer->running = false;
+    hal_sim_event_cancel(&timer->event);
+  }
+  return ESP_OK;
+}
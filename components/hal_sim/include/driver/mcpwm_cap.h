@@ -0,0 +1,91 @@
+#pragma once
+
+// driver/mcpwm_cap.h für das Linux-Target (hal_sim). Ein Capture-Kanal hört
+// auf die Pegelwechsel seines GPIOs und liefert den Zählerstand zum exakten
+// Zeitpunkt der Flanke, ohne Interrupt-Latenz.
+
+#include "driver/gpio.h"
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef SOC_MCPWM_GROUPS
+#define SOC_MCPWM_GROUPS 2
+#endif
+#ifndef SOC_MCPWM_CAPTURE_CHANNELS_PER_TIMER
+#define SOC_MCPWM_CAPTURE_CHANNELS_PER_TIMER 3
+#endif
+
+// Wie auf dem ESP32-S3: Capture-Timer am APB-Takt
+#define HAL_SIM_MCPWM_CAPTURE_HZ 80000000
+
+typedef struct mcpwm_cap_timer_t *mcpwm_cap_timer_handle_t;
+typedef struct mcpwm_cap_channel_t *mcpwm_cap_channel_handle_t;
+
+typedef enum {
+  MCPWM_CAP_EDGE_POS,
+  MCPWM_CAP_EDGE_NEG,
+} mcpwm_capture_edge_t;
+
+typedef enum {
+  MCPWM_CAPTURE_CLK_SRC_DEFAULT = 0,
+  MCPWM_CAPTURE_CLK_SRC_APB,
+} mcpwm_capture_clock_source_t;
+
+typedef struct {
+  uint32_t cap_value;
+  mcpwm_capture_edge_t cap_edge;
+} mcpwm_capture_event_data_t;
+
+typedef bool (*mcpwm_capture_event_cb_t)(
+    mcpwm_cap_channel_handle_t cap_channel,
+    const mcpwm_capture_event_data_t *edata, void *user_ctx);
+
+typedef struct {
+  mcpwm_capture_event_cb_t on_cap;
+} mcpwm_capture_event_callbacks_t;
+
+typedef struct {
+  int group_id;
+  mcpwm_capture_clock_source_t clk_src;
+  uint32_t resolution_hz;
+  struct {
+    uint32_t allow_pd : 1;
+  } flags;
+} mcpwm_capture_timer_config_t;
+
+typedef struct {
+  int gpio_num;
+  int intr_priority;
+  uint32_t prescale;
+  struct {
+    uint32_t pos_edge : 1;
+    uint32_t neg_edge : 1;
+    uint32_t pull_up : 1;
+    uint32_t pull_down : 1;
+    uint32_t invert_cap_signal : 1;
+    uint32_t io_loop_back : 1;
+    uint32_t keep_io_conf_at_exit : 1;
+  } flags;
+} mcpwm_capture_channel_config_t;
+
+esp_err_t mcpwm_new_capture_timer(const mcpwm_capture_timer_config_t *config,
+                                  mcpwm_cap_timer_handle_t *ret_cap_timer);
+esp_err_t mcpwm_del_capture_timer(mcpwm_cap_timer_handle_t cap_timer);
+esp_err_t mcpwm_capture_timer_enable(mcpwm_cap_timer_handle_t cap_timer);
+esp_err_t mcpwm_capture_timer_disable(mcpwm_cap_timer_handle_t cap_timer);
+esp_err_t mcpwm_capture_timer_start(mcpwm_cap_timer_handle_t cap_timer);
+esp_err_t mcpwm_capture_timer_stop(mcpwm_cap_timer_handle_t cap_timer);
+esp_err_t mcpwm_capture_timer_get_resolution(mcpwm_cap_timer_handle_t cap_timer,
+                                             uint32_t *out_resolution);
+
+esp_err_t
+mcpwm_new_capture_channel(mcpwm_cap_timer_handle_t cap_timer,
+                          const mcpwm_capture_channel_config_t *config,
+                          mcpwm_cap_channel_handle_t *ret_cap_channel);
+esp_err_t mcpwm_del_capture_channel(mcpwm_cap_channel_handle_t cap_channel);
+esp_err_t mcpwm_capture_channel_enable(mcpwm_cap_channel_handle_t cap_channel);
+esp_err_t mcpwm_capture_channel_disable(mcpwm_cap_channel_handle_t cap_channel);
+esp_err_t mcpwm_capture_channel_register_event_callbacks(
+    mcpwm_cap_channel_handle_t cap_channel,
+    const mcpwm_capture_event_callbacks_t *cbs, void *user_data);
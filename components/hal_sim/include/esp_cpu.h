@@ -0,0 +1,14 @@
+#pragma once
+
+// esp_cpu.h für das Linux-Target (hal_sim): der Zykluszähler, der mit der
+// Simulationszeit bei HAL_SIM_CPU_HZ läuft, und die Kern-ID (ein Kern)
+
+#include <stdint.h>
+
+#define HAL_SIM_CPU_HZ 160000000
+
+typedef uint32_t esp_cpu_cycle_count_t;
+
+esp_cpu_cycle_count_t esp_cpu_get_cycle_count(void);
+
+static inline int esp_cpu_get_core_id(void) { return 0; }
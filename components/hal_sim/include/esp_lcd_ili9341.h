@@ -0,0 +1,12 @@
+#pragma once
+
+// esp_lcd_ili9341.h (espressif/esp_lcd_ili9341) für das Linux-Target
+// (hal_sim). Das Panel hat 240x320 Pixel in RGB565.
+
+#include "esp_lcd_panel_io.h"
+#include "esp_lcd_panel_vendor.h"
+
+esp_err_t
+esp_lcd_new_panel_ili9341(const esp_lcd_panel_io_handle_t io,
+                          const esp_lcd_panel_dev_config_t *panel_dev_config,
+                          esp_lcd_panel_handle_t *ret_panel);
@@ -0,0 +1,20 @@
+#pragma once
+
+// esp_lcd_panel_vendor.h für das Linux-Target (hal_sim)
+
+#include "esp_err.h"
+#include "esp_lcd_types.h"
+
+typedef struct {
+  int reset_gpio_num;
+  union {
+    lcd_rgb_element_order_t color_space;
+    lcd_rgb_element_order_t rgb_ele_order;
+    lcd_rgb_endian_t rgb_endian;
+  };
+  uint32_t bits_per_pixel;
+  struct {
+    uint32_t reset_active_high : 1;
+  } flags;
+  void *vendor_config;
+} esp_lcd_panel_dev_config_t;
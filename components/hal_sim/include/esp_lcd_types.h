@@ -0,0 +1,27 @@
+#pragma once
+
+// esp_lcd_types.h für das Linux-Target (hal_sim)
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct esp_lcd_i80_bus_t *esp_lcd_i80_bus_handle_t;
+typedef struct esp_lcd_panel_io_t *esp_lcd_panel_io_handle_t;
+typedef struct esp_lcd_panel_t *esp_lcd_panel_handle_t;
+
+typedef enum {
+  LCD_RGB_ENDIAN_RGB = 0,
+  LCD_RGB_ENDIAN_BGR,
+} lcd_rgb_endian_t;
+
+typedef enum {
+  LCD_RGB_ELEMENT_ORDER_RGB = LCD_RGB_ENDIAN_RGB,
+  LCD_RGB_ELEMENT_ORDER_BGR = LCD_RGB_ENDIAN_BGR,
+} lcd_rgb_element_order_t;
+
+typedef enum {
+  LCD_CLK_SRC_PLL160M = 1,
+  LCD_CLK_SRC_XTAL,
+  LCD_CLK_SRC_DEFAULT = LCD_CLK_SRC_PLL160M,
+} lcd_clock_source_t;
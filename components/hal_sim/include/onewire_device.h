@@ -0,0 +1,21 @@
+#pragma once
+
+// onewire_device.h (espressif/onewire_bus) für das Linux-Target (hal_sim).
+// Die Suche läuft bitweise wie SEARCH ROM über die Geräte am Pin.
+
+#include "onewire_bus.h"
+
+typedef struct {
+  onewire_bus_handle_t bus;
+  onewire_device_address_t address;
+} onewire_device_t;
+
+typedef struct onewire_device_iter_t *onewire_device_iter_handle_t;
+
+esp_err_t onewire_new_device_iter(onewire_bus_handle_t bus,
+                                  onewire_device_iter_handle_t *ret_iter);
+// ESP_ERR_NOT_FOUND, wenn alle Geräte geliefert sind, ESP_ERR_INVALID_CRC
+// bei einer Adresse mit falscher CRC (die Suche läuft danach weiter)
+esp_err_t onewire_device_iter_get_next(onewire_device_iter_handle_t iter,
+                                       onewire_device_t *dev);
+esp_err_t onewire_del_device_iter(onewire_device_iter_handle_t iter);
@@ -0,0 +1,251 @@
+#include "driver/gpio.h"
+#include "driver/i2c.h"
+#include "ds18x20.h"
+#include "echo_capture.h"
+#include "esp_check.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "hub_sensors.h"
+#include "metrics.h"
+#include <onewire_bus.h>
+
+// MPU6050 wie im gyro-Projekt. SDA/SCL liegen hier auf 5/6, weil das
+// Display GPIO 8 und 9 belegt.
+#define MPU6050_ADDR 0x68
+#define SMPLRT_DIV 0x19
+#define MPU_CONFIG 0x1A
+#define ACCEL_XOUT_H 0x3B
+#define PWR_MGMT_1 0x6B
+#define IMU_SAMPLE_BYTES 14 // ACCEL_XOUT_H bis GYRO_ZOUT_L
+
+#define I2C_MASTER_SDA_IO 5
+#define I2C_MASTER_SCL_IO 6
+#define I2C_MASTER_NUM 0
+#define I2C_MASTER_FREQ_HZ 400000
+
+#define IMU_PERIOD_US 1000 // 1 kHz
+#define IMU_TASK_PRIORITY 10
+#define IMU_CORE 1
+
+// HC-SR04 wie im ultraschall-Projekt, ein Sensor
+#define TRIGGER_GPIO GPIO_NUM_1
+#define ECHO_GPIO GPIO_NUM_2
+#define DISTANCE_PERIOD_MS 60 // Nachhall des letzten Pings abwarten
+#define MAX_ECHO_MS 30        // ~5 m
+#define MIN_RANGE_CM 2.0f
+#define MAX_RANGE_CM 400.0f
+
+// DS18x20 wie im temperature-Projekt
+#define ONEWIRE_GPIO 18
+#define TEMPERATURE_PERIOD_MS 1000
+#define TEMPERATURE_RESOLUTION_BITS 10
+#define DEFAULT_TEMPERATURE_C 20.0f
+
+static const char *TAG = "sensors";
+
+static TaskHandle_t imu_task_handle;
+static metric_t *imu_missed, *imu_errors;
+
+static QueueHandle_t echo_queue;
+static echo_channel_t echo_channel;
+
+static ds18x20_t sensors;
+
+// Mittel aller DS18x20 in °C, geschrieben von der Temperatur-Task
+static volatile float air_celsius = DEFAULT_TEMPERATURE_C;
+
+static esp_err_t mpu6050_write_reg(uint8_t reg_addr, uint8_t data) {
+  uint8_t write_buf[2] = {reg_addr, data};
+  return i2c_master_write_to_device(I2C_MASTER_NUM, MPU6050_ADDR, write_buf,
+                                    sizeof(write_buf), pdMS_TO_TICKS(100));
+}
+
+static inline int16_t be16(const uint8_t *p) { return p[0] << 8 | p[1]; }
+
+static void imu_timer_cb(void *arg) { xTaskNotifyGive(imu_task_handle); }
+
+// Liest alle 14 Messregister in einem Zug (~0,5 ms bei 400 kHz). Ohne
+// freien Puffer wird gar nicht erst gelesen, pubsub zählt das als no_buffer.
+static void imu_task(void *arg) {
+  uint8_t reg = ACCEL_XOUT_H;
+  uint8_t raw[IMU_SAMPLE_BYTES];
+  while (1) {
+    uint32_t ticks = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    metrics_add(imu_missed, ticks - 1);
+    pubsub_sample_t *s = pubsub_alloc(topic_imu);
+    if (s == NULL) {
+      continue;
+    }
+    s->t_us = esp_timer_get_time();
+    if (i2c_master_write_read_device(I2C_MASTER_NUM, MPU6050_ADDR, &reg, 1,
+                                     raw, sizeof(raw),
+                                     pdMS_TO_TICKS(20)) != ESP_OK) {
+      metrics_inc(imu_errors);
+      pubsub_release(s);
+      continue;
+    }
+    // Register sind big endian: accel x/y/z, temp, gyro x/y/z
+    imu_sample_t *imu = (imu_sample_t *)s->data;
+    for (int i = 0; i < 3; i++) {
+      imu->accel[i] = be16(&raw[2 * i]);
+      imu->gyro[i] = be16(&raw[8 + 2 * i]);
+    }
+    imu->temp = be16(&raw[6]);
+    pubsub_publish(s);
+  }
+}
+
+esp_err_t imu_start(void) {
+  imu_missed = metrics_counter("imu.missed", "");
+  imu_errors = metrics_counter("imu.errors", "");
+  i2c_config_t conf = {
+      .mode = I2C_MODE_MASTER,
+      .sda_io_num = I2C_MASTER_SDA_IO,
+      .scl_io_num = I2C_MASTER_SCL_IO,
+      .sda_pullup_en = GPIO_PULLUP_ENABLE,
+      .scl_pullup_en = GPIO_PULLUP_ENABLE,
+      .master.clk_speed = I2C_MASTER_FREQ_HZ,
+  };
+  ESP_RETURN_ON_ERROR(i2c_param_config(I2C_MASTER_NUM, &conf), TAG, "i2c");
+  ESP_RETURN_ON_ERROR(i2c_driver_install(I2C_MASTER_NUM, conf.mode, 0, 0, 0),
+                      TAG, "i2c driver");
+  ESP_RETURN_ON_ERROR(mpu6050_write_reg(PWR_MGMT_1, 0x00), TAG, "mpu6050");
+  // DLPF 184 Hz, damit liefert der Sensor 1 kHz ohne Teiler
+  ESP_RETURN_ON_ERROR(mpu6050_write_reg(MPU_CONFIG, 0x01), TAG, "mpu6050");
+  ESP_RETURN_ON_ERROR(mpu6050_write_reg(SMPLRT_DIV, 0x00), TAG, "mpu6050");
+
+  // Kern 1, Display und BLE laufen auf Kern 0
+  if (xTaskCreatePinnedToCore(imu_task, "imu", 3072, NULL, IMU_TASK_PRIORITY,
+                              &imu_task_handle, IMU_CORE) != pdPASS) {
+    return ESP_ERR_NO_MEM;
+  }
+  const esp_timer_create_args_t timer_args = {
+      .callback = imu_timer_cb,
+      .name = "imu",
+  };
+  esp_timer_handle_t timer;
+  ESP_RETURN_ON_ERROR(esp_timer_create(&timer_args, &timer), TAG, "timer");
+  return esp_timer_start_periodic(timer, IMU_PERIOD_US);
+}
+
+static void send_trigger_pulse(void) {
+  gpio_set_level(TRIGGER_GPIO, 0);
+  esp_rom_delay_us(2);
+  gpio_set_level(TRIGGER_GPIO, 1);
+  esp_rom_delay_us(10);
+  gpio_set_level(TRIGGER_GPIO, 0);
+}
+
+// Ein Ping pro Takt. Die Sequenznummer verwirft Echos eines früheren Pings,
+// die erst nach dem Timeout kommen (siehe echo_capture.h).
+static void distance_task(void *arg) {
+  uint32_t seq = 0;
+  TickType_t last_wake = xTaskGetTickCount();
+  while (1) {
+    echo_capture_arm(&echo_channel, ++seq);
+    int64_t fired = esp_timer_get_time();
+    send_trigger_pulse();
+
+    echo_pulse_t pulse;
+    while (xQueueReceive(echo_queue, &pulse, pdMS_TO_TICKS(MAX_ECHO_MS)) ==
+           pdTRUE) {
+      if (pulse.seq != seq) {
+        continue;
+      }
+      // Schall in Luft: 331,3 m/s + 0,606 m/s pro °C, hin und zurück
+      float echo_us = echo_ticks_to_us(echo_pulse_ticks(&pulse));
+      float cm_per_us = (331.3f + 0.606f * air_celsius) / 10000.0f;
+      float cm = echo_us / 2.0f * cm_per_us;
+      if (cm < MIN_RANGE_CM || cm > MAX_RANGE_CM) {
+        break;
+      }
+      pubsub_sample_t *s = pubsub_alloc(topic_distance);
+      if (s != NULL) {
+        s->t_us = fired;
+        *(distance_sample_t *)s->data = (distance_sample_t){
+            .sensor = 0,
+            .cm = cm,
+            .echo_us = echo_us,
+        };
+        pubsub_publish(s);
+      }
+      break;
+    }
+    vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(DISTANCE_PERIOD_MS));
+  }
+}
+
+esp_err_t distance_start(void) {
+  gpio_config_t trig = {
+      .pin_bit_mask = 1ULL << TRIGGER_GPIO,
+      .mode = GPIO_MODE_OUTPUT,
+      .intr_type = GPIO_INTR_DISABLE,
+  };
+  ESP_RETURN_ON_ERROR(gpio_config(&trig), TAG, "trigger");
+  echo_queue = xQueueCreate(4, sizeof(echo_pulse_t));
+  if (echo_queue == NULL) {
+    return ESP_ERR_NO_MEM;
+  }
+  ESP_RETURN_ON_ERROR(echo_capture_add(&echo_channel, ECHO_GPIO, 0, echo_queue),
+                      TAG, "capture");
+  if (xTaskCreatePinnedToCore(distance_task, "distance", 3072, NULL, 6, NULL,
+                              IMU_CORE) != pdPASS) {
+    return ESP_ERR_NO_MEM;
+  }
+  return ESP_OK;
+}
+
+// Ein Sample pro Sensor und Messung, alle mit demselben Zeitstempel
+static void temperature_task(void *arg) {
+  TickType_t last_wake = xTaskGetTickCount();
+  while (1) {
+    if (ds18x20_convert_all(&sensors) == ESP_OK) {
+      ds18x20_read_all(&sensors);
+      int64_t t = esp_timer_get_time();
+      float sum = 0;
+      int n = 0;
+      for (size_t i = 0; i < sensors.count; i++) {
+        ds18x20_sensor_t *ds = &sensors.sensors[i];
+        if (!ds->valid) {
+          continue;
+        }
+        sum += ds->temperature;
+        n++;
+        pubsub_sample_t *s = pubsub_alloc(topic_temperature);
+        if (s != NULL) {
+          s->t_us = t;
+          *(temperature_sample_t *)s->data = (temperature_sample_t){
+              .sensor = i,
+              .celsius = ds->temperature,
+          };
+          pubsub_publish(s);
+        }
+      }
+      if (n > 0) {
+        air_celsius = sum / n;
+      }
+    }
+    vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(TEMPERATURE_PERIOD_MS));
+  }
+}
+
+esp_err_t temperature_start(void) {
+  onewire_bus_handle_t bus = NULL;
+  onewire_bus_config_t cfg = {.bus_gpio_num = ONEWIRE_GPIO};
+  onewire_bus_rmt_config_t rmt = {.max_rx_bytes = 10};
+  ESP_RETURN_ON_ERROR(onewire_new_bus_rmt(&cfg, &rmt, &bus), TAG, "1-wire");
+  ESP_RETURN_ON_ERROR(ds18x20_init(&sensors, bus), TAG, "ds18x20");
+  if (sensors.count == 0) {
+    return ESP_ERR_NOT_FOUND;
+  }
+  ds18x20_set_resolution_all(&sensors, TEMPERATURE_RESOLUTION_BITS);
+  // Langsam und nicht zeitkritisch, weg vom Kern der IMU
+  if (xTaskCreatePinnedToCore(temperature_task, "temperature", 4096, NULL, 3,
+                              NULL, 0) != pdPASS) {
+    return ESP_ERR_NO_MEM;
+  }
+  return ESP_OK;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "esp_err.h"
+#include "pubsub.h"
+#include <stdint.h>
+
+// Sensoren des sensor_hub-Projekts, auch vom display-Projekt genutzt.
+// Samples auf dem Bus: die Sensor-Tasks schreiben sie direkt in die Puffer
+// des Pools, alle Ausgaben lesen denselben Puffer. Die Topics legt das
+// Projekt an, bevor es die Sensoren startet.
+
+// MPU6050, Rohwerte wie im gyro-Projekt (±2 g, ±250 °/s)
+typedef struct {
+  int16_t accel[3];
+  int16_t temp; // Chiptemperatur, Rohwert
+  int16_t gyro[3];
+} imu_sample_t;
+
+// HC-SR04, Abstand mit temperaturabhängiger Schallgeschwindigkeit
+typedef struct {
+  uint8_t sensor;
+  float cm;
+  float echo_us;
+} distance_sample_t;
+
+// Ein DS18x20 am 1-Wire-Bus
+typedef struct {
+  uint8_t sensor;
+  float celsius;
+} temperature_sample_t;
+
+extern pubsub_topic_t *topic_imu;
+extern pubsub_topic_t *topic_distance;
+extern pubsub_topic_t *topic_temperature;
+
+// Jede Funktion startet die Task des Sensors
+esp_err_t imu_start(void);
+esp_err_t distance_start(void);
+esp_err_t temperature_start(void);
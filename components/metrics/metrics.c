@@ -0,0 +1,242 @@
+#include "metrics.h"
+
+#include "esp_attr.h"
+#include "esp_cpu.h"
+#include "freertos/FreeRTOS.h"
+#include <inttypes.h>
+#include <string.h>
+
+typedef struct {
+  uint32_t count;
+  uint32_t max;
+  uint64_t sum;
+  uint32_t buckets[METRICS_BUCKETS];
+} hist_core_t;
+
+struct metric {
+  const char *name;
+  const char *unit;
+  metric_type_t type;
+  union {
+    uint32_t counter[portNUM_PROCESSORS];
+    struct {
+      int32_t value;
+      int32_t max;
+    } gauge;
+    hist_core_t *hist; // ein Eintrag pro Kern
+  };
+};
+
+static metric_t metrics[METRICS_MAX];
+static hist_core_t hist_pool[METRICS_MAX_HISTOGRAMS][portNUM_PROCESSORS];
+static size_t n_metrics; // erst nach dem Eintrag erhöht, Leser ohne Sperre
+static size_t n_hists;
+static portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+
+static metric_t *add(const char *name, const char *unit, metric_type_t type) {
+  metric_t *m = NULL;
+  portENTER_CRITICAL(&lock);
+  for (size_t i = 0; i < n_metrics; i++) {
+    if (strcmp(metrics[i].name, name) == 0) {
+      // Gleicher Name mit anderem Typ ist ein Programmierfehler
+      m = metrics[i].type == type ? &metrics[i] : NULL;
+      portEXIT_CRITICAL(&lock);
+      return m;
+    }
+  }
+  if (n_metrics < METRICS_MAX &&
+      (type != METRIC_HISTOGRAM || n_hists < METRICS_MAX_HISTOGRAMS)) {
+    m = &metrics[n_metrics];
+    *m = (metric_t){.name = name, .unit = unit, .type = type};
+    if (type == METRIC_HISTOGRAM) {
+      m->hist = hist_pool[n_hists++];
+    }
+    __atomic_store_n(&n_metrics, n_metrics + 1, __ATOMIC_RELEASE);
+  }
+  portEXIT_CRITICAL(&lock);
+  return m;
+}
+
+metric_t *metrics_counter(const char *name, const char *unit) {
+  return add(name, unit, METRIC_COUNTER);
+}
+
+metric_t *metrics_gauge(const char *name, const char *unit) {
+  return add(name, unit, METRIC_GAUGE);
+}
+
+metric_t *metrics_histogram(const char *name, const char *unit) {
+  return add(name, unit, METRIC_HISTOGRAM);
+}
+
+void IRAM_ATTR metrics_add(metric_t *m, uint32_t n) {
+  if (m) {
+    __atomic_fetch_add(&m->counter[esp_cpu_get_core_id()], n,
+                       __ATOMIC_RELAXED);
+  }
+}
+
+void IRAM_ATTR metrics_inc(metric_t *m) { metrics_add(m, 1); }
+
+static inline void IRAM_ATTR gauge_max(metric_t *m, int32_t value) {
+  int32_t max = __atomic_load_n(&m->gauge.max, __ATOMIC_RELAXED);
+  while (value > max &&
+         !__atomic_compare_exchange_n(&m->gauge.max, &max, value, true,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+  }
+}
+
+void IRAM_ATTR metrics_gauge_set(metric_t *m, int32_t value) {
+  if (m) {
+    __atomic_store_n(&m->gauge.value, value, __ATOMIC_RELAXED);
+    gauge_max(m, value);
+  }
+}
+
+void IRAM_ATTR metrics_gauge_add(metric_t *m, int32_t delta) {
+  if (m) {
+    gauge_max(m, __atomic_add_fetch(&m->gauge.value, delta, __ATOMIC_RELAXED));
+  }
+}
+
+// Mit gesperrten Interrupts des eigenen Kerns kann weder eine ISR dazwischen
+// schreiben noch die Task den Kern wechseln
+void IRAM_ATTR metrics_record(metric_t *m, uint32_t value) {
+  if (!m) {
+    return;
+  }
+  int b = value ? 32 - __builtin_clz(value) : 0;
+  if (b >= METRICS_BUCKETS) {
+    b = METRICS_BUCKETS - 1;
+  }
+  UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+  hist_core_t *h = &m->hist[esp_cpu_get_core_id()];
+  h->count++;
+  h->sum += value;
+  if (value > h->max) {
+    h->max = value;
+  }
+  h->buckets[b]++;
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+}
+
+size_t metrics_count(void) {
+  return __atomic_load_n(&n_metrics, __ATOMIC_ACQUIRE);
+}
+
+bool metrics_read(size_t index, metrics_value_t *out) {
+  if (index >= metrics_count()) {
+    return false;
+  }
+  metrics_snapshot(&metrics[index], out);
+  return true;
+}
+
+void metrics_snapshot(const metric_t *m, metrics_value_t *out) {
+  if (!m) {
+    *out = (metrics_value_t){.name = "", .unit = ""};
+    return;
+  }
+  *out = (metrics_value_t){.name = m->name, .unit = m->unit, .type = m->type};
+  switch (m->type) {
+  case METRIC_COUNTER:
+    for (int c = 0; c < portNUM_PROCESSORS; c++) {
+      out->count += __atomic_load_n(&m->counter[c], __ATOMIC_RELAXED);
+    }
+    break;
+  case METRIC_GAUGE:
+    out->value = __atomic_load_n(&m->gauge.value, __ATOMIC_RELAXED);
+    out->max = __atomic_load_n(&m->gauge.max, __ATOMIC_RELAXED);
+    break;
+  case METRIC_HISTOGRAM:
+    for (int c = 0; c < portNUM_PROCESSORS; c++) {
+      const volatile hist_core_t *h = &m->hist[c];
+      out->count += h->count;
+      out->sum += h->sum;
+      if (h->max > out->max) {
+        out->max = h->max;
+      }
+      for (int b = 0; b < METRICS_BUCKETS; b++) {
+        out->buckets[b] += h->buckets[b];
+      }
+    }
+    break;
+  }
+}
+
+uint32_t metrics_percentile(const metrics_value_t *v, int pct) {
+  uint64_t total = 0;
+  for (int b = 0; b < METRICS_BUCKETS; b++) {
+    total += v->buckets[b];
+  }
+  if (total == 0) {
+    return 0;
+  }
+  // Rang des gesuchten Werts, aufgerundet und mindestens 1
+  uint64_t rank = (total * pct + 99) / 100;
+  rank = rank ? rank : 1;
+  uint64_t seen = 0;
+  for (int b = 0; b < METRICS_BUCKETS - 1; b++) {
+    seen += v->buckets[b];
+    if (seen >= rank) {
+      uint32_t upper = b ? (uint32_t)((1ull << b) - 1) : 0;
+      return upper < v->max ? upper : (uint32_t)v->max;
+    }
+  }
+  return (uint32_t)v->max;
+}
+
+void metrics_print(FILE *out) {
+  metrics_value_t v;
+  for (size_t i = 0; metrics_read(i, &v); i++) {
+    switch (v.type) {
+    case METRIC_COUNTER:
+      fprintf(out, "%-20s count %" PRIu64, v.name, v.count);
+      break;
+    case METRIC_GAUGE:
+      fprintf(out, "%-20s gauge %" PRId32 " max=%" PRId64, v.name, v.value,
+              v.max);
+      break;
+    case METRIC_HISTOGRAM:
+      fprintf(out,
+              "%-20s hist  n=%" PRIu64 " avg=%" PRIu64 " p50=%" PRIu32
+              " p99=%" PRIu32 " max=%" PRId64,
+              v.name, v.count, v.count ? v.sum / v.count : 0,
+              metrics_percentile(&v, 50), metrics_percentile(&v, 99), v.max);
+      break;
+    }
+    fprintf(out, "%s%s\n", *v.unit ? " " : "", v.unit);
+  }
+}
+
+size_t metrics_format(char *buf, size_t len) {
+  if (len == 0) {
+    return 0;
+  }
+  size_t used = 0;
+  buf[0] = '\0';
+  metrics_value_t v;
+  for (size_t i = 0; metrics_read(i, &v); i++) {
+    char line[64];
+    int n;
+    switch (v.type) {
+    case METRIC_COUNTER:
+      n = snprintf(line, sizeof(line), "%s %" PRIu64 "\n", v.name, v.count);
+      break;
+    case METRIC_GAUGE:
+      n = snprintf(line, sizeof(line), "%s %" PRId32 "/%" PRId64 "\n",
+                   v.name, v.value, v.max);
+      break;
+    default:
+      n = snprintf(line, sizeof(line), "%s %" PRIu32 "/%" PRId64 " %s\n",
+                   v.name, metrics_percentile(&v, 99), v.max, v.unit);
+      break;
+    }
+    if (n < 0 || (size_t)n >= sizeof(line) || used + n >= len) {
+      break;
+    }
+    memcpy(&buf[used], line, n + 1);
+    used += n;
+  }
+  return used;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+Gemeinsame Messwerte aller Treiber: Zähler, Gauges und Histogramme mit
+festen, logarithmischen Buckets.
+
+Alle Messwerte kommen beim Start aus einem statischen Vorrat und werden über
+ihren Namen registriert; wer denselben Namen zweimal registriert, bekommt
+denselben Messwert zurück (z. B. zwei 1-Wire-Busse mit demselben Treiber).
+Ist der Vorrat erschöpft, kommt NULL zurück, alle Update-Funktionen
+ignorieren NULL. Name und Einheit werden nicht kopiert und müssen statisch
+sein.
+
+Die Update-Funktionen liegen im IRAM und dürfen aus ISRs aufgerufen werden:
+
+  Zähler       ein Slot pro Kern, erhöht mit einer atomaren Addition (ohne
+               Sperre, auch wenn die Task zwischendurch den Kern wechselt)
+  Gauge        letzter Wert und Maximum seit dem Start (ab 0), atomar
+               geschrieben
+  Histogramm   Anzahl, Summe, Maximum und METRICS_BUCKETS Buckets pro Kern,
+               aktualisiert mit gesperrten Interrupts des eigenen Kerns (wie
+               binlog_write), ohne Spinlock zwischen den Kernen
+
+Bucket 0 zählt den Wert 0, Bucket b die Werte in [2^(b-1), 2^b), der letzte
+Bucket alles darüber. Die Einheit legt der Aufrufer fest (µs, Zyklen, Bytes).
+
+metrics_read() fasst die Kerne zu einem Schnappschuss zusammen. Die Felder
+eines Histogramms werden dabei nicht gemeinsam gesperrt, während eines
+Updates kann die Anzahl um eins neben den Buckets liegen.
+*/
+
+#define METRICS_MAX 48
+#define METRICS_MAX_HISTOGRAMS 16
+#define METRICS_BUCKETS 24
+
+typedef enum {
+  METRIC_COUNTER,
+  METRIC_GAUGE,
+  METRIC_HISTOGRAM,
+} metric_type_t;
+
+typedef struct metric metric_t;
+
+typedef struct {
+  const char *name;
+  const char *unit;
+  metric_type_t type;
+  uint64_t count;  // Zähler: Summe über die Kerne, Histogramm: Einträge
+  int32_t value;   // Gauge: letzter Wert
+  int64_t max;     // Gauge und Histogramm: größter Wert
+  uint64_t sum;    // Histogramm: Summe der Werte
+  uint32_t buckets[METRICS_BUCKETS];
+} metrics_value_t;
+
+metric_t *metrics_counter(const char *name, const char *unit);
+metric_t *metrics_gauge(const char *name, const char *unit);
+metric_t *metrics_histogram(const char *name, const char *unit);
+
+void metrics_inc(metric_t *m);
+void metrics_add(metric_t *m, uint32_t n);
+void metrics_gauge_set(metric_t *m, int32_t value);
+void metrics_gauge_add(metric_t *m, int32_t delta);
+void metrics_record(metric_t *m, uint32_t value);
+
+// Anzahl registrierter Messwerte, Indizes für metrics_read()
+size_t metrics_count(void);
+
+// Schnappschuss des Messwerts `index`, false wenn es ihn nicht gibt
+bool metrics_read(size_t index, metrics_value_t *out);
+
+// Dasselbe über das Handle; bei NULL bleibt `out` leer
+void metrics_snapshot(const metric_t *m, metrics_value_t *out);
+
+// Obere Grenze des Buckets, in dem das Perzentil `pct` (0..100) liegt,
+// höchstens das tatsächliche Maximum
+uint32_t metrics_percentile(const metrics_value_t *v, int pct);
+
+// Alle Messwerte, eine Zeile pro Wert, z. B. auf die Konsolen-UART:
+//   i2c.read_us     hist  n=1200 avg=412 p50=511 p99=1023 max=873 us
+void metrics_print(FILE *out);
+
+// Kurzform für kleine Anzeigen (LCD), eine Zeile pro Wert. Gibt die Länge
+// ohne abschließende 0 zurück, gekürzt wird an Zeilengrenzen.
+size_t metrics_format(char *buf, size_t len);
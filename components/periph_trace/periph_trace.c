@@ -0,0 +1,185 @@
+#include "periph_trace.h"
+#include "periph_trace_format.h"
+
+#include "driver/uart.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "ring_buffer.h"
+
+#define WRITER_STACK 3072
+#define WRITER_PRIORITY 2
+
+static uint8_t ring_mem[PERIPH_TRACE_RING_SIZE];
+static ring_buffer_t ring;
+static portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Im DRAM, damit periph_trace_active() auch bei abgeschaltetem Flash-Cache
+// aus IRAM-ISRs lesbar ist
+volatile bool periph_trace_running;
+static int64_t last_us;
+static uint32_t pending_lost; // noch nicht als PT_LOST vermerkt
+static periph_trace_stats_t stats;
+
+static periph_trace_write_fn_t sink;
+static void *sink_ctx;
+static TaskHandle_t writer_task;
+static SemaphoreHandle_t writer_done;
+static volatile bool stopping;
+
+// Schreibt type + dt + payload; nur unter `lock` aufrufen
+static bool IRAM_ATTR put_locked(uint8_t type, uint64_t dt,
+                                 const uint8_t *payload, size_t len) {
+  uint8_t head[1 + PT_VARINT_MAX];
+  head[0] = type;
+  size_t n = 1 + pt_put_varint(&head[1], dt);
+  if (ring_free(&ring) < n + len) {
+    return false;
+  }
+  ring_write(&ring, head, n);
+  ring_write(&ring, payload, len);
+  return true;
+}
+
+void IRAM_ATTR periph_trace_record(uint8_t type, int64_t t_us,
+                                   const uint8_t *payload, size_t len) {
+  if (!periph_trace_running) {
+    return;
+  }
+  portENTER_CRITICAL_SAFE(&lock);
+  // Aufrufer auf verschiedenen Kernen können sich überholen
+  uint64_t dt = t_us > last_us ? (uint64_t)(t_us - last_us) : 0;
+  if (t_us > last_us) {
+    last_us = t_us;
+  }
+  if (pending_lost) {
+    uint8_t lost[PT_VARINT_MAX];
+    size_t n = pt_put_varint(lost, pending_lost);
+    if (put_locked(PT_LOST, dt, lost, n)) {
+      pending_lost = 0;
+      dt = 0;
+    }
+  }
+  if (!pending_lost && len <= PERIPH_TRACE_MAX_RECORD &&
+      put_locked(type, dt, payload, len)) {
+    stats.records++;
+  } else {
+    pending_lost++;
+    stats.lost++;
+  }
+  uint32_t used = ring_used(&ring);
+  if (used > stats.max_fill) {
+    stats.max_fill = used;
+  }
+  portEXIT_CRITICAL_SAFE(&lock);
+}
+
+static void drain(void) {
+  size_t n;
+  const uint8_t *p;
+  while ((p = ring_read_ptr(&ring, &n)) && n > 0) {
+    size_t written = sink(p, n, sink_ctx);
+    if (written == 0) {
+      stats.sink_errors++;
+      return; // nächster Versuch im nächsten Takt
+    }
+    ring_read_commit(&ring, written);
+    stats.bytes += written;
+  }
+}
+
+static void writer(void *arg) {
+  while (!stopping) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(PERIPH_TRACE_FLUSH_MS));
+    drain();
+  }
+  drain();
+  xSemaphoreGive(writer_done);
+  vTaskDelete(NULL);
+}
+
+esp_err_t periph_trace_start(periph_trace_write_fn_t write, void *ctx) {
+  if (!write) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (periph_trace_running || writer_task) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  if (!writer_done) {
+    writer_done = xSemaphoreCreateBinary();
+    if (!writer_done) {
+      return ESP_ERR_NO_MEM;
+    }
+  }
+  sink = write;
+  sink_ctx = ctx;
+  ring_init(&ring, ring_mem, sizeof(ring_mem));
+  stats = (periph_trace_stats_t){0};
+  pending_lost = 0;
+  stopping = false;
+
+  periph_trace_header_t header = {
+      .magic = PT_MAGIC,
+      .version = PT_VERSION,
+      .time_hz = 1000000,
+      .cap_hz = PERIPH_TRACE_CAP_HZ,
+  };
+  if (write(&header, sizeof(header), ctx) != sizeof(header)) {
+    return ESP_FAIL;
+  }
+
+  if (xTaskCreate(writer, "periph_trace", WRITER_STACK, NULL,
+                  WRITER_PRIORITY, &writer_task) != pdPASS) {
+    writer_task = NULL;
+    return ESP_ERR_NO_MEM;
+  }
+  last_us = esp_timer_get_time();
+  periph_trace_running = true;
+  return ESP_OK;
+}
+
+static size_t file_write(const void *data, size_t len, void *ctx) {
+  return fwrite(data, 1, len, ctx);
+}
+
+esp_err_t periph_trace_start_file(FILE *file) {
+  if (!file) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  return periph_trace_start(file_write, file);
+}
+
+static size_t uart_sink(const void *data, size_t len, void *ctx) {
+  int n = uart_write_bytes((uart_port_t)(intptr_t)ctx, data, len);
+  return n > 0 ? (size_t)n : 0;
+}
+
+esp_err_t periph_trace_start_uart(int uart_port) {
+  if (!uart_is_driver_installed(uart_port)) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  return periph_trace_start(uart_sink, (void *)(intptr_t)uart_port);
+}
+
+void periph_trace_stop(void) {
+  if (!writer_task) {
+    return;
+  }
+  periph_trace_running = false;
+  stopping = true;
+  xTaskNotifyGive(writer_task);
+  xSemaphoreTake(writer_done, portMAX_DELAY);
+  writer_task = NULL;
+  if (sink == file_write) {
+    fflush(sink_ctx);
+  }
+}
+
+periph_trace_stats_t periph_trace_get_stats(void) {
+  portENTER_CRITICAL(&lock);
+  periph_trace_stats_t s = stats;
+  portEXIT_CRITICAL(&lock);
+  return s;
+}
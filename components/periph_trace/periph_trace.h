@@ -0,0 +1,101 @@
+#pragma once
+
+#include "esp_err.h"
+#include "sdkconfig.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+Mitschnitt aller Bus-Transaktionen und GPIO-Flanken als kompakter
+Binär-Trace (Format: periph_trace_format.h), z.B. auf SD-Karte oder über
+eine zweite UART. hal_sim spielt den Trace auf dem PC wieder ab
+(HAL_SIM_REPLAY=trace.bin), so dass Treiber- und Filteränderungen gegen
+exakt dieselben Messdaten verglichen werden können.
+
+Die Komponente hängt sich per Linker (--wrap) vor die Treiberfunktionen:
+
+  I2C (Legacy)  i2c_master_cmd_begin samt Kommandoliste, die
+                i2c_master_*_device-Funktionen
+  1-Wire        onewire_bus_reset/write_bytes/read_bytes/read_bit,
+                onewire_device_iter_get_next
+  GPIO          gpio_set_level, Flanken aller über gpio_isr_handler_add
+                angemeldeten ISRs
+  MCPWM         Capture-Ereignisse (Flanke und Zählerstand)
+
+Ohne periph_trace_start() reichen die Wrapper nur durch. Datensätze landen
+zuerst in einem Ringpuffer im RAM (aus ISRs erlaubt), eine Task schreibt
+ihn in die Senke. Läuft der Puffer voll, gehen Datensätze verloren; das
+wird im Trace als PT_LOST vermerkt.
+
+Eingeschaltet wird der Mitschnitt mit CONFIG_PERIPH_TRACE_ENABLE (idf.py
+menuconfig, "Peripherie-Trace (periph_trace)"). Ohne die Option und auf dem
+Linux-Target registriert sich die Komponente leer, die Start-Funktionen
+melden dann ESP_ERR_NOT_SUPPORTED.
+*/
+
+#define PERIPH_TRACE_RING_SIZE 16384 // Zweierpotenz
+#define PERIPH_TRACE_MAX_RECORD 320  // größter einzelner Datensatz
+#define PERIPH_TRACE_FLUSH_MS 20
+// MCPWM_CAPTURE_CLK_SRC_DEFAULT ist auf dem ESP32-S3 der APB-Takt
+#define PERIPH_TRACE_CAP_HZ 80000000
+
+// Schreibt `len` Bytes in die Senke, gibt die geschriebene Anzahl zurück
+typedef size_t (*periph_trace_write_fn_t)(const void *data, size_t len,
+                                          void *ctx);
+
+typedef struct {
+  uint32_t records;
+  uint32_t lost;      // wegen vollem Puffer oder zu großer Datensätze
+  uint32_t bytes;     // an die Senke übergeben
+  uint32_t max_fill;  // höchster Füllstand des Ringpuffers in Bytes
+  uint32_t sink_errors;
+} periph_trace_stats_t;
+
+#if !CONFIG_PERIPH_TRACE_ENABLE
+
+static inline esp_err_t periph_trace_start(periph_trace_write_fn_t write,
+                                           void *ctx) {
+  return ESP_ERR_NOT_SUPPORTED;
+}
+static inline esp_err_t periph_trace_start_file(FILE *file) {
+  return ESP_ERR_NOT_SUPPORTED;
+}
+static inline esp_err_t periph_trace_start_uart(int uart_port) {
+  return ESP_ERR_NOT_SUPPORTED;
+}
+static inline void periph_trace_stop(void) {}
+static inline bool periph_trace_active(void) { return false; }
+static inline periph_trace_stats_t periph_trace_get_stats(void) {
+  return (periph_trace_stats_t){0};
+}
+
+#else
+
+// Startet die Aufzeichnung in eine beliebige Senke
+esp_err_t periph_trace_start(periph_trace_write_fn_t write, void *ctx);
+
+// Datei, z.B. fopen("/sdcard/trace.bin", "wb") auf einer gemounteten Karte
+esp_err_t periph_trace_start_file(FILE *file);
+
+// UART, deren Treiber bereits installiert ist
+esp_err_t periph_trace_start_uart(int uart_port);
+
+// Leert den Puffer in die Senke und beendet die Aufzeichnung
+void periph_trace_stop(void);
+
+// Intern, nur über periph_trace_active() lesen
+extern volatile bool periph_trace_running;
+
+// Inline, weil die IRAM-Wrapper und ISR-Trampoline es aufrufen
+static inline bool periph_trace_active(void) { return periph_trace_running; }
+
+periph_trace_stats_t periph_trace_get_stats(void);
+
+// Für die Wrapper: legt einen Datensatz mit Zeitstempel `t_us` an. Der
+// Payload folgt dem Typ und dt (siehe periph_trace_format.h). ISR-fest.
+void periph_trace_record(uint8_t type, int64_t t_us, const uint8_t *payload,
+                         size_t len);
+
+#endif
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+Binärformat des Peripherie-Traces.
+
+Die Datei beginnt mit dem Header (periph_trace_header_t, little endian),
+danach folgen die Datensätze ohne Trenner:
+
+  [type][dt][payload ...]
+
+  type  PT_*
+  dt    Zeit seit dem vorherigen Datensatz in µs (esp_timer), als varint
+  varint: 7 Bit pro Byte, niederwertigste Gruppe zuerst, Bit 7 = es folgt
+  ein weiteres Byte
+
+Payload je Typ:
+
+  PT_GPIO_OUT     gpio, level                     gpio_set_level der App
+  PT_GPIO_EDGE    gpio, level                     Flanke im GPIO-ISR
+  PT_CAP_EDGE     gpio, edge (0 = steigend), cap_value (u32 le)
+  PT_I2C          port, err (varint, zigzag), dur_us (varint), n_ops,
+                  n_ops * ([op] bzw. [op][len varint][daten])
+                  mit op = PT_I2C_START/STOP/WRITE/READ; READ enthält die
+                  gelesenen Bytes. Das Adressbyte ist ein WRITE nach START.
+  PT_OW_RESET     present (0/1), dur_us
+  PT_OW_WRITE     dur_us, len (varint), daten
+  PT_OW_READ      dur_us, len (varint), daten
+  PT_OW_BIT       bit, dur_us
+  PT_OW_SEARCH    found (0/1), bei found: Adresse (u64 le)
+  PT_LOST         Anzahl verworfener Datensätze (varint)
+
+dur_us ist die Dauer des Treiberaufrufs. Die Datei ist unabhängig von
+ESP-IDF und wird auch vom Replay in hal_sim gelesen.
+*/
+
+#define PT_MAGIC 0x43525450u // "PTRC"
+#define PT_VERSION 1
+
+typedef struct __attribute__((packed)) {
+  uint32_t magic;
+  uint8_t version;
+  uint8_t reserved[3];
+  uint32_t time_hz; // Auflösung von dt (1 MHz)
+  uint32_t cap_hz;  // Takt von cap_value, 0 wenn nicht benutzt
+} periph_trace_header_t;
+
+enum {
+  PT_GPIO_OUT = 1,
+  PT_GPIO_EDGE,
+  PT_CAP_EDGE,
+  PT_I2C,
+  PT_OW_RESET,
+  PT_OW_WRITE,
+  PT_OW_READ,
+  PT_OW_BIT,
+  PT_OW_SEARCH,
+  PT_LOST,
+};
+
+enum {
+  PT_I2C_START = 0,
+  PT_I2C_STOP,
+  PT_I2C_WRITE,
+  PT_I2C_READ,
+};
+
+// Ein 64-Bit-Wert braucht höchstens zehn varint-Bytes
+#define PT_VARINT_MAX 10
+
+static inline size_t pt_put_varint(uint8_t *p, uint64_t v) {
+  size_t n = 0;
+  while (v >= 0x80) {
+    p[n++] = (uint8_t)v | 0x80;
+    v >>= 7;
+  }
+  p[n++] = (uint8_t)v;
+  return n;
+}
+
+// Gibt die Anzahl gelesener Bytes zurück, 0 bei abgeschnittenem Wert
+static inline size_t pt_get_varint(const uint8_t *p, size_t len,
+                                   uint64_t *out) {
+  uint64_t v = 0;
+  for (size_t n = 0; n < len && n < PT_VARINT_MAX; n++) {
+    v |= (uint64_t)(p[n] & 0x7F) << (7 * n);
+    if (!(p[n] & 0x80)) {
+      *out = v;
+      return n + 1;
+    }
+  }
+  return 0;
+}
+
+static inline uint64_t pt_zigzag(int64_t v) {
+  return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static inline int64_t pt_unzigzag(uint64_t v) {
+  return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
@@ -0,0 +1,51 @@
+#include "periph_trace.h"
+#include "periph_trace_format.h"
+
+#include "driver/gpio.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
+
+// Jede per gpio_isr_handler_add angemeldete ISR läuft über ein Trampolin,
+// das zuerst die Flanke aufzeichnet
+
+typedef struct {
+  gpio_num_t gpio;
+  gpio_isr_t isr;
+  void *arg;
+} hook_t;
+
+static hook_t hooks[GPIO_NUM_MAX];
+
+esp_err_t __real_gpio_set_level(gpio_num_t gpio_num, uint32_t level);
+esp_err_t __real_gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr,
+                                      void *args);
+
+esp_err_t IRAM_ATTR __wrap_gpio_set_level(gpio_num_t gpio_num,
+                                          uint32_t level) {
+  if (periph_trace_active()) {
+    uint8_t payload[2] = {(uint8_t)gpio_num, level ? 1 : 0};
+    periph_trace_record(PT_GPIO_OUT, esp_timer_get_time(), payload,
+                        sizeof(payload));
+  }
+  return __real_gpio_set_level(gpio_num, level);
+}
+
+static void IRAM_ATTR trampoline(void *arg) {
+  hook_t *hook = arg;
+  if (periph_trace_active()) {
+    uint8_t payload[2] = {(uint8_t)hook->gpio,
+                          (uint8_t)gpio_get_level(hook->gpio)};
+    periph_trace_record(PT_GPIO_EDGE, esp_timer_get_time(), payload,
+                        sizeof(payload));
+  }
+  hook->isr(hook->arg);
+}
+
+esp_err_t __wrap_gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr,
+                                      void *args) {
+  if (gpio_num < 0 || gpio_num >= GPIO_NUM_MAX || !isr) {
+    return __real_gpio_isr_handler_add(gpio_num, isr, args);
+  }
+  hooks[gpio_num] = (hook_t){gpio_num, isr, args};
+  return __real_gpio_isr_handler_add(gpio_num, trampoline, &hooks[gpio_num]);
+}
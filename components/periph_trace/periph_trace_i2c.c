@@ -0,0 +1,276 @@
+#include "periph_trace.h"
+#include "periph_trace_format.h"
+
+#include "driver/i2c.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include <string.h>
+
+// Die Kommandoliste des Legacy-Treibers ist undurchsichtig, daher führt
+// jeder Wrapper eine Schattenkopie mit: geschriebene Bytes als Kopie,
+// Lesezugriffe als Zeiger, der nach i2c_master_cmd_begin ausgelesen wird.
+
+#define SHADOW_SLOTS 4
+#define SHADOW_OPS 16
+#define SHADOW_DATA 128
+
+typedef struct {
+  uint8_t op;
+  uint16_t len;
+  uint16_t offset; // WRITE: Position in data
+  uint8_t *dst;    // READ: Ziel der Anwendung
+} shadow_op_t;
+
+typedef struct {
+  i2c_cmd_handle_t cmd;
+  shadow_op_t ops[SHADOW_OPS];
+  size_t n_ops;
+  uint8_t data[SHADOW_DATA];
+  size_t data_len;
+  bool overflow;
+} shadow_t;
+
+static shadow_t shadows[SHADOW_SLOTS];
+static portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+
+esp_err_t __real_i2c_master_start(i2c_cmd_handle_t cmd);
+esp_err_t __real_i2c_master_stop(i2c_cmd_handle_t cmd);
+esp_err_t __real_i2c_master_write(i2c_cmd_handle_t cmd, const uint8_t *data,
+                                  size_t data_len, bool ack_en);
+esp_err_t __real_i2c_master_write_byte(i2c_cmd_handle_t cmd, uint8_t data,
+                                       bool ack_en);
+esp_err_t __real_i2c_master_read(i2c_cmd_handle_t cmd, uint8_t *data,
+                                 size_t data_len, i2c_ack_type_t ack);
+esp_err_t __real_i2c_master_read_byte(i2c_cmd_handle_t cmd, uint8_t *data,
+                                      i2c_ack_type_t ack);
+esp_err_t __real_i2c_master_cmd_begin(i2c_port_t port, i2c_cmd_handle_t cmd,
+                                      TickType_t ticks_to_wait);
+void __real_i2c_cmd_link_delete(i2c_cmd_handle_t cmd);
+esp_err_t __real_i2c_master_write_to_device(i2c_port_t port, uint8_t addr,
+                                            const uint8_t *write_buffer,
+                                            size_t write_size,
+                                            TickType_t ticks_to_wait);
+esp_err_t __real_i2c_master_read_from_device(i2c_port_t port, uint8_t addr,
+                                             uint8_t *read_buffer,
+                                             size_t read_size,
+                                             TickType_t ticks_to_wait);
+esp_err_t __real_i2c_master_write_read_device(
+    i2c_port_t port, uint8_t addr, const uint8_t *write_buffer,
+    size_t write_size, uint8_t *read_buffer, size_t read_size,
+    TickType_t ticks_to_wait);
+
+// Liefert den Schatten zu `cmd`, legt bei Bedarf einen an
+static shadow_t *shadow_for(i2c_cmd_handle_t cmd, bool create) {
+  shadow_t *found = NULL;
+  portENTER_CRITICAL(&lock);
+  for (size_t i = 0; i < SHADOW_SLOTS && !found; i++) {
+    if (shadows[i].cmd == cmd) {
+      found = &shadows[i];
+    }
+  }
+  for (size_t i = 0; i < SHADOW_SLOTS && !found && create; i++) {
+    if (shadows[i].cmd == NULL) {
+      found = &shadows[i];
+      found->cmd = cmd;
+      found->n_ops = 0;
+      found->data_len = 0;
+      found->overflow = false;
+    }
+  }
+  portEXIT_CRITICAL(&lock);
+  return found;
+}
+
+static void shadow_add(i2c_cmd_handle_t cmd, uint8_t op, const uint8_t *data,
+                       size_t len, uint8_t *dst) {
+  if (!periph_trace_active()) {
+    return;
+  }
+  shadow_t *s = shadow_for(cmd, true);
+  if (!s) {
+    return;
+  }
+  if (s->n_ops == SHADOW_OPS ||
+      (data && s->data_len + len > SHADOW_DATA)) {
+    s->overflow = true;
+    return;
+  }
+  shadow_op_t *o = &s->ops[s->n_ops++];
+  *o = (shadow_op_t){.op = op, .len = len, .dst = dst};
+  if (data) {
+    o->offset = s->data_len;
+    memcpy(&s->data[s->data_len], data, len);
+    s->data_len += len;
+  }
+}
+
+esp_err_t __wrap_i2c_master_start(i2c_cmd_handle_t cmd) {
+  shadow_add(cmd, PT_I2C_START, NULL, 0, NULL);
+  return __real_i2c_master_start(cmd);
+}
+
+esp_err_t __wrap_i2c_master_stop(i2c_cmd_handle_t cmd) {
+  shadow_add(cmd, PT_I2C_STOP, NULL, 0, NULL);
+  return __real_i2c_master_stop(cmd);
+}
+
+esp_err_t __wrap_i2c_master_write(i2c_cmd_handle_t cmd, const uint8_t *data,
+                                  size_t data_len, bool ack_en) {
+  shadow_add(cmd, PT_I2C_WRITE, data, data_len, NULL);
+  return __real_i2c_master_write(cmd, data, data_len, ack_en);
+}
+
+esp_err_t __wrap_i2c_master_write_byte(i2c_cmd_handle_t cmd, uint8_t data,
+                                       bool ack_en) {
+  shadow_add(cmd, PT_I2C_WRITE, &data, 1, NULL);
+  return __real_i2c_master_write_byte(cmd, data, ack_en);
+}
+
+esp_err_t __wrap_i2c_master_read(i2c_cmd_handle_t cmd, uint8_t *data,
+                                 size_t data_len, i2c_ack_type_t ack) {
+  shadow_add(cmd, PT_I2C_READ, NULL, data_len, data);
+  return __real_i2c_master_read(cmd, data, data_len, ack);
+}
+
+esp_err_t __wrap_i2c_master_read_byte(i2c_cmd_handle_t cmd, uint8_t *data,
+                                      i2c_ack_type_t ack) {
+  shadow_add(cmd, PT_I2C_READ, NULL, 1, data);
+  return __real_i2c_master_read_byte(cmd, data, ack);
+}
+
+void __wrap_i2c_cmd_link_delete(i2c_cmd_handle_t cmd) {
+  shadow_t *s = shadow_for(cmd, false);
+  if (s) {
+    s->cmd = NULL;
+  }
+  __real_i2c_cmd_link_delete(cmd);
+}
+
+// Schreibt einen Datensatz in `out`, gibt die Länge zurück, 0 wenn er nicht
+// passt
+typedef struct {
+  uint8_t *p;
+  size_t len;
+  size_t cap;
+} writer_t;
+
+static void put(writer_t *w, const void *data, size_t len) {
+  if (w->len + len <= w->cap) {
+    memcpy(&w->p[w->len], data, len);
+  }
+  w->len += len;
+}
+
+static void put_varint(writer_t *w, uint64_t v) {
+  uint8_t tmp[PT_VARINT_MAX];
+  put(w, tmp, pt_put_varint(tmp, v));
+}
+
+static void put_header(writer_t *w, i2c_port_t port, esp_err_t err,
+                       int64_t dur_us, size_t n_ops) {
+  uint8_t p = (uint8_t)port;
+  put(w, &p, 1);
+  put_varint(w, pt_zigzag(err));
+  put_varint(w, dur_us);
+  put_varint(w, n_ops);
+}
+
+static void put_op(writer_t *w, uint8_t op, const uint8_t *data, size_t len) {
+  put(w, &op, 1);
+  if (op == PT_I2C_WRITE || op == PT_I2C_READ) {
+    put_varint(w, len);
+    put(w, data, len);
+  }
+}
+
+static void emit(writer_t *w, int64_t t_us) {
+  // Zu große Datensätze zählt periph_trace_record als verloren
+  periph_trace_record(PT_I2C, t_us, w->p,
+                      w->len <= w->cap ? w->len : PERIPH_TRACE_MAX_RECORD + 1);
+}
+
+esp_err_t __wrap_i2c_master_cmd_begin(i2c_port_t port, i2c_cmd_handle_t cmd,
+                                      TickType_t ticks_to_wait) {
+  int64_t t0 = esp_timer_get_time();
+  esp_err_t err = __real_i2c_master_cmd_begin(port, cmd, ticks_to_wait);
+  shadow_t *s = periph_trace_active() ? shadow_for(cmd, false) : NULL;
+  if (!s || s->overflow) {
+    return err;
+  }
+  uint8_t buf[PERIPH_TRACE_MAX_RECORD];
+  writer_t w = {buf, 0, sizeof(buf)};
+  put_header(&w, port, err, esp_timer_get_time() - t0, s->n_ops);
+  for (size_t i = 0; i < s->n_ops; i++) {
+    const shadow_op_t *o = &s->ops[i];
+    put_op(&w, o->op, o->op == PT_I2C_READ ? o->dst : &s->data[o->offset],
+           o->len);
+  }
+  emit(&w, t0);
+  return err;
+}
+
+// Die i2c_master_*_device-Funktionen bauen ihre Kommandoliste im Treiber
+// selbst, an den Wrappern oben vorbei; hier wird sie nachgebildet.
+static void record_device(i2c_port_t port, uint8_t addr, const uint8_t *wr,
+                          size_t wr_len, const uint8_t *rd, size_t rd_len,
+                          esp_err_t err, int64_t t0) {
+  uint8_t buf[PERIPH_TRACE_MAX_RECORD];
+  writer_t w = {buf, 0, sizeof(buf)};
+  size_t n_ops = 1 + (wr_len ? 3 : 0) + (rd_len ? 3 : 0);
+  put_header(&w, port, err, esp_timer_get_time() - t0, n_ops);
+  if (wr_len) {
+    uint8_t a = addr << 1 | I2C_MASTER_WRITE;
+    put_op(&w, PT_I2C_START, NULL, 0);
+    put_op(&w, PT_I2C_WRITE, &a, 1);
+    put_op(&w, PT_I2C_WRITE, wr, wr_len);
+  }
+  if (rd_len) {
+    uint8_t a = addr << 1 | I2C_MASTER_READ;
+    put_op(&w, PT_I2C_START, NULL, 0);
+    put_op(&w, PT_I2C_WRITE, &a, 1);
+    put_op(&w, PT_I2C_READ, rd, rd_len);
+  }
+  put_op(&w, PT_I2C_STOP, NULL, 0);
+  emit(&w, t0);
+}
+
+esp_err_t __wrap_i2c_master_write_to_device(i2c_port_t port, uint8_t addr,
+                                            const uint8_t *write_buffer,
+                                            size_t write_size,
+                                            TickType_t ticks_to_wait) {
+  int64_t t0 = esp_timer_get_time();
+  esp_err_t err = __real_i2c_master_write_to_device(
+      port, addr, write_buffer, write_size, ticks_to_wait);
+  if (periph_trace_active()) {
+    record_device(port, addr, write_buffer, write_size, NULL, 0, err, t0);
+  }
+  return err;
+}
+
+esp_err_t __wrap_i2c_master_read_from_device(i2c_port_t port, uint8_t addr,
+                                             uint8_t *read_buffer,
+                                             size_t read_size,
+                                             TickType_t ticks_to_wait) {
+  int64_t t0 = esp_timer_get_time();
+  esp_err_t err = __real_i2c_master_read_from_device(
+      port, addr, read_buffer, read_size, ticks_to_wait);
+  if (periph_trace_active()) {
+    record_device(port, addr, NULL, 0, read_buffer, read_size, err, t0);
+  }
+  return err;
+}
+
+esp_err_t __wrap_i2c_master_write_read_device(
+    i2c_port_t port, uint8_t addr, const uint8_t *write_buffer,
+    size_t write_size, uint8_t *read_buffer, size_t read_size,
+    TickType_t ticks_to_wait) {
+  int64_t t0 = esp_timer_get_time();
+  esp_err_t err = __real_i2c_master_write_read_device(
+      port, addr, write_buffer, write_size, read_buffer, read_size,
+      ticks_to_wait);
+  if (periph_trace_active()) {
+    record_device(port, addr, write_buffer, write_size, read_buffer,
+                  read_size, err, t0);
+  }
+  return err;
+}
@@ -0,0 +1,92 @@
+#include "periph_trace.h"
+#include "periph_trace_format.h"
+
+#include "driver/mcpwm_cap.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "soc/soc_caps.h"
+
+// Der Capture-Kanal kennt seinen Pin nach außen nicht, daher merkt sich der
+// Wrapper die Zuordnung beim Anlegen
+
+#define MAX_CHANNELS                                                           \
+  (SOC_MCPWM_GROUPS * SOC_MCPWM_CAPTURE_CHANNELS_PER_TIMER)
+
+typedef struct {
+  mcpwm_cap_channel_handle_t channel;
+  int gpio;
+  mcpwm_capture_event_cb_t on_cap;
+  void *user_ctx;
+} hook_t;
+
+static hook_t hooks[MAX_CHANNELS];
+
+esp_err_t __real_mcpwm_new_capture_channel(
+    mcpwm_cap_timer_handle_t cap_timer,
+    const mcpwm_capture_channel_config_t *config,
+    mcpwm_cap_channel_handle_t *ret_cap_channel);
+esp_err_t __real_mcpwm_capture_channel_register_event_callbacks(
+    mcpwm_cap_channel_handle_t cap_channel,
+    const mcpwm_capture_event_callbacks_t *cbs, void *user_data);
+
+static hook_t *hook_for(mcpwm_cap_channel_handle_t channel) {
+  for (size_t i = 0; i < MAX_CHANNELS; i++) {
+    if (hooks[i].channel == channel) {
+      return &hooks[i];
+    }
+  }
+  return NULL;
+}
+
+esp_err_t __wrap_mcpwm_new_capture_channel(
+    mcpwm_cap_timer_handle_t cap_timer,
+    const mcpwm_capture_channel_config_t *config,
+    mcpwm_cap_channel_handle_t *ret_cap_channel) {
+  esp_err_t err =
+      __real_mcpwm_new_capture_channel(cap_timer, config, ret_cap_channel);
+  if (err == ESP_OK) {
+    // Gelöschte Kanäle bleiben stehen; der Treiber vergibt denselben
+    // Speicher selten neu, dann überschreibt der Eintrag den alten
+    hook_t *hook = hook_for(*ret_cap_channel);
+    if (!hook) {
+      hook = hook_for(NULL);
+    }
+    if (hook) {
+      *hook = (hook_t){.channel = *ret_cap_channel, .gpio = config->gpio_num};
+    }
+  }
+  return err;
+}
+
+static bool IRAM_ATTR trampoline(mcpwm_cap_channel_handle_t cap_channel,
+                                 const mcpwm_capture_event_data_t *edata,
+                                 void *user_ctx) {
+  hook_t *hook = user_ctx;
+  if (periph_trace_active()) {
+    uint32_t v = edata->cap_value;
+    uint8_t payload[6] = {
+        (uint8_t)hook->gpio, edata->cap_edge == MCPWM_CAP_EDGE_POS ? 0 : 1,
+        (uint8_t)v,          (uint8_t)(v >> 8),
+        (uint8_t)(v >> 16),  (uint8_t)(v >> 24),
+    };
+    periph_trace_record(PT_CAP_EDGE, esp_timer_get_time(), payload,
+                        sizeof(payload));
+  }
+  return hook->on_cap(cap_channel, edata, hook->user_ctx);
+}
+
+esp_err_t __wrap_mcpwm_capture_channel_register_event_callbacks(
+    mcpwm_cap_channel_handle_t cap_channel,
+    const mcpwm_capture_event_callbacks_t *cbs, void *user_data) {
+  hook_t *hook = cap_channel ? hook_for(cap_channel) : NULL;
+  if (!hook || !cbs || !cbs->on_cap) {
+    return __real_mcpwm_capture_channel_register_event_callbacks(
+        cap_channel, cbs, user_data);
+  }
+  hook->on_cap = cbs->on_cap;
+  hook->user_ctx = user_data;
+  mcpwm_capture_event_callbacks_t wrapped = *cbs;
+  wrapped.on_cap = trampoline;
+  return __real_mcpwm_capture_channel_register_event_callbacks(
+      cap_channel, &wrapped, hook);
+}
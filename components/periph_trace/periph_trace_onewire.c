@@ -0,0 +1,112 @@
+#include "periph_trace.h"
+#include "periph_trace_format.h"
+
+#include "esp_timer.h"
+#include <string.h>
+
+// onewire_bus ist eine verwaltete Komponente, die nicht jedes Projekt
+// einbindet. Damit periph_trace nicht davon abhängt, sind die benutzten
+// Typen und Signaturen hier nachgebildet (onewire_bus 1.0).
+typedef struct onewire_bus_t *onewire_bus_handle_t;
+typedef struct onewire_device_iter_t *onewire_device_iter_handle_t;
+typedef struct {
+  onewire_bus_handle_t bus;
+  uint64_t address;
+} onewire_device_t;
+
+esp_err_t __real_onewire_bus_reset(onewire_bus_handle_t bus);
+esp_err_t __real_onewire_bus_write_bytes(onewire_bus_handle_t bus,
+                                         const uint8_t *tx_data,
+                                         uint8_t tx_data_size);
+esp_err_t __real_onewire_bus_read_bytes(onewire_bus_handle_t bus,
+                                        uint8_t *rx_buf, size_t rx_buf_size);
+esp_err_t __real_onewire_bus_read_bit(onewire_bus_handle_t bus,
+                                      uint8_t *rx_bit);
+esp_err_t __real_onewire_device_iter_get_next(
+    onewire_device_iter_handle_t iter, onewire_device_t *dev);
+
+// Die Suche in onewire_device.c ruft selbst reset/write/read_bit auf und
+// läuft damit durch die Wrapper; sie wird nur als Ergebnis aufgezeichnet
+static volatile bool in_search;
+
+static bool recording(void) { return periph_trace_active() && !in_search; }
+
+esp_err_t __wrap_onewire_bus_reset(onewire_bus_handle_t bus) {
+  int64_t t0 = esp_timer_get_time();
+  esp_err_t err = __real_onewire_bus_reset(bus);
+  if (recording()) {
+    uint8_t payload[1 + PT_VARINT_MAX];
+    payload[0] = err == ESP_OK;
+    size_t n = 1 + pt_put_varint(&payload[1], esp_timer_get_time() - t0);
+    periph_trace_record(PT_OW_RESET, t0, payload, n);
+  }
+  return err;
+}
+
+static void record_data(uint8_t type, int64_t t0, const uint8_t *data,
+                        size_t len) {
+  uint8_t payload[PERIPH_TRACE_MAX_RECORD];
+  size_t n = pt_put_varint(payload, esp_timer_get_time() - t0);
+  n += pt_put_varint(&payload[n], len);
+  if (n + len > sizeof(payload)) {
+    n = sizeof(payload) + 1; // wird als verloren gezählt
+  } else {
+    memcpy(&payload[n], data, len);
+    n += len;
+  }
+  periph_trace_record(type, t0, payload, n);
+}
+
+esp_err_t __wrap_onewire_bus_write_bytes(onewire_bus_handle_t bus,
+                                         const uint8_t *tx_data,
+                                         uint8_t tx_data_size) {
+  int64_t t0 = esp_timer_get_time();
+  esp_err_t err = __real_onewire_bus_write_bytes(bus, tx_data, tx_data_size);
+  if (recording() && err == ESP_OK) {
+    record_data(PT_OW_WRITE, t0, tx_data, tx_data_size);
+  }
+  return err;
+}
+
+esp_err_t __wrap_onewire_bus_read_bytes(onewire_bus_handle_t bus,
+                                        uint8_t *rx_buf, size_t rx_buf_size) {
+  int64_t t0 = esp_timer_get_time();
+  esp_err_t err = __real_onewire_bus_read_bytes(bus, rx_buf, rx_buf_size);
+  if (recording() && err == ESP_OK) {
+    record_data(PT_OW_READ, t0, rx_buf, rx_buf_size);
+  }
+  return err;
+}
+
+esp_err_t __wrap_onewire_bus_read_bit(onewire_bus_handle_t bus,
+                                      uint8_t *rx_bit) {
+  int64_t t0 = esp_timer_get_time();
+  esp_err_t err = __real_onewire_bus_read_bit(bus, rx_bit);
+  if (recording() && err == ESP_OK) {
+    uint8_t payload[1 + PT_VARINT_MAX];
+    payload[0] = *rx_bit;
+    size_t n = 1 + pt_put_varint(&payload[1], esp_timer_get_time() - t0);
+    periph_trace_record(PT_OW_BIT, t0, payload, n);
+  }
+  return err;
+}
+
+esp_err_t __wrap_onewire_device_iter_get_next(
+    onewire_device_iter_handle_t iter, onewire_device_t *dev) {
+  int64_t t0 = esp_timer_get_time();
+  bool record = recording();
+  in_search = true;
+  esp_err_t err = __real_onewire_device_iter_get_next(iter, dev);
+  in_search = false;
+  if (record) {
+    uint8_t payload[9] = {err == ESP_OK};
+    size_t n = 1;
+    if (err == ESP_OK) {
+      for (int i = 0; i < 8; i++) {
+        payload[n++] = (uint8_t)(dev->address >> (8 * i));
+      }
+    }
+    periph_trace_record(PT_OW_SEARCH, t0, payload, n);
+  }
+  return err;
+}
@@ -0,0 +1,491 @@
+/*
+Auswertung des Profilers: liest Frames von der UART (oder aus einer Datei
+bzw. stdin), ordnet pc und Aufrufer über die Symboltabelle der ELF-Datei
+Funktionen zu und gibt "gefaltete" Stacks aus, eine Zeile pro Stack mit
+Anzahl, direkt verwendbar für flamegraph.pl oder speedscope:
+
+  gcc -O2 -Wall -I.. -I../../sms_proto -o prof_fold prof_fold.c \
+      ../../sms_proto/cobs.c ../../sms_proto/crc16.c
+  ./prof_fold build/gif.elf /dev/ttyUSB1 921600 > gif.folded   (Ctrl-C)
+  flamegraph.pl gif.folded > gif.svg
+
+  gif_task;lv_timer_handler;lv_draw_sw_blend 412
+  [ISR] 17
+
+Optionen vor der ELF-Datei: -c <kern> nur diesen Kern, -n ohne Aufrufer.
+Auf stderr steht eine Zusammenfassung mit den Funktionen, in denen die
+meiste Zeit verbracht wird (Self-Anteil). Text und binlog-Frames auf
+derselben Leitung werden übersprungen.
+*/
+
+#define _DEFAULT_SOURCE // cfmakeraw
+
+#include "cobs.h"
+#include "crc16.h"
+#include "profiler_format.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#define CHUNK_MAX 4096
+#define MAX_CORES 2
+#define MAX_TASKS 128
+#define STACKS_SIZE 65536 // Zweierpotenz
+#define TOP_N 15
+// Symbole ohne Größe (ROM) gelten bis zum nächsten, höchstens so weit
+#define UNSIZED_MAX 4096
+
+typedef struct {
+  uint32_t addr;
+  uint32_t size;
+  const char *name;
+  uint64_t self; // Samples mit pc in dieser Funktion
+} symbol_t;
+
+typedef struct {
+  uint32_t task;
+  uint32_t caller; // Anfang der Funktion bzw. Adresse, wenn unbekannt
+  uint32_t pc;
+  uint8_t flags;
+  uint64_t count;
+} fold_t;
+
+typedef struct {
+  uint32_t handle;
+  char name[PROF_MAX_NAME + 1];
+} task_t;
+
+static uint8_t *elf;
+static symbol_t *symbols;
+static size_t symbol_count;
+static task_t tasks[MAX_TASKS];
+static size_t task_count;
+static fold_t stacks[STACKS_SIZE];
+static size_t stack_count;
+
+static int only_core = -1;
+static bool no_caller;
+static volatile sig_atomic_t stop;
+
+static uint32_t get16(const uint8_t *p) { return p[0] | p[1] << 8; }
+
+static uint32_t get32(const uint8_t *p) {
+  return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static int by_addr(const void *a, const void *b) {
+  const symbol_t *x = a, *y = b;
+  return x->addr < y->addr ? -1 : x->addr > y->addr;
+}
+
+// Nur 32-Bit little endian (Xtensa, RISC-V); Funktionen aus .symtab
+static bool load_elf(const char *path) {
+  FILE *f = fopen(path, "rb");
+  if (!f) {
+    perror(path);
+    return false;
+  }
+  fseek(f, 0, SEEK_END);
+  long size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  elf = malloc(size);
+  if (!elf || fread(elf, 1, size, f) != (size_t)size) {
+    fclose(f);
+    return false;
+  }
+  fclose(f);
+  if (size < 52 || memcmp(elf, "\x7f" "ELF", 4) != 0 || elf[4] != 1 ||
+      elf[5] != 1) {
+    fprintf(stderr, "%s: keine 32-Bit-ELF-Datei (little endian)\n", path);
+    return false;
+  }
+  uint32_t shoff = get32(&elf[0x20]);
+  uint32_t shentsize = get16(&elf[0x2E]);
+  uint32_t shnum = get16(&elf[0x30]);
+  if (shoff + (uint64_t)shnum * shentsize > (uint64_t)size) {
+    fprintf(stderr, "%s: Abschnittstabelle beschädigt\n", path);
+    return false;
+  }
+  for (uint32_t i = 0; i < shnum; i++) {
+    const uint8_t *sh = &elf[shoff + i * shentsize];
+    uint32_t link = get32(&sh[24]);
+    if (get32(&sh[4]) != 2 || link >= shnum) { // SHT_SYMTAB
+      continue;
+    }
+    uint32_t offset = get32(&sh[16]);
+    uint32_t sz = get32(&sh[20]);
+    const uint8_t *str_sh = &elf[shoff + link * shentsize];
+    uint32_t str_off = get32(&str_sh[16]);
+    uint32_t str_size = get32(&str_sh[20]);
+    if (offset + (uint64_t)sz > (uint64_t)size ||
+        str_off + (uint64_t)str_size > (uint64_t)size) {
+      continue;
+    }
+    symbols = realloc(symbols, (symbol_count + sz / 16) * sizeof(symbol_t));
+    for (uint32_t s = 0; s + 16 <= sz; s += 16) {
+      const uint8_t *sym = &elf[offset + s];
+      uint32_t name = get32(sym);
+      uint32_t addr = get32(&sym[4]);
+      // STT_FUNC, Name innerhalb der Stringtabelle
+      if ((sym[12] & 0xf) != 2 || !addr || name >= str_size ||
+          !memchr(&elf[str_off + name], 0, str_size - name)) {
+        continue;
+      }
+      symbols[symbol_count++] = (symbol_t){
+          .addr = addr,
+          .size = get32(&sym[8]),
+          .name = (const char *)&elf[str_off + name],
+      };
+    }
+  }
+  if (!symbol_count) {
+    fprintf(stderr, "%s: keine Funktionssymbole (gestrippt?)\n", path);
+    return false;
+  }
+  qsort(symbols, symbol_count, sizeof(symbol_t), by_addr);
+  for (size_t i = 0; i < symbol_count; i++) {
+    if (symbols[i].size == 0) {
+      uint32_t gap = i + 1 < symbol_count
+                         ? symbols[i + 1].addr - symbols[i].addr
+                         : UNSIZED_MAX;
+      symbols[i].size = gap < UNSIZED_MAX ? gap : UNSIZED_MAX;
+    }
+  }
+  return true;
+}
+
+// Letztes Symbol mit addr <= a, das a auch umfasst
+static symbol_t *find_symbol(uint32_t a) {
+  size_t lo = 0, hi = symbol_count;
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    if (symbols[mid].addr <= a) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  if (lo == 0) {
+    return NULL;
+  }
+  symbol_t *s = &symbols[lo - 1];
+  return a - s->addr < s->size ? s : NULL;
+}
+
+static uint32_t canonical(uint32_t a) {
+  symbol_t *s = find_symbol(a);
+  return s ? s->addr : a;
+}
+
+static void format_addr(char *out, size_t cap, uint32_t a) {
+  symbol_t *s = find_symbol(a);
+  if (s) {
+    snprintf(out, cap, "%s", s->name);
+  } else {
+    snprintf(out, cap, "0x%08x", a);
+  }
+}
+
+static void set_task_name(uint32_t handle, const uint8_t *name, size_t len) {
+  task_t *t = NULL;
+  for (size_t i = 0; i < task_count; i++) {
+    if (tasks[i].handle == handle) {
+      t = &tasks[i];
+    }
+  }
+  if (!t && task_count < MAX_TASKS) {
+    t = &tasks[task_count++];
+  }
+  if (t) {
+    // Handles werden nach vTaskDelete wiederverwendet, der letzte Name gilt
+    t->handle = handle;
+    len = len < PROF_MAX_NAME ? len : PROF_MAX_NAME;
+    memcpy(t->name, name, len);
+    t->name[len] = 0;
+  }
+}
+
+static const char *task_name(uint32_t handle) {
+  static char buf[16];
+  for (size_t i = 0; i < task_count; i++) {
+    if (tasks[i].handle == handle) {
+      return tasks[i].name;
+    }
+  }
+  snprintf(buf, sizeof(buf), "task_%08x", handle);
+  return buf;
+}
+
+static void add_sample(uint8_t flags, uint32_t pc, uint32_t caller,
+                       uint32_t task) {
+  fold_t key = {.flags = flags};
+  if (!(flags & (PROF_F_ISR | PROF_F_NO_TASK))) {
+    key.task = task;
+    key.pc = canonical(pc);
+    key.caller = no_caller || !caller ? 0 : canonical(caller);
+    symbol_t *s = find_symbol(pc);
+    if (s) {
+      s->self++;
+    }
+  }
+  uint32_t h = key.task * 2654435761u ^ key.pc * 40503u ^ key.caller ^
+               key.flags;
+  for (size_t i = 0; i < STACKS_SIZE; i++) {
+    fold_t *e = &stacks[(h + i) & (STACKS_SIZE - 1)];
+    if (!e->count) {
+      if (stack_count + 1 >= STACKS_SIZE) {
+        return; // voll, Sample wird nicht gezählt
+      }
+      *e = key;
+      stack_count++;
+    }
+    if (e->task == key.task && e->pc == key.pc && e->caller == key.caller &&
+        e->flags == key.flags) {
+      e->count++;
+      return;
+    }
+  }
+}
+
+typedef struct {
+  bool have_seq;
+  uint8_t seq;
+  uint32_t hz;
+  uint64_t samples[MAX_CORES];
+  uint64_t in_isr[MAX_CORES];
+  uint64_t dropped[MAX_CORES];
+  uint64_t lost_frames;
+} decoder_t;
+
+static void decode_record(decoder_t *dec, const uint8_t *rec, size_t len) {
+  // PROF_INFO hat kein Kern-Byte
+  int core = len > 1 && rec[0] != PROF_INFO ? rec[1] : 0;
+  if (core >= MAX_CORES) {
+    return;
+  }
+  switch (rec[0]) {
+  case PROF_SAMPLE:
+    if (len == PROF_SAMPLE_LEN && (only_core < 0 || core == only_core)) {
+      dec->samples[core]++;
+      if (rec[2] & PROF_F_ISR) {
+        dec->in_isr[core]++;
+      }
+      add_sample(rec[2], get32(&rec[3]), get32(&rec[7]), get32(&rec[11]));
+    }
+    break;
+  case PROF_TASK:
+    if (len >= PROF_TASK_LEN(0)) {
+      set_task_name(get32(&rec[2]), &rec[6], len - PROF_TASK_LEN(0));
+    }
+    break;
+  case PROF_LOST:
+    if (len == PROF_LOST_LEN) {
+      dec->dropped[core] += get32(&rec[2]);
+    }
+    break;
+  case PROF_INFO:
+    if (len == PROF_INFO_LEN) {
+      dec->hz = get32(&rec[1]);
+    }
+    break;
+  }
+}
+
+static bool decode_frame(decoder_t *dec, const uint8_t *in, size_t len) {
+  static uint8_t buf[CHUNK_MAX];
+  len = cobs_decode(in, len, buf);
+  if (len < 4 || buf[0] != PROF_FRAME_TAG ||
+      crc16_ccitt(buf, len - 2) != get16(&buf[len - 2])) {
+    return false;
+  }
+  len -= 2;
+  if (dec->have_seq && buf[1] != (uint8_t)(dec->seq + 1)) {
+    dec->lost_frames += (uint8_t)(buf[1] - dec->seq - 1);
+  }
+  dec->seq = buf[1];
+  dec->have_seq = true;
+  for (size_t pos = 2; pos < len;) {
+    size_t rec_len = buf[pos];
+    if (rec_len == 0 || pos + 1 + rec_len > len) {
+      break;
+    }
+    decode_record(dec, &buf[pos + 1], rec_len);
+    pos += 1 + rec_len;
+  }
+  return true;
+}
+
+static void print_stacks(void) {
+  char caller[128], pc[128];
+  for (size_t i = 0; i < STACKS_SIZE; i++) {
+    const fold_t *e = &stacks[i];
+    if (!e->count) {
+      continue;
+    }
+    if (e->flags & PROF_F_NO_TASK) {
+      printf("[kein Task] %llu\n", (unsigned long long)e->count);
+      continue;
+    }
+    if (e->flags & PROF_F_ISR) {
+      printf("[ISR] %llu\n", (unsigned long long)e->count);
+      continue;
+    }
+    format_addr(pc, sizeof(pc), e->pc);
+    if (e->caller) {
+      format_addr(caller, sizeof(caller), e->caller);
+      printf("%s;%s;%s %llu\n", task_name(e->task), caller, pc,
+             (unsigned long long)e->count);
+    } else {
+      printf("%s;%s %llu\n", task_name(e->task), pc,
+             (unsigned long long)e->count);
+    }
+  }
+}
+
+static int by_self(const void *a, const void *b) {
+  const symbol_t *x = *(symbol_t *const *)a, *y = *(symbol_t *const *)b;
+  return x->self < y->self ? 1 : x->self > y->self ? -1 : 0;
+}
+
+static void print_summary(const decoder_t *dec) {
+  uint64_t total = 0;
+  for (int c = 0; c < MAX_CORES; c++) {
+    total += dec->samples[c];
+    if (dec->samples[c] || dec->dropped[c]) {
+      fprintf(stderr,
+              "Kern %d: %llu Samples, %.1f %% in ISRs, %llu verworfen\n", c,
+              (unsigned long long)dec->samples[c],
+              dec->samples[c] ? 100.0 * dec->in_isr[c] / dec->samples[c] : 0,
+              (unsigned long long)dec->dropped[c]);
+    }
+  }
+  fprintf(stderr, "%u Hz, %llu Frames verloren\n", dec->hz,
+          (unsigned long long)dec->lost_frames);
+  if (!total) {
+    return;
+  }
+  symbol_t **top = malloc(symbol_count * sizeof(symbol_t *));
+  size_t n = 0;
+  for (size_t i = 0; i < symbol_count; i++) {
+    if (symbols[i].self) {
+      top[n++] = &symbols[i];
+    }
+  }
+  qsort(top, n, sizeof(symbol_t *), by_self);
+  for (size_t i = 0; i < n && i < TOP_N; i++) {
+    fprintf(stderr, "%6.2f %%  %8llu  %s\n", 100.0 * top[i]->self / total,
+            (unsigned long long)top[i]->self, top[i]->name);
+  }
+  free(top);
+}
+
+static speed_t baud_to_speed(int baud) {
+  switch (baud) {
+  case 115200:
+    return B115200;
+  case 230400:
+    return B230400;
+  case 460800:
+    return B460800;
+  case 921600:
+    return B921600;
+  case 2000000:
+    return B2000000;
+  default:
+    return B0;
+  }
+}
+
+static int open_input(const char *path, int baud) {
+  if (!path || strcmp(path, "-") == 0) {
+    return STDIN_FILENO;
+  }
+  int fd = open(path, O_RDONLY | O_NOCTTY | O_CLOEXEC);
+  if (fd < 0 || !isatty(fd)) {
+    return fd;
+  }
+  struct termios tio;
+  speed_t speed = baud_to_speed(baud);
+  if (speed == B0 || tcgetattr(fd, &tio) < 0) {
+    fprintf(stderr, "Baudrate %d nicht unterstützt\n", baud);
+    close(fd);
+    return -1;
+  }
+  cfmakeraw(&tio);
+  cfsetispeed(&tio, speed);
+  cfsetospeed(&tio, speed);
+  tcsetattr(fd, TCSANOW, &tio);
+  return fd;
+}
+
+static void on_signal(int sig) { stop = 1; }
+
+int main(int argc, char **argv) {
+  int opt;
+  while ((opt = getopt(argc, argv, "c:n")) != -1) {
+    switch (opt) {
+    case 'c':
+      only_core = atoi(optarg);
+      break;
+    case 'n':
+      no_caller = true;
+      break;
+    default:
+      argc = 0;
+      break;
+    }
+  }
+  if (optind >= argc) {
+    fprintf(stderr,
+            "Aufruf: %s [-c kern] [-n] firmware.elf [gerät|datei|-] [baud]\n",
+            argv[0]);
+    return 2;
+  }
+  if (!load_elf(argv[optind])) {
+    return 1;
+  }
+  const char *path = optind + 1 < argc ? argv[optind + 1] : NULL;
+  int fd = open_input(path, optind + 2 < argc ? atoi(argv[optind + 2])
+                                              : 921600);
+  if (fd < 0) {
+    perror(path);
+    return 1;
+  }
+  // Von einer UART wird bis Ctrl-C gelesen, danach ausgewertet; ohne
+  // SA_RESTART bricht read() dabei ab
+  struct sigaction sa = {.sa_handler = on_signal};
+  sigaction(SIGINT, &sa, NULL);
+  sigaction(SIGTERM, &sa, NULL);
+
+  decoder_t dec = {0};
+  static uint8_t chunk[CHUNK_MAX];
+  size_t chunk_len = 0;
+  uint8_t buf[4096];
+  ssize_t got;
+  while (!stop && ((got = read(fd, buf, sizeof(buf))) > 0 ||
+                   (got < 0 && errno == EINTR))) {
+    for (ssize_t i = 0; i < got; i++) {
+      if (buf[i] != 0) {
+        if (chunk_len < CHUNK_MAX) {
+          chunk[chunk_len++] = buf[i];
+        }
+        continue;
+      }
+      if (chunk_len) {
+        decode_frame(&dec, chunk, chunk_len);
+      }
+      chunk_len = 0;
+    }
+  }
+  print_stacks();
+  print_summary(&dec);
+  return 0;
+}
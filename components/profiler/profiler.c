@@ -0,0 +1,345 @@
+#include "profiler.h"
+
+#include "sdkconfig.h"
+
+#if CONFIG_IDF_TARGET_ARCH_XTENSA
+
+#include "driver/gptimer.h"
+#include "driver/uart.h"
+#include "esp_attr.h"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "record_frame.h"
+#include "ring_buffer.h"
+#include "soc/soc_caps.h"
+#include "xtensa_context.h"
+#include <string.h>
+
+#define SENDER_STACK 3072
+#define SENDER_PRIORITY 1
+#define SETUP_STACK 2048
+#define UART_TX_BUF 4096
+#define UART_RX_BUF 256 // muss größer als der Hardware-FIFO sein
+#define TIMER_RESOLUTION_HZ 1000000
+#define INTR_LEVEL 3
+// Tasks pro Kern, deren Name schon gemeldet wurde
+#define MAX_TASKS 32
+// Längster Datensatz im Ring (PROF_TASK mit vollem Namen)
+#define MAX_RECORD (1 + PROF_TASK_LEN(PROF_MAX_NAME))
+
+static const char *TAG = "profiler";
+
+typedef struct {
+  gptimer_handle_t timer;
+  ring_buffer_t ring;
+  uint8_t mem[PROFILER_RING_SIZE];
+  TaskHandle_t seen[MAX_TASKS]; // nur die ISR des Kerns
+  size_t n_seen;
+  volatile bool forget; // Sender: Namen beim nächsten Sample neu melden
+  profiler_stats_t stats;
+  uint32_t reported_drops; // nur die Sende-Task
+} core_state_t;
+
+static core_state_t cores[portNUM_PROCESSORS];
+static volatile bool enabled;
+static uint32_t sample_hz;
+static int port = -1;
+
+static inline void IRAM_ATTR put32(uint8_t *p, uint32_t v) {
+  p[0] = v;
+  p[1] = v >> 8;
+  p[2] = v >> 16;
+  p[3] = v >> 24;
+}
+
+// a0 enthält in den oberen zwei Bits die Fenstergröße des Aufrufs (01 =
+// call4, 10 = call8, 11 = call12), der Rest zeigt hinter den call-Befehl.
+// Minus 3 ergibt eine Adresse im call selbst, damit landet auch ein call am
+// Funktionsende im richtigen Symbol.
+static inline uint32_t IRAM_ATTR return_address(uint32_t a0) {
+  if ((a0 & 0xc0000000) == 0) {
+    return 0; // kein Rücksprung über call4/8/12, z.B. Task-Einstieg
+  }
+  return ((a0 & 0x3fffffff) | 0x40000000) - 3;
+}
+
+// Name der Task einmal pro Kern melden; bei vollem Ring bleibt sie
+// ungesehen und wird beim nächsten Sample erneut versucht
+static void IRAM_ATTR note_task(core_state_t *c, int core, TaskHandle_t task) {
+  if (c->forget) {
+    c->n_seen = 0;
+    c->forget = false;
+  }
+  for (size_t i = 0; i < c->n_seen; i++) {
+    if (c->seen[i] == task) {
+      return;
+    }
+  }
+  const char *name = pcTaskGetName(task);
+  size_t len = strnlen(name, PROF_MAX_NAME);
+  uint8_t rec[1 + PROF_TASK_LEN(PROF_MAX_NAME)];
+  rec[0] = PROF_TASK_LEN(len);
+  rec[1] = PROF_TASK;
+  rec[2] = core;
+  put32(&rec[3], (uint32_t)(uintptr_t)task);
+  memcpy(&rec[7], name, len);
+  if (ring_free(&c->ring) >= 1 + rec[0]) {
+    ring_write(&c->ring, rec, 1 + rec[0]);
+    if (c->n_seen < MAX_TASKS) {
+      c->seen[c->n_seen++] = task;
+    }
+  }
+}
+
+// Läuft auf dem Kern des Timers. Die unterbrochene Task hat ihren Kontext
+// beim Eintritt in den Interrupt auf ihren Stack gesichert, pxTopOfStack
+// (das erste Feld im TCB) zeigt darauf. Das gilt nur für die äußerste
+// Unterbrechung; war schon eine ISR aktiv, liegt deren Kontext auf dem
+// Interrupt-Stack und wird nicht ausgewertet.
+static bool IRAM_ATTR on_alarm(gptimer_handle_t timer,
+                               const gptimer_alarm_event_data_t *edata,
+                               void *arg) {
+  if (!enabled) {
+    return false;
+  }
+  core_state_t *c = arg;
+  int core = esp_cpu_get_core_id();
+  TaskHandle_t task = xTaskGetCurrentTaskHandle();
+  uint8_t flags = 0;
+  uint32_t pc = 0, caller = 0;
+  if (!task) {
+    flags |= PROF_F_NO_TASK;
+  } else if (xPortInterruptedFromISRContext()) {
+    flags |= PROF_F_ISR;
+  } else {
+    const XtExcFrame *frame = *(XtExcFrame *const *)task;
+    pc = frame->pc;
+    caller = return_address(frame->a0);
+    note_task(c, core, task);
+  }
+
+  uint8_t rec[1 + PROF_SAMPLE_LEN];
+  rec[0] = PROF_SAMPLE_LEN;
+  rec[1] = PROF_SAMPLE;
+  rec[2] = core;
+  rec[3] = flags;
+  put32(&rec[4], pc);
+  put32(&rec[8], caller);
+  put32(&rec[12], (uint32_t)(uintptr_t)task);
+  if (ring_free(&c->ring) >= sizeof(rec)) {
+    ring_write(&c->ring, rec, sizeof(rec));
+    c->stats.samples++;
+    if (flags & PROF_F_ISR) {
+      c->stats.in_isr++;
+    }
+  } else {
+    c->stats.dropped++;
+  }
+  return false;
+}
+
+static record_frame_t out;
+
+static size_t send_uart(const void *data, size_t len, void *ctx) {
+  return uart_write_bytes(port, data, len);
+}
+
+static void send_info(void) {
+  uint8_t *p = record_frame_reserve(&out, 1 + PROF_INFO_LEN);
+  p[0] = PROF_INFO_LEN;
+  p[1] = PROF_INFO;
+  put32(&p[2], sample_hz);
+  p[6] = portNUM_PROCESSORS;
+}
+
+static void put_lost(uint8_t *p, int core, uint32_t count) {
+  p[0] = PROF_LOST_LEN;
+  p[1] = PROF_LOST;
+  p[2] = core;
+  put32(&p[3], count);
+}
+
+// Alle PROFILER_NAMES_MS die Tasknamen und die Rate neu melden, damit ein
+// später gestarteter Host-Empfänger sie ebenfalls bekommt
+static void sender(void *arg) {
+  TickType_t last_wake = xTaskGetTickCount();
+  TickType_t last_names = last_wake;
+  send_info();
+  while (1) {
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+      core_state_t *c = &cores[core];
+      record_frame_drain(&out, &c->ring, core, c->stats.dropped,
+                         &c->reported_drops);
+    }
+    record_frame_flush(&out);
+    vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(PROFILER_FLUSH_MS));
+    if (last_wake - last_names >= pdMS_TO_TICKS(PROFILER_NAMES_MS)) {
+      last_names = last_wake;
+      for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        cores[core].forget = true;
+      }
+      send_info();
+    }
+  }
+}
+
+static esp_err_t start_timer(core_state_t *c) {
+  gptimer_config_t config = {
+      .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+      .direction = GPTIMER_COUNT_UP,
+      .resolution_hz = TIMER_RESOLUTION_HZ,
+      .intr_priority = INTR_LEVEL,
+  };
+  esp_err_t err = gptimer_new_timer(&config, &c->timer);
+  if (err != ESP_OK) {
+    return err;
+  }
+  gptimer_alarm_config_t alarm = {
+      .alarm_count = TIMER_RESOLUTION_HZ / sample_hz,
+      .reload_count = 0,
+      .flags.auto_reload_on_alarm = true,
+  };
+  gptimer_event_callbacks_t cbs = {.on_alarm = on_alarm};
+  err = gptimer_set_alarm_action(c->timer, &alarm);
+  if (err == ESP_OK) {
+    err = gptimer_register_event_callbacks(c->timer, &cbs, c);
+  }
+  if (err == ESP_OK) {
+    err = gptimer_enable(c->timer);
+  }
+  if (err == ESP_OK) {
+    err = gptimer_start(c->timer);
+    if (err != ESP_OK) {
+      gptimer_disable(c->timer);
+    }
+  }
+  if (err != ESP_OK) {
+    gptimer_del_timer(c->timer);
+    c->timer = NULL;
+  }
+  return err;
+}
+
+static void stop_timer(core_state_t *c) {
+  if (!c->timer) {
+    return;
+  }
+  gptimer_stop(c->timer);
+  gptimer_disable(c->timer);
+  gptimer_del_timer(c->timer);
+  c->timer = NULL;
+}
+
+typedef struct {
+  int core;
+  esp_err_t err;
+  SemaphoreHandle_t done;
+} setup_t;
+
+// Der Interrupt eines gptimer wird auf dem Kern belegt, der
+// gptimer_register_event_callbacks() aufruft, daher eine kurze Task pro Kern
+static void setup_task(void *arg) {
+  setup_t *s = arg;
+  s->err = start_timer(&cores[s->core]);
+  xSemaphoreGive(s->done);
+  vTaskDelete(NULL);
+}
+
+// Die Sende-Task entsteht zuletzt: schlägt vorher etwas fehl, müssen nur
+// die schon laufenden Timer wieder weg, und eine Task mitten in
+// uart_write_bytes muss nie gelöscht werden
+esp_err_t profiler_start(int uart_port, uint32_t hz) {
+  if (port >= 0) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  if (uart_port < 0 || uart_port >= SOC_UART_NUM || hz == 0 ||
+      hz > PROFILER_MAX_HZ) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  bool installed = false;
+  if (!uart_is_driver_installed(uart_port)) {
+    esp_err_t err = uart_driver_install(uart_port, UART_RX_BUF, UART_TX_BUF,
+                                        0, NULL, 0);
+    if (err != ESP_OK) {
+      return err;
+    }
+    installed = true;
+  }
+  sample_hz = hz;
+  for (int core = 0; core < portNUM_PROCESSORS; core++) {
+    ring_init(&cores[core].ring, cores[core].mem, PROFILER_RING_SIZE);
+  }
+
+  // Die Timer laufen ab hier, schreiben aber erst mit enabled
+  esp_err_t err = ESP_ERR_NO_MEM;
+  SemaphoreHandle_t done = xSemaphoreCreateBinary();
+  if (done) {
+    err = ESP_OK;
+    for (int core = 0; core < portNUM_PROCESSORS && err == ESP_OK; core++) {
+      setup_t s = {.core = core, .err = ESP_ERR_NO_MEM, .done = done};
+      if (xTaskCreatePinnedToCore(setup_task, "prof_setup", SETUP_STACK, &s,
+                                  configMAX_PRIORITIES - 1, NULL,
+                                  core) == pdPASS) {
+        xSemaphoreTake(done, portMAX_DELAY);
+      }
+      err = s.err;
+    }
+    vSemaphoreDelete(done);
+  }
+  record_frame_config_t config = {
+      .tag = PROF_FRAME_TAG,
+      .max_record = MAX_RECORD,
+      .lost_len = 1 + PROF_LOST_LEN,
+      .lost = put_lost,
+      .send = send_uart,
+  };
+  record_frame_init(&out, &config);
+  port = uart_port; // die Sende-Task kann sofort auf dem anderen Kern laufen
+  if (err == ESP_OK && xTaskCreate(sender, "profiler", SENDER_STACK, NULL,
+                                   SENDER_PRIORITY, NULL) != pdPASS) {
+    err = ESP_ERR_NO_MEM;
+  }
+  if (err != ESP_OK) {
+    port = -1;
+    ESP_LOGE(TAG, "Start: %s", esp_err_to_name(err));
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+      stop_timer(&cores[core]);
+    }
+    if (installed) {
+      uart_driver_delete(uart_port);
+    }
+    return err;
+  }
+  enabled = true;
+  ESP_LOGI(TAG, "%lu Hz auf %d Kernen, UART%d", (unsigned long)hz,
+           portNUM_PROCESSORS, uart_port);
+  return ESP_OK;
+}
+
+void profiler_set_enabled(bool on) { enabled = on; }
+
+profiler_stats_t profiler_get_stats(int core) {
+  profiler_stats_t s = {0};
+  if (core >= 0 && core < portNUM_PROCESSORS) {
+    s = cores[core].stats;
+  }
+  return s;
+}
+
+#else
+
+// Ohne Xtensa-Kontext gibt es keinen unterbrochenen PC zu lesen
+esp_err_t profiler_start(int uart_port, uint32_t hz) {
+  return ESP_ERR_NOT_SUPPORTED;
+}
+
+void profiler_set_enabled(bool on) {}
+
+profiler_stats_t profiler_get_stats(int core) {
+  return (profiler_stats_t){0};
+}
+
+#endif
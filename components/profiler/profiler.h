@@ -0,0 +1,48 @@
+#pragma once
+
+#include "esp_err.h"
+#include "profiler_format.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+Statistischer CPU-Profiler: ein gptimer pro Kern löst mit fester Rate einen
+Interrupt aus, der Befehlszeiger, Aufrufer und Task des unterbrochenen Codes
+in einen Ringpuffer des Kerns schreibt. Eine Sende-Task schickt die Samples
+als Frames (profiler_format.h) über eine UART; host/prof_fold ordnet sie
+mit der ELF-Datei Funktionen zu und erzeugt Eingabe für Flame Graphs.
+
+Der Interrupt läuft auf Level 3 und unterbricht damit auch ISRs der Level 1
+und 2; solche Samples werden nur als "ISR" gezählt. Code in kritischen
+Abschnitten (portENTER_CRITICAL) sperrt auch Level 3, seine Samples landen
+beim Verlassen des Abschnitts. Die Rate ist bewusst keine runde Zahl,
+damit sie nicht mit periodischen Tasks im Gleichtakt läuft.
+
+Nur auf Xtensa (ESP32, ESP32-S3): der Interrupt liest den gesicherten
+Kontext aus dem Stack der unterbrochenen Task.
+*/
+
+#define PROFILER_DEFAULT_HZ 997
+#define PROFILER_MAX_HZ 10000
+#define PROFILER_RING_SIZE 2048 // pro Kern, Zweierpotenz
+#define PROFILER_FLUSH_MS 20
+#define PROFILER_NAMES_MS 1000  // so oft Tasknamen neu melden
+
+typedef struct {
+  uint32_t samples;
+  uint32_t in_isr;  // davon in einer anderen ISR
+  uint32_t dropped; // Ringpuffer voll
+} profiler_stats_t;
+
+// Startet die Timer auf allen Kernen und die Sende-Task. Ist auf
+// `uart_port` noch kein Treiber installiert, wird er installiert; Pins und
+// Baudrate stellt der Aufrufer ein. Besser eine eigene UART als die Konsole:
+// bei 1 kHz und zwei Kernen fallen rund 32 kB/s an.
+esp_err_t profiler_start(int uart_port, uint32_t sample_hz);
+
+// Hält die Aufnahme an bzw. setzt sie fort, z.B. um nur einen Abschnitt zu
+// messen. Die Timer laufen weiter.
+void profiler_set_enabled(bool enabled);
+
+// Zähler eines Kerns seit dem Start
+profiler_stats_t profiler_get_stats(int core);
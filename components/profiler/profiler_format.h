@@ -0,0 +1,46 @@
+#pragma once
+
+/*
+Leitungsformat des Profilers, angelehnt an binlog.
+
+Ein Datensatz:
+
+  [len][type][payload]     len = Bytes nach len
+
+  PROF_SAMPLE  [core][flags][pc u32][caller u32][task u32]
+               pc       unterbrochener Befehl
+               caller   Rücksprungadresse der unterbrochenen Funktion
+                        (Register a0, ohne Fenster-Bits, minus 3)
+               task     TaskHandle_t der unterbrochenen Task
+  PROF_TASK    [core][task u32][name ...]   Name zu einem TaskHandle_t
+  PROF_LOST    [core][anzahl u32]           verworfene Samples seit der
+                                            letzten Meldung
+  PROF_INFO    [sample_hz u32][cores]
+
+Werte little endian. Die Sende-Task packt Datensätze in Frames:
+
+  0x00 COBS([PROF_FRAME_TAG][seq][datensatz ...][crc16 lo][crc16 hi]) 0x00
+
+crc16 ist CRC-16/CCITT über Tag, seq und Datensätze. Das Tag trennt die
+Frames von denen des binlog. Die Datei ist unabhängig von ESP-IDF und wird
+auch von host/prof_fold benutzt.
+*/
+
+#define PROF_FRAME_TAG 0xA5
+#define PROF_MAX_NAME 16
+
+#define PROF_SAMPLE_LEN 15
+#define PROF_TASK_LEN(name_len) (6 + (name_len))
+#define PROF_LOST_LEN 6
+#define PROF_INFO_LEN 6
+
+enum {
+  PROF_SAMPLE = 1,
+  PROF_TASK,
+  PROF_LOST,
+  PROF_INFO,
+};
+
+// flags eines Samples
+#define PROF_F_ISR 0x01     // eine andere ISR war unterbrochen, pc unbekannt
+#define PROF_F_NO_TASK 0x02 // Scheduler lief noch nicht
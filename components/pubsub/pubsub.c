@@ -0,0 +1,246 @@
+#include "pubsub.h"
+
+#include "esp_timer.h"
+#include "metrics.h"
+#include "ring_buffer.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define POOL_WORDS (PUBSUB_MAX_POOL / 32)
+
+struct pubsub_sub {
+  pubsub_topic_t *topic;
+  const char *name;
+  TaskHandle_t task; // NULL = ohne Notification
+  ring_buffer_t ring; // pubsub_sample_t *, Schreiber ist der Erzeuger
+  uint32_t delivered; // nur der Abonnent
+  uint32_t dropped;   // nur der Erzeuger
+};
+
+struct pubsub_topic {
+  char name[PUBSUB_MAX_NAME + 1];
+  char metric_name[PUBSUB_MAX_NAME + 8]; // "bus.<name>_us", bleibt stehen
+  metric_t *latency_us;
+  uint8_t *pool;
+  size_t stride; // Abstand der Puffer im Pool
+  size_t pool_size;
+  uint32_t free[POOL_WORDS]; // gesetztes Bit = Puffer frei
+  pubsub_sub_t subs[PUBSUB_MAX_SUBSCRIBERS];
+  size_t n_subs; // erst nach dem Eintrag erhöht, Erzeuger ohne Sperre
+  // nur der Erzeuger
+  uint32_t seq;
+  uint32_t published;
+  uint32_t no_buffer;
+  // nur pubsub_print_stats
+  uint32_t last_published;
+  int64_t last_print_us;
+};
+
+static pubsub_topic_t topics[PUBSUB_MAX_TOPICS];
+static size_t n_topics; // wie n_subs
+static portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+
+static inline pubsub_sample_t *sample_at(pubsub_topic_t *t, size_t i) {
+  return (pubsub_sample_t *)(t->pool + i * t->stride);
+}
+
+esp_err_t pubsub_topic_create(const char *name, size_t sample_size,
+                              size_t pool_size, pubsub_topic_t **out) {
+  if (pool_size == 0 || pool_size > PUBSUB_MAX_POOL ||
+      strlen(name) > PUBSUB_MAX_NAME) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  // Jeder Puffer muss so ausgerichtet sein wie pubsub_sample_t (int64_t)
+  const size_t align = _Alignof(pubsub_sample_t);
+  size_t stride =
+      (sizeof(pubsub_sample_t) + sample_size + align - 1) & ~(align - 1);
+  uint8_t *pool = calloc(pool_size, stride);
+  if (pool == NULL) {
+    return ESP_ERR_NO_MEM;
+  }
+  portENTER_CRITICAL(&lock);
+  if (n_topics >= PUBSUB_MAX_TOPICS) {
+    portEXIT_CRITICAL(&lock);
+    free(pool);
+    return ESP_ERR_NO_MEM;
+  }
+  pubsub_topic_t *t = &topics[n_topics];
+  memset(t, 0, sizeof(*t));
+  strcpy(t->name, name);
+  t->pool = pool;
+  t->stride = stride;
+  t->pool_size = pool_size;
+  for (size_t i = 0; i < pool_size; i++) {
+    pubsub_sample_t *s = sample_at(t, i);
+    s->topic = t;
+    s->index = i;
+    t->free[i / 32] |= 1u << (i % 32);
+  }
+  __atomic_store_n(&n_topics, n_topics + 1, __ATOMIC_RELEASE);
+  portEXIT_CRITICAL(&lock);
+
+  // Vor dem ersten Abonnenten, bis dahin misst niemand eine Latenz
+  strcpy(t->metric_name, "bus.");
+  strcat(t->metric_name, name);
+  strcat(t->metric_name, "_us");
+  t->latency_us = metrics_histogram(t->metric_name, "us");
+  t->last_print_us = esp_timer_get_time();
+  *out = t;
+  return ESP_OK;
+}
+
+esp_err_t pubsub_subscribe(pubsub_topic_t *topic, const char *name,
+                           size_t depth, bool wake, pubsub_sub_t **out) {
+  if (depth == 0 || (depth & (depth - 1)) != 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  uint8_t *mem = malloc(depth * sizeof(pubsub_sample_t *));
+  if (mem == NULL) {
+    return ESP_ERR_NO_MEM;
+  }
+  portENTER_CRITICAL(&lock);
+  if (topic->n_subs >= PUBSUB_MAX_SUBSCRIBERS) {
+    portEXIT_CRITICAL(&lock);
+    free(mem);
+    return ESP_ERR_NO_MEM;
+  }
+  pubsub_sub_t *sub = &topic->subs[topic->n_subs];
+  *sub = (pubsub_sub_t){
+      .topic = topic,
+      .name = name,
+      .task = wake ? xTaskGetCurrentTaskHandle() : NULL,
+  };
+  ring_init(&sub->ring, mem, depth * sizeof(pubsub_sample_t *));
+  __atomic_store_n(&topic->n_subs, topic->n_subs + 1, __ATOMIC_RELEASE);
+  portEXIT_CRITICAL(&lock);
+  *out = sub;
+  return ESP_OK;
+}
+
+// Niedrigstes gesetztes Bit per CAS löschen; ein Fehlschlag heißt nur, dass
+// ein anderer Kern gleichzeitig dasselbe Wort geändert hat
+pubsub_sample_t *pubsub_alloc(pubsub_topic_t *topic) {
+  for (size_t w = 0; w < POOL_WORDS; w++) {
+    uint32_t bits = __atomic_load_n(&topic->free[w], __ATOMIC_RELAXED);
+    while (bits != 0) {
+      uint32_t bit = bits & -bits;
+      if (__atomic_compare_exchange_n(&topic->free[w], &bits, bits & ~bit,
+                                      true, __ATOMIC_ACQUIRE,
+                                      __ATOMIC_RELAXED)) {
+        pubsub_sample_t *s = sample_at(topic, w * 32 + __builtin_ctz(bit));
+        s->t_us = 0;
+        return s;
+      }
+    }
+  }
+  topic->no_buffer++;
+  return NULL;
+}
+
+void pubsub_release(pubsub_sample_t *sample) {
+  if (__atomic_sub_fetch(&sample->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+    __atomic_fetch_or(&sample->topic->free[sample->index / 32],
+                      1u << (sample->index % 32), __ATOMIC_RELEASE);
+  }
+}
+
+// Der Erzeuger hält selbst eine Referenz, bis alle Ringe beschrieben sind;
+// sonst könnte ein schneller Abonnent das Sample schon freigeben, während
+// es noch in weitere Ringe kommt.
+void pubsub_publish(pubsub_sample_t *sample) {
+  pubsub_topic_t *t = sample->topic;
+  size_t n_subs = __atomic_load_n(&t->n_subs, __ATOMIC_ACQUIRE);
+  if (sample->t_us == 0) {
+    sample->t_us = esp_timer_get_time();
+  }
+  sample->seq = t->seq++;
+  __atomic_store_n(&sample->refs, 1 + n_subs, __ATOMIC_RELAXED);
+  t->published++;
+  for (size_t i = 0; i < n_subs; i++) {
+    pubsub_sub_t *sub = &t->subs[i];
+    if (ring_free(&sub->ring) >= sizeof(sample)) {
+      ring_write(&sub->ring, &sample, sizeof(sample));
+      if (sub->task != NULL) {
+        xTaskNotifyGive(sub->task);
+      }
+    } else {
+      sub->dropped++;
+      pubsub_release(sample);
+    }
+  }
+  pubsub_release(sample);
+}
+
+pubsub_sample_t *pubsub_receive(pubsub_sub_t *sub) {
+  pubsub_sample_t *sample;
+  if (ring_read(&sub->ring, &sample, sizeof(sample)) != sizeof(sample)) {
+    return NULL;
+  }
+  sub->delivered++;
+  metrics_record(sub->topic->latency_us, esp_timer_get_time() - sample->t_us);
+  return sample;
+}
+
+size_t pubsub_topic_count(void) {
+  return __atomic_load_n(&n_topics, __ATOMIC_ACQUIRE);
+}
+
+// Die Zähler werden ohne Sperre gelesen und können gegeneinander um ein
+// Sample versetzt sein; für eine Statistik reicht das
+bool pubsub_get_stats(size_t index, pubsub_stats_t *out) {
+  if (index >= pubsub_topic_count()) {
+    return false;
+  }
+  pubsub_topic_t *t = &topics[index];
+  uint32_t free_bufs = 0;
+  for (size_t w = 0; w < POOL_WORDS; w++) {
+    free_bufs += __builtin_popcount(
+        __atomic_load_n(&t->free[w], __ATOMIC_RELAXED));
+  }
+  *out = (pubsub_stats_t){
+      .name = t->name,
+      .published = t->published,
+      .no_buffer = t->no_buffer,
+      .in_use = t->pool_size - free_bufs,
+      .pool_size = t->pool_size,
+      .n_subs = __atomic_load_n(&t->n_subs, __ATOMIC_ACQUIRE),
+  };
+  for (size_t i = 0; i < out->n_subs; i++) {
+    out->subs[i].name = t->subs[i].name;
+    out->subs[i].delivered = t->subs[i].delivered;
+    out->subs[i].dropped = t->subs[i].dropped;
+  }
+  return true;
+}
+
+void pubsub_print_stats(FILE *out) {
+  int64_t now = esp_timer_get_time();
+  pubsub_stats_t st;
+  for (size_t i = 0; pubsub_get_stats(i, &st); i++) {
+    pubsub_topic_t *t = &topics[i];
+    int64_t elapsed = now - t->last_print_us;
+    float rate = elapsed > 0 ? (st.published - t->last_published) * 1e6f /
+                                   elapsed
+                             : 0;
+    t->last_published = st.published;
+    t->last_print_us = now;
+
+    metrics_value_t lat;
+    metrics_snapshot(t->latency_us, &lat);
+    fprintf(out,
+            "%-8s %7.1f/s pool %lu/%lu nobuf %lu lat p50=%lu p99=%lu "
+            "max=%lld us\n",
+            st.name, rate, (unsigned long)st.in_use,
+            (unsigned long)st.pool_size, (unsigned long)st.no_buffer,
+            (unsigned long)metrics_percentile(&lat, 50),
+            (unsigned long)metrics_percentile(&lat, 99), (long long)lat.max);
+    if (st.n_subs > 0) {
+      fprintf(out, "%-8s drop", "");
+      for (size_t s = 0; s < st.n_subs; s++) {
+        fprintf(out, " %s=%lu", st.subs[s].name,
+                (unsigned long)st.subs[s].dropped);
+      }
+      fprintf(out, "\n");
+    }
+  }
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+Publish/Subscribe-Bus für Messwerte innerhalb der Firmware, ohne Kopieren.
+
+Jedes Topic hat beim Anlegen einen festen Vorrat (Pool) gleich großer
+Sample-Puffer bekommen. Der Erzeuger holt sich mit pubsub_alloc() einen
+Puffer, schreibt die Messung direkt hinein und übergibt ihn mit
+pubsub_publish(). Jeder Abonnent hat einen eigenen Ring
+(components/ring_buffer), in dem nur Zeiger auf die Samples liegen; alle
+Abonnenten lesen denselben Puffer. Ein Referenzzähler im Sample zählt mit,
+wer es noch braucht, der letzte pubsub_release() gibt es an den Pool zurück.
+
+Ohne Sperren:
+
+  Pool     Belegung als Bitmaske, pubsub_alloc und pubsub_release mit
+           atomarem fetch_and/fetch_or, aus beliebig vielen Tasks auf beiden
+           Kernen
+  Ringe    genau ein Schreiber (der Erzeuger des Topics) und ein Leser (der
+           Abonnent)
+
+Pro Topic darf daher nur eine Task veröffentlichen. Abonniert wird beim
+Start, bevor der Erzeuger läuft.
+
+Ist der Ring eines Abonnenten voll, fehlt das Sample nur bei ihm (dropped),
+ein langsames Display hält also den Logger nicht auf. Ist der Pool leer,
+liefert pubsub_alloc() NULL und das Sample fehlt überall (no_buffer). Der
+Pool muss deshalb mehr Puffer haben, als alle Abonnenten zusammen
+gleichzeitig festhalten.
+
+Ein Abonnent mit `wake` wird bei jedem Sample per Task-Notification
+geweckt; eine Task kann mehrere Topics abonnieren und wartet mit
+pubsub_wait() auf alle gleichzeitig. Ohne `wake` holt der Abonnent die
+Samples in seinem eigenen Takt ab (z.B. ein Display mit seiner Bildrate)
+und spart bei einer 1-kHz-IMU tausend Kontextwechsel pro Sekunde.
+
+Die Latenz vom Messzeitpunkt (t_us) bis zur Auslieferung mit
+pubsub_receive() landet pro Topic als Histogramm "bus.<topic>_us" in
+components/metrics.
+*/
+
+#define PUBSUB_MAX_TOPICS 8
+#define PUBSUB_MAX_SUBSCRIBERS 4 // pro Topic
+#define PUBSUB_MAX_POOL 128      // Puffer pro Topic
+#define PUBSUB_MAX_NAME 12
+
+typedef struct pubsub_topic pubsub_topic_t;
+typedef struct pubsub_sub pubsub_sub_t;
+
+typedef struct {
+  pubsub_topic_t *topic;
+  int64_t t_us;  // Messzeitpunkt (esp_timer_get_time()), 0 = beim Publish
+  uint32_t seq;  // laufende Nummer pro Topic, setzt pubsub_publish
+  uint32_t refs; // intern
+  uint8_t index; // intern, Platz im Pool
+  uint8_t data[] __attribute__((aligned(4)));
+} pubsub_sample_t;
+
+typedef struct {
+  const char *name;
+  uint32_t published;
+  uint32_t no_buffer; // Pool leer, Sample nicht veröffentlicht
+  uint32_t in_use;    // gerade belegte Puffer
+  uint32_t pool_size;
+  size_t n_subs;
+  struct {
+    const char *name;
+    uint32_t delivered; // mit pubsub_receive abgeholt
+    uint32_t dropped;   // Ring voll
+  } subs[PUBSUB_MAX_SUBSCRIBERS];
+} pubsub_stats_t;
+
+// Legt ein Topic mit `pool_size` Puffern zu je `sample_size` Bytes an. Der
+// Speicher kommt einmalig vom Heap. `name` wird kopiert.
+esp_err_t pubsub_topic_create(const char *name, size_t sample_size,
+                              size_t pool_size, pubsub_topic_t **out);
+
+// Abonniert ein Topic für die aufrufende Task. Mit `wake` bekommt sie bei
+// jedem neuen Sample eine Notification. `depth` Samples passen in den Ring
+// (Zweierpotenz). `name` ist nur für die Statistik und muss statisch sein.
+esp_err_t pubsub_subscribe(pubsub_topic_t *topic, const char *name,
+                           size_t depth, bool wake, pubsub_sub_t **out);
+
+// Erzeuger: freier Puffer oder NULL, wenn der Pool leer ist
+pubsub_sample_t *pubsub_alloc(pubsub_topic_t *topic);
+
+// Erzeuger: übergibt das Sample an alle Abonnenten. Danach gehört es dem
+// Bus, der Erzeuger darf es nicht mehr anfassen.
+void pubsub_publish(pubsub_sample_t *sample);
+
+// Abonnent: nächstes Sample oder NULL. Jedes Sample muss mit
+// pubsub_release zurückgegeben werden, auch wenn es nicht gebraucht wird.
+pubsub_sample_t *pubsub_receive(pubsub_sub_t *sub);
+
+void pubsub_release(pubsub_sample_t *sample);
+
+// Wartet höchstens `timeout` Ticks auf neue Samples in irgendeinem
+// Abonnement der aufrufenden Task. Verbraucht die Task-Notification.
+static inline void pubsub_wait(TickType_t timeout) {
+  ulTaskNotifyTake(pdTRUE, timeout);
+}
+
+// Erst Topics anlegen, dann darüber iterieren
+size_t pubsub_topic_count(void);
+bool pubsub_get_stats(size_t index, pubsub_stats_t *out);
+
+// Eine Zeile pro Topic: Rate seit dem letzten Aufruf, belegte Puffer,
+// Latenz und die verworfenen Samples jedes Abonnenten, z. B.
+//   imu     1000.0/s pool 6/64 nobuf 0 lat p50=511 p99=2047 max=1840 us
+//           drop lcd=0 log=0 uart=12
+void pubsub_print_stats(FILE *out);
@@ -0,0 +1,141 @@
+/*
+Host tests for the SPSC ring buffer (ring_buffer.c): wrap-around, overflow
+and the zero-copy pointers at the buffer end.
+
+  gcc -O2 -Wall -I.. -o ring_check ring_check.c ../ring_buffer.c
+  ./ring_check
+
+head and tail count bytes monotonically; one case starts them just below
+SIZE_MAX so that the counters themselves wrap during the test.
+*/
+
+#include "ring_buffer.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define SIZE 16
+
+static int failures;
+
+static void check(int ok, const char *what) {
+  if (!ok) {
+    printf("FAIL %s\n", what);
+    failures++;
+  }
+}
+
+static void fill(uint8_t *p, size_t n, uint8_t first) {
+  for (size_t i = 0; i < n; i++) {
+    p[i] = first + i;
+  }
+}
+
+static int is_sequence(const uint8_t *p, size_t n, uint8_t first) {
+  for (size_t i = 0; i < n; i++) {
+    if (p[i] != (uint8_t)(first + i)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+static void test_wrap(void) {
+  uint8_t mem[SIZE], in[SIZE * 2], out[SIZE * 2];
+  ring_buffer_t ring;
+  ring_init(&ring, mem, SIZE);
+
+  fill(in, 10, 0);
+  check(ring_write(&ring, in, 10) == 10, "write 10");
+  check(ring_read(&ring, out, 6) == 6 && is_sequence(out, 6, 0), "read 6");
+
+  // 10 more: 6 up to the end, 4 from the start
+  fill(in, 10, 10);
+  check(ring_write(&ring, in, 10) == 10, "write across the end");
+  check(ring_used(&ring) == 14 && ring_free(&ring) == 2, "used/free");
+
+  size_t contiguous;
+  const uint8_t *p = ring_read_ptr(&ring, &contiguous);
+  check(p == &mem[6] && contiguous == 10, "read_ptr stops at the end");
+  check(ring_read(&ring, out, 14) == 14 && is_sequence(out, 14, 6),
+        "read across the end");
+  check(ring_used(&ring) == 0, "empty after read");
+
+  uint8_t *w = ring_write_ptr(&ring, &contiguous);
+  check(w == &mem[4] && contiguous == 12, "write_ptr after wrap");
+}
+
+static void test_overflow(void) {
+  uint8_t mem[SIZE], in[SIZE * 2], out[SIZE * 2];
+  ring_buffer_t ring;
+  ring_init(&ring, mem, SIZE);
+
+  fill(in, sizeof(in), 0);
+  check(ring_write(&ring, in, sizeof(in)) == SIZE, "overflow writes only size");
+  check(ring_free(&ring) == 0, "full");
+  check(ring_write(&ring, in, 1) == 0, "write into full ring");
+
+  size_t contiguous;
+  check(ring_write_ptr(&ring, &contiguous) && contiguous == 0,
+        "write_ptr of full ring");
+  check(ring_read(&ring, out, sizeof(out)) == SIZE &&
+            is_sequence(out, SIZE, 0),
+        "overflow kept the oldest bytes");
+  check(ring_read(&ring, out, 1) == 0, "read from empty ring");
+  ring_read_ptr(&ring, &contiguous);
+  check(contiguous == 0, "read_ptr of empty ring");
+}
+
+static void test_counter_wrap(void) {
+  uint8_t mem[SIZE], in[SIZE], out[SIZE];
+  ring_buffer_t ring;
+  ring_init(&ring, mem, SIZE);
+  atomic_store(&ring.head, SIZE_MAX - 5);
+  atomic_store(&ring.tail, SIZE_MAX - 5);
+
+  uint8_t next = 0;
+  for (int round = 0; round < 4; round++) {
+    fill(in, 12, next);
+    check(ring_write(&ring, in, 12) == 12, "write around SIZE_MAX");
+    check(ring_used(&ring) == 12, "used around SIZE_MAX");
+    check(ring_read(&ring, out, 12) == 12 && is_sequence(out, 12, next),
+          "read around SIZE_MAX");
+    next += 12;
+  }
+}
+
+// Zero-copy use: the writer fills the ring through write_ptr in odd-sized
+// pieces, the reader consumes through read_ptr
+static void test_zero_copy(void) {
+  uint8_t mem[SIZE];
+  ring_buffer_t ring;
+  ring_init(&ring, mem, SIZE);
+  uint8_t wnext = 0, rnext = 0;
+  int ok = 1;
+  for (int i = 0; i < 1000; i++) {
+    size_t contiguous;
+    uint8_t *w = ring_write_ptr(&ring, &contiguous);
+    size_t n = contiguous < (size_t)(i % 7) ? contiguous : (size_t)(i % 7);
+    fill(w, n, wnext);
+    wnext += n;
+    ring_write_commit(&ring, n);
+
+    const uint8_t *r = ring_read_ptr(&ring, &contiguous);
+    n = contiguous < (size_t)(i % 5) ? contiguous : (size_t)(i % 5);
+    ok &= is_sequence(r, n, rnext);
+    rnext += n;
+    ring_read_commit(&ring, n);
+    ok &= ring_used(&ring) == (uint8_t)(wnext - rnext);
+  }
+  check(ok, "zero-copy pieces");
+}
+
+int main(void) {
+  test_wrap();
+  test_overflow();
+  test_counter_wrap();
+  test_zero_copy();
+  printf("%s\n", failures ? "FAILED" : "ok");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,88 @@
+#include "ring_buffer.h"
+
+#include <string.h>
+
+void ring_init(ring_buffer_t *ring, uint8_t *mem, size_t size) {
+  ring->buf = mem;
+  ring->size = size;
+  ring_reset(ring);
+}
+
+void ring_reset(ring_buffer_t *ring) {
+  atomic_store(&ring->head, 0);
+  atomic_store(&ring->tail, 0);
+}
+
+size_t ring_used(const ring_buffer_t *ring) {
+  return atomic_load_explicit(&ring->head, memory_order_acquire) -
+         atomic_load_explicit(&ring->tail, memory_order_acquire);
+}
+
+size_t ring_free(const ring_buffer_t *ring) {
+  return ring->size - ring_used(ring);
+}
+
+uint8_t *ring_write_ptr(ring_buffer_t *ring, size_t *contiguous) {
+  size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+  size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+  size_t offset = head & (ring->size - 1);
+  size_t free = ring->size - (head - tail);
+  size_t to_end = ring->size - offset;
+  *contiguous = free < to_end ? free : to_end;
+  return &ring->buf[offset];
+}
+
+void ring_write_commit(ring_buffer_t *ring, size_t n) {
+  atomic_fetch_add_explicit(&ring->head, n, memory_order_release);
+}
+
+size_t ring_write(ring_buffer_t *ring, const void *src, size_t n) {
+  const uint8_t *in = src;
+  size_t done = 0;
+
+  while (done < n) {
+    size_t contiguous;
+    uint8_t *dst = ring_write_ptr(ring, &contiguous);
+    if (contiguous == 0) {
+      break;
+    }
+    size_t chunk = n - done < contiguous ? n - done : contiguous;
+    memcpy(dst, &in[done], chunk);
+    ring_write_commit(ring, chunk);
+    done += chunk;
+  }
+  return done;
+}
+
+const uint8_t *ring_read_ptr(const ring_buffer_t *ring, size_t *contiguous) {
+  size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+  size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+  size_t offset = tail & (ring->size - 1);
+  size_t used = head - tail;
+  size_t to_end = ring->size - offset;
+  *contiguous = used < to_end ? used : to_end;
+  return &ring->buf[offset];
+}
+
+void ring_read_commit(ring_buffer_t *ring, size_t n) {
+  atomic_fetch_add_explicit(&ring->tail, n, memory_order_release);
+}
+
+size_t ring_read(ring_buffer_t *ring, void *dst, size_t n) {
+  uint8_t *out = dst;
+  size_t done = 0;
+
+  // Höchstens zwei Durchläufe: bis zum Pufferende und ab dem Anfang
+  while (done < n) {
+    size_t contiguous;
+    const uint8_t *src = ring_read_ptr(ring, &contiguous);
+    if (contiguous == 0) {
+      break;
+    }
+    size_t chunk = n - done < contiguous ? n - done : contiguous;
+    memcpy(&out[done], src, chunk);
+    ring_read_commit(ring, chunk);
+    done += chunk;
+  }
+  return done;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Lock-freier Ringpuffer für genau einen Schreiber und einen Leser (SPSC).
+// head/tail zählen monoton hoch, die Größe muss eine Zweierpotenz sein. Über
+// ring_write_ptr/ring_read_ptr kann direkt in bzw. aus dem Speicher gelesen
+// werden, ohne Zwischenkopie.
+typedef struct {
+  uint8_t *buf;
+  size_t size;
+  atomic_size_t head; // geschriebene Bytes insgesamt
+  atomic_size_t tail; // gelesene Bytes insgesamt
+} ring_buffer_t;
+
+void ring_init(ring_buffer_t *ring, uint8_t *mem, size_t size);
+void ring_reset(ring_buffer_t *ring);
+
+size_t ring_used(const ring_buffer_t *ring);
+size_t ring_free(const ring_buffer_t *ring);
+
+// Schreiber: zusammenhängender freier Bereich ab der Schreibposition
+uint8_t *ring_write_ptr(ring_buffer_t *ring, size_t *contiguous);
+void ring_write_commit(ring_buffer_t *ring, size_t n);
+
+// Kopiert bis zu n Bytes hinein (auch über das Pufferende hinweg)
+size_t ring_write(ring_buffer_t *ring, const void *src, size_t n);
+
+// Leser: zusammenhängender belegter Bereich ab der Leseposition
+const uint8_t *ring_read_ptr(const ring_buffer_t *ring, size_t *contiguous);
+void ring_read_commit(ring_buffer_t *ring, size_t n);
+
+// Kopiert bis zu n Bytes heraus (auch über das Pufferende hinweg)
+size_t ring_read(ring_buffer_t *ring, void *dst, size_t n);
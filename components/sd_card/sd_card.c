@@ -0,0 +1,61 @@
+#include "sd_card.h"
+
+#include "driver/spi_master.h"
+#include "esp_log.h"
+#include "esp_vfs_fat.h"
+#include "sdmmc_cmd.h"
+
+// SD-Karten SPI Pinbelegung, wie im gif-Projekt
+#define PIN_SD_SS 45  // Chip Select
+#define PIN_SD_DI 48  // MOSI
+#define PIN_SD_DO 47  // MISO
+#define PIN_SD_SCK 21 // SCK
+
+static const char *TAG = "sd_card";
+
+esp_err_t init_sd_card(void) {
+  esp_err_t ret;
+
+  esp_vfs_fat_sdmmc_mount_config_t mount_config = {
+      .format_if_mount_failed = false,
+      .max_files = 5,
+      .allocation_unit_size = 16 * 1024,
+  };
+  sdmmc_card_t *card;
+
+  spi_bus_config_t bus_cfg = {
+      .mosi_io_num = PIN_SD_DI,
+      .miso_io_num = PIN_SD_DO,
+      .sclk_io_num = PIN_SD_SCK,
+      .quadwp_io_num = -1,
+      .quadhd_io_num = -1,
+      // Groß genug für einen kompletten Lese-Chunk des speaker-Players
+      .max_transfer_sz = 4096,
+  };
+  ret = spi_bus_initialize(SPI2_HOST, &bus_cfg, SDSPI_DEFAULT_DMA);
+  if (ret != ESP_OK) {
+    ESP_LOGE(TAG, "SPI Bus Initialisierung fehlgeschlagen (%s)",
+             esp_err_to_name(ret));
+    return ret;
+  }
+
+  sdspi_device_config_t slot_config = SDSPI_DEVICE_CONFIG_DEFAULT();
+  slot_config.gpio_cs = PIN_SD_SS;
+  slot_config.host_id = SPI2_HOST;
+
+  sdmmc_host_t host = SDSPI_HOST_DEFAULT();
+  host.slot = SPI2_HOST;
+
+  ret = esp_vfs_fat_sdspi_mount(SD_MOUNT_POINT, &host, &slot_config,
+                                &mount_config, &card);
+  if (ret != ESP_OK) {
+    ESP_LOGE(TAG, "Mounten der SD-Karte fehlgeschlagen (%s)",
+             esp_err_to_name(ret));
+    spi_bus_free(SPI2_HOST);
+    return ret;
+  }
+
+  ESP_LOGI(TAG, "SD-Karte erfolgreich gemountet.");
+  sdmmc_card_print_info(stdout, card);
+  return ESP_OK;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "esp_err.h"
+
+#define SD_MOUNT_POINT "/sdcard"
+
+// Mountet die SD-Karte per SPI2 unter SD_MOUNT_POINT (gleiche Verdrahtung wie
+// im gif-Projekt). Genutzt von speaker, sdlog und sensor_hub.
+esp_err_t init_sd_card(void);
@@ -0,0 +1,153 @@
+/*
+Liest eine Datei des SD-Loggers auf dem PC und gibt die Datensätze als CSV
+aus (Zeit in µs seit dem Öffnen, Stream, Daten als Hex). Am Ende steht auf
+stderr eine Zusammenfassung aus dem Footer bzw. aus den gelesenen Blöcken,
+wenn die Datei nicht geschlossen wurde.
+
+  gcc -O2 -Wall -I.. -o sd_logger_dump sd_logger_dump.c
+  ./sd_logger_dump log0001.bin > log.csv
+  ./sd_logger_dump -s imu log0001.bin   # nur ein Stream
+*/
+
+#include "sd_logger_format.h"
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static uint32_t get32(const uint8_t *p) {
+  return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+int main(int argc, char **argv) {
+  const char *only = NULL;
+  int opt;
+  while ((opt = getopt(argc, argv, "s:")) != -1) {
+    if (opt == 's') {
+      only = optarg;
+    } else {
+      return 2;
+    }
+  }
+  if (optind != argc - 1) {
+    fprintf(stderr, "Aufruf: %s [-s stream] datei.bin\n", argv[0]);
+    return 2;
+  }
+  FILE *f = fopen(argv[optind], "rb");
+  if (!f) {
+    perror(argv[optind]);
+    return 1;
+  }
+
+  uint8_t sector[SDL_SECTOR];
+  sdl_header_t h;
+  if (fread(sector, 1, SDL_SECTOR, f) != SDL_SECTOR) {
+    fprintf(stderr, "Datei zu kurz\n");
+    return 1;
+  }
+  memcpy(&h, sector, sizeof(h));
+  if (h.magic != SDL_MAGIC || h.version != SDL_VERSION ||
+      h.block_size % SDL_SECTOR != 0 || h.block_size == 0 ||
+      h.n_streams > SDL_MAX_STREAMS) {
+    fprintf(stderr, "Kein SD-Logger-Format (Version %d)\n", SDL_VERSION);
+    return 1;
+  }
+  int only_id = 0;
+  for (int i = 0; i < h.n_streams; i++) {
+    h.streams[i][SDL_STREAM_NAME - 1] = 0;
+    if (only && strcmp(only, h.streams[i]) == 0) {
+      only_id = i + 1;
+    }
+  }
+  if (only && !only_id) {
+    fprintf(stderr, "Stream %s nicht in der Datei\n", only);
+    return 1;
+  }
+
+  uint8_t *block = malloc(h.block_size);
+  if (!block) {
+    return 1;
+  }
+  uint32_t blocks = 0;
+  uint64_t records = 0;
+  uint32_t bad = 0;
+  printf("t_us,stream,data\n");
+  while (blocks < h.max_blocks &&
+         fread(block, 1, h.block_size, f) == h.block_size) {
+    sdl_block_header_t b;
+    memcpy(&b, block, sizeof(b));
+    // Dahinter steht der Footer oder Inhalt einer früheren Datei
+    if (b.magic != SDL_BLOCK_MAGIC || b.file_id != h.file_id ||
+        b.seq != blocks) {
+      break;
+    }
+    blocks++;
+
+    const uint8_t *p = block + sizeof(b);
+    const uint8_t *end = p + b.used;
+    if (b.used > h.block_size - sizeof(b)) {
+      bad++;
+      continue;
+    }
+    for (uint32_t r = 0; r < b.records; r++) {
+      if (end - p < SDL_RECORD_HEADER || end - p < SDL_RECORD_HEADER + p[1] ||
+          p[0] == 0 || p[0] > h.n_streams) {
+        bad++;
+        break;
+      }
+      uint8_t stream = p[0], len = p[1];
+      int64_t t = b.t0_us + (int32_t)get32(&p[2]) - h.start_us;
+      if (!only_id || stream == only_id) {
+        printf("%" PRId64 ",%s,", t, h.streams[stream - 1]);
+        for (int i = 0; i < len; i++) {
+          printf("%02x", p[SDL_RECORD_HEADER + i]);
+        }
+        printf("\n");
+      }
+      records++;
+      p += SDL_RECORD_HEADER + len;
+    }
+  }
+
+  // Der Footer liegt im letzten Sektor der Datei
+  sdl_footer_t foot;
+  bool closed = fseek(f, -SDL_SECTOR, SEEK_END) == 0 &&
+                fread(sector, 1, SDL_SECTOR, f) == SDL_SECTOR;
+  memcpy(&foot, sector, sizeof(foot));
+  closed = closed && foot.magic == SDL_FOOTER_MAGIC &&
+           foot.file_id == h.file_id;
+
+  fprintf(stderr, "%" PRIu32 " Blöcke zu %" PRIu32 " Bytes, %" PRIu64
+                  " Datensätze\n",
+          blocks, h.block_size, records);
+  if (bad) {
+    fprintf(stderr, "%" PRIu32 " beschädigte Blöcke\n", bad);
+  }
+  if (!closed) {
+    fprintf(stderr, "Kein Footer, Datei wurde nicht geschlossen\n");
+    return 0;
+  }
+  if (foot.blocks != blocks) {
+    fprintf(stderr, "Footer nennt %" PRIu32 " Blöcke\n", foot.blocks);
+  }
+  fprintf(stderr, "verworfen %" PRIu32 ", Schreibzugriff max %" PRIu32
+                  " us, Mittel %" PRIu32 " us\n",
+          foot.dropped, foot.write_us_max, foot.write_us_avg);
+  for (int i = 0; i < h.n_streams; i++) {
+    sdl_stream_info_t *s = &foot.streams[i];
+    double span = (s->last_us - s->first_us) / 1e6;
+    fprintf(stderr, "  %-16s %8" PRIu32 " Datensätze", h.streams[i],
+            s->records);
+    if (s->records > 1 && span > 0) {
+      fprintf(stderr, " in %.1f s (%.1f Hz)", span,
+              (s->records - 1) / span);
+    }
+    fprintf(stderr, "\n");
+  }
+  free(block);
+  fclose(f);
+  return 0;
+}
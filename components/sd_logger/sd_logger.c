@@ -0,0 +1,340 @@
+#include "sd_logger.h"
+
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "esp_vfs_fat.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define WRITER_STACK 3072
+// Über der Anwendung, unter den Mess-Tasks: die Schreib-Task wartet fast
+// nur auf die Karte
+#define WRITER_PRIORITY 5
+
+#define BLOCK_HEADER sizeof(sdl_block_header_t)
+
+static const char *TAG = "sd_logger";
+
+struct sd_logger {
+  int fd;
+  size_t block_size;
+  uint32_t file_id;
+  uint8_t *buf[2];
+
+  // Nur unter `lock`
+  portMUX_TYPE lock;
+  int fill;          // Puffer, in den die Erzeuger schreiben
+  int pending;       // Puffer, der auf die Karte wartet, sonst -1
+  size_t pos;        // 0 = Block noch nicht angefangen
+  uint32_t next_seq; // Nummer des nächsten Blocks
+  uint32_t seq;      // Nummer des angefangenen Blocks
+  uint32_t records;  // im angefangenen Block
+  int64_t t0_us;     // des angefangenen Blocks
+  bool stopping;
+  size_t n_streams;
+  sdl_stream_info_t streams[SDL_MAX_STREAMS];
+  sd_logger_stats_t stats;
+
+  TaskHandle_t task;
+  SemaphoreHandle_t done;
+};
+
+static inline void put32(uint8_t *p, uint32_t v) {
+  p[0] = v;
+  p[1] = v >> 8;
+  p[2] = v >> 16;
+  p[3] = v >> 24;
+}
+
+// Schließt den angefangenen Block ab und übergibt ihn der Schreib-Task. Nur
+// unter `lock` und nur wenn kein Block mehr wartet.
+static void IRAM_ATTR hand_off(sd_logger_t *log) {
+  sdl_block_header_t h = {
+      .magic = SDL_BLOCK_MAGIC,
+      .file_id = log->file_id,
+      .seq = log->seq,
+      .used = log->pos - BLOCK_HEADER,
+      .records = log->records,
+      .t0_us = log->t0_us,
+  };
+  memcpy(log->buf[log->fill], &h, sizeof(h));
+  log->pending = log->fill;
+  log->fill ^= 1;
+  log->pos = 0;
+}
+
+esp_err_t IRAM_ATTR sd_logger_write(sd_logger_t *log, uint8_t stream,
+                                    int64_t t_us, const void *data,
+                                    size_t len) {
+  if (stream == 0 || stream > log->n_streams || len > SDL_MAX_DATA) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  size_t need = SDL_RECORD_HEADER + len;
+  bool wake = false;
+  esp_err_t ret = ESP_OK;
+
+  portENTER_CRITICAL_SAFE(&log->lock);
+  if (log->stopping) {
+    portEXIT_CRITICAL_SAFE(&log->lock);
+    return ESP_ERR_INVALID_STATE;
+  }
+  // dt muss in 32 Bit passen, sonst beginnt ein neuer Block (nur bei
+  // Streams, die seltener als alle 35 Minuten schreiben)
+  int64_t dt = t_us - log->t0_us;
+  if (log->pos > 0 && log->pending < 0 &&
+      (log->pos + need > log->block_size || dt > INT32_MAX ||
+       dt < INT32_MIN)) {
+    hand_off(log);
+    wake = true;
+  }
+  if (log->pos == 0 && log->next_seq < log->stats.max_blocks) {
+    log->seq = log->next_seq++;
+    log->pos = BLOCK_HEADER;
+    log->records = 0;
+    log->t0_us = t_us;
+  }
+  dt = t_us - log->t0_us;
+  if (log->pos > 0 && log->pos + need <= log->block_size &&
+      dt <= INT32_MAX && dt >= INT32_MIN) {
+    uint8_t *p = log->buf[log->fill] + log->pos;
+    p[0] = stream;
+    p[1] = len;
+    put32(&p[2], (uint32_t)(int32_t)dt);
+    memcpy(&p[SDL_RECORD_HEADER], data, len);
+    log->pos += need;
+    log->records++;
+
+    sdl_stream_info_t *s = &log->streams[stream - 1];
+    if (s->records++ == 0) {
+      s->first_us = t_us;
+    }
+    s->last_us = t_us;
+    log->stats.records++;
+  } else {
+    // Zweiter Puffer noch nicht auf der Karte oder Datei voll
+    log->stats.dropped++;
+    ret = ESP_ERR_NO_MEM;
+  }
+  portEXIT_CRITICAL_SAFE(&log->lock);
+
+  if (wake) {
+    if (xPortInIsrContext()) {
+      BaseType_t woken = pdFALSE;
+      vTaskNotifyGiveFromISR(log->task, &woken);
+      portYIELD_FROM_ISR(woken);
+    } else {
+      xTaskNotifyGive(log->task);
+    }
+  }
+  return ret;
+}
+
+// Schreibt einen übergebenen Block an seine Position in der Datei
+static void write_block(sd_logger_t *log, int index) {
+  uint8_t *b = log->buf[index];
+  sdl_block_header_t h;
+  memcpy(&h, b, sizeof(h));
+  // Rest auffüllen, damit keine alten Datensätze im Block stehen bleiben
+  memset(b + BLOCK_HEADER + h.used, 0,
+         log->block_size - BLOCK_HEADER - h.used);
+
+  int64_t start = esp_timer_get_time();
+  ssize_t n = write(log->fd, b, log->block_size);
+  uint32_t us = esp_timer_get_time() - start;
+
+  bool ok = n == (ssize_t)log->block_size;
+  if (!ok) {
+    // Position für den nächsten Block wiederherstellen, die Lücke bleibt
+    off_t next = SDL_SECTOR + (off_t)(h.seq + 1) * log->block_size;
+    lseek(log->fd, next, SEEK_SET);
+  }
+
+  portENTER_CRITICAL(&log->lock);
+  log->stats.blocks++;
+  log->stats.write_us_sum += us;
+  if (us > log->stats.write_us_max) {
+    log->stats.write_us_max = us;
+  }
+  if (!ok) {
+    log->stats.write_errors++;
+  }
+  portEXIT_CRITICAL(&log->lock);
+}
+
+static void writer(void *arg) {
+  sd_logger_t *log = arg;
+  while (1) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    // `pending` setzt nur sd_logger_write, und nur wenn er -1 ist
+    if (log->pending >= 0) {
+      write_block(log, log->pending);
+      portENTER_CRITICAL(&log->lock);
+      log->pending = -1;
+      portEXIT_CRITICAL(&log->lock);
+    }
+    if (log->stopping) {
+      break;
+    }
+  }
+  xSemaphoreGive(log->done);
+  vTaskDelete(NULL);
+}
+
+static void destroy(sd_logger_t *log) {
+  if (log->fd >= 0) {
+    close(log->fd);
+  }
+  if (log->done) {
+    vSemaphoreDelete(log->done);
+  }
+  heap_caps_free(log->buf[0]);
+  heap_caps_free(log->buf[1]);
+  free(log);
+}
+
+esp_err_t sd_logger_open(const sd_logger_config_t *config, sd_logger_t **out) {
+  size_t block_size =
+      config->block_size ? config->block_size : SD_LOGGER_BLOCK_SIZE;
+  if (!config->base_path || !config->path || config->n_streams == 0 ||
+      config->n_streams > SDL_MAX_STREAMS || block_size % SDL_SECTOR != 0 ||
+      block_size < BLOCK_HEADER + SDL_RECORD_HEADER + SDL_MAX_DATA) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  // Header- und Footer-Sektor plus mindestens ein Block
+  if (config->size < 2 * SDL_SECTOR + block_size) {
+    return ESP_ERR_INVALID_SIZE;
+  }
+
+  sd_logger_t *log = calloc(1, sizeof(*log));
+  if (!log) {
+    return ESP_ERR_NO_MEM;
+  }
+  log->fd = -1;
+  log->block_size = block_size;
+  log->file_id = esp_random();
+  log->pending = -1;
+  log->n_streams = config->n_streams;
+  log->stats.max_blocks = (config->size - 2 * SDL_SECTOR) / block_size;
+  portMUX_INITIALIZE(&log->lock);
+
+  // Die SPI-Übertragung zur Karte läuft per DMA direkt aus den Puffern
+  for (int i = 0; i < 2; i++) {
+    log->buf[i] = heap_caps_aligned_alloc(
+        4, block_size, MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA);
+  }
+  log->done = xSemaphoreCreateBinary();
+  if (!log->buf[0] || !log->buf[1] || !log->done) {
+    destroy(log);
+    return ESP_ERR_NO_MEM;
+  }
+
+  // Eine vorhandene Datei lässt sich nicht zusammenhängend vergrößern
+  unlink(config->path);
+  uint64_t size =
+      2 * SDL_SECTOR + (uint64_t)log->stats.max_blocks * block_size;
+  esp_err_t err = esp_vfs_fat_create_contiguous_file(
+      config->base_path, config->path, size, true);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "%s: %" PRIu64 " Bytes nicht zusammenhängend frei (%s)",
+             config->path, size, esp_err_to_name(err));
+    destroy(log);
+    return err;
+  }
+  // Ohne O_TRUNC, sonst gibt FatFs die Cluster wieder frei
+  log->fd = open(config->path, O_WRONLY);
+  if (log->fd < 0) {
+    destroy(log);
+    return ESP_FAIL;
+  }
+
+  sdl_header_t h = {
+      .magic = SDL_MAGIC,
+      .version = SDL_VERSION,
+      .n_streams = config->n_streams,
+      .file_id = log->file_id,
+      .block_size = block_size,
+      .max_blocks = log->stats.max_blocks,
+      .start_us = esp_timer_get_time(),
+  };
+  for (size_t i = 0; i < config->n_streams; i++) {
+    strlcpy(h.streams[i], config->streams[i], SDL_STREAM_NAME);
+  }
+  memset(log->buf[0], 0, SDL_SECTOR);
+  memcpy(log->buf[0], &h, sizeof(h));
+  if (write(log->fd, log->buf[0], SDL_SECTOR) != SDL_SECTOR) {
+    destroy(log);
+    return ESP_FAIL;
+  }
+
+  if (xTaskCreate(writer, "sd_logger", WRITER_STACK, log, WRITER_PRIORITY,
+                  &log->task) != pdPASS) {
+    destroy(log);
+    return ESP_ERR_NO_MEM;
+  }
+  ESP_LOGI(TAG, "%s: %lu Blöcke zu %u Bytes", config->path,
+           (unsigned long)log->stats.max_blocks, (unsigned)block_size);
+  *out = log;
+  return ESP_OK;
+}
+
+sd_logger_stats_t sd_logger_get_stats(sd_logger_t *log) {
+  portENTER_CRITICAL(&log->lock);
+  sd_logger_stats_t s = log->stats;
+  portEXIT_CRITICAL(&log->lock);
+  return s;
+}
+
+esp_err_t sd_logger_close(sd_logger_t *log, sd_logger_stats_t *stats) {
+  // Ab hier nimmt sd_logger_write nichts mehr an, die Task schreibt den
+  // wartenden Block noch und beendet sich
+  portENTER_CRITICAL(&log->lock);
+  log->stopping = true;
+  portEXIT_CRITICAL(&log->lock);
+  xTaskNotifyGive(log->task);
+  xSemaphoreTake(log->done, portMAX_DELAY);
+
+  if (log->pos > 0) {
+    hand_off(log);
+    write_block(log, log->pending);
+  }
+
+  sd_logger_stats_t s = log->stats;
+  sdl_footer_t f = {
+      .magic = SDL_FOOTER_MAGIC,
+      .file_id = log->file_id,
+      .blocks = log->next_seq,
+      .dropped = s.dropped,
+      .write_us_max = s.write_us_max,
+      .write_us_avg = s.blocks ? s.write_us_sum / s.blocks : 0,
+  };
+  memcpy(f.streams, log->streams, sizeof(f.streams));
+  memset(log->buf[0], 0, SDL_SECTOR);
+  memcpy(log->buf[0], &f, sizeof(f));
+
+  esp_err_t err = ESP_OK;
+  off_t end = SDL_SECTOR + (off_t)log->next_seq * log->block_size;
+  if (lseek(log->fd, end, SEEK_SET) != end ||
+      write(log->fd, log->buf[0], SDL_SECTOR) != SDL_SECTOR ||
+      ftruncate(log->fd, end + SDL_SECTOR) != 0 || fsync(log->fd) != 0) {
+    err = ESP_FAIL;
+  }
+  if (close(log->fd) != 0) {
+    err = ESP_FAIL;
+  }
+  log->fd = -1;
+
+  if (stats) {
+    *stats = s;
+  }
+  destroy(log);
+  return err;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "esp_err.h"
+#include "sd_logger_format.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+Schneller Binär-Logger für Messreihen auf der SD-Karte (Format:
+sd_logger_format.h).
+
+Normales fwrite über FAT hat Ausreißer von vielen Millisekunden, wenn neue
+Cluster gesucht und die FAT aktualisiert werden muss. Der Logger legt die
+Datei deshalb beim Öffnen in voller Größe zusammenhängend an
+(esp_vfs_fat_create_contiguous_file) und überschreibt danach nur noch
+vorhandene Cluster. Geschrieben werden ganze Blöcke aus Vielfachen von 512
+Bytes an sektorgenauen Positionen; FatFs reicht sie damit ohne Umweg über
+seinen Sektorpuffer als Multi-Block-Schreibzugriff an die Karte weiter.
+
+Zwei Puffer wechseln sich ab: In einen schreiben die Erzeuger, der andere
+geht gleichzeitig in einer eigenen Task auf die Karte. Ist der zweite noch
+nicht geschrieben, wenn der erste voll ist, gehen Datensätze verloren und
+werden gezählt. Ein Puffer muss also länger reichen als der langsamste
+Schreibzugriff (write_us_max in den Statistiken).
+
+sd_logger_write() ist aus Tasks beider Kerne und aus ISRs erlaubt.
+*/
+
+#define SD_LOGGER_BLOCK_SIZE 16384 // Standard, Vielfaches von 512
+
+typedef struct {
+  const char *base_path; // Einhängepunkt, z.B. "/sdcard"
+  const char *path;      // z.B. "/sdcard/log0001.bin", wird überschrieben
+  uint64_t size;         // vorbelegte Dateigröße in Bytes
+  size_t block_size;     // 0 = SD_LOGGER_BLOCK_SIZE
+  // Namen der Streams, Stream-ID = Index + 1
+  const char *const *streams;
+  size_t n_streams;
+} sd_logger_config_t;
+
+typedef struct {
+  uint32_t records;
+  uint32_t dropped;      // Puffer voll oder Datei voll
+  uint32_t blocks;       // auf die Karte geschrieben
+  uint32_t max_blocks;   // Platz in der Datei
+  uint32_t write_us_max; // längster Schreibzugriff eines Blocks
+  uint64_t write_us_sum;
+  uint32_t write_errors;
+} sd_logger_stats_t;
+
+typedef struct sd_logger sd_logger_t;
+
+// Legt die Datei an, schreibt den Header und startet die Schreib-Task
+esp_err_t sd_logger_open(const sd_logger_config_t *config, sd_logger_t **out);
+
+// Hängt einen Datensatz an (len <= SDL_MAX_DATA). `t_us` ist die Zeit der
+// Messung (esp_timer_get_time()). Gibt ESP_ERR_NO_MEM zurück, wenn der
+// Datensatz verworfen wurde.
+esp_err_t sd_logger_write(sd_logger_t *log, uint8_t stream, int64_t t_us,
+                          const void *data, size_t len);
+
+sd_logger_stats_t sd_logger_get_stats(sd_logger_t *log);
+
+// Schreibt den angefangenen Block und den Footer, kürzt die Datei auf die
+// belegte Größe und gibt alles frei. `stats` darf NULL sein.
+esp_err_t sd_logger_close(sd_logger_t *log, sd_logger_stats_t *stats);
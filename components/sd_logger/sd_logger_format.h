@@ -0,0 +1,80 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+Dateiformat des SD-Loggers (little endian, unabhängig von ESP-IDF, wird
+auch von host/sd_logger_dump gelesen).
+
+  Sektor 0          sdl_header_t, Rest mit Nullen aufgefüllt
+  ab Byte 512       Datenblöcke zu je block_size Bytes (Vielfaches von 512)
+  letzter Sektor    sdl_footer_t, nur nach sd_logger_close()
+
+Jeder Datenblock beginnt mit sdl_block_header_t, danach folgen die
+Datensätze dicht hintereinander:
+
+  [stream u8][len u8][dt_us i32][daten, len Bytes]
+
+dt_us ist der Abstand zu t0_us des Blocks; bei Erzeugern auf beiden Kernen
+kann er leicht negativ sein. stream 0 kommt nicht vor, ab
+`used` ist der Block mit Nullen aufgefüllt. Ein Datensatz reicht nie über
+ein Blockende hinaus, so dass jeder Block für sich lesbar ist.
+
+Die Datei wird vorab zusammenhängend angelegt. Fehlt der Footer (Strom weg
+vor dem Schließen), ist sie noch auf die volle Größe vorbelegt: Die Blöcke
+gelten dann bis zum ersten Block mit falscher magic, file_id oder seq.
+Wegen der festen Blockgröße lässt sich über t0_us per Bisektion zu einer
+Zeit springen, ohne die Datei von vorne zu lesen.
+*/
+
+#define SDL_MAGIC 0x474C4453u        // "SDLG"
+#define SDL_BLOCK_MAGIC 0x4B4C4253u  // "SBLK"
+#define SDL_FOOTER_MAGIC 0x444E4553u // "SEND"
+#define SDL_VERSION 1
+
+#define SDL_SECTOR 512
+#define SDL_MAX_STREAMS 8
+#define SDL_STREAM_NAME 16 // inklusive abschließender Null
+#define SDL_RECORD_HEADER 6
+#define SDL_MAX_DATA 255
+
+typedef struct __attribute__((packed)) {
+  uint32_t magic;
+  uint8_t version;
+  uint8_t n_streams;
+  uint16_t reserved;
+  uint32_t file_id;    // zufällig, unterscheidet alte Blöcke auf der Karte
+  uint32_t block_size;
+  uint32_t max_blocks; // Platz in der vorbelegten Datei
+  int64_t start_us;    // esp_timer beim Öffnen
+  char streams[SDL_MAX_STREAMS][SDL_STREAM_NAME]; // Index = Stream-ID - 1
+} sdl_header_t;
+
+typedef struct __attribute__((packed)) {
+  uint32_t magic;
+  uint32_t file_id;
+  uint32_t seq;  // 0, 1, 2, ...
+  uint32_t used; // Bytes an Datensätzen nach dem Blockkopf
+  uint32_t records;
+  int64_t t0_us; // Zeit des ersten Datensatzes
+} sdl_block_header_t;
+
+typedef struct __attribute__((packed)) {
+  uint32_t records;
+  int64_t first_us;
+  int64_t last_us;
+} sdl_stream_info_t;
+
+// Index am Dateiende: was steht in der Datei und wie lief die Aufzeichnung
+typedef struct __attribute__((packed)) {
+  uint32_t magic;
+  uint32_t file_id;
+  uint32_t blocks;       // geschriebene Datenblöcke
+  uint32_t dropped;      // verworfene Datensätze
+  uint32_t write_us_max; // längster Schreibzugriff auf die Karte
+  uint32_t write_us_avg;
+  sdl_stream_info_t streams[SDL_MAX_STREAMS];
+} sdl_footer_t;
+
+_Static_assert(sizeof(sdl_header_t) <= SDL_SECTOR, "Header > 1 Sektor");
+_Static_assert(sizeof(sdl_footer_t) <= SDL_SECTOR, "Footer > 1 Sektor");
@@ -0,0 +1,51 @@
+#include "cobs.h"
+
+size_t cobs_encode(const uint8_t *in, size_t len, uint8_t *out,
+                   size_t out_cap) {
+  if (out_cap < COBS_MAX_ENCODED(len)) {
+    return 0;
+  }
+
+  size_t code_pos = 0; // Position des aktuellen Längenbytes
+  size_t o = 1;
+  uint8_t code = 1;
+
+  for (size_t i = 0; i < len; i++) {
+    if (in[i] == 0) {
+      out[code_pos] = code;
+      code_pos = o++;
+      code = 1;
+      continue;
+    }
+    out[o++] = in[i];
+    if (++code == 0xFF) {
+      // Block mit 254 Bytes ohne Null ist voll
+      out[code_pos] = code;
+      code_pos = o++;
+      code = 1;
+    }
+  }
+  out[code_pos] = code;
+  return o;
+}
+
+size_t cobs_decode(const uint8_t *in, size_t len, uint8_t *out) {
+  size_t i = 0;
+  size_t o = 0;
+
+  while (i < len) {
+    uint8_t code = in[i++];
+    if (code == 0 || i + code - 1 > len) {
+      return 0;
+    }
+    for (uint8_t k = 1; k < code; k++) {
+      out[o++] = in[i++];
+    }
+    // Ein Block kürzer als 254 Bytes endet mit einer (entfernten) Null,
+    // außer am Ende der Daten
+    if (code != 0xFF && i < len) {
+      out[o++] = 0;
+    }
+  }
+  return o;
+}
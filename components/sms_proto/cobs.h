@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Consistent Overhead Byte Stuffing: entfernt alle 0x00 aus einem Block, so
+// dass 0x00 als eindeutiger Frame-Trenner dienen kann. Overhead: höchstens
+// ein Byte pro 254 Bytes plus eins.
+
+#define COBS_MAX_ENCODED(len) ((len) + (len) / 254 + 1)
+
+// Kodiert `len` Bytes nach `out` (ohne abschließende 0x00). Gibt die Länge
+// zurück, 0 wenn `out_cap` nicht reicht.
+size_t cobs_encode(const uint8_t *in, size_t len, uint8_t *out, size_t out_cap);
+
+// Dekodiert einen Frame (ohne Trenner). `in` und `out` dürfen gleich sein.
+// Gibt die Länge zurück, 0 bei ungültigen Daten.
+size_t cobs_decode(const uint8_t *in, size_t len, uint8_t *out);
@@ -0,0 +1,15 @@
+#include "crc16.h"
+
+// Nibble-Tabelle: 32 Bytes, zwei Zugriffe pro Byte
+static const uint16_t crc_table[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF};
+
+uint16_t crc16_ccitt(const uint8_t *data, size_t len) {
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < len; i++) {
+    crc = (crc << 4) ^ crc_table[(crc >> 12) ^ (data[i] >> 4)];
+    crc = (crc << 4) ^ crc_table[(crc >> 12) ^ (data[i] & 0x0F)];
+  }
+  return crc;
+}
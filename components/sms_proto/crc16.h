@@ -0,0 +1,7 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// CRC-16/CCITT-FALSE (Polynom 0x1021, Startwert 0xFFFF)
+uint16_t crc16_ccitt(const uint8_t *data, size_t len);
@@ -0,0 +1,228 @@
+/*
+Host-Test für record_frame (gemeinsamer Sendeweg von binlog, profiler und
+evtrace). Datensätze werden wie auf dem ESP32 in einen Ring geschrieben,
+die gesendeten Frames werden dekodiert und geprüft.
+
+  gcc -O2 -Wall -I.. -I../../ring_buffer -o record_frame_check \
+      record_frame_check.c ../record_frame.c ../cobs.c ../crc16.c \
+      ../../ring_buffer/ring_buffer.c
+  ./record_frame_check
+
+Geprüft: Kopf mit und ohne Tag, fortlaufende seq, Aufteilung auf mehrere
+Frames, halb veröffentlichte Datensätze am Ringende, kaputte Längenbytes
+und Verlustmeldungen.
+*/
+
+#include "crc16.h"
+#include "record_frame.h"
+#include "ring_buffer.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define RING_SIZE 64
+#define MAX_RECORD 24
+#define LOST_LEN 6
+#define MAX_FRAMES 16
+
+typedef struct {
+  size_t count;
+  size_t len[MAX_FRAMES];
+  uint8_t data[MAX_FRAMES][RECORD_FRAME_MAX];
+  int bad; // Frames mit falschem Trenner oder falscher CRC
+} sent_t;
+
+static int failures;
+
+static void check(int ok, const char *what) {
+  if (!ok) {
+    printf("FAIL %s\n", what);
+    failures++;
+  }
+}
+
+static size_t send(const void *data, size_t len, void *ctx) {
+  sent_t *s = ctx;
+  const uint8_t *wire = data;
+  uint8_t buf[RECORD_FRAME_MAX + 8];
+  size_t n = 0;
+  if (len < 2 || wire[0] != 0 || wire[len - 1] != 0 ||
+      len - 2 > sizeof(buf) ||
+      (n = cobs_decode(&wire[1], len - 2, buf)) < 2 ||
+      crc16_ccitt(buf, n - 2) != (buf[n - 2] | buf[n - 1] << 8)) {
+    s->bad++;
+    return len;
+  }
+  if (s->count < MAX_FRAMES) {
+    s->len[s->count] = n - 2;
+    memcpy(s->data[s->count], buf, n - 2);
+    s->count++;
+  }
+  return len;
+}
+
+static void put_lost(uint8_t *rec, int source, uint32_t count) {
+  rec[0] = LOST_LEN - 1;
+  rec[1] = 0xEE;
+  rec[2] = source;
+  memcpy(&rec[3], &count, 3);
+}
+
+static void setup(record_frame_t *f, sent_t *s, int tag) {
+  memset(s, 0, sizeof(*s));
+  record_frame_config_t config = {
+      .tag = tag,
+      .max_record = MAX_RECORD,
+      .lost_len = LOST_LEN,
+      .lost = put_lost,
+      .send = send,
+      .ctx = s,
+  };
+  record_frame_init(f, &config);
+}
+
+// Datensatz mit `len` Nutzbytes, Inhalt aus `seed` abgeleitet
+static size_t make_record(uint8_t *rec, size_t len, uint8_t seed) {
+  rec[0] = len;
+  for (size_t i = 0; i < len; i++) {
+    rec[1 + i] = seed + i;
+  }
+  return 1 + len;
+}
+
+static void test_header(void) {
+  static uint8_t mem[RING_SIZE];
+  ring_buffer_t ring;
+  ring_init(&ring, mem, sizeof(mem));
+  record_frame_t f;
+  sent_t s;
+  uint32_t reported = 0;
+  uint8_t rec[MAX_RECORD];
+
+  setup(&f, &s, 0xA5);
+  record_frame_flush(&f);
+  check(s.count == 0 && s.bad == 0, "leerer Frame wird nicht gesendet");
+
+  for (int i = 0; i < 2; i++) {
+    ring_write(&ring, rec, make_record(rec, 3, 10 * i));
+    record_frame_drain(&f, &ring, 0, 0, &reported);
+    record_frame_flush(&f);
+  }
+  check(s.count == 2 && s.bad == 0, "zwei Frames mit Tag");
+  check(s.len[0] == 6 && s.data[0][0] == 0xA5 && s.data[0][1] == 0 &&
+            s.data[0][2] == 3 && s.data[0][5] == 2,
+        "Kopf [tag][seq] und Datensatz");
+  check(s.data[1][0] == 0xA5 && s.data[1][1] == 1, "seq zählt weiter");
+
+  setup(&f, &s, RECORD_FRAME_NO_TAG);
+  ring_write(&ring, rec, make_record(rec, 2, 7));
+  record_frame_drain(&f, &ring, 0, 0, &reported);
+  record_frame_flush(&f);
+  check(s.count == 1 && s.len[0] == 4 && s.data[0][0] == 0 &&
+            s.data[0][1] == 2 && s.data[0][3] == 8,
+        "Kopf [seq] ohne Tag");
+}
+
+// Viele Datensätze verteilen sich lückenlos auf mehrere Frames
+static void test_split(void) {
+  static uint8_t mem[RECORD_FRAME_MAX * 4];
+  ring_buffer_t ring;
+  ring_init(&ring, mem, sizeof(mem));
+  record_frame_t f;
+  sent_t s;
+  uint32_t reported = 0;
+  setup(&f, &s, 0xA6);
+
+  uint8_t rec[MAX_RECORD];
+  size_t records = 40;
+  for (size_t i = 0; i < records; i++) {
+    ring_write(&ring, rec, make_record(rec, MAX_RECORD - 1 - i % 5, i));
+  }
+  record_frame_drain(&f, &ring, 0, 0, &reported);
+  record_frame_flush(&f);
+  check(ring_used(&ring) == 0, "Ring geleert");
+  check(s.count > 1 && s.bad == 0, "auf mehrere Frames verteilt");
+
+  size_t seen = 0;
+  int ok = 1;
+  for (size_t i = 0; i < s.count; i++) {
+    ok &= s.data[i][1] == i && s.len[i] + 2 <= RECORD_FRAME_MAX;
+    for (size_t p = 2; p < s.len[i]; p += 1 + s.data[i][p]) {
+      ok &= s.data[i][p] == MAX_RECORD - 1 - seen % 5 &&
+            s.data[i][p + 1] == (uint8_t)seen;
+      seen++;
+    }
+  }
+  check(ok && seen == records, "alle Datensätze in Reihenfolge");
+}
+
+// ring_write veröffentlicht über das Ringende hinweg erst den ersten Teil
+static void test_partial(void) {
+  static uint8_t mem[RING_SIZE];
+  ring_buffer_t ring;
+  ring_init(&ring, mem, sizeof(mem));
+  record_frame_t f;
+  sent_t s;
+  uint32_t reported = 0;
+  setup(&f, &s, 0xA5);
+
+  uint8_t skip[RING_SIZE - 5] = {0};
+  ring_write(&ring, skip, sizeof(skip));
+  ring_read_commit(&ring, sizeof(skip));
+
+  uint8_t rec[MAX_RECORD];
+  size_t n = make_record(rec, 19, 1);
+  size_t contiguous;
+  uint8_t *w = ring_write_ptr(&ring, &contiguous);
+  memcpy(w, rec, contiguous);
+  ring_write_commit(&ring, contiguous);
+  record_frame_drain(&f, &ring, 0, 0, &reported);
+  record_frame_flush(&f);
+  check(s.count == 0 && ring_used(&ring) == contiguous,
+        "halber Datensatz bleibt im Ring");
+
+  w = ring_write_ptr(&ring, &contiguous);
+  memcpy(w, rec + 5, n - 5);
+  ring_write_commit(&ring, n - 5);
+  record_frame_drain(&f, &ring, 0, 0, &reported);
+  record_frame_flush(&f);
+  check(s.count == 1 && s.len[0] == 2 + n &&
+            memcmp(&s.data[0][2], rec, n) == 0,
+        "vollständiger Datensatz über das Ringende");
+}
+
+static void test_garbage_and_lost(void) {
+  static uint8_t mem[RING_SIZE];
+  ring_buffer_t ring;
+  ring_init(&ring, mem, sizeof(mem));
+  record_frame_t f;
+  sent_t s;
+  uint32_t reported = 0;
+  setup(&f, &s, 0xA5);
+
+  uint8_t rec[MAX_RECORD];
+  ring_write(&ring, rec, make_record(rec, 2, 1));
+  uint8_t bad[] = {200, 1, 2, 3};
+  ring_write(&ring, bad, sizeof(bad));
+  record_frame_drain(&f, &ring, 1, 3, &reported);
+  record_frame_flush(&f);
+  check(ring_used(&ring) == 0, "Rest nach kaputtem Längenbyte verworfen");
+  check(s.count == 1 && s.len[0] == 2 + 3 + LOST_LEN &&
+            s.data[0][5] == LOST_LEN - 1 && s.data[0][7] == 1 &&
+            s.data[0][8] == 3,
+        "Datensatz vor dem Müll und Verlustmeldung gesendet");
+  check(reported == 3, "Verluste als gemeldet vermerkt");
+
+  record_frame_drain(&f, &ring, 1, 3, &reported);
+  record_frame_flush(&f);
+  check(s.count == 1, "keine zweite Meldung ohne neue Verluste");
+}
+
+int main(void) {
+  test_header();
+  test_split();
+  test_partial();
+  test_garbage_and_lost();
+  printf(failures ? "FAILED\n" : "ok\n");
+  return failures ? 1 : 0;
+}
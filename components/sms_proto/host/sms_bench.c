@@ -0,0 +1,284 @@
+/*
+Benchmark und Loopback-Test für das SMS-Protokoll.
+
+Ohne Argumente läuft das "Gerät" (sms_server, derselbe Code wie auf dem ESP32)
+in einem Thread am anderen Ende eines Pseudo-Terminals. Mit Gerätepfad wird
+stattdessen das echte Board benutzt:
+
+  gcc -O2 -Wall -I.. -o sms_bench sms_bench.c sms_host.c ../sms_proto.c \
+      ../sms_server.c ../cobs.c ../crc16.c -lpthread -lutil
+  ./sms_bench                      # pty-Loopback
+  ./sms_bench /dev/ttyUSB1 115200  # USB-UART an UART1 des uart-Projekts
+
+Gemessen werden Round-Trip-Zeit und Durchsatz von PING bei verschiedenen
+Payload-Größen, der Overhead der Rahmung (Bytes auf der Leitung pro
+Nutzbyte), das Rate-Limit der Abonnements und die Resynchronisation nach
+Fremdbytes (Logausgaben) im Datenstrom.
+*/
+
+#define _DEFAULT_SOURCE
+
+#include "sms_host.h"
+#include "sms_server.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <pty.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#define PING_ROUNDS 2000
+#define RESPONSE_TIMEOUT_MS 500
+#define STREAM_SECONDS 1
+#define STREAM_INTERVAL_MS 10
+
+// Simuliertes Gerät am pty-Slave
+
+typedef struct {
+  int fd;
+  atomic_bool stop;
+  bool led;
+  uint32_t garbage_every; // alle n Events eine Logzeile einstreuen, 0 = nie
+} device_t;
+
+static int64_t now_us(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+static size_t device_send(const void *data, size_t len, void *ctx) {
+  device_t *dev = ctx;
+  const uint8_t *p = data;
+  size_t done = 0;
+  while (done < len) {
+    ssize_t n = write(dev->fd, p + done, len - done);
+    if (n < 0) {
+      if (errno == EINTR || errno == EAGAIN) {
+        continue;
+      }
+      break;
+    }
+    done += n;
+  }
+  return done;
+}
+
+static uint8_t device_command(uint8_t cmd, const uint8_t *arg, size_t arg_len,
+                              uint8_t *reply, size_t *reply_len, void *ctx) {
+  device_t *dev = ctx;
+  if (cmd != SMS_CMD_LED) {
+    return SMS_ERR_UNKNOWN_CMD;
+  }
+  if (arg_len != 1 || arg[0] > 2) {
+    return SMS_ERR_BAD_ARG;
+  }
+  dev->led = arg[0] == 2 ? !dev->led : arg[0];
+  reply[0] = dev->led;
+  *reply_len = 1;
+  return SMS_OK;
+}
+
+static void *device_thread(void *arg) {
+  device_t *dev = arg;
+  sms_server_t server;
+  sms_server_init(&server, device_send, device_command, dev);
+
+  uint8_t frame[SMS_MAX_FRAME];
+  size_t frame_len = 0;
+  bool overflow = false;
+  uint32_t published = 0;
+
+  while (!atomic_load(&dev->stop)) {
+    struct pollfd pfd = {.fd = dev->fd, .events = POLLIN};
+    if (poll(&pfd, 1, 1) > 0) {
+      uint8_t buf[4096];
+      ssize_t n = read(dev->fd, buf, sizeof(buf));
+      for (ssize_t i = 0; i < n; i++) {
+        if (buf[i] != 0x00) {
+          if (frame_len < sizeof(frame)) {
+            frame[frame_len++] = buf[i];
+          } else {
+            overflow = true;
+          }
+          continue;
+        }
+        if (!overflow) {
+          sms_server_handle_frame(&server, frame, frame_len);
+        }
+        frame_len = 0;
+        overflow = false;
+      }
+    }
+
+    // Sensor liefert jede Millisekunde, das Abo entscheidet, was rausgeht
+    int64_t now = now_us();
+    uint8_t gyro[12];
+    for (int i = 0; i < 6; i++) {
+      sms_put_u16(&gyro[2 * i], (uint16_t)(now >> (i * 2)));
+    }
+    if (sms_server_publish(&server, SMS_TOPIC_GYRO, gyro, sizeof(gyro), now)) {
+      published++;
+      if (dev->garbage_every && published % dev->garbage_every == 0) {
+        static const char log_line[] = "I (1234) uart_interrupt: rx 0 B/s\r\n";
+        device_send(log_line, sizeof(log_line) - 1, dev);
+      }
+    }
+    if (sms_server_due(&server, SMS_TOPIC_LINK_STATS, now)) {
+      uint8_t payload[SMS_LINK_STATS_LEN];
+      sms_put_link_stats(payload, &server.stats);
+      sms_server_publish(&server, SMS_TOPIC_LINK_STATS, payload,
+                         sizeof(payload), now);
+    }
+  }
+  return NULL;
+}
+
+// Benchmarks
+
+static void bench_ping(sms_host_t *host) {
+  static const size_t sizes[] = {0, 16, 64, 128, SMS_MAX_PAYLOAD};
+  uint8_t payload[SMS_MAX_PAYLOAD];
+  uint8_t resp[SMS_MAX_PAYLOAD];
+
+  // Mit Nullen durchsetzt, damit COBS etwas zu tun hat
+  for (size_t i = 0; i < sizeof(payload); i++) {
+    payload[i] = i % 7 ? (uint8_t)(i * 37) : 0;
+  }
+
+  printf("%8s %10s %10s %10s %10s %9s\n", "payload", "rtt_us", "max_us",
+         "req/s", "kB/s", "overhead");
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+    size_t size = sizes[s];
+    const sms_host_stats_t *st = sms_host_get_stats(host);
+    uint64_t tx_before = st->tx_bytes;
+    uint64_t rx_before = st->rx_bytes;
+    int64_t max_us = 0;
+    int ok = 0;
+
+    int64_t start = now_us();
+    for (int i = 0; i < PING_ROUNDS; i++) {
+      size_t len = sizeof(resp);
+      int64_t t0 = now_us();
+      if (sms_host_request(host, SMS_CMD_PING, payload, size, resp, &len,
+                           RESPONSE_TIMEOUT_MS) < 0) {
+        continue;
+      }
+      int64_t dt = now_us() - t0;
+      if (dt > max_us) {
+        max_us = dt;
+      }
+      if (len == size && memcmp(resp, payload, size) == 0) {
+        ok++;
+      }
+    }
+    int64_t elapsed = now_us() - start;
+
+    uint64_t wire = (st->tx_bytes - tx_before) + (st->rx_bytes - rx_before);
+    uint64_t useful = 2ull * size * ok;
+    printf("%8zu %10.1f %10lld %10.0f %10.1f %8.2fx%s\n", size,
+           (double)elapsed / PING_ROUNDS, (long long)max_us,
+           PING_ROUNDS * 1e6 / elapsed, useful * 1e3 / elapsed,
+           useful ? (double)wire / useful : 0.0,
+           ok == PING_ROUNDS ? "" : "  (Fehler!)");
+  }
+}
+
+static void count_event(const sms_msg_t *msg, void *ctx) {
+  uint32_t *per_topic = ctx;
+  if (msg->code < SMS_TOPIC_COUNT) {
+    per_topic[msg->code]++;
+  }
+}
+
+static void bench_stream(sms_host_t *host) {
+  uint32_t per_topic[SMS_TOPIC_COUNT] = {0};
+  sms_host_set_event_cb(host, count_event, per_topic);
+
+  if (sms_host_subscribe(host, SMS_TOPIC_GYRO, STREAM_INTERVAL_MS,
+                         RESPONSE_TIMEOUT_MS) != SMS_OK ||
+      sms_host_subscribe(host, SMS_TOPIC_LINK_STATS, 250,
+                         RESPONSE_TIMEOUT_MS) != SMS_OK) {
+    printf("subscribe fehlgeschlagen\n");
+    return;
+  }
+  sms_host_poll(host, STREAM_SECONDS * 1000);
+  sms_host_unsubscribe(host, SMS_TOPIC_GYRO, RESPONSE_TIMEOUT_MS);
+  sms_host_unsubscribe(host, SMS_TOPIC_LINK_STATS, RESPONSE_TIMEOUT_MS);
+  sms_host_poll(host, 20); // Nachzügler
+  sms_host_set_event_cb(host, NULL, NULL);
+
+  sms_link_stats_t dev;
+  memset(&dev, 0, sizeof(dev));
+  sms_host_link_stats(host, &dev, RESPONSE_TIMEOUT_MS);
+
+  const sms_host_stats_t *st = sms_host_get_stats(host);
+  printf("stream %d s: gyro=%lu (erwartet ~%d) link_stats=%lu lost=%lu\n",
+         STREAM_SECONDS, (unsigned long)per_topic[SMS_TOPIC_GYRO],
+         STREAM_SECONDS * 1000 / STREAM_INTERVAL_MS,
+         (unsigned long)per_topic[SMS_TOPIC_LINK_STATS],
+         (unsigned long)st->events_lost);
+  printf("Gerät: rx=%lu rx_err=%lu tx=%lu tx_drop=%lu rate_limited=%lu\n",
+         (unsigned long)dev.rx_frames, (unsigned long)dev.rx_errors,
+         (unsigned long)dev.tx_frames, (unsigned long)dev.tx_dropped,
+         (unsigned long)dev.rate_limited);
+  printf("Host: rx=%lu rx_err=%lu stray=%lu timeouts=%lu\n",
+         (unsigned long)st->rx_frames, (unsigned long)st->rx_errors,
+         (unsigned long)st->stray, (unsigned long)st->timeouts);
+}
+
+int main(int argc, char **argv) {
+  sms_host_t *host;
+  device_t dev = {.fd = -1, .garbage_every = 10};
+  pthread_t thread;
+
+  if (argc > 1) {
+    int baud = argc > 2 ? atoi(argv[2]) : 115200;
+    host = sms_host_open(argv[1], baud);
+    if (!host) {
+      perror(argv[1]);
+      return 1;
+    }
+  } else {
+    int master, slave;
+    struct termios tio;
+    if (openpty(&master, &slave, NULL, NULL, NULL) < 0) {
+      perror("openpty");
+      return 1;
+    }
+    // Raw auf beiden Seiten, sonst übersetzt die Line Discipline Bytes
+    tcgetattr(slave, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(slave, TCSANOW, &tio);
+    tcgetattr(master, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(master, TCSANOW, &tio);
+
+    dev.fd = slave;
+    atomic_init(&dev.stop, false);
+    pthread_create(&thread, NULL, device_thread, &dev);
+    host = sms_host_from_fd(master);
+  }
+
+  if (sms_host_ping(host, RESPONSE_TIMEOUT_MS) != SMS_OK) {
+    printf("keine Antwort auf PING\n");
+    sms_host_close(host);
+    return 1;
+  }
+  bench_ping(host);
+  bench_stream(host);
+
+  if (dev.fd >= 0) {
+    atomic_store(&dev.stop, true);
+    pthread_join(thread, NULL);
+    close(dev.fd);
+  }
+  sms_host_close(host);
+  return 0;
+}
@@ -0,0 +1,349 @@
+#define _DEFAULT_SOURCE // cfmakeraw
+
+#include "sms_host.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+struct sms_host {
+  int fd;
+  uint8_t next_id;
+
+  // Empfang: Bytes bis zum nächsten 0x00 sammeln
+  uint8_t rx[SMS_MAX_FRAME];
+  size_t rx_len;
+  bool rx_overflow;
+
+  // Offener Request
+  bool waiting;
+  bool answered;
+  uint8_t want_id;
+  uint8_t *resp;
+  size_t resp_cap;
+  size_t resp_len;
+
+  sms_event_cb_t event_cb;
+  void *event_ctx;
+  uint8_t last_seq[SMS_TOPIC_COUNT];
+  bool seen_seq[SMS_TOPIC_COUNT];
+
+  sms_host_stats_t stats;
+};
+
+static speed_t baud_to_speed(int baud) {
+  switch (baud) {
+  case 9600:
+    return B9600;
+  case 115200:
+    return B115200;
+  case 230400:
+    return B230400;
+  case 460800:
+    return B460800;
+  case 921600:
+    return B921600;
+  case 1000000:
+    return B1000000;
+  case 2000000:
+    return B2000000;
+  case 3000000:
+    return B3000000;
+  default:
+    return B0;
+  }
+}
+
+static int64_t now_ms(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000LL + ts.tv_nsec / 1000000;
+}
+
+sms_host_t *sms_host_from_fd(int fd) {
+  sms_host_t *host = calloc(1, sizeof(*host));
+  if (host) {
+    host->fd = fd;
+  }
+  return host;
+}
+
+sms_host_t *sms_host_open(const char *path, int baud) {
+  speed_t speed = baud_to_speed(baud);
+  if (speed == B0) {
+    errno = EINVAL;
+    return NULL;
+  }
+
+  int fd = open(path, O_RDWR | O_NOCTTY | O_CLOEXEC);
+  if (fd < 0) {
+    return NULL;
+  }
+  struct termios tio;
+  if (tcgetattr(fd, &tio) < 0) {
+    close(fd);
+    return NULL;
+  }
+  cfmakeraw(&tio);
+  cfsetispeed(&tio, speed);
+  cfsetospeed(&tio, speed);
+  tio.c_cflag |= CLOCAL | CREAD;
+  tio.c_cc[VMIN] = 0;
+  tio.c_cc[VTIME] = 0;
+  if (tcsetattr(fd, TCSANOW, &tio) < 0) {
+    close(fd);
+    return NULL;
+  }
+  tcflush(fd, TCIOFLUSH);
+
+  sms_host_t *host = sms_host_from_fd(fd);
+  if (!host) {
+    close(fd);
+  }
+  return host;
+}
+
+void sms_host_close(sms_host_t *host) {
+  if (host) {
+    close(host->fd);
+    free(host);
+  }
+}
+
+void sms_host_set_event_cb(sms_host_t *host, sms_event_cb_t cb, void *ctx) {
+  host->event_cb = cb;
+  host->event_ctx = ctx;
+}
+
+const sms_host_stats_t *sms_host_get_stats(const sms_host_t *host) {
+  return &host->stats;
+}
+
+static int write_all(sms_host_t *host, const uint8_t *data, size_t len) {
+  while (len > 0) {
+    ssize_t n = write(host->fd, data, len);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno == EAGAIN) {
+        struct pollfd pfd = {.fd = host->fd, .events = POLLOUT};
+        poll(&pfd, 1, 100);
+        continue;
+      }
+      return -1;
+    }
+    host->stats.tx_bytes += n;
+    data += n;
+    len -= n;
+  }
+  return 0;
+}
+
+static void dispatch(sms_host_t *host, const sms_msg_t *msg) {
+  if (msg->type == SMS_TYPE_RESPONSE) {
+    if (!host->waiting || host->answered || msg->id != host->want_id) {
+      host->stats.stray++;
+      return;
+    }
+    size_t n =
+        msg->payload_len < host->resp_cap ? msg->payload_len : host->resp_cap;
+    if (n) {
+      memcpy(host->resp, msg->payload, n);
+    }
+    host->resp_len = n;
+    host->answered = true;
+    return;
+  }
+
+  if (msg->type == SMS_TYPE_EVENT) {
+    if (msg->code < SMS_TOPIC_COUNT) {
+      // Die ID eines Events zählt pro Topic hoch
+      uint8_t expected = host->last_seq[msg->code] + 1;
+      if (host->seen_seq[msg->code] && msg->id != expected) {
+        host->stats.events_lost += (uint8_t)(msg->id - expected);
+      }
+      host->last_seq[msg->code] = msg->id;
+      host->seen_seq[msg->code] = true;
+    }
+    host->stats.events++;
+    if (host->event_cb) {
+      host->event_cb(msg, host->event_ctx);
+    }
+    return;
+  }
+
+  host->stats.stray++;
+}
+
+// Zerlegt empfangene Bytes in Frames. Gibt die Anzahl der Events zurück.
+static int feed(sms_host_t *host, const uint8_t *data, size_t len) {
+  uint32_t events = host->stats.events;
+
+  for (size_t i = 0; i < len; i++) {
+    if (data[i] != 0x00) {
+      if (host->rx_len < sizeof(host->rx)) {
+        host->rx[host->rx_len++] = data[i];
+      } else {
+        host->rx_overflow = true;
+      }
+      continue;
+    }
+
+    // Frame-Ende; leere Frames entstehen durch den führenden Trenner
+    if (host->rx_len > 0) {
+      sms_msg_t msg;
+      if (!host->rx_overflow && sms_decode(host->rx, host->rx_len, &msg) == 0) {
+        host->stats.rx_frames++;
+        dispatch(host, &msg);
+      } else {
+        host->stats.rx_errors++;
+      }
+    }
+    host->rx_len = 0;
+    host->rx_overflow = false;
+  }
+  return (int)(host->stats.events - events);
+}
+
+// Wartet höchstens `timeout_ms` auf Daten und verarbeitet sie
+static int read_once(sms_host_t *host, int timeout_ms) {
+  struct pollfd pfd = {.fd = host->fd, .events = POLLIN};
+  int r = poll(&pfd, 1, timeout_ms);
+  if (r < 0) {
+    return errno == EINTR ? 0 : -1;
+  }
+  if (r == 0) {
+    return 0;
+  }
+
+  uint8_t buf[4096];
+  ssize_t n = read(host->fd, buf, sizeof(buf));
+  if (n < 0) {
+    return errno == EINTR || errno == EAGAIN ? 0 : -1;
+  }
+  if (n == 0 && (pfd.revents & POLLHUP)) {
+    return -1;
+  }
+  host->stats.rx_bytes += n;
+  return feed(host, buf, n);
+}
+
+int sms_host_request(sms_host_t *host, uint8_t cmd, const void *payload,
+                     size_t payload_len, uint8_t *resp, size_t *resp_len,
+                     int timeout_ms) {
+  uint8_t frame[SMS_MAX_FRAME];
+  uint8_t id = host->next_id++;
+  size_t n = sms_encode(SMS_TYPE_REQUEST, id, cmd, payload, payload_len, frame,
+                        sizeof(frame));
+  if (n == 0) {
+    errno = EINVAL;
+    return -1;
+  }
+
+  host->waiting = true;
+  host->answered = false;
+  host->want_id = id;
+  host->resp = resp;
+  host->resp_cap = resp_len ? *resp_len : 0;
+  host->resp_len = 0;
+
+  int result = -1;
+  if (write_all(host, frame, n) == 0) {
+    host->stats.tx_frames++;
+    int64_t deadline = now_ms() + timeout_ms;
+    while (!host->answered) {
+      int64_t left = deadline - now_ms();
+      if (left <= 0 || read_once(host, (int)left) < 0) {
+        break;
+      }
+    }
+    if (host->answered) {
+      if (resp_len) {
+        *resp_len = host->resp_len;
+      }
+      result = 0;
+    } else {
+      host->stats.timeouts++;
+    }
+  }
+
+  host->waiting = false;
+  host->resp = NULL;
+  return result;
+}
+
+int sms_host_poll(sms_host_t *host, int timeout_ms) {
+  int events = 0;
+  int64_t deadline = now_ms() + timeout_ms;
+  do {
+    int64_t left = deadline - now_ms();
+    int r = read_once(host, left > 0 ? (int)left : 0);
+    if (r < 0) {
+      return -1;
+    }
+    events += r;
+  } while (now_ms() < deadline);
+  return events;
+}
+
+// Request mit Statusbyte am Anfang der Antwort
+static int status_request(sms_host_t *host, uint8_t cmd, const void *payload,
+                          size_t payload_len, uint8_t *resp, size_t resp_cap,
+                          int timeout_ms) {
+  size_t len = resp_cap;
+  if (sms_host_request(host, cmd, payload, payload_len, resp, &len,
+                       timeout_ms) < 0 ||
+      len < 1) {
+    return -1;
+  }
+  return resp[0];
+}
+
+int sms_host_ping(sms_host_t *host, int timeout_ms) {
+  return sms_host_request(host, SMS_CMD_PING, NULL, 0, NULL, NULL,
+                          timeout_ms) < 0
+             ? -1
+             : SMS_OK;
+}
+
+int sms_host_set_led(sms_host_t *host, uint8_t mode, int timeout_ms) {
+  uint8_t resp[2];
+  return status_request(host, SMS_CMD_LED, &mode, 1, resp, sizeof(resp),
+                        timeout_ms);
+}
+
+int sms_host_subscribe(sms_host_t *host, uint8_t topic, uint16_t interval_ms,
+                       int timeout_ms) {
+  uint8_t arg[3] = {topic};
+  uint8_t resp[1];
+  sms_put_u16(&arg[1], interval_ms);
+  return status_request(host, SMS_CMD_SUBSCRIBE, arg, sizeof(arg), resp,
+                        sizeof(resp), timeout_ms);
+}
+
+int sms_host_unsubscribe(sms_host_t *host, uint8_t topic, int timeout_ms) {
+  uint8_t resp[1];
+  return status_request(host, SMS_CMD_UNSUBSCRIBE, &topic, 1, resp,
+                        sizeof(resp), timeout_ms);
+}
+
+int sms_host_link_stats(sms_host_t *host, sms_link_stats_t *stats,
+                        int timeout_ms) {
+  uint8_t resp[1 + SMS_LINK_STATS_LEN];
+  size_t len = sizeof(resp);
+  if (sms_host_request(host, SMS_CMD_STATS, NULL, 0, resp, &len, timeout_ms) <
+          0 ||
+      len < 1) {
+    return -1;
+  }
+  if (resp[0] == SMS_OK && len == sizeof(resp)) {
+    sms_get_link_stats(&resp[1], stats);
+  }
+  return resp[0];
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "sms_proto.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+Host-Seite des SMS-Protokolls (Linux/POSIX).
+
+Öffnet eine serielle Schnittstelle (oder nimmt einen fertigen Dateideskriptor,
+z.B. ein Pseudo-Terminal), schickt Requests mit fortlaufender ID und wartet
+auf die Antwort mit derselben ID. Events, die währenddessen eintreffen, gehen
+an den registrierten Callback. Nicht thread-safe: ein Handle gehört einem
+Thread.
+*/
+
+typedef struct sms_host sms_host_t;
+
+typedef void (*sms_event_cb_t)(const sms_msg_t *msg, void *ctx);
+
+typedef struct {
+  uint64_t tx_bytes;
+  uint64_t rx_bytes;
+  uint32_t tx_frames;
+  uint32_t rx_frames;    // gültige Frames
+  uint32_t rx_errors;    // COBS-/CRC-Fehler oder Fremdbytes
+  uint32_t events;       // an den Callback gelieferte Events
+  uint32_t events_lost;  // Lücken in den Sequenznummern der Events
+  uint32_t stray;        // Antworten ohne passenden Request
+  uint32_t timeouts;
+} sms_host_stats_t;
+
+// Öffnet ein TTY im Raw-Modus mit der gegebenen Baudrate
+sms_host_t *sms_host_open(const char *path, int baud);
+
+// Nutzt einen bereits geöffneten Deskriptor (wird bei close geschlossen)
+sms_host_t *sms_host_from_fd(int fd);
+
+void sms_host_close(sms_host_t *host);
+
+void sms_host_set_event_cb(sms_host_t *host, sms_event_cb_t cb, void *ctx);
+
+// Schickt einen Request und wartet auf die Antwort. Der Payload der Antwort
+// wird nach `resp` kopiert, `resp_len` enthält vorher die Puffergröße und
+// danach die Länge. Gibt 0 zurück, -1 bei Timeout oder I/O-Fehler.
+int sms_host_request(sms_host_t *host, uint8_t cmd, const void *payload,
+                     size_t payload_len, uint8_t *resp, size_t *resp_len,
+                     int timeout_ms);
+
+// Liest bis zu `timeout_ms` lang und verteilt eintreffende Events. Gibt die
+// Anzahl der Events zurück, -1 bei I/O-Fehler.
+int sms_host_poll(sms_host_t *host, int timeout_ms);
+
+// Komfortfunktionen; geben den Status der Antwort zurück, -1 bei Timeout
+int sms_host_ping(sms_host_t *host, int timeout_ms);
+int sms_host_set_led(sms_host_t *host, uint8_t mode, int timeout_ms);
+int sms_host_subscribe(sms_host_t *host, uint8_t topic, uint16_t interval_ms,
+                       int timeout_ms);
+int sms_host_unsubscribe(sms_host_t *host, uint8_t topic, int timeout_ms);
+int sms_host_link_stats(sms_host_t *host, sms_link_stats_t *stats,
+                        int timeout_ms);
+
+const sms_host_stats_t *sms_host_get_stats(const sms_host_t *host);
@@ -0,0 +1,73 @@
+#include "record_frame.h"
+
+#include "crc16.h"
+
+static void frame_begin(record_frame_t *f) {
+  f->len = 0;
+  if (f->cfg.tag != RECORD_FRAME_NO_TAG) {
+    f->buf[f->len++] = f->cfg.tag;
+  }
+  f->buf[f->len++] = f->seq;
+  f->header = f->len;
+}
+
+void record_frame_init(record_frame_t *f, const record_frame_config_t *cfg) {
+  f->cfg = *cfg;
+  f->seq = 0;
+  frame_begin(f);
+}
+
+void record_frame_flush(record_frame_t *f) {
+  if (f->len <= f->header) {
+    return;
+  }
+  uint16_t crc = crc16_ccitt(f->buf, f->len);
+  f->buf[f->len++] = crc;
+  f->buf[f->len++] = crc >> 8;
+  f->wire[0] = 0;
+  size_t n = cobs_encode(f->buf, f->len, &f->wire[1], sizeof(f->wire) - 2);
+  f->wire[1 + n] = 0;
+  f->cfg.send(f->wire, n + 2, f->cfg.ctx);
+  f->seq++;
+  frame_begin(f);
+}
+
+// CRC bleibt frei
+uint8_t *record_frame_reserve(record_frame_t *f, size_t n) {
+  if (f->len + n + 2 > RECORD_FRAME_MAX) {
+    record_frame_flush(f);
+  }
+  uint8_t *p = &f->buf[f->len];
+  f->len += n;
+  return p;
+}
+
+// Liest nur vollständige Datensätze: ring_write veröffentlicht einen
+// Datensatz über das Pufferende hinweg in zwei Schritten, und die Sende-Task
+// ist an keinen Kern gebunden, kann also mitten hineinlesen.
+void record_frame_drain(record_frame_t *f, ring_buffer_t *ring, int source,
+                        uint32_t dropped, uint32_t *reported) {
+  size_t used, contiguous;
+  while ((used = ring_used(ring)) > 0) {
+    size_t n = 1 + *ring_read_ptr(ring, &contiguous);
+    if (n > f->cfg.max_record) {
+      // Längenbyte kaputt, die Grenzen der Datensätze sind verloren. Den
+      // Rest verwerfen statt Unsinn zu senden (oder über buf zu schreiben).
+      ring_read_commit(ring, used);
+      break;
+    }
+    if (used < n) {
+      break; // Rest folgt beim nächsten Durchlauf
+    }
+    uint8_t *p = record_frame_reserve(f, n);
+    if (ring_read(ring, p, n) != n) {
+      f->len -= n;
+      break;
+    }
+  }
+  if (dropped != *reported) {
+    f->cfg.lost(record_frame_reserve(f, f->cfg.lost_len), source,
+                dropped - *reported);
+    *reported = dropped;
+  }
+}
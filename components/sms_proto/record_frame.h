@@ -0,0 +1,56 @@
+#pragma once
+
+#include "cobs.h"
+#include "ring_buffer.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Bündelt längenpräfixierte Datensätze ([len][len Bytes]) aus SPSC-Ringen
+// zu Frames: [tag][seq][Datensätze][crc16], COBS-kodiert zwischen zwei 0x00.
+// Gemeinsamer Sendeweg von binlog, profiler und evtrace; binlog sendet ohne
+// Tag-Byte. Nur von einer Task aus benutzen.
+
+// Nutzdaten eines Frames vor COBS, inklusive Tag, seq und CRC
+#define RECORD_FRAME_MAX 256
+#define RECORD_FRAME_NO_TAG (-1)
+
+typedef size_t (*record_send_fn_t)(const void *data, size_t len, void *ctx);
+
+// Schreibt eine Verlustmeldung für `count` Datensätze aus Quelle `source`
+// nach `rec` (lost_len Bytes inklusive Längenbyte)
+typedef void (*record_lost_fn_t)(uint8_t *rec, int source, uint32_t count);
+
+typedef struct {
+  int tag;           // erstes Byte jedes Frames oder RECORD_FRAME_NO_TAG
+  size_t max_record; // größter gültiger Datensatz inklusive Längenbyte
+  size_t lost_len;
+  record_lost_fn_t lost;
+  record_send_fn_t send;
+  void *ctx;
+} record_frame_config_t;
+
+typedef struct {
+  record_frame_config_t cfg;
+  uint8_t seq;
+  size_t header;
+  size_t len;
+  uint8_t buf[RECORD_FRAME_MAX];
+  uint8_t wire[COBS_MAX_ENCODED(RECORD_FRAME_MAX) + 2];
+} record_frame_t;
+
+// max_record muss samt Kopf und CRC in einen Frame passen
+void record_frame_init(record_frame_t *f, const record_frame_config_t *cfg);
+
+// Platz für einen Datensatz von `n` Bytes; sendet vorher den laufenden Frame,
+// wenn er nicht mehr hineinpasst
+uint8_t *record_frame_reserve(record_frame_t *f, size_t n);
+
+// Sendet den laufenden Frame, falls er Datensätze enthält
+void record_frame_flush(record_frame_t *f);
+
+// Überträgt alle vollständigen Datensätze aus `ring` in Frames und meldet
+// danach Verluste seit dem letzten Aufruf (`dropped` ist der Zählerstand
+// des Schreibers, `reported` der davon schon gemeldete Teil).
+void record_frame_drain(record_frame_t *f, ring_buffer_t *ring, int source,
+                        uint32_t dropped, uint32_t *reported);
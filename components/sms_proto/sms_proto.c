@@ -0,0 +1,69 @@
+#include "sms_proto.h"
+
+#include "cobs.h"
+#include "crc16.h"
+#include <string.h>
+
+size_t sms_encode(uint8_t type, uint8_t id, uint8_t code, const void *payload,
+                  size_t payload_len, uint8_t *out, size_t out_cap) {
+  uint8_t msg[SMS_MAX_MESSAGE];
+
+  if (payload_len > SMS_MAX_PAYLOAD) {
+    return 0;
+  }
+  msg[0] = type;
+  msg[1] = id;
+  msg[2] = code;
+  if (payload_len) {
+    memcpy(&msg[SMS_HEADER_LEN], payload, payload_len);
+  }
+  size_t len = SMS_HEADER_LEN + payload_len;
+  sms_put_u16(&msg[len], crc16_ccitt(msg, len));
+  len += SMS_CRC_LEN;
+
+  if (out_cap < 2) {
+    return 0;
+  }
+  out[0] = 0x00; // Trenner vor und nach dem Frame
+  size_t n = cobs_encode(msg, len, &out[1], out_cap - 2);
+  if (n == 0) {
+    return 0;
+  }
+  n++;
+  out[n++] = 0x00;
+  return n;
+}
+
+int sms_decode(uint8_t *frame, size_t len, sms_msg_t *msg) {
+  size_t n = cobs_decode(frame, len, frame);
+  if (n < SMS_HEADER_LEN + SMS_CRC_LEN) {
+    return -1;
+  }
+  size_t body = n - SMS_CRC_LEN;
+  if (crc16_ccitt(frame, body) != sms_get_u16(&frame[body])) {
+    return -1;
+  }
+
+  msg->type = frame[0];
+  msg->id = frame[1];
+  msg->code = frame[2];
+  msg->payload = &frame[SMS_HEADER_LEN];
+  msg->payload_len = body - SMS_HEADER_LEN;
+  return 0;
+}
+
+void sms_put_link_stats(uint8_t *p, const sms_link_stats_t *stats) {
+  sms_put_u32(&p[0], stats->rx_frames);
+  sms_put_u32(&p[4], stats->rx_errors);
+  sms_put_u32(&p[8], stats->tx_frames);
+  sms_put_u32(&p[12], stats->tx_dropped);
+  sms_put_u32(&p[16], stats->rate_limited);
+}
+
+void sms_get_link_stats(const uint8_t *p, sms_link_stats_t *stats) {
+  stats->rx_frames = sms_get_u32(&p[0]);
+  stats->rx_errors = sms_get_u32(&p[4]);
+  stats->tx_frames = sms_get_u32(&p[8]);
+  stats->tx_dropped = sms_get_u32(&p[12]);
+  stats->rate_limited = sms_get_u32(&p[16]);
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+Binäres Kommando-/Telemetrieprotokoll zwischen Board und PC.
+
+Aufbau einer Nachricht vor dem Kodieren:
+
+  [type][id][code][payload ...][crc16 lo][crc16 hi]
+
+  type  SMS_TYPE_*
+  id    Request-ID (Antwort wiederholt sie), bei Events eine laufende Nummer
+        pro Topic, damit der Empfänger Verluste erkennt
+  code  Kommando bzw. Topic
+  crc16 CRC-16/CCITT über alle vorherigen Bytes
+
+Auf der Leitung wird jede Nachricht COBS-kodiert und zwischen zwei 0x00
+gesetzt. Der führende Trenner schließt fremde Bytes davor (z.B. Logausgaben
+auf derselben UART) als eigenen, ungültigen Frame ab; leere Frames werden
+ignoriert.
+Die Datei ist unabhängig von ESP-IDF und wird auch von der Host-Bibliothek in
+host/ verwendet.
+*/
+
+#define SMS_MAX_PAYLOAD 240
+#define SMS_HEADER_LEN 3
+#define SMS_CRC_LEN 2
+#define SMS_MAX_MESSAGE (SMS_HEADER_LEN + SMS_MAX_PAYLOAD + SMS_CRC_LEN)
+// Kodierte Länge inklusive beider Trenner
+#define SMS_MAX_FRAME (SMS_MAX_MESSAGE + SMS_MAX_MESSAGE / 254 + 3)
+
+// Nachrichtentypen
+#define SMS_TYPE_REQUEST 0x01
+#define SMS_TYPE_RESPONSE 0x02
+#define SMS_TYPE_EVENT 0x03
+
+// Kommandos
+#define SMS_CMD_PING 0x01        // Antwort enthält denselben Payload
+#define SMS_CMD_LED 0x02         // [0=aus, 1=an, 2=umschalten] -> [status][led]
+#define SMS_CMD_STATS 0x03       // -> [status][sms_link_stats_t]
+#define SMS_CMD_SUBSCRIBE 0x10   // [topic][interval_ms lo][hi] -> [status]
+#define SMS_CMD_UNSUBSCRIBE 0x11 // [topic] -> [status]
+
+// Status (erstes Payload-Byte jeder Antwort außer PING)
+#define SMS_OK 0x00
+#define SMS_ERR_UNKNOWN_CMD 0x01
+#define SMS_ERR_BAD_ARG 0x02
+#define SMS_ERR_NO_SPACE 0x03
+
+// Topics für Telemetrie
+#define SMS_TOPIC_GYRO 0x01        // 6 x int16: accel x/y/z, gyro x/y/z
+#define SMS_TOPIC_TEMPERATURE 0x02 // [sensor][int16 centi-°C] ...
+#define SMS_TOPIC_DISTANCE 0x03    // [sensor][uint16 mm] ...
+#define SMS_TOPIC_LINK_STATS 0x04  // sms_link_stats_t
+#define SMS_TOPIC_COUNT 0x05
+
+typedef struct {
+  uint8_t type;
+  uint8_t id;
+  uint8_t code;
+  const uint8_t *payload; // zeigt in den dekodierten Puffer
+  size_t payload_len;
+} sms_msg_t;
+
+// Zähler der Verbindung, Little Endian auf der Leitung
+typedef struct {
+  uint32_t rx_frames;
+  uint32_t rx_errors; // COBS- oder CRC-Fehler
+  uint32_t tx_frames;
+  uint32_t tx_dropped;   // TX-Puffer voll
+  uint32_t rate_limited; // wegen Rate-Limit nicht gesendete Events
+} sms_link_stats_t;
+
+#define SMS_LINK_STATS_LEN 20
+
+// Baut eine Nachricht und kodiert sie inklusive der 0x00-Trenner nach `out`
+// (mindestens SMS_MAX_FRAME Bytes). Gibt die Länge zurück, 0 bei Fehler.
+size_t sms_encode(uint8_t type, uint8_t id, uint8_t code, const void *payload,
+                  size_t payload_len, uint8_t *out, size_t out_cap);
+
+// Dekodiert einen Frame (ohne Trenner) in-place und prüft die CRC.
+// Gibt 0 zurück, wenn `msg` gültig ist, sonst -1.
+int sms_decode(uint8_t *frame, size_t len, sms_msg_t *msg);
+
+// (De-)Serialisierung von sms_link_stats_t (SMS_LINK_STATS_LEN Bytes)
+void sms_put_link_stats(uint8_t *p, const sms_link_stats_t *stats);
+void sms_get_link_stats(const uint8_t *p, sms_link_stats_t *stats);
+
+// Helfer für Payloads in Little Endian
+static inline void sms_put_u16(uint8_t *p, uint16_t v) {
+  p[0] = v & 0xFF;
+  p[1] = v >> 8;
+}
+
+static inline void sms_put_u32(uint8_t *p, uint32_t v) {
+  p[0] = v & 0xFF;
+  p[1] = (v >> 8) & 0xFF;
+  p[2] = (v >> 16) & 0xFF;
+  p[3] = v >> 24;
+}
+
+static inline uint16_t sms_get_u16(const uint8_t *p) {
+  return p[0] | (p[1] << 8);
+}
+
+static inline uint32_t sms_get_u32(const uint8_t *p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
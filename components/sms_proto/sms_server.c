@@ -0,0 +1,133 @@
+#include "sms_server.h"
+
+#include <string.h>
+
+void sms_server_init(sms_server_t *server, sms_send_fn_t send,
+                     sms_command_fn_t command, void *ctx) {
+  memset(server, 0, sizeof(*server));
+  server->send = send;
+  server->command = command;
+  server->ctx = ctx;
+}
+
+static void send_msg(sms_server_t *server, uint8_t type, uint8_t id,
+                     uint8_t code, const void *payload, size_t len) {
+  uint8_t frame[SMS_MAX_FRAME];
+  size_t n = sms_encode(type, id, code, payload, len, frame, sizeof(frame));
+  if (n == 0) {
+    return;
+  }
+  if (server->send(frame, n, server->ctx) < n) {
+    server->stats.tx_dropped++;
+    return;
+  }
+  server->stats.tx_frames++;
+}
+
+// [topic][interval_ms lo][hi]
+static uint8_t subscribe(sms_server_t *server, const uint8_t *arg,
+                         size_t arg_len) {
+  if (arg_len != 3 || arg[0] == 0 || arg[0] >= SMS_TOPIC_COUNT) {
+    return SMS_ERR_BAD_ARG;
+  }
+  uint32_t interval_ms = sms_get_u16(&arg[1]);
+  if (interval_ms < SMS_MIN_INTERVAL_MS) {
+    interval_ms = SMS_MIN_INTERVAL_MS;
+  }
+
+  sms_subscription_t *sub = &server->subs[arg[0]];
+  if (!sub->active) {
+    sub->seq = 0;
+    sub->next_us = 0; // erstes Event sofort
+  }
+  sub->active = true;
+  sub->interval_us = interval_ms * 1000;
+  return SMS_OK;
+}
+
+static uint8_t unsubscribe(sms_server_t *server, const uint8_t *arg,
+                           size_t arg_len) {
+  if (arg_len != 1 || arg[0] >= SMS_TOPIC_COUNT) {
+    return SMS_ERR_BAD_ARG;
+  }
+  server->subs[arg[0]].active = false;
+  return SMS_OK;
+}
+
+void sms_server_handle_frame(sms_server_t *server, uint8_t *frame, size_t len) {
+  if (len == 0) {
+    return;
+  }
+
+  sms_msg_t msg;
+  if (sms_decode(frame, len, &msg) < 0 || msg.type != SMS_TYPE_REQUEST) {
+    server->stats.rx_errors++;
+    return;
+  }
+  server->stats.rx_frames++;
+
+  // Erstes Byte ist der Status, außer bei PING
+  uint8_t reply[SMS_MAX_PAYLOAD];
+  size_t reply_len = 0;
+
+  switch (msg.code) {
+  case SMS_CMD_PING:
+    send_msg(server, SMS_TYPE_RESPONSE, msg.id, msg.code, msg.payload,
+             msg.payload_len);
+    return;
+  case SMS_CMD_STATS:
+    reply[0] = SMS_OK;
+    sms_put_link_stats(&reply[1], &server->stats);
+    reply_len = 1 + SMS_LINK_STATS_LEN;
+    break;
+  case SMS_CMD_SUBSCRIBE:
+    reply[0] = subscribe(server, msg.payload, msg.payload_len);
+    reply_len = 1;
+    break;
+  case SMS_CMD_UNSUBSCRIBE:
+    reply[0] = unsubscribe(server, msg.payload, msg.payload_len);
+    reply_len = 1;
+    break;
+  default:
+    if (server->command) {
+      reply[0] = server->command(msg.code, msg.payload, msg.payload_len,
+                                 &reply[1], &reply_len, server->ctx);
+    } else {
+      reply[0] = SMS_ERR_UNKNOWN_CMD;
+    }
+    if (reply[0] != SMS_OK) {
+      reply_len = 0;
+    }
+    reply_len++;
+    break;
+  }
+  send_msg(server, SMS_TYPE_RESPONSE, msg.id, msg.code, reply, reply_len);
+}
+
+bool sms_server_due(const sms_server_t *server, uint8_t topic, int64_t now_us) {
+  if (topic >= SMS_TOPIC_COUNT) {
+    return false;
+  }
+  const sms_subscription_t *sub = &server->subs[topic];
+  return sub->active && now_us >= sub->next_us;
+}
+
+bool sms_server_publish(sms_server_t *server, uint8_t topic,
+                        const void *payload, size_t len, int64_t now_us) {
+  if (topic >= SMS_TOPIC_COUNT || !server->subs[topic].active) {
+    return false;
+  }
+  sms_subscription_t *sub = &server->subs[topic];
+  if (now_us < sub->next_us) {
+    server->stats.rate_limited++;
+    return false;
+  }
+
+  // Takt halten, nach einer Pause aber nicht mehrere Events nachholen
+  sub->next_us += sub->interval_us;
+  if (sub->next_us <= now_us) {
+    sub->next_us = now_us + sub->interval_us;
+  }
+  send_msg(server, SMS_TYPE_EVENT, sub->seq++, topic, payload, len);
+  return true;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "sms_proto.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+Geräteseite des SMS-Protokolls: beantwortet Requests und verwaltet die
+Abonnements.
+
+PING, STATS, SUBSCRIBE und UNSUBSCRIBE werden hier erledigt, alle anderen
+Kommandos gehen an den Callback der Anwendung. Ein Abonnement legt pro Topic
+ein Mindestintervall fest; sms_server_publish verwirft Events, die früher
+kommen, so dass ein schneller Sensor die Leitung nicht zustopft.
+
+Nicht thread-safe: Frames verarbeiten und publizieren muss in derselben Task
+passieren. Die Datei ist unabhängig von ESP-IDF, der pty-Benchmark in host/
+verwendet denselben Code als simuliertes Gerät.
+*/
+
+// Kleinere Intervalle werden auf diesen Wert angehoben
+#define SMS_MIN_INTERVAL_MS 5
+
+// Schreibt einen fertigen Frame auf die Leitung. Gibt die Anzahl der
+// übernommenen Bytes zurück; alles unter `len` zählt als verworfen.
+typedef size_t (*sms_send_fn_t)(const void *data, size_t len, void *ctx);
+
+// Anwendungskommando. Die Antwort (ohne Statusbyte) kommt nach `reply`,
+// höchstens SMS_MAX_PAYLOAD - 1 Bytes. Rückgabe ist der Status (SMS_OK,
+// SMS_ERR_*).
+typedef uint8_t (*sms_command_fn_t)(uint8_t cmd, const uint8_t *arg,
+                                    size_t arg_len, uint8_t *reply,
+                                    size_t *reply_len, void *ctx);
+
+typedef struct {
+  bool active;
+  uint8_t seq;         // ID des nächsten Events
+  uint32_t interval_us;
+  int64_t next_us;     // frühester Zeitpunkt für das nächste Event
+} sms_subscription_t;
+
+typedef struct {
+  sms_send_fn_t send;
+  sms_command_fn_t command;
+  void *ctx;
+  sms_subscription_t subs[SMS_TOPIC_COUNT];
+  sms_link_stats_t stats;
+} sms_server_t;
+
+void sms_server_init(sms_server_t *server, sms_send_fn_t send,
+                     sms_command_fn_t command, void *ctx);
+
+// Verarbeitet einen Frame ohne Trenner (wird in-place dekodiert). Leere
+// Frames werden ignoriert.
+void sms_server_handle_frame(sms_server_t *server, uint8_t *frame, size_t len);
+
+// true, wenn das Topic abonniert und das Intervall abgelaufen ist. Damit kann
+// der Aufrufer sich das Zusammenbauen des Payloads sparen.
+bool sms_server_due(const sms_server_t *server, uint8_t topic, int64_t now_us);
+
+// Sendet ein Event, falls das Topic abonniert und fällig ist. Zu frühe Events
+// werden in stats.rate_limited gezählt.
+bool sms_server_publish(sms_server_t *server, uint8_t topic,
+                        const void *payload, size_t len, int64_t now_us);
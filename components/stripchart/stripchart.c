@@ -0,0 +1,175 @@
+#include "stripchart.h"
+
+#include "metrics.h"
+#include <stdlib.h>
+
+struct stripchart {
+  lv_obj_t *chart;
+  lv_chart_series_t *series[STRIPCHART_MAX_SERIES];
+  lv_coord_t *points[STRIPCHART_MAX_SERIES]; // Ringpuffer, gehört LVGL nicht
+  uint8_t n_series;
+  uint16_t n_points;
+  lv_coord_t min, max;
+  uint16_t head; // nächste Schreibposition
+
+  // Min-Max des laufenden Blocks, pro Reihe
+  uint16_t decimation;
+  uint16_t in_block;
+  int32_t lo[STRIPCHART_MAX_SERIES], hi[STRIPCHART_MAX_SERIES];
+  uint16_t lo_at[STRIPCHART_MAX_SERIES], hi_at[STRIPCHART_MAX_SERIES];
+
+  // Seit dem letzten stripchart_commit()
+  uint16_t dirty_from;
+  uint16_t n_dirty;
+};
+
+// Invalidierte Spalten in Pixeln, über alle Diagramme
+static metric_t *invalidated_px;
+
+esp_err_t stripchart_create(lv_obj_t *parent, const stripchart_config_t *cfg,
+                            stripchart_t **out) {
+  if (cfg->n_series == 0 || cfg->n_series > STRIPCHART_MAX_SERIES ||
+      cfg->points <= 2 * STRIPCHART_GAP || cfg->decimation == 0 ||
+      cfg->min >= cfg->max) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  stripchart_t *c = calloc(1, sizeof(*c));
+  if (c == NULL) {
+    return ESP_ERR_NO_MEM;
+  }
+  for (size_t s = 0; s < cfg->n_series; s++) {
+    c->points[s] = malloc(cfg->points * sizeof(lv_coord_t));
+    if (c->points[s] == NULL) {
+      for (size_t i = 0; i < s; i++) {
+        free(c->points[i]);
+      }
+      free(c);
+      return ESP_ERR_NO_MEM;
+    }
+    for (size_t i = 0; i < cfg->points; i++) {
+      c->points[s][i] = LV_CHART_POINT_NONE;
+    }
+  }
+  c->n_series = cfg->n_series;
+  c->n_points = cfg->points;
+  c->decimation = cfg->decimation;
+  c->min = cfg->min;
+  c->max = cfg->max;
+  invalidated_px = metrics_counter("chart.inval_px", "px");
+
+  c->chart = lv_chart_create(parent);
+  lv_chart_set_type(c->chart, LV_CHART_TYPE_LINE);
+  lv_chart_set_update_mode(c->chart, LV_CHART_UPDATE_MODE_CIRCULAR);
+  lv_chart_set_point_count(c->chart, cfg->points);
+  lv_chart_set_range(c->chart, LV_CHART_AXIS_PRIMARY_Y, cfg->min, cfg->max);
+  lv_chart_set_div_line_count(c->chart, 3, 0);
+  // Ohne Punktmarken und mit dünnen Linien bleibt jede invalidierte Spalte
+  // schmal
+  lv_obj_set_style_size(c->chart, 0, LV_PART_INDICATOR);
+  lv_obj_set_style_line_width(c->chart, 1, LV_PART_ITEMS);
+  lv_obj_set_style_bg_color(c->chart, lv_color_black(), LV_PART_MAIN);
+  lv_obj_set_style_border_color(c->chart, lv_color_make(64, 64, 64),
+                                LV_PART_MAIN);
+  lv_obj_set_style_line_color(c->chart, lv_color_make(48, 48, 48),
+                              LV_PART_MAIN);
+  lv_obj_set_style_pad_all(c->chart, 2, LV_PART_MAIN);
+  for (size_t s = 0; s < cfg->n_series; s++) {
+    c->series[s] = lv_chart_add_series(c->chart, cfg->colors[s],
+                                       LV_CHART_AXIS_PRIMARY_Y);
+    // Gibt das eigene Array der Reihe im LVGL-Heap wieder frei
+    lv_chart_set_ext_y_array(c->chart, c->series[s], c->points[s]);
+  }
+  *out = c;
+  return ESP_OK;
+}
+
+lv_obj_t *stripchart_obj(stripchart_t *c) { return c->chart; }
+
+static lv_coord_t clamp(const stripchart_t *c, int32_t v) {
+  if (v == LV_CHART_POINT_NONE) {
+    return v;
+  }
+  return v < c->min ? c->min : v > c->max ? c->max : v;
+}
+
+// Eine Spalte für alle Reihen, dahinter wandert die Lücke mit
+static void write_column(stripchart_t *c, const int32_t *values) {
+  if (c->n_dirty++ == 0) {
+    c->dirty_from = c->head;
+  }
+  uint16_t gap = (c->head + STRIPCHART_GAP) % c->n_points;
+  for (size_t s = 0; s < c->n_series; s++) {
+    c->points[s][c->head] = clamp(c, values[s]);
+    c->points[s][gap] = LV_CHART_POINT_NONE;
+  }
+  c->head = (c->head + 1) % c->n_points;
+}
+
+void stripchart_push(stripchart_t *c, const int32_t *values) {
+  for (size_t s = 0; s < c->n_series; s++) {
+    if (c->in_block == 0 || values[s] < c->lo[s]) {
+      c->lo[s] = values[s];
+      c->lo_at[s] = c->in_block;
+    }
+    if (c->in_block == 0 || values[s] > c->hi[s]) {
+      c->hi[s] = values[s];
+      c->hi_at[s] = c->in_block;
+    }
+  }
+  if (++c->in_block < c->decimation) {
+    return;
+  }
+  c->in_block = 0;
+  if (c->decimation == 1) {
+    write_column(c, values);
+    return;
+  }
+  // In zeitlicher Reihenfolge, sonst zeigt eine Flanke in die falsche
+  // Richtung
+  int32_t first[STRIPCHART_MAX_SERIES], second[STRIPCHART_MAX_SERIES];
+  for (size_t s = 0; s < c->n_series; s++) {
+    bool lo_first = c->lo_at[s] <= c->hi_at[s];
+    first[s] = lo_first ? c->lo[s] : c->hi[s];
+    second[s] = lo_first ? c->hi[s] : c->lo[s];
+  }
+  write_column(c, first);
+  write_column(c, second);
+}
+
+// Spalten a..b (a <= b) inklusive der Linien, die dort beginnen oder enden
+static void invalidate_columns(stripchart_t *c, uint16_t a, uint16_t b) {
+  lv_point_t pa, pb;
+  lv_chart_get_point_pos_by_id(c->chart, c->series[0], a, &pa);
+  lv_chart_get_point_pos_by_id(c->chart, c->series[0], b, &pb);
+  lv_coord_t line_width =
+      lv_obj_get_style_line_width(c->chart, LV_PART_ITEMS);
+  lv_area_t area;
+  lv_obj_get_coords(c->chart, &area);
+  area.x2 = area.x1 + pb.x + line_width;
+  area.x1 += pa.x - line_width;
+  lv_obj_invalidate_area(c->chart, &area);
+  metrics_add(invalidated_px, lv_area_get_width(&area));
+}
+
+void stripchart_commit(stripchart_t *c) {
+  if (c->n_dirty == 0) {
+    return;
+  }
+  uint16_t n = c->n_points;
+  if (c->n_dirty + STRIPCHART_GAP + 2 >= n) {
+    lv_obj_invalidate(c->chart);
+    metrics_add(invalidated_px, lv_obj_get_width(c->chart));
+  } else {
+    // Vom Punkt vor dem ersten neuen (seine Linie endet im ersten neuen)
+    // bis zum Punkt hinter der Lücke (seine Linie zur Lücke verschwindet)
+    uint16_t from = (c->dirty_from + n - 1) % n;
+    uint16_t to = (c->head + STRIPCHART_GAP) % n;
+    if (from <= to) {
+      invalidate_columns(c, from, to);
+    } else {
+      invalidate_columns(c, from, n - 1);
+      invalidate_columns(c, 0, to);
+    }
+  }
+  c->n_dirty = 0;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "esp_err.h"
+#include "lvgl.h"
+#include <stdint.h>
+
+/*
+Laufendes Liniendiagramm für schnelle Messreihen (LVGL 8).
+
+Jede Reihe ist ein Ringpuffer fester Länge außerhalb des LVGL-Heaps, der
+über lv_chart_set_ext_y_array() an ein lv_chart im Modus
+LV_CHART_UPDATE_MODE_CIRCULAR hängt. Neue Punkte überschreiben den ältesten
+an der Schreibposition, die wie bei einem Oszilloskop von links nach rechts
+über das Diagramm läuft; die STRIPCHART_GAP Punkte davor bleiben leer und
+trennen neue von alten Werten. Es verschiebt sich also nichts:
+stripchart_commit() invalidiert einmal pro Frame nur die Spalten zwischen
+der alten und der neuen Schreibposition, für alle Reihen gemeinsam.
+lv_chart_set_next_value() dagegen invalidiert pro Punkt und Reihe, im
+SHIFT-Modus sogar das ganze Diagramm.
+
+Schnelle Reihen werden vorher mit Min-Max dezimiert: aus `decimation`
+Rohwerten werden zwei Punkte, Minimum und Maximum in der Reihenfolge, in der
+sie auftraten. Anders als beim Mittelwert oder jedem n-ten Sample bleiben
+kurze Spitzen sichtbar, und anders als LTTB braucht das keinen Blick auf den
+nächsten Block, jeder Block ist sofort fertig. `points` sollte kleiner als
+die Breite des Diagramms in Pixeln bleiben, sonst fasst LVGL beim Zeichnen
+noch einmal zusammen.
+
+Alle Reihen eines Diagramms bekommen ihre Werte gemeinsam (ein Wert pro
+Reihe und Sample) und teilen sich die Schreibposition. Aufrufen nur aus der
+Task, die auch lv_timer_handler() aufruft.
+*/
+
+#define STRIPCHART_MAX_SERIES 3
+#define STRIPCHART_GAP 4
+
+typedef struct {
+  uint16_t points;     // Punkte pro Reihe
+  uint16_t decimation; // Rohwerte pro Min-Max-Paar, 1 = jeder Wert ein Punkt
+  lv_coord_t min, max; // Wertebereich, Werte außerhalb werden begrenzt
+  uint8_t n_series;
+  const lv_color_t *colors; // eine Farbe pro Reihe
+} stripchart_config_t;
+
+typedef struct stripchart stripchart_t;
+
+// Legt das lv_chart in `parent` an; Größe und Position setzt der Aufrufer
+// über stripchart_obj()
+esp_err_t stripchart_create(lv_obj_t *parent, const stripchart_config_t *cfg,
+                            stripchart_t **out);
+
+lv_obj_t *stripchart_obj(stripchart_t *c);
+
+// Ein Sample, `values` hat einen Wert pro Reihe. Schreibt erst nach
+// `decimation` Samples in die Ringe, invalidiert noch nichts. Ohne
+// Dezimierung lässt LV_CHART_POINT_NONE die Reihe in dieser Spalte leer.
+void stripchart_push(stripchart_t *c, const int32_t *values);
+
+// Invalidiert die seit dem letzten Aufruf geschriebenen Spalten, einmal vor
+// lv_timer_handler()
+void stripchart_commit(stripchart_t *c);
@@ -0,0 +1,335 @@
+/*
+Benchmark für ts_compress auf dem PC: Kompressionsrate und Durchsatz für
+Kodieren und Dekodieren, jede Reihe wird zusätzlich verlustfrei
+zurückgeprüft.
+
+Ohne Datei laufen synthetische Reihen (IMU 1 kHz mit Zeit-Jitter, Abstand
+20 Hz, Temperatur 1 Hz). Mit einer Aufzeichnung des SD-Loggers (sdlog)
+werden deren Streams "imu" (7 x int16 big endian), "temp" und "distance"
+(beide [index][float]) komprimiert.
+
+  gcc -O2 -Wall -I.. -I../../sd_logger -o ts_bench ts_bench.c \
+      ../ts_compress.c -lm
+  ./ts_bench
+  ./ts_bench -b 512 imu.bin
+*/
+
+#include "sd_logger_format.h"
+#include "ts_compress.h"
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_SERIES 16
+#define MIN_BENCH_S 0.2 // so oft wiederholen, bis die Zeit messbar ist
+
+typedef struct {
+  char name[32];
+  ts_schema_t schema;
+  int64_t *t;
+  ts_value_t *v; // n * n_channels
+  size_t n;
+  size_t cap;
+} series_t;
+
+static series_t series[MAX_SERIES];
+static int n_series;
+static size_t block_size = 1024;
+
+static series_t *new_series(const char *name, int n_channels, uint8_t type) {
+  if (n_series == MAX_SERIES) {
+    return NULL;
+  }
+  series_t *s = &series[n_series++];
+  snprintf(s->name, sizeof(s->name), "%s", name);
+  s->schema.n_channels = n_channels;
+  for (int c = 0; c < n_channels; c++) {
+    s->schema.types[c] = type;
+  }
+  return s;
+}
+
+static void append(series_t *s, int64_t t, const ts_value_t *v) {
+  if (s->n == s->cap) {
+    s->cap = s->cap ? s->cap * 2 : 1024;
+    s->t = realloc(s->t, s->cap * sizeof(*s->t));
+    s->v = realloc(s->v, s->cap * s->schema.n_channels * sizeof(*s->v));
+    if (!s->t || !s->v) {
+      fprintf(stderr, "Kein Speicher\n");
+      exit(1);
+    }
+  }
+  s->t[s->n] = t;
+  memcpy(&s->v[s->n * s->schema.n_channels], v,
+         s->schema.n_channels * sizeof(*v));
+  s->n++;
+}
+
+static size_t raw_bytes(const series_t *s) {
+  size_t per = sizeof(int64_t);
+  for (int c = 0; c < s->schema.n_channels; c++) {
+    per += s->schema.types[c] == TS_I16 ? 2 : 4;
+  }
+  return per * s->n;
+}
+
+// --- Eingaben ----------------------------------------------------------------
+
+static double noise(void) { return (double)rand() / RAND_MAX * 2 - 1; }
+
+static void synthetic(void) {
+  srand(1);
+  series_t *imu = new_series("imu 1 kHz (7 x i16)", 7, TS_I16);
+  for (int k = 0; k < 60000; k++) {
+    ts_value_t v[7];
+    double slow = sin(k / 800.0);
+    v[0].i = (int)(800 * slow + 40 * noise());
+    v[1].i = (int)(-300 * slow + 40 * noise());
+    v[2].i = (int)(16384 + 60 * noise());
+    v[3].i = (int)(-3200 + 2 * noise()); // Chiptemperatur
+    v[4].i = (int)(20 + 30 * noise());
+    v[5].i = (int)(-15 + 30 * noise());
+    v[6].i = (int)(400 * cos(k / 800.0) + 30 * noise());
+    // Abtastung in einer Task: wenige µs Jitter um den 1-ms-Takt
+    append(imu, k * 1000LL + (int64_t)(20 * noise()), v);
+  }
+
+  series_t *dist = new_series("Abstand 20 Hz (f32 cm)", 1, TS_F32);
+  for (int k = 0; k < 6000; k++) {
+    ts_value_t v = {.f = (float)(120 + 40 * sin(k / 300.0) + 0.2 * noise())};
+    append(dist, k * 50000LL, &v);
+  }
+
+  series_t *temp = new_series("Temperatur 1 Hz (f32 C)", 1, TS_F32);
+  for (int k = 0; k < 3600; k++) {
+    // DS18B20 mit 12 bit: Vielfache von 0,0625 °C
+    double c = 21.5 + 1.5 * sin(k / 900.0) + 0.1 * noise();
+    ts_value_t v = {.f = (float)(round(c * 16) / 16)};
+    append(temp, k * 1000000LL + (k % 7), &v);
+  }
+}
+
+static uint32_t get32(const uint8_t *p) {
+  return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static int load_sd_logger(const char *path) {
+  FILE *f = fopen(path, "rb");
+  if (!f) {
+    perror(path);
+    return -1;
+  }
+  uint8_t sector[SDL_SECTOR];
+  sdl_header_t h;
+  if (fread(sector, 1, SDL_SECTOR, f) != SDL_SECTOR) {
+    fclose(f);
+    return -1;
+  }
+  memcpy(&h, sector, sizeof(h));
+  if (h.magic != SDL_MAGIC || h.block_size % SDL_SECTOR != 0 ||
+      h.block_size == 0 || h.n_streams > SDL_MAX_STREAMS) {
+    fprintf(stderr, "%s: kein SD-Logger-Format\n", path);
+    fclose(f);
+    return -1;
+  }
+  int imu_id = 0, temp_id = 0, dist_id = 0;
+  for (int i = 0; i < h.n_streams; i++) {
+    h.streams[i][SDL_STREAM_NAME - 1] = 0;
+    if (strcmp(h.streams[i], "imu") == 0) {
+      imu_id = i + 1;
+    } else if (strcmp(h.streams[i], "temp") == 0) {
+      temp_id = i + 1;
+    } else if (strcmp(h.streams[i], "distance") == 0) {
+      dist_id = i + 1;
+    }
+  }
+
+  series_t *imu = imu_id ? new_series("imu (7 x i16)", 7, TS_I16) : NULL;
+  series_t *temp[8] = {0}, *dist[8] = {0};
+  uint8_t *block = malloc(h.block_size);
+  for (uint32_t seq = 0; block && seq < h.max_blocks &&
+                         fread(block, 1, h.block_size, f) == h.block_size;
+       seq++) {
+    sdl_block_header_t b;
+    memcpy(&b, block, sizeof(b));
+    if (b.magic != SDL_BLOCK_MAGIC || b.file_id != h.file_id ||
+        b.seq != seq || b.used > h.block_size - sizeof(b)) {
+      break;
+    }
+    const uint8_t *p = block + sizeof(b), *end = p + b.used;
+    while (end - p >= SDL_RECORD_HEADER &&
+           end - p >= SDL_RECORD_HEADER + p[1]) {
+      uint8_t stream = p[0], len = p[1];
+      const uint8_t *d = p + SDL_RECORD_HEADER;
+      int64_t t = b.t0_us + (int32_t)get32(&p[2]) - h.start_us;
+      if (stream == imu_id && imu && len == 14) {
+        ts_value_t v[7];
+        for (int c = 0; c < 7; c++) {
+          v[c].i = (int16_t)(d[2 * c] << 8 | d[2 * c + 1]);
+        }
+        append(imu, t, v);
+      } else if ((stream == temp_id || stream == dist_id) && len == 5 &&
+                 d[0] < 8) {
+        // [index][float], eine Reihe pro Sensor
+        series_t **s = stream == temp_id ? &temp[d[0]] : &dist[d[0]];
+        if (!*s) {
+          char name[32];
+          snprintf(name, sizeof(name), "%s[%d] (f32)",
+                   h.streams[stream - 1], d[0]);
+          *s = new_series(name, 1, TS_F32);
+        }
+        ts_value_t v;
+        memcpy(&v.f, &d[1], sizeof(float));
+        if (*s) {
+          append(*s, t, &v);
+        }
+      }
+      p += SDL_RECORD_HEADER + len;
+    }
+  }
+  free(block);
+  fclose(f);
+  return 0;
+}
+
+// --- Messung -----------------------------------------------------------------
+
+static double now_s(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Hängt einen fertigen Block mit seiner Länge (u16) an `out` an
+static size_t put_block(ts_encoder_t *enc, uint8_t *out) {
+  size_t len = ts_encoder_finish(enc);
+  out[0] = len;
+  out[1] = len >> 8;
+  memcpy(out + sizeof(uint16_t), enc->buf, len);
+  return sizeof(uint16_t) + len;
+}
+
+// Kodiert die ganze Reihe Block für Block, wie sie z.B. nacheinander auf
+// die Karte gingen, und gibt die Gesamtgröße zurück
+static size_t encode(const series_t *s, uint8_t *out, uint8_t *block) {
+  ts_encoder_t enc;
+  size_t total = 0;
+  ts_encoder_init(&enc, &s->schema, block, block_size);
+  for (size_t i = 0; i < s->n; i++) {
+    const ts_value_t *v = &s->v[i * s->schema.n_channels];
+    if (!ts_encoder_add(&enc, s->t[i], v)) {
+      total += put_block(&enc, out + total);
+      ts_encoder_init(&enc, &s->schema, block, block_size);
+      ts_encoder_add(&enc, s->t[i], v);
+    }
+  }
+  return total + put_block(&enc, out + total);
+}
+
+// Dekodiert und vergleicht, gibt die Anzahl Abweichungen zurück
+static size_t decode(const series_t *s, const uint8_t *in, size_t len,
+                     bool check) {
+  ts_decoder_t dec;
+  size_t i = 0, bad = 0, pos = 0;
+  int64_t t;
+  ts_value_t v[TS_MAX_CHANNELS];
+  while (pos + sizeof(uint16_t) <= len) {
+    size_t blen = in[pos] | in[pos + 1] << 8;
+    pos += sizeof(uint16_t);
+    if (ts_decoder_init(&dec, &s->schema, in + pos, blen) < 0) {
+      return s->n + 1;
+    }
+    while (ts_decoder_next(&dec, &t, v)) {
+      if (check && (i >= s->n || t != s->t[i] ||
+                    memcmp(v, &s->v[i * s->schema.n_channels],
+                           s->schema.n_channels * sizeof(*v)) != 0)) {
+        bad++;
+      }
+      i++;
+    }
+    pos += blen;
+  }
+  return bad + (i != s->n ? 1 : 0);
+}
+
+static void bench(const series_t *s) {
+  size_t raw = raw_bytes(s);
+  // Obergrenze: jede Messung im schlechtesten Fall plus Blockköpfe
+  size_t cap = s->n * ts_block_min(&s->schema) * 2 + block_size;
+  uint8_t *out = malloc(cap);
+  uint8_t *block = malloc(block_size);
+  if (!out || !block) {
+    return;
+  }
+
+  size_t len = 0;
+  int reps = 0;
+  double t0 = now_s(), t1;
+  do {
+    len = encode(s, out, block);
+    reps++;
+  } while ((t1 = now_s()) - t0 < MIN_BENCH_S);
+  double enc_mbs = raw * (double)reps / (t1 - t0) / 1e6;
+
+  size_t bad = decode(s, out, len, true);
+  reps = 0;
+  t0 = now_s();
+  do {
+    decode(s, out, len, false);
+    reps++;
+  } while ((t1 = now_s()) - t0 < MIN_BENCH_S);
+  double dec_mbs = raw * (double)reps / (t1 - t0) / 1e6;
+
+  printf("%-26s %8zu %9zu %9zu %6.2f %7.1f %8.1f %8.1f  %s\n", s->name,
+         s->n, raw, len, (double)raw / len, len * 8.0 / s->n, enc_mbs,
+         dec_mbs, bad ? "FEHLER" : "ok");
+  free(block);
+  free(out);
+}
+
+int main(int argc, char **argv) {
+  int opt;
+  while ((opt = getopt(argc, argv, "b:")) != -1) {
+    if (opt == 'b') {
+      block_size = strtoul(optarg, NULL, 0);
+    } else {
+      fprintf(stderr, "Aufruf: %s [-b blockgröße] [sdlog.bin ...]\n",
+              argv[0]);
+      return 2;
+    }
+  }
+  // Die Blöcke stehen mit u16-Länge hintereinander
+  if (block_size > UINT16_MAX) {
+    fprintf(stderr, "Blockgröße höchstens %d\n", UINT16_MAX);
+    return 2;
+  }
+  if (optind == argc) {
+    synthetic();
+  }
+  for (int i = optind; i < argc; i++) {
+    if (load_sd_logger(argv[i]) != 0) {
+      return 1;
+    }
+  }
+
+  printf("Blockgröße %zu Bytes, roh = int64-Zeit + Kanäle\n", block_size);
+  printf("%-26s %8s %9s %9s %6s %7s %8s %8s\n", "Reihe", "Messungen",
+         "roh B", "komp. B", "Rate", "Bit/M", "kod MB/s", "dek MB/s");
+  for (int i = 0; i < n_series; i++) {
+    if (series[i].n == 0) {
+      continue;
+    }
+    if (block_size < ts_block_min(&series[i].schema)) {
+      fprintf(stderr, "%s: Block kleiner als %zu Bytes\n", series[i].name,
+              ts_block_min(&series[i].schema));
+      return 1;
+    }
+    bench(&series[i]);
+  }
+  return 0;
+}
@@ -0,0 +1,373 @@
+#include "ts_compress.h"
+
+#include <string.h>
+
+// Schlechtester Fall in Bits: varint eines 64-Bit-Werts sind 10 Gruppen
+#define VARINT_BITS(groups) ((groups) * 8)
+#define WORST_TIME (4 + VARINT_BITS(10))
+#define WORST_I16 VARINT_BITS(3) // Differenz braucht 17 Bit
+#define WORST_I32 VARINT_BITS(5) // Differenz braucht 33 Bit
+#define WORST_F32 (2 + 5 + 5 + 32)
+
+static inline uint64_t zigzag(int64_t v) {
+  return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static inline int64_t unzigzag(uint64_t v) {
+  return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+// Modulo 2^64, damit auch beliebige Zeitstempel und kaputte Blöcke kein
+// undefiniertes Verhalten auslösen
+static inline int64_t wrap_add(int64_t a, int64_t b) {
+  return (int64_t)((uint64_t)a + (uint64_t)b);
+}
+
+static inline int64_t wrap_sub(int64_t a, int64_t b) {
+  return (int64_t)((uint64_t)a - (uint64_t)b);
+}
+
+static uint32_t to_bits(const ts_value_t *v, uint8_t type) {
+  if (type == TS_F32) {
+    uint32_t u;
+    memcpy(&u, &v->f, sizeof(u));
+    return u;
+  }
+  return (uint32_t)v->i;
+}
+
+static void from_bits(ts_value_t *v, uint8_t type, uint32_t u) {
+  if (type == TS_F32) {
+    memcpy(&v->f, &u, sizeof(u));
+  } else if (type == TS_I16) {
+    v->i = (int16_t)u;
+  } else {
+    v->i = (int32_t)u;
+  }
+}
+
+static bool schema_valid(const ts_schema_t *schema) {
+  if (schema->n_channels == 0 || schema->n_channels > TS_MAX_CHANNELS) {
+    return false;
+  }
+  for (int c = 0; c < schema->n_channels; c++) {
+    if (schema->types[c] < TS_I16 || schema->types[c] > TS_F32) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// --- Bitstrom ----------------------------------------------------------------
+
+// Schreibt die unteren n Bits von v (n <= 64), höchstwertiges zuerst
+static void put_bits(ts_encoder_t *e, uint64_t v, int n) {
+  uint8_t *p = e->buf + TS_BLOCK_HEADER;
+  while (n > 0) {
+    int used = e->bits & 7;
+    if (used == 0) {
+      p[e->bits >> 3] = 0;
+    }
+    int take = n < 8 - used ? n : 8 - used;
+    uint8_t chunk = (v >> (n - take)) & ((1u << take) - 1);
+    p[e->bits >> 3] |= chunk << (8 - used - take);
+    e->bits += take;
+    n -= take;
+  }
+}
+
+static void put_varint(ts_encoder_t *e, uint64_t v) {
+  while (v >= 0x80) {
+    put_bits(e, (v & 0x7F) | 0x80, 8);
+    v >>= 7;
+  }
+  put_bits(e, v, 8);
+}
+
+static bool get_bits(ts_decoder_t *d, int n, uint64_t *out) {
+  const uint8_t *p = d->buf + TS_BLOCK_HEADER;
+  if (d->bits + n > (d->len - TS_BLOCK_HEADER) * 8) {
+    return false;
+  }
+  uint64_t v = 0;
+  while (n > 0) {
+    int used = d->bits & 7;
+    int take = n < 8 - used ? n : 8 - used;
+    uint8_t chunk = p[d->bits >> 3] >> (8 - used - take);
+    v = (v << take) | (chunk & ((1u << take) - 1));
+    d->bits += take;
+    n -= take;
+  }
+  *out = v;
+  return true;
+}
+
+static bool get_varint(ts_decoder_t *d, uint64_t *out) {
+  uint64_t v = 0;
+  for (int shift = 0; shift < 70; shift += 7) {
+    uint64_t b;
+    if (!get_bits(d, 8, &b)) {
+      return false;
+    }
+    v |= (b & 0x7F) << shift;
+    if (!(b & 0x80)) {
+      *out = v;
+      return true;
+    }
+  }
+  return false;
+}
+
+// --- Kodierer ----------------------------------------------------------------
+
+size_t ts_block_min(const ts_schema_t *schema) {
+  // Jede Folgemessung ist mindestens so teuer wie die erste (roh)
+  size_t bits = WORST_TIME;
+  for (int c = 0; c < schema->n_channels; c++) {
+    if (schema->types[c] == TS_I16) {
+      bits += WORST_I16;
+    } else if (schema->types[c] == TS_I32) {
+      bits += WORST_I32;
+    } else {
+      bits += WORST_F32;
+    }
+  }
+  return TS_BLOCK_HEADER + (bits + 7) / 8;
+}
+
+bool ts_encoder_init(ts_encoder_t *enc, const ts_schema_t *schema,
+                     uint8_t *buf, size_t cap) {
+  if (!schema_valid(schema) || cap < ts_block_min(schema)) {
+    return false;
+  }
+  memset(enc, 0, sizeof(*enc));
+  enc->schema = schema;
+  enc->buf = buf;
+  enc->cap = cap;
+  enc->worst_bits = (ts_block_min(schema) - TS_BLOCK_HEADER) * 8;
+  return true;
+}
+
+static void put_time(ts_encoder_t *e, int64_t t) {
+  if (e->n == 0) {
+    put_bits(e, (uint64_t)t, 64);
+    return;
+  }
+  int64_t dt = wrap_sub(t, e->prev_t);
+  if (e->n == 1) {
+    put_varint(e, zigzag(dt));
+  } else {
+    int64_t dod = wrap_sub(dt, e->prev_dt);
+    if (dod == 0) {
+      put_bits(e, 0, 1);
+    } else if (dod >= -63 && dod <= 64) {
+      put_bits(e, 0x2, 2);
+      put_bits(e, dod + 63, 7);
+    } else if (dod >= -255 && dod <= 256) {
+      put_bits(e, 0x6, 3);
+      put_bits(e, dod + 255, 9);
+    } else if (dod >= -2047 && dod <= 2048) {
+      put_bits(e, 0xE, 4);
+      put_bits(e, dod + 2047, 12);
+    } else {
+      put_bits(e, 0xF, 4);
+      put_varint(e, zigzag(dod));
+    }
+  }
+  e->prev_dt = dt;
+}
+
+static void put_float(ts_encoder_t *e, int c, uint32_t u) {
+  uint32_t x = u ^ e->prev[c];
+  if (x == 0) {
+    put_bits(e, 0, 1);
+    return;
+  }
+  put_bits(e, 1, 1);
+  int lead = __builtin_clz(x);
+  int trail = __builtin_ctz(x);
+  int len = 32 - lead - trail;
+  // Passt in das Fenster des Vorgängers: nur die Bits darin. Ist das
+  // Fenster nach einem Sprung viel breiter als nötig, lohnt ein neues.
+  int window = 32 - e->lead[c] - e->trail[c];
+  if (e->lead[c] <= lead && e->trail[c] <= trail && window > 0 &&
+      window <= len + 10) {
+    put_bits(e, 0, 1);
+    put_bits(e, x >> e->trail[c], window);
+    return;
+  }
+  put_bits(e, 1, 1);
+  put_bits(e, lead, 5);
+  put_bits(e, len - 1, 5);
+  put_bits(e, x >> trail, len);
+  e->lead[c] = lead;
+  e->trail[c] = trail;
+}
+
+bool ts_encoder_add(ts_encoder_t *enc, int64_t t_us,
+                    const ts_value_t *values) {
+  const ts_schema_t *s = enc->schema;
+  if (enc->n == UINT16_MAX ||
+      TS_BLOCK_HEADER * 8 + enc->bits + enc->worst_bits > enc->cap * 8) {
+    return false;
+  }
+  put_time(enc, t_us);
+  for (int c = 0; c < s->n_channels; c++) {
+    uint32_t u = to_bits(&values[c], s->types[c]);
+    if (enc->n == 0) {
+      put_bits(enc, u, s->types[c] == TS_I16 ? 16 : 32);
+      // Ungültiges Fenster, der zweite Wert legt es fest
+      enc->lead[c] = 32;
+      enc->trail[c] = 32;
+    } else if (s->types[c] == TS_F32) {
+      put_float(enc, c, u);
+    } else {
+      int64_t delta = (int64_t)values[c].i - (int32_t)enc->prev[c];
+      put_varint(enc, zigzag(delta));
+    }
+    enc->prev[c] = u;
+  }
+  enc->prev_t = t_us;
+  enc->n++;
+  return true;
+}
+
+size_t ts_encoder_finish(ts_encoder_t *enc) {
+  enc->buf[0] = enc->n;
+  enc->buf[1] = enc->n >> 8;
+  enc->buf[2] = enc->schema->n_channels;
+  return TS_BLOCK_HEADER + (enc->bits + 7) / 8;
+}
+
+// --- Dekodierer --------------------------------------------------------------
+
+int ts_decoder_init(ts_decoder_t *dec, const ts_schema_t *schema,
+                    const uint8_t *buf, size_t len) {
+  if (!schema_valid(schema) || len < TS_BLOCK_HEADER ||
+      buf[2] != schema->n_channels) {
+    return -1;
+  }
+  memset(dec, 0, sizeof(*dec));
+  dec->schema = schema;
+  dec->buf = buf;
+  dec->len = len;
+  dec->n = buf[0] | buf[1] << 8;
+  return dec->n;
+}
+
+static bool get_time(ts_decoder_t *d, int64_t *t) {
+  uint64_t v;
+  if (d->read == 0) {
+    if (!get_bits(d, 64, &v)) {
+      return false;
+    }
+    *t = (int64_t)v;
+    return true;
+  }
+  int64_t dt;
+  if (d->read == 1) {
+    if (!get_varint(d, &v)) {
+      return false;
+    }
+    dt = unzigzag(v);
+  } else {
+    // Anzahl führender Einsen bestimmt das Format (höchstens vier)
+    int ones = 0;
+    while (ones < 4) {
+      if (!get_bits(d, 1, &v)) {
+        return false;
+      }
+      if (v == 0) {
+        break;
+      }
+      ones++;
+    }
+    static const int width[] = {0, 7, 9, 12};
+    static const int bias[] = {0, 63, 255, 2047};
+    int64_t dod;
+    if (ones == 0) {
+      dod = 0;
+    } else if (ones < 4) {
+      if (!get_bits(d, width[ones], &v)) {
+        return false;
+      }
+      dod = (int64_t)v - bias[ones];
+    } else {
+      if (!get_varint(d, &v)) {
+        return false;
+      }
+      dod = unzigzag(v);
+    }
+    dt = wrap_add(d->prev_dt, dod);
+  }
+  d->prev_dt = dt;
+  *t = wrap_add(d->prev_t, dt);
+  return true;
+}
+
+static bool get_float(ts_decoder_t *d, int c, uint32_t *u) {
+  uint64_t v;
+  if (!get_bits(d, 1, &v)) {
+    return false;
+  }
+  if (v == 0) {
+    *u = d->prev[c];
+    return true;
+  }
+  if (!get_bits(d, 1, &v)) {
+    return false;
+  }
+  if (v == 1) {
+    uint64_t lead, len;
+    if (!get_bits(d, 5, &lead) || !get_bits(d, 5, &len)) {
+      return false;
+    }
+    len++;
+    if (lead + len > 32) {
+      return false;
+    }
+    d->lead[c] = lead;
+    d->trail[c] = 32 - lead - len;
+  } else if (d->lead[c] + d->trail[c] >= 32) {
+    return false; // Fenster noch nicht festgelegt
+  }
+  if (!get_bits(d, 32 - d->lead[c] - d->trail[c], &v)) {
+    return false;
+  }
+  *u = d->prev[c] ^ (uint32_t)(v << d->trail[c]);
+  return true;
+}
+
+bool ts_decoder_next(ts_decoder_t *dec, int64_t *t_us, ts_value_t *values) {
+  const ts_schema_t *s = dec->schema;
+  if (dec->read >= dec->n || !get_time(dec, t_us)) {
+    return false;
+  }
+  for (int c = 0; c < s->n_channels; c++) {
+    uint32_t u;
+    uint64_t v;
+    if (dec->read == 0) {
+      if (!get_bits(dec, s->types[c] == TS_I16 ? 16 : 32, &v)) {
+        return false;
+      }
+      u = v;
+      dec->lead[c] = 32;
+      dec->trail[c] = 32;
+    } else if (s->types[c] == TS_F32) {
+      if (!get_float(dec, c, &u)) {
+        return false;
+      }
+    } else {
+      if (!get_varint(dec, &v)) {
+        return false;
+      }
+      u = (uint32_t)((int32_t)dec->prev[c] + unzigzag(v));
+    }
+    from_bits(&values[c], s->types[c], u);
+    // Bei TS_I16 vorzeichenrichtig erweitert, wie im Kodierer
+    dec->prev[c] = to_bits(&values[c], s->types[c]);
+  }
+  dec->prev_t = *t_us;
+  dec->read++;
+  return true;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+Verlustfreie Kompression von Messreihen mit festem Takt, blockweise und mit
+fester Speichergröße (nach Facebooks Gorilla, VLDB 2015).
+
+Eine Reihe besteht aus Zeitstempel + n Kanälen pro Messung. Kodiert wird
+in einen Bitstrom:
+
+  Zeitstempel   erste Messung roh (64 Bit), zweite als Differenz (zig-zag
+                varint), danach die Differenz der Differenzen:
+                  0                     '0'
+                  -63..64               '10'   + 7 Bit
+                  -255..256             '110'  + 9 Bit
+                  -2047..2048           '1110' + 12 Bit
+                  sonst                 '1111' + zig-zag varint
+                Bei festem Takt kostet der Zeitstempel damit 1 Bit.
+  TS_I16/I32    Differenz zum Vorgänger als zig-zag varint (7 Bit pro
+                Gruppe + Fortsetzungsbit)
+  TS_F32        XOR mit dem Vorgänger: '0' bei gleichem Wert, sonst '1' und
+                die signifikanten Bits, entweder im Fenster (führende und
+                folgende Nullen) des Vorgängers ('0' + Bits) oder mit neuem
+                Fenster ('1' + 5 Bit führende Nullen + 5 Bit Länge - 1 +
+                Bits), je nachdem, was kürzer ist
+
+Ein Block ist für sich dekodierbar:
+
+  [n u16 le][n_channels u8][Bitstrom, MSB zuerst]
+
+Der Kodierer nimmt eine Messung nur an, wenn sie im schlechtesten Fall
+noch in den Block passt. Voll heißt: Block abschließen, wegschreiben und
+mit ts_encoder_init neu beginnen. Unabhängig von ESP-IDF, läuft auch auf
+dem PC (host/ts_bench).
+*/
+
+#define TS_MAX_CHANNELS 16
+#define TS_BLOCK_HEADER 3
+
+typedef enum {
+  TS_I16 = 1,
+  TS_I32,
+  TS_F32,
+} ts_type_t;
+
+typedef struct {
+  uint8_t n_channels;
+  uint8_t types[TS_MAX_CHANNELS]; // ts_type_t
+} ts_schema_t;
+
+typedef union {
+  int32_t i; // TS_I16, TS_I32
+  float f;   // TS_F32
+} ts_value_t;
+
+typedef struct {
+  const ts_schema_t *schema;
+  uint8_t *buf;
+  size_t cap;
+  size_t bits;       // geschriebene Bits nach dem Header
+  size_t worst_bits; // größte mögliche Messung
+  uint16_t n;
+  int64_t prev_t;
+  int64_t prev_dt;
+  uint32_t prev[TS_MAX_CHANNELS]; // Rohbits des Vorgängers
+  uint8_t lead[TS_MAX_CHANNELS];  // XOR-Fenster der Float-Kanäle
+  uint8_t trail[TS_MAX_CHANNELS];
+} ts_encoder_t;
+
+typedef struct {
+  const ts_schema_t *schema;
+  const uint8_t *buf;
+  size_t len;
+  size_t bits;
+  uint16_t n;    // Messungen im Block
+  uint16_t read; // bereits gelesen
+  int64_t prev_t;
+  int64_t prev_dt;
+  uint32_t prev[TS_MAX_CHANNELS];
+  uint8_t lead[TS_MAX_CHANNELS];
+  uint8_t trail[TS_MAX_CHANNELS];
+} ts_decoder_t;
+
+// Kleinster sinnvoller Block für ein Schema (Header + eine Messung)
+size_t ts_block_min(const ts_schema_t *schema);
+
+// Beginnt einen neuen Block in `buf`. Gibt false zurück, wenn das Schema
+// ungültig ist oder nicht einmal eine Messung in `cap` passt.
+bool ts_encoder_init(ts_encoder_t *enc, const ts_schema_t *schema,
+                     uint8_t *buf, size_t cap);
+
+// Hängt eine Messung an, `values` hat schema->n_channels Einträge (bei
+// TS_I16 im Wertebereich von int16_t). false, wenn der Block voll ist
+// (dann bleibt er unverändert).
+bool ts_encoder_add(ts_encoder_t *enc, int64_t t_us, const ts_value_t *values);
+
+// Trägt die Anzahl in den Header ein, gibt die Länge des Blocks in Bytes
+// zurück
+size_t ts_encoder_finish(ts_encoder_t *enc);
+
+// Gibt die Anzahl Messungen im Block zurück, -1 bei ungültigem Block
+int ts_decoder_init(ts_decoder_t *dec, const ts_schema_t *schema,
+                    const uint8_t *buf, size_t len);
+
+// Liest die nächste Messung, false am Blockende oder bei kaputten Daten
+bool ts_decoder_next(ts_decoder_t *dec, int64_t *t_us, ts_value_t *values);
@@ -0,0 +1,227 @@
+#include "dashboard.h"
+
+#include "esp_check.h"
+#include "esp_timer.h"
+#include "hub_sensors.h"
+#include "stripchart.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+// Aufteilung des Bildschirms (240 x 320, hochkant), je eine Titelzeile über
+// dem Diagramm
+#define TITLE_H 16
+#define GYRO_Y 0
+#define GYRO_H 120
+#define DISTANCE_Y (GYRO_Y + TITLE_H + GYRO_H + 4)
+#define DISTANCE_H 64
+#define TEMPERATURE_Y (DISTANCE_Y + TITLE_H + DISTANCE_H + 4)
+#define TEMPERATURE_H 60
+#define CHART_W 236
+
+// Gyroskop: 1 kHz, 20 Samples pro Min-Max-Paar ergeben 100 Punkte/s, die
+// 200 Punkte zeigen also 4 s. Wertebereich wie der Sensor (±250 °/s) in
+// 0,1 °/s.
+#define GYRO_POINTS 200
+#define GYRO_DECIMATION 20
+#define GYRO_LSB_PER_DPS 131
+#define GYRO_RANGE 2500
+
+// Abstand in mm, ~17 Pings/s, 200 Punkte sind 12 s
+#define DISTANCE_POINTS 200
+#define DISTANCE_MAX_MM 4000
+
+// Temperatur in 0,1 °C, ein Punkt pro Messung (1 s), also 2 min. Eine Reihe
+// pro DS18x20, höchstens STRIPCHART_MAX_SERIES.
+#define TEMPERATURE_POINTS 120
+#define TEMPERATURE_MIN 100
+#define TEMPERATURE_MAX 350
+
+// Die Ringe müssen bis zum nächsten Frame reichen, auch wenn ein Flush
+// länger dauert: 64 ms IMU
+#define IMU_DEPTH 64
+#define SLOW_DEPTH 8
+
+#define VALUES_MS 100 // Zahlen in den Titelzeilen
+
+static const char *TAG = "dashboard";
+
+static const lv_color_t xyz_colors[3] = {
+    LV_COLOR_MAKE(255, 64, 64), LV_COLOR_MAKE(64, 255, 64),
+    LV_COLOR_MAKE(64, 128, 255)};
+static const lv_color_t distance_color[1] = {LV_COLOR_MAKE(255, 200, 0)};
+static const lv_color_t temperature_colors[3] = {
+    LV_COLOR_MAKE(0, 200, 255), LV_COLOR_MAKE(255, 0, 200),
+    LV_COLOR_MAKE(200, 200, 200)};
+
+static pubsub_sub_t *imu, *distance, *temperature;
+static stripchart_t *gyro_chart, *distance_chart, *temperature_chart;
+static lv_obj_t *gyro_title, *distance_title, *temperature_title, *status;
+
+// Letzte Werte für die Titelzeilen, NAN = noch keiner
+static int32_t last_gyro[3];
+static float last_cm = NAN;
+static float last_celsius[STRIPCHART_MAX_SERIES] = {NAN, NAN, NAN};
+static int64_t last_values;
+
+static lv_obj_t *add_label(lv_obj_t *screen, lv_coord_t y, lv_color_t color) {
+  lv_obj_t *label = lv_label_create(screen);
+  lv_obj_set_style_text_color(label, color, LV_PART_MAIN);
+  lv_obj_align(label, LV_ALIGN_TOP_LEFT, 2, y);
+  lv_label_set_text(label, "");
+  return label;
+}
+
+static esp_err_t add_chart(lv_obj_t *screen, lv_coord_t y, lv_coord_t h,
+                           const stripchart_config_t *cfg,
+                           stripchart_t **out) {
+  ESP_RETURN_ON_ERROR(stripchart_create(screen, cfg, out), TAG, "chart");
+  lv_obj_t *obj = stripchart_obj(*out);
+  lv_obj_set_size(obj, CHART_W, h);
+  lv_obj_align(obj, LV_ALIGN_TOP_MID, 0, y + TITLE_H);
+  return ESP_OK;
+}
+
+esp_err_t dashboard_create(lv_obj_t *screen) {
+  ESP_RETURN_ON_ERROR(pubsub_subscribe(topic_imu, "lcd", IMU_DEPTH, false,
+                                       &imu),
+                      TAG, "imu");
+  ESP_RETURN_ON_ERROR(pubsub_subscribe(topic_distance, "lcd", SLOW_DEPTH,
+                                       false, &distance),
+                      TAG, "distance");
+  ESP_RETURN_ON_ERROR(pubsub_subscribe(topic_temperature, "lcd", SLOW_DEPTH,
+                                       false, &temperature),
+                      TAG, "temperature");
+
+  const stripchart_config_t gyro_cfg = {
+      .points = GYRO_POINTS,
+      .decimation = GYRO_DECIMATION,
+      .min = -GYRO_RANGE,
+      .max = GYRO_RANGE,
+      .n_series = 3,
+      .colors = xyz_colors,
+  };
+  const stripchart_config_t distance_cfg = {
+      .points = DISTANCE_POINTS,
+      .decimation = 1,
+      .min = 0,
+      .max = DISTANCE_MAX_MM,
+      .n_series = 1,
+      .colors = distance_color,
+  };
+  const stripchart_config_t temperature_cfg = {
+      .points = TEMPERATURE_POINTS,
+      .decimation = 1,
+      .min = TEMPERATURE_MIN,
+      .max = TEMPERATURE_MAX,
+      .n_series = STRIPCHART_MAX_SERIES,
+      .colors = temperature_colors,
+  };
+  ESP_RETURN_ON_ERROR(add_chart(screen, GYRO_Y, GYRO_H, &gyro_cfg,
+                                &gyro_chart),
+                      TAG, "gyro");
+  ESP_RETURN_ON_ERROR(add_chart(screen, DISTANCE_Y, DISTANCE_H,
+                                &distance_cfg, &distance_chart),
+                      TAG, "distance");
+  ESP_RETURN_ON_ERROR(add_chart(screen, TEMPERATURE_Y, TEMPERATURE_H,
+                                &temperature_cfg, &temperature_chart),
+                      TAG, "temperature");
+
+  gyro_title = add_label(screen, GYRO_Y, lv_color_white());
+  distance_title = add_label(screen, DISTANCE_Y, distance_color[0]);
+  temperature_title = add_label(screen, TEMPERATURE_Y, temperature_colors[0]);
+  status = add_label(screen, TEMPERATURE_Y + TITLE_H + TEMPERATURE_H + 2,
+                     lv_color_white());
+  return ESP_OK;
+}
+
+static void drain_imu(void) {
+  pubsub_sample_t *s;
+  while ((s = pubsub_receive(imu)) != NULL) {
+    const imu_sample_t *v = (const imu_sample_t *)s->data;
+    for (int i = 0; i < 3; i++) {
+      last_gyro[i] = v->gyro[i] * 10 / GYRO_LSB_PER_DPS;
+    }
+    pubsub_release(s);
+    stripchart_push(gyro_chart, last_gyro);
+  }
+}
+
+static void drain_distance(void) {
+  pubsub_sample_t *s;
+  while ((s = pubsub_receive(distance)) != NULL) {
+    last_cm = ((const distance_sample_t *)s->data)->cm;
+    pubsub_release(s);
+    int32_t mm = lroundf(last_cm * 10.0f);
+    stripchart_push(distance_chart, &mm);
+  }
+}
+
+// Alle Sensoren einer Messung kommen gemeinsam, daraus wird eine Spalte.
+// Sensoren ohne Wert bleiben in dieser Spalte leer.
+static void drain_temperature(void) {
+  int32_t row[STRIPCHART_MAX_SERIES];
+  bool any = false;
+  for (int i = 0; i < STRIPCHART_MAX_SERIES; i++) {
+    row[i] = LV_CHART_POINT_NONE;
+  }
+  pubsub_sample_t *s;
+  while ((s = pubsub_receive(temperature)) != NULL) {
+    const temperature_sample_t *v = (const temperature_sample_t *)s->data;
+    if (v->sensor < STRIPCHART_MAX_SERIES) {
+      last_celsius[v->sensor] = v->celsius;
+      row[v->sensor] = lroundf(v->celsius * 10.0f);
+      any = true;
+    }
+    pubsub_release(s);
+  }
+  if (any) {
+    stripchart_push(temperature_chart, row);
+  }
+}
+
+// Label nur bei geändertem Text neu setzen, sonst zeichnet LVGL es neu
+static void set_text(lv_obj_t *label, const char *text) {
+  if (strcmp(lv_label_get_text(label), text) != 0) {
+    lv_label_set_text(label, text);
+  }
+}
+
+static void update_titles(void) {
+  char text[64];
+  snprintf(text, sizeof(text), "Gyro deg/s  %ld  %ld  %ld",
+           (long)(last_gyro[0] / 10), (long)(last_gyro[1] / 10),
+           (long)(last_gyro[2] / 10));
+  set_text(gyro_title, text);
+  if (isnan(last_cm)) {
+    set_text(distance_title, "Abstand  -");
+  } else {
+    snprintf(text, sizeof(text), "Abstand  %.1f cm", last_cm);
+    set_text(distance_title, text);
+  }
+  int n = snprintf(text, sizeof(text), "Temperatur");
+  for (int i = 0; i < STRIPCHART_MAX_SERIES; i++) {
+    if (!isnan(last_celsius[i])) {
+      n += snprintf(&text[n], sizeof(text) - n, "  %.1f", last_celsius[i]);
+    }
+  }
+  snprintf(&text[n], sizeof(text) - n, " C");
+  set_text(temperature_title, text);
+}
+
+void dashboard_update(void) {
+  drain_imu();
+  drain_distance();
+  drain_temperature();
+  stripchart_commit(gyro_chart);
+  stripchart_commit(distance_chart);
+  stripchart_commit(temperature_chart);
+
+  int64_t now = esp_timer_get_time();
+  if (now - last_values >= VALUES_MS * 1000LL) {
+    update_titles();
+    last_values = now;
+  }
+}
+
+void dashboard_set_status(const char *text) { set_text(status, text); }
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "esp_err.h"
+#include "lvgl.h"
+
+// Live-Diagramme für Gyroskop, Abstand und Temperatur auf dem ganzen
+// Bildschirm, gespeist vom Bus (hub_sensors.h). Abonniert beim Anlegen, die
+// Sensoren dürfen erst danach starten.
+esp_err_t dashboard_create(lv_obj_t *screen);
+
+// Holt alle neuen Samples vom Bus in die Diagramme und invalidiert die
+// geänderten Spalten. Einmal pro Frame vor lv_timer_handler() aufrufen.
+void dashboard_update(void);
+
+// Eine Zeile ganz unten für Statistik (Bildrate, Flush, Verluste)
+void dashboard_set_status(const char *text);
@@ -9,6 +9,9 @@
 #include "freertos/FreeRTOS.h" // FreeRTOS Basis-Header
 #include "freertos/task.h"     // FreeRTOS Task-Management
 #include "lvgl.h"              // Haupt-Header für die LVGL Grafikbibliothek
+#include "metrics.h" // Gemeinsame Messwerte (components/metrics)
+#include "dashboard.h" // Diagramme für die Sensorwerte
+#include "hub_sensors.h" // Sensoren und Bus, wie im sensor_hub-Projekt
 
 /* 
  * Allgemeine Panel-Parameter
@@ -58,6 +61,25 @@ static lv_color_t *buf_a, *buf_b;
 // Tag für Log-Ausgaben, um Nachrichten dieser Komponente im seriellen Monitor
 // zu identifizieren.
 static const char *TAG = "LCD_DEMO";
+// Messwerte des Flush-Pfads: Dauer von esp_lcd_panel_draw_bitmap und die
+// übertragenen Bytes. Werden einmal pro Sekunde unten auf dem Display
+// angezeigt.
+static metric_t *flush_us, *flush_bytes;
+// Dauer eines Durchlaufs der Hauptschleife (Bus leeren + lv_timer_handler)
+static metric_t *frame_us;
+#define METRICS_PERIOD_MS 1000
+#define METRICS_PRINT_EVERY 10 // Konsole nur alle 10 s
+
+// Topics des Busses, die Sensor-Tasks aus components/hub_sensors
+// veröffentlichen darauf.
+// Einziger Abonnent ist das Dashboard, der IMU-Pool muss nur dessen Ring
+// füllen können.
+pubsub_topic_t *topic_imu;
+pubsub_topic_t *topic_distance;
+pubsub_topic_t *topic_temperature;
+#define IMU_POOL 80
+#define DISTANCE_POOL 12
+#define TEMPERATURE_POOL 12
 
 /* 
  * Kleine Hilfsfunktionen
@@ -91,9 +113,12 @@ static void lv_tick_cb(void *arg) {
 // a:   Der Bereich (Area) des Displays, der aktualisiert werden soll. 
 // map: Zeiger auf den Puffer mit den Farbdaten (Pixeln), die gezeichnet werden sollen.
 static void flush_cb(lv_disp_drv_t *drv, const lv_area_t *a, lv_color_t *map) {
+  int64_t start = esp_timer_get_time(); // Startzeit für die Messung
   // Sendet die Bitmap-Daten (Pixeldaten) an das LCD-Panel für den angegebenen
   // Bereich.
   esp_lcd_panel_draw_bitmap(panel, a->x1, a->y1, a->x2 + 1, a->y2 + 1, map);
+  metrics_record(flush_us, esp_timer_get_time() - start);
+  metrics_add(flush_bytes, lv_area_get_size(a) * COLOR_SIZE);
   // LVGL mitteilen, dass der Flush-Vorgang abgeschlossen ist und der Puffer
   // wiederverwendet werden kann.
   lv_disp_flush_ready(drv);
@@ -104,6 +129,10 @@ static void flush_cb(lv_disp_drv_t *drv, const lv_area_t *a, lv_color_t *map) {
  */
 void app_main(void) {
   ESP_LOGI(TAG, "Starte Applikation (boot)"); // Log-Nachricht beim Start
+  // Messwerte registrieren, bevor der erste Flush kommt
+  flush_us = metrics_histogram("lcd.flush_us", "us");
+  flush_bytes = metrics_counter("lcd.bytes", "B");
+  frame_us = metrics_histogram("lcd.frame_us", "us");
 
   /* 1 ─ Hintergrundbeleuchtung & RD-Pin initialisieren */
   backlight_on(); // Hintergrundbeleuchtung einschalten.
@@ -209,11 +238,9 @@ void app_main(void) {
   drv.flush_cb =
       flush_cb; // Die oben definierte flush_cb Funktion als Callback zuweisen.
   drv.draw_buf = &draw_buf; // Zeiger auf die LVGL-Zeichenpufferstruktur setzen.
-  drv.full_refresh =
-      1; // Wichtig für manche Setups: Erzwingt ein vollständiges Neuzeichnen
-         // des Puffers, um "halb zerschnittene" Artefakte bei partiellem
-         // Refresh zu vermeiden, besonders wenn Puffer kleiner als der
-         // Bildschirm sind.
+  // Kein full_refresh: LVGL schickt nur die invalidierten Bereiche, bei den
+  // Diagrammen also nur die Spalten mit neuen Punkten statt 150 kB pro
+  // Frame.
   lv_disp_drv_register(
       &drv); // Den konfigurierten Treiber bei LVGL registrieren.
 
@@ -230,50 +257,75 @@ void app_main(void) {
   // Mikrosekunden) auslöst.
   esp_timer_start_periodic(tick, 10 * 1000);
 
-  /* 9 ─ UI : Erstellung von drei "Hello-World" Labels */
+  /* 9 ─ UI : Dashboard mit den Sensordiagrammen */
   // Hintergrund des aktiven Bildschirms (Screen) konfigurieren:
   // Deckkraft auf voll (opak) setzen.
   lv_obj_set_style_bg_opa(lv_scr_act(), LV_OPA_COVER, LV_PART_MAIN);
   // Hintergrundfarbe auf Schwarz setzen.
   lv_obj_set_style_bg_color(lv_scr_act(), lv_color_black(), LV_PART_MAIN);
 
-  // Drei LVGL Label-Objekte auf dem aktiven Bildschirm erstellen.
-  lv_obj_t *lbl_red = lv_label_create(lv_scr_act());
-  lv_obj_t *lbl_green = lv_label_create(lv_scr_act());
-  lv_obj_t *lbl_blue = lv_label_create(lv_scr_act());
-
-  // Text für die Labels setzen.
-  lv_label_set_text(lbl_red, "Hello World");
-  lv_label_set_text(lbl_green, "Hello World");
-  lv_label_set_text(lbl_blue, "Hello World");
-
-  // Textfarbe für die Labels setzen.
-  lv_obj_set_style_text_color(lbl_red, lv_color_make(255, 0, 0),
-                              LV_PART_MAIN); // Rot
-  lv_obj_set_style_text_color(lbl_green, lv_color_make(0, 255, 0),
-                              LV_PART_MAIN); // Grün
-  lv_obj_set_style_text_color(lbl_blue, lv_color_make(0, 0, 255),
-                              LV_PART_MAIN); // Blau
+  // Topics anlegen und abonnieren, bevor die Sensoren das erste Sample
+  // veröffentlichen
+  ESP_ERROR_CHECK(pubsub_topic_create("imu", sizeof(imu_sample_t), IMU_POOL,
+                                      &topic_imu));
+  ESP_ERROR_CHECK(pubsub_topic_create("distance", sizeof(distance_sample_t),
+                                      DISTANCE_POOL, &topic_distance));
+  ESP_ERROR_CHECK(pubsub_topic_create("temp", sizeof(temperature_sample_t),
+                                      TEMPERATURE_POOL, &topic_temperature));
+  ESP_ERROR_CHECK(dashboard_create(lv_scr_act()));
 
-  // Labels auf dem Bildschirm ausrichten.
-  lv_obj_align(lbl_red, LV_ALIGN_TOP_MID, 0,
-               40); // Oben mittig, mit 40 Pixeln Abstand vom oberen Rand.
-  lv_obj_align(lbl_green, LV_ALIGN_CENTER, 0,
-               0); // Exakt in der Mitte des Bildschirms.
-  lv_obj_align(lbl_blue, LV_ALIGN_BOTTOM_MID, 0,
-               -40); // Unten mittig, mit 40 Pixeln Abstand vom unteren Rand
-                     // (nach oben verschoben).
+  // Die Temperatur zuerst, sie bestimmt die Schallgeschwindigkeit
+  if (temperature_start() != ESP_OK) {
+    ESP_LOGW(TAG, "Kein DS18x20 gefunden");
+  }
+  ESP_ERROR_CHECK(imu_start());
+  ESP_ERROR_CHECK(distance_start());
 
   /* 10 ─ Hauptschleife der Applikation */
   ESP_LOGI(TAG,
            "Applikation läuft (running)"); // Log-Nachricht, dass die
                                            // Initialisierung abgeschlossen ist.
+  int64_t last_metrics = 0; // Zeitpunkt der letzten Aktualisierung in µs
+  uint64_t last_bytes = 0;  // lcd.bytes bei der letzten Aktualisierung
+  uint32_t reports = 0;
   while (true) {
     // Kurze Pause von 10 Millisekunden, um anderen Tasks (z.B. Systemtasks)
     // Rechenzeit zu geben.
     vTaskDelay(pdMS_TO_TICKS(10));
-    // LVGL Timer-Handler aufrufen. Diese Funktion ist essentiell für LVGL,
-    // da sie Animationen, Events und das Neuzeichnen von Objekten managed.
+    // Einmal pro Sekunde die Statuszeile: Dauer eines Frames, übertragene
+    // Bytes pro Sekunde und verlorene IMU-Samples
+    int64_t now = esp_timer_get_time();
+    if (now - last_metrics >= METRICS_PERIOD_MS * 1000LL) {
+      metrics_value_t frame, bytes;
+      metrics_snapshot(frame_us, &frame);
+      metrics_snapshot(flush_bytes, &bytes);
+      // Verluste auf "imu" (Topic 0), einziger Abonnent ist das Dashboard
+      pubsub_stats_t bus;
+      uint32_t dropped = 0;
+      if (pubsub_get_stats(0, &bus)) {
+        dropped = bus.no_buffer;
+        if (bus.n_subs > 0) {
+          dropped += bus.subs[0].dropped;
+        }
+      }
+      char text[64];
+      snprintf(text, sizeof(text), "p99 %lu us  %lu kB/s  drop %lu",
+               (unsigned long)metrics_percentile(&frame, 99),
+               (unsigned long)((bytes.count - last_bytes) / 1024),
+               (unsigned long)dropped);
+      dashboard_set_status(text);
+      last_bytes = bytes.count;
+      if (++reports % METRICS_PRINT_EVERY == 0) {
+        pubsub_print_stats(stdout);
+        metrics_print(stdout);
+      }
+      last_metrics = now;
+    }
+    // Neue Samples in die Diagramme, danach den LVGL Timer-Handler
+    // aufrufen. Diese Funktion ist essentiell für LVGL, da sie
+    // Animationen, Events und das Neuzeichnen von Objekten managed.
+    dashboard_update();
     lv_timer_handler();
+    metrics_record(frame_us, esp_timer_get_time() - now);
   }
-}
\ No newline at end of file
+}
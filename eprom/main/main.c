@@ -1,4 +1,6 @@
 #include "driver/i2c.h"
+#include "esp_timer.h"
+#include "metrics.h"
 #include <stdio.h>
 #include <stdint.h>
 
@@ -8,6 +10,9 @@
 #define FREQ 100000
 #define TIMEOUT_MS 1000
 
+// bus time per transfer (without the write cycle delay) and failed transfers
+static metric_t *i2c_write_us, *i2c_read_us, *i2c_errors;
+
 // function prototypes
 void init_i2c();
 void write_byte(uint8_t, uint8_t);
@@ -22,6 +27,9 @@ int app_main(void) {
   uint8_t addr = full_mem_addr;
   uint8_t read_data[100] = {0};
 
+  i2c_write_us = metrics_histogram("i2c.write_us", "us");
+  i2c_read_us = metrics_histogram("i2c.read_us", "us");
+  i2c_errors = metrics_counter("i2c.errors", "");
   init_i2c();
 
   // write the data
@@ -40,6 +48,7 @@ int app_main(void) {
     addr++;
   }
   printf("%s\n", read_data);
+  metrics_print(stdout);
   return 0; // normal termination
 }
 
@@ -69,7 +78,12 @@ void write_byte(uint8_t mem_addr, uint8_t data) {
   i2c_master_write_byte(cmd, mem_addr, true);
   i2c_master_write_byte(cmd, data, true);
   i2c_master_stop(cmd);
-  i2c_master_cmd_begin(I2C_NUM_0, cmd, TIMEOUT_MS / portTICK_PERIOD_MS);
+  int64_t start = esp_timer_get_time();
+  if (i2c_master_cmd_begin(I2C_NUM_0, cmd, TIMEOUT_MS / portTICK_PERIOD_MS) !=
+      ESP_OK) {
+    metrics_inc(i2c_errors);
+  }
+  metrics_record(i2c_write_us, esp_timer_get_time() - start);
   i2c_cmd_link_delete(cmd);
   vTaskDelay(pdMS_TO_TICKS(10));
 }
@@ -85,6 +99,11 @@ void read_byte(uint8_t mem_addr, uint8_t *data) {
   i2c_master_write_byte(cmd, EEPROM_ADDR | I2C_MASTER_READ, true);
   i2c_master_read_byte(cmd, data, I2C_MASTER_NACK);
   i2c_master_stop(cmd);
-  i2c_master_cmd_begin(I2C_NUM_0, cmd, TIMEOUT_MS / portTICK_PERIOD_MS);
+  int64_t start = esp_timer_get_time();
+  if (i2c_master_cmd_begin(I2C_NUM_0, cmd, TIMEOUT_MS / portTICK_PERIOD_MS) !=
+      ESP_OK) {
+    metrics_inc(i2c_errors);
+  }
+  metrics_record(i2c_read_us, esp_timer_get_time() - start);
   i2c_cmd_link_delete(cmd);
 }
\ No newline at end of file
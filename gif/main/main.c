@@ -1,3 +1,6 @@
+#include "binlog.h"    // Binärlogger für den Flush-Callback
+#include "driver/uart.h" // Eigene UART für den Profiler
+#include "profiler.h"    // Statistischer CPU-Profiler
 #include "esp_log.h"   // Für Logging-Funktionen (ESP_LOGI, ESP_LOGE, etc.)
 #include "esp_timer.h" // Für hochauflösende Timer (wird für LVGL Ticks benötigt)
 #include "freertos/FreeRTOS.h" // FreeRTOS Basis-Header
@@ -71,6 +74,16 @@ static const int data_pins[8] = {36, 35, 38, 39, 40, 41, 42, 37};
   "/sdcard/anim.gif" // Vollständiger Pfad zur GIF-Datei im VFS. \
   //  (z.B. "anim.gif" nicht "animation_bild.gif")
 
+// ===== Profiler =====
+// 1 = Samples von beiden Kernen über PROFILER_UART senden, z.B. an einen
+// USB-UART-Adapter an PROFILER_TX_GPIO. Auswertung mit
+// components/profiler/host/prof_fold (Flame Graph für lv_timer_handler, den
+// GIF-Dekoder und die Flushes).
+#define PROFILER 0
+#define PROFILER_UART UART_NUM_1
+#define PROFILER_TX_GPIO 17
+#define PROFILER_BAUD 921600
+
 // ===== LVGL Log-Funktion =====
 #if LV_USE_LOG // Nur kompilieren, wenn LV_USE_LOG in lv_conf.h aktiviert ist
 // Callback-Funktion, um LVGL Log-Nachrichten über das ESP-IDF Logging-System
@@ -88,8 +101,10 @@ static void lvgl_log_cb(const char *buf) {
 static void lvgl_flush_cb(lv_disp_drv_t *drv, const lv_area_t *area,
                           lv_color_t *color_p) {
   // Debug-Ausgabe, um zu sehen, wann und welcher Bereich geflusht wird.
-  ESP_LOGI(TAG, "Flush callback called! Area: x1=%d, y1=%d, x2=%d, y2=%d",
-           area->x1, area->y1, area->x2, area->y2);
+  // Binär statt ESP_LOGI, damit das Formatieren nicht jeden Flush bremst
+  // (Dekodieren mit components/binlog/host/binlog_decode).
+  BINLOG("Flush callback called! Area: x1=%d, y1=%d, x2=%d, y2=%d", area->x1,
+         area->y1, area->x2, area->y2);
 
   // Panel-Handle aus den Benutzerdaten des Treibers holen.
   esp_lcd_panel_handle_t panel = (esp_lcd_panel_handle_t)drv->user_data;
@@ -186,8 +201,34 @@ static esp_err_t init_sd_card(void) {
   return ESP_OK;               // Erfolg zurückgeben
 }
 
+#if PROFILER
+// Startet den Profiler auf einer eigenen UART, die Konsole ist mit binlog
+// belegt
+static void start_profiler(void) {
+  uart_config_t config = {
+      .baud_rate = PROFILER_BAUD,
+      .data_bits = UART_DATA_8_BITS,
+      .parity = UART_PARITY_DISABLE,
+      .stop_bits = UART_STOP_BITS_1,
+      .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+      .source_clk = UART_SCLK_DEFAULT,
+  };
+  ESP_ERROR_CHECK(uart_driver_install(PROFILER_UART, 256, 8192, 0, NULL, 0));
+  ESP_ERROR_CHECK(uart_param_config(PROFILER_UART, &config));
+  ESP_ERROR_CHECK(uart_set_pin(PROFILER_UART, PROFILER_TX_GPIO,
+                               UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE,
+                               UART_PIN_NO_CHANGE));
+  ESP_ERROR_CHECK(profiler_start(PROFILER_UART, PROFILER_DEFAULT_HZ));
+}
+#endif
+
 // ===== Hauptfunktion der Applikation =====
 void app_main(void) {
+  // Binärlogger auf der Konsolen-UART starten (für den Flush-Callback)
+  ESP_ERROR_CHECK(binlog_start(BINLOG_CONSOLE_UART));
+#if PROFILER
+  start_profiler();
+#endif
   ESP_LOGI(TAG, "--- STARTE FINALES GIF DEMO ---");
 
   // --- 1. Initialisiere Display Hardware ---
@@ -1,4 +1,7 @@
+#include "binlog.h"
 #include "driver/i2c.h"
+#include "esp_timer.h"
+#include "metrics.h"
 #include <stdio.h>
 #include <time.h>
 
@@ -20,6 +23,12 @@
 #define I2C_MASTER_NUM 0
 #define I2C_MASTER_FREQ_HZ 400000
 
+// Alle 20 Messungen (10 s) die Kosten der Log-Aufrufe und die Messwerte
+// ausgeben
+#define STATS_EVERY 20
+
+static metric_t *i2c_read_us, *i2c_bytes, *i2c_errors;
+
 void wait_ms(int delay_ms) {
   clock_t start_time = clock();
   while ((clock() - start_time) * 1000 / CLOCKS_PER_SEC < delay_ms) {
@@ -49,10 +58,17 @@ void mpu6050_write_reg(uint8_t reg_addr, uint8_t data) {
                              sizeof(write_buf), 1000);
 }
 
-// MPU6050 Register lesen
+// MPU6050 Register lesen, Dauer inklusive Warten auf den Bus
 void mpu6050_read_reg(uint8_t reg_addr, uint8_t *data, size_t len) {
-  i2c_master_write_read_device(I2C_MASTER_NUM, MPU6050_ADDR, &reg_addr, 1, data,
-                               len, 1000);
+  int64_t start = esp_timer_get_time();
+  esp_err_t err = i2c_master_write_read_device(
+      I2C_MASTER_NUM, MPU6050_ADDR, &reg_addr, 1, data, len, 1000);
+  metrics_record(i2c_read_us, esp_timer_get_time() - start);
+  if (err == ESP_OK) {
+    metrics_add(i2c_bytes, 1 + len);
+  } else {
+    metrics_inc(i2c_errors);
+  }
 }
 
 // 16-bit Wert aus zwei 8-bit Registern lesen
@@ -63,11 +79,18 @@ int16_t read_16bit_value(uint8_t reg_addr) {
 }
 
 void app_main(void) {
+  // Ab hier gehen die Messwerte binär über die Konsolen-UART, lesbar mit
+  // components/binlog/host/binlog_decode
+  binlog_start(BINLOG_CONSOLE_UART);
+  i2c_read_us = metrics_histogram("i2c.read_us", "us");
+  i2c_bytes = metrics_counter("i2c.bytes", "B");
+  i2c_errors = metrics_counter("i2c.errors", "");
   i2c_master_init();
   printf("I2C initialisiert\n");
   mpu6050_write_reg(PWR_MGMT_1, 0x00);
   printf("MPU6050 initialisiert\n");
 
+  uint32_t samples = 0;
   while (1) {
     // Beschleunigungsdaten lesen
     int16_t accel_x = read_16bit_value(ACCEL_XOUT_H);
@@ -79,9 +102,22 @@ void app_main(void) {
     int16_t gyro_y = read_16bit_value(GYRO_YOUT_H);
     int16_t gyro_z = read_16bit_value(GYRO_ZOUT_H);
 
-    // Daten ausgeben
-    printf("Beschleunigung: X=%d, Y=%d, Z=%d\n", accel_x, accel_y, accel_z);
-    printf("Gyroskop: X=%d, Y=%d, Z=%d\n", gyro_x, gyro_y, gyro_z);
+    // Daten ausgeben, formatiert wird erst auf dem PC
+    BINLOG("Beschleunigung: X=%d, Y=%d, Z=%d", accel_x, accel_y, accel_z);
+    BINLOG("Gyroskop: X=%d, Y=%d, Z=%d", gyro_x, gyro_y, gyro_z);
+
+    if (++samples % STATS_EVERY == 0) {
+      binlog_stats_t st = binlog_get_stats(0);
+      if (st.calls) {
+        BINLOG("binlog: %lu Aufrufe, %lu Zyklen im Mittel, max %lu, "
+               "%lu verworfen",
+               (unsigned long)st.calls,
+               (unsigned long)(st.cycles / st.calls),
+               (unsigned long)st.cycles_max, (unsigned long)st.dropped);
+      }
+      // Als Text, binlog_decode reicht ihn unverändert durch
+      metrics_print(stdout);
+    }
 
     wait_ms(500);
   }
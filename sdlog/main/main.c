@@ -0,0 +1,305 @@
+#include "driver/gpio.h"
+#include "driver/i2c.h"
+#include "ds18x20.h"
+#include "echo_capture.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "periph_trace.h"
+#include "sd_card.h"
+#include "sd_logger.h"
+#include <onewire_bus.h>
+#include <stdio.h>
+#include <string.h>
+
+// MPU6050 wie im gyro-Projekt
+#define MPU6050_ADDR 0x68
+#define SMPLRT_DIV 0x19
+#define MPU_CONFIG 0x1A
+#define ACCEL_XOUT_H 0x3B
+#define PWR_MGMT_1 0x6B
+// ACCEL_XOUT_H bis GYRO_ZOUT_L: Beschleunigung, Temperatur, Gyroskop
+#define IMU_SAMPLE_BYTES 14
+
+#define I2C_MASTER_SCL_IO 9
+#define I2C_MASTER_SDA_IO 8
+#define I2C_MASTER_NUM 0
+#define I2C_MASTER_FREQ_HZ 400000
+
+#define ONEWIRE_GPIO 18
+
+// HC-SR04 wie im ultraschall-Projekt, ein Sensor
+#define TRIGGER_GPIO GPIO_NUM_1
+#define ECHO_GPIO GPIO_NUM_2
+#define DISTANCE_PERIOD_MS 60 // Nachhall des letzten Pings abwarten
+#define MAX_ECHO_MS 30        // ~5 m
+#define MIN_RANGE_CM 2.0f
+#define MAX_RANGE_CM 400.0f
+#define DEFAULT_TEMPERATURE_C 20.0f
+
+#define IMU_PERIOD_US 1000 // 1 kHz
+#define IMU_TASK_PRIORITY 10
+#define TEMP_PERIOD_MS 1000
+#define LOG_SECONDS 60
+#define LOG_PATH SD_MOUNT_POINT "/imu.bin"
+// Mit CONFIG_PERIPH_TRACE_ENABLE (menuconfig) landen alle I2C-, 1-Wire- und
+// GPIO-Zugriffe zusätzlich in dieser Datei (components/periph_trace)
+#define TRACE_PATH SD_MOUNT_POINT "/trace.bin"
+// Doppelt so viel wie die IMU-Daten brauchen: Platz für Abstand, Temperatur
+// und den Rest des letzten Blocks
+#define LOG_BYTES                                                              \
+  ((uint64_t)LOG_SECONDS * (1000000 / IMU_PERIOD_US) *                         \
+   (SDL_RECORD_HEADER + IMU_SAMPLE_BYTES) * 2)
+
+enum { STREAM_IMU = 1, STREAM_TEMP, STREAM_DISTANCE };
+static const char *const stream_names[] = {"imu", "temp", "distance"};
+
+static const char *TAG = "sdlog";
+
+static sd_logger_t *logger;
+static TaskHandle_t imu_task_handle;
+static SemaphoreHandle_t tasks_stopped;
+static volatile bool running = true;
+static uint32_t imu_missed; // Takte, in denen die Task noch beschäftigt war
+static uint32_t imu_errors;
+
+static ds18x20_t sensors;
+// Mittel aller DS18x20 in °C, geschrieben von der Temperatur-Task
+static volatile float air_celsius = DEFAULT_TEMPERATURE_C;
+
+static QueueHandle_t echo_queue;
+static echo_channel_t echo_channel;
+
+static void i2c_master_init(void) {
+  i2c_config_t conf = {
+      .mode = I2C_MODE_MASTER,
+      .sda_io_num = I2C_MASTER_SDA_IO,
+      .scl_io_num = I2C_MASTER_SCL_IO,
+      .sda_pullup_en = GPIO_PULLUP_ENABLE,
+      .scl_pullup_en = GPIO_PULLUP_ENABLE,
+      .master.clk_speed = I2C_MASTER_FREQ_HZ,
+  };
+  ESP_ERROR_CHECK(i2c_param_config(I2C_MASTER_NUM, &conf));
+  ESP_ERROR_CHECK(i2c_driver_install(I2C_MASTER_NUM, conf.mode, 0, 0, 0));
+}
+
+static esp_err_t mpu6050_write_reg(uint8_t reg_addr, uint8_t data) {
+  uint8_t write_buf[2] = {reg_addr, data};
+  return i2c_master_write_to_device(I2C_MASTER_NUM, MPU6050_ADDR, write_buf,
+                                    sizeof(write_buf), pdMS_TO_TICKS(100));
+}
+
+static void imu_timer_cb(void *arg) { xTaskNotifyGive(imu_task_handle); }
+
+// Liest alle 14 Messregister in einem Zug, das dauert bei 400 kHz etwa
+// 0,5 ms und passt damit in den 1-ms-Takt
+static void imu_task(void *arg) {
+  uint8_t reg = ACCEL_XOUT_H;
+  uint8_t sample[IMU_SAMPLE_BYTES];
+  while (running) {
+    uint32_t ticks = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+    if (ticks == 0) {
+      continue;
+    }
+    imu_missed += ticks - 1;
+    int64_t t = esp_timer_get_time();
+    if (i2c_master_write_read_device(I2C_MASTER_NUM, MPU6050_ADDR, &reg, 1,
+                                     sample, sizeof(sample),
+                                     pdMS_TO_TICKS(20)) != ESP_OK) {
+      imu_errors++;
+      continue;
+    }
+    sd_logger_write(logger, STREAM_IMU, t, sample, sizeof(sample));
+  }
+  xSemaphoreGive(tasks_stopped);
+  vTaskDelete(NULL);
+}
+
+// Ein Datensatz pro Sensor: [index][°C als float]
+static void temp_task(void *arg) {
+  TickType_t last_wake = xTaskGetTickCount();
+  while (running) {
+    if (ds18x20_convert_all(&sensors) == ESP_OK) {
+      ds18x20_read_all(&sensors);
+    }
+    int64_t t = esp_timer_get_time();
+    float sum = 0;
+    int n = 0;
+    for (size_t i = 0; i < sensors.count; i++) {
+      if (sensors.sensors[i].valid) {
+        uint8_t rec[1 + sizeof(float)] = {(uint8_t)i};
+        memcpy(&rec[1], &sensors.sensors[i].temperature, sizeof(float));
+        sd_logger_write(logger, STREAM_TEMP, t, rec, sizeof(rec));
+        sum += sensors.sensors[i].temperature;
+        n++;
+      }
+    }
+    if (n > 0) {
+      air_celsius = sum / n;
+    }
+    vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(TEMP_PERIOD_MS));
+  }
+  xSemaphoreGive(tasks_stopped);
+  vTaskDelete(NULL);
+}
+
+static void send_trigger_pulse(void) {
+  gpio_set_level(TRIGGER_GPIO, 0);
+  esp_rom_delay_us(2);
+  gpio_set_level(TRIGGER_GPIO, 1);
+  esp_rom_delay_us(10);
+  gpio_set_level(TRIGGER_GPIO, 0);
+}
+
+// Ein Ping pro Takt, ein Datensatz pro Echo: [index][cm als float], wie bei
+// der Temperatur. Die Sequenznummer verwirft Echos eines früheren Pings
+// (siehe echo_capture.h).
+static void distance_task(void *arg) {
+  uint32_t seq = 0;
+  TickType_t last_wake = xTaskGetTickCount();
+  while (running) {
+    echo_capture_arm(&echo_channel, ++seq);
+    int64_t fired = esp_timer_get_time();
+    send_trigger_pulse();
+
+    echo_pulse_t pulse;
+    while (xQueueReceive(echo_queue, &pulse, pdMS_TO_TICKS(MAX_ECHO_MS)) ==
+           pdTRUE) {
+      if (pulse.seq != seq) {
+        continue;
+      }
+      // Schall in Luft: 331,3 m/s + 0,606 m/s pro °C, hin und zurück
+      float echo_us = echo_ticks_to_us(echo_pulse_ticks(&pulse));
+      float cm = echo_us / 2.0f * (331.3f + 0.606f * air_celsius) / 10000.0f;
+      if (cm >= MIN_RANGE_CM && cm <= MAX_RANGE_CM) {
+        uint8_t rec[1 + sizeof(float)] = {0};
+        memcpy(&rec[1], &cm, sizeof(float));
+        sd_logger_write(logger, STREAM_DISTANCE, fired, rec, sizeof(rec));
+      }
+      break;
+    }
+    vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(DISTANCE_PERIOD_MS));
+  }
+  xSemaphoreGive(tasks_stopped);
+  vTaskDelete(NULL);
+}
+
+static esp_err_t distance_init(void) {
+  gpio_config_t trig = {
+      .pin_bit_mask = 1ULL << TRIGGER_GPIO,
+      .mode = GPIO_MODE_OUTPUT,
+      .intr_type = GPIO_INTR_DISABLE,
+  };
+  esp_err_t err = gpio_config(&trig);
+  if (err != ESP_OK) {
+    return err;
+  }
+  echo_queue = xQueueCreate(4, sizeof(echo_pulse_t));
+  if (echo_queue == NULL) {
+    return ESP_ERR_NO_MEM;
+  }
+  return echo_capture_add(&echo_channel, ECHO_GPIO, 0, echo_queue);
+}
+
+static void print_stats(const sd_logger_stats_t *s) {
+  printf("%lu Datensätze, %lu verworfen, %lu/%lu Blöcke, Schreiben max "
+         "%lu us, Mittel %lu us, IMU verpasst %lu, I2C-Fehler %lu\n",
+         (unsigned long)s->records, (unsigned long)s->dropped,
+         (unsigned long)s->blocks, (unsigned long)s->max_blocks,
+         (unsigned long)s->write_us_max,
+         (unsigned long)(s->blocks ? s->write_us_sum / s->blocks : 0),
+         (unsigned long)imu_missed, (unsigned long)imu_errors);
+}
+
+void app_main(void) {
+  ESP_ERROR_CHECK(init_sd_card());
+
+#if CONFIG_PERIPH_TRACE_ENABLE
+  // Vor den Sensoren, damit der Mitschnitt mit dem Einrichten beginnt
+  // (ohne Datei ESP_ERR_INVALID_ARG)
+  FILE *trace = fopen(TRACE_PATH, "wb");
+  ESP_ERROR_CHECK(periph_trace_start_file(trace));
+#endif
+
+  i2c_master_init();
+  ESP_ERROR_CHECK(mpu6050_write_reg(PWR_MGMT_1, 0x00));
+  // DLPF 184 Hz, damit liefert der Sensor 1 kHz ohne Teiler
+  ESP_ERROR_CHECK(mpu6050_write_reg(MPU_CONFIG, 0x01));
+  ESP_ERROR_CHECK(mpu6050_write_reg(SMPLRT_DIV, 0x00));
+
+  // Temperatur und Abstand sind optional. Ohne DS18x20 rechnet der Abstand
+  // mit DEFAULT_TEMPERATURE_C; ohne HC-SR04 kommen einfach keine Echos, nur
+  // ein Fehler beim Einrichten lässt den Abstand weg.
+  onewire_bus_handle_t bus = NULL;
+  onewire_bus_config_t cfg = {.bus_gpio_num = ONEWIRE_GPIO};
+  onewire_bus_rmt_config_t rmt = {.max_rx_bytes = 10};
+  int n_tasks = 1;
+  bool temperature = onewire_new_bus_rmt(&cfg, &rmt, &bus) == ESP_OK &&
+                     ds18x20_init(&sensors, bus) == ESP_OK &&
+                     sensors.count > 0;
+  if (temperature) {
+    n_tasks++;
+  } else {
+    ESP_LOGW(TAG, "Kein DS18x20 gefunden, ohne Temperatur");
+  }
+  bool distance = distance_init() == ESP_OK;
+  if (distance) {
+    n_tasks++;
+  } else {
+    ESP_LOGW(TAG, "Echo-Capture nicht verfügbar, ohne Abstand");
+  }
+
+  sd_logger_config_t log_cfg = {
+      .base_path = SD_MOUNT_POINT,
+      .path = LOG_PATH,
+      .size = LOG_BYTES,
+      .streams = stream_names,
+      .n_streams = sizeof(stream_names) / sizeof(stream_names[0]),
+  };
+  ESP_ERROR_CHECK(sd_logger_open(&log_cfg, &logger));
+
+  tasks_stopped = xSemaphoreCreateCounting(3, 0);
+  // Kern 1, die Schreib-Task des Loggers und die SD-Karte laufen frei
+  xTaskCreatePinnedToCore(imu_task, "imu", 3072, NULL, IMU_TASK_PRIORITY,
+                          &imu_task_handle, 1);
+  if (temperature) {
+    xTaskCreate(temp_task, "temp", 3072, NULL, 4, NULL);
+  }
+  if (distance) {
+    xTaskCreatePinnedToCore(distance_task, "distance", 3072, NULL, 6, NULL, 1);
+  }
+
+  const esp_timer_create_args_t timer_args = {
+      .callback = imu_timer_cb,
+      .name = "imu",
+  };
+  esp_timer_handle_t timer;
+  ESP_ERROR_CHECK(esp_timer_create(&timer_args, &timer));
+  ESP_ERROR_CHECK(esp_timer_start_periodic(timer, IMU_PERIOD_US));
+
+  for (int s = 0; s < LOG_SECONDS; s++) {
+    vTaskDelay(pdMS_TO_TICKS(1000));
+    sd_logger_stats_t stats = sd_logger_get_stats(logger);
+    print_stats(&stats);
+  }
+
+  // Erst alle Erzeuger anhalten, dann die Datei schließen
+  esp_timer_stop(timer);
+  running = false;
+  for (int i = 0; i < n_tasks; i++) {
+    xSemaphoreTake(tasks_stopped, portMAX_DELAY);
+  }
+#if CONFIG_PERIPH_TRACE_ENABLE
+  periph_trace_stop();
+  fclose(trace);
+#endif
+  sd_logger_stats_t stats;
+  ESP_ERROR_CHECK(sd_logger_close(logger, &stats));
+  print_stats(&stats);
+  printf("%s geschlossen, %s\n", LOG_PATH,
+         stats.dropped || imu_missed ? "mit Verlusten" : "ohne Verluste");
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "hub_sensors.h"
+
+// Ausgaben. Jede startet eine Task, die ihre Topics selbst abonniert und
+// danach `ready` einmal freigibt; erst dann dürfen die Sensoren starten.
+esp_err_t display_start(SemaphoreHandle_t ready);
+esp_err_t logger_start(SemaphoreHandle_t ready);
+esp_err_t link_start(SemaphoreHandle_t ready);
+esp_err_t ble_start(SemaphoreHandle_t ready);
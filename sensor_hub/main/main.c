@@ -0,0 +1,82 @@
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "hub.h"
+#include "metrics.h"
+#include <stdio.h>
+
+// Alle Sensoren des Boards in einer Firmware: gyro, temperature und
+// ultraschall veröffentlichen auf dem Bus (components/pubsub), Display,
+// SD-Logger, UART und BLE lesen davon.
+
+// Puffer pro Topic. Die IMU kommt mit 1 kHz, der Pool muss die Ringe aller
+// vier Abonnenten gleichzeitig füllen können.
+#define IMU_POOL 128
+#define DISTANCE_POOL 16
+#define TEMPERATURE_POOL 16
+
+#define STATS_PERIOD_MS 5000
+#define METRICS_EVERY 6 // alle 30 s auch die Messwerte ausgeben
+
+static const char *TAG = "hub";
+
+pubsub_topic_t *topic_imu;
+pubsub_topic_t *topic_distance;
+pubsub_topic_t *topic_temperature;
+
+typedef esp_err_t (*output_start_fn_t)(SemaphoreHandle_t ready);
+
+static const struct {
+  const char *name;
+  output_start_fn_t start;
+} outputs[] = {
+    {"display", display_start},
+    {"logger", logger_start},
+    {"link", link_start},
+    {"ble", ble_start},
+};
+#define OUTPUT_COUNT (sizeof(outputs) / sizeof(outputs[0]))
+
+void app_main(void) {
+  ESP_ERROR_CHECK(pubsub_topic_create("imu", sizeof(imu_sample_t), IMU_POOL,
+                                      &topic_imu));
+  ESP_ERROR_CHECK(pubsub_topic_create("distance", sizeof(distance_sample_t),
+                                      DISTANCE_POOL, &topic_distance));
+  ESP_ERROR_CHECK(pubsub_topic_create("temp", sizeof(temperature_sample_t),
+                                      TEMPERATURE_POOL, &topic_temperature));
+
+  // Erst alle Abonnenten, sonst fehlen ihnen die ersten Samples. Fehlt die
+  // Hardware einer Ausgabe (z.B. keine SD-Karte), läuft der Rest weiter.
+  SemaphoreHandle_t ready = xSemaphoreCreateCounting(OUTPUT_COUNT, 0);
+  size_t started = 0;
+  for (size_t i = 0; i < OUTPUT_COUNT; i++) {
+    esp_err_t err = outputs[i].start(ready);
+    if (err == ESP_OK) {
+      started++;
+    } else {
+      ESP_LOGW(TAG, "Ausgabe %s nicht gestartet (%s)", outputs[i].name,
+               esp_err_to_name(err));
+    }
+  }
+  for (size_t i = 0; i < started; i++) {
+    xSemaphoreTake(ready, portMAX_DELAY);
+  }
+
+  // Die Temperatur zuerst, sie bestimmt die Schallgeschwindigkeit
+  if (temperature_start() != ESP_OK) {
+    ESP_LOGW(TAG, "Kein DS18x20 gefunden");
+  }
+  ESP_ERROR_CHECK(imu_start());
+  ESP_ERROR_CHECK(distance_start());
+  ESP_LOGI(TAG, "%u Ausgaben, Sensoren laufen", (unsigned)started);
+
+  uint32_t reports = 0;
+  while (1) {
+    vTaskDelay(pdMS_TO_TICKS(STATS_PERIOD_MS));
+    pubsub_print_stats(stdout);
+    if (++reports % METRICS_EVERY == 0) {
+      metrics_print(stdout);
+    }
+  }
+}
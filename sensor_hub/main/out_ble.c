@@ -0,0 +1,217 @@
+#include "esp_check.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "host/ble_hs.h"
+#include "hub.h"
+#include "nimble/nimble_port.h"
+#include "nimble/nimble_port_freertos.h"
+#include "nvs_flash.h"
+#include "services/gap/ble_svc_gap.h"
+#include "services/gatt/ble_svc_gatt.h"
+#include <stdio.h>
+#include <string.h>
+
+// GATT-Server wie im servo-Projekt (Nordic UART Service). Ein verbundenes
+// Handy mit einem BLE-Terminal bekommt alle BLE_PERIOD_MS eine Textzeile pro
+// Topic, jede kürzer als 20 Bytes, damit sie auch ohne größere MTU passt:
+//   G -12 3 250     Gyroskop in °/s
+//   D 81.4          Abstand in cm
+//   T 21.50         Temperatur in °C
+#define BLE_PERIOD_MS 200
+#define DEVICE_NAME "ESP32 Sensor Hub"
+#define GYRO_LSB_PER_DPS 131 // ±250 °/s
+#define POLL_MS 10
+#define DEPTH 16 // reicht für POLL_MS bei 1 kHz
+
+static const ble_uuid128_t UART_SERVICE_UUID =
+    BLE_UUID128_INIT(0x6e, 0x40, 0x00, 0x01, 0xb5, 0xa3, 0xf3, 0x93, 0xe0, 0xa9,
+                     0xe5, 0x0e, 0x24, 0xdc, 0xca, 0x9e);
+
+static const ble_uuid128_t UART_CHAR_UUID_TX =
+    BLE_UUID128_INIT(0x6e, 0x40, 0x00, 0x03, 0xb5, 0xa3, 0xf3, 0x93, 0xe0, 0xa9,
+                     0xe5, 0x0e, 0x24, 0xdc, 0xca, 0x9e);
+
+static const char *TAG = "ble";
+
+static uint16_t tx_handle;
+static uint8_t addr_type;
+// Nur eine Verbindung; geschrieben von der NimBLE-Task
+static volatile uint16_t conn_handle = BLE_HS_CONN_HANDLE_NONE;
+static volatile bool notify_enabled;
+
+static void advertise(void);
+
+// Lesen ist nicht vorgesehen, NimBLE braucht trotzdem einen Callback
+static int tx_access(uint16_t con_handle, uint16_t attr_handle,
+                     struct ble_gatt_access_ctxt *ctxt, void *arg) {
+  return 0;
+}
+
+static const struct ble_gatt_svc_def gatt_svcs[] = {
+    {.type = BLE_GATT_SVC_TYPE_PRIMARY,
+     .uuid = &UART_SERVICE_UUID.u,
+     .characteristics =
+         (struct ble_gatt_chr_def[]){
+             {.uuid = &UART_CHAR_UUID_TX.u,
+              .flags = BLE_GATT_CHR_F_NOTIFY,
+              .val_handle = &tx_handle,
+              .access_cb = tx_access},
+             {0}}},
+    {0}};
+
+static int gap_event(struct ble_gap_event *event, void *arg) {
+  switch (event->type) {
+  case BLE_GAP_EVENT_CONNECT:
+    if (event->connect.status == 0) {
+      conn_handle = event->connect.conn_handle;
+    } else {
+      advertise();
+    }
+    break;
+  case BLE_GAP_EVENT_DISCONNECT:
+    conn_handle = BLE_HS_CONN_HANDLE_NONE;
+    notify_enabled = false;
+    advertise();
+    break;
+  case BLE_GAP_EVENT_SUBSCRIBE:
+    if (event->subscribe.attr_handle == tx_handle) {
+      notify_enabled = event->subscribe.cur_notify;
+    }
+    break;
+  case BLE_GAP_EVENT_ADV_COMPLETE:
+    advertise();
+    break;
+  default:
+    break;
+  }
+  return 0;
+}
+
+static void advertise(void) {
+  struct ble_hs_adv_fields fields;
+  memset(&fields, 0, sizeof(fields));
+  const char *name = ble_svc_gap_device_name();
+  fields.name = (uint8_t *)name;
+  fields.name_len = strlen(name);
+  fields.name_is_complete = 1;
+  ble_gap_adv_set_fields(&fields);
+
+  struct ble_gap_adv_params adv_params;
+  memset(&adv_params, 0, sizeof(adv_params));
+  adv_params.conn_mode = BLE_GAP_CONN_MODE_UND;
+  adv_params.disc_mode = BLE_GAP_DISC_MODE_GEN;
+  ble_gap_adv_start(addr_type, NULL, BLE_HS_FOREVER, &adv_params, gap_event,
+                    NULL);
+}
+
+static void on_sync(void) {
+  ble_hs_id_infer_auto(0, &addr_type);
+  advertise();
+}
+
+static void host_task(void *param) { nimble_port_run(); }
+
+static void notify_line(const char *line, int len) {
+  uint16_t conn = conn_handle;
+  if (conn == BLE_HS_CONN_HANDLE_NONE || !notify_enabled || len <= 0) {
+    return;
+  }
+  struct os_mbuf *om = ble_hs_mbuf_from_flat(line, len);
+  if (om != NULL) {
+    // Gibt das mbuf auch im Fehlerfall frei
+    ble_gatts_notify_custom(conn, tx_handle, om);
+  }
+}
+
+// Leert den Ring und behält nur das neueste Sample
+static pubsub_sample_t *latest(pubsub_sub_t *sub) {
+  pubsub_sample_t *last = NULL, *s;
+  while ((s = pubsub_receive(sub)) != NULL) {
+    if (last != NULL) {
+      pubsub_release(last);
+    }
+    last = s;
+  }
+  return last;
+}
+
+// Die Ringe werden alle POLL_MS geleert, damit immer das neueste Sample
+// vorne liegt; gesendet wird nur alle BLE_PERIOD_MS
+static void ble_task(void *arg) {
+  pubsub_sub_t *imu, *distance, *temperature;
+  ESP_ERROR_CHECK(pubsub_subscribe(topic_imu, "ble", DEPTH, false, &imu));
+  ESP_ERROR_CHECK(
+      pubsub_subscribe(topic_distance, "ble", DEPTH, false, &distance));
+  ESP_ERROR_CHECK(
+      pubsub_subscribe(topic_temperature, "ble", DEPTH, false, &temperature));
+  xSemaphoreGive((SemaphoreHandle_t)arg);
+
+  // Neueste Samples bis zum nächsten Senden, NULL = nichts Neues
+  pubsub_sample_t *last[3] = {NULL};
+  pubsub_sub_t *subs[3] = {imu, distance, temperature};
+  char line[24];
+  TickType_t last_wake = xTaskGetTickCount();
+  TickType_t last_send = last_wake;
+  while (1) {
+    vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(POLL_MS));
+    for (int i = 0; i < 3; i++) {
+      pubsub_sample_t *s = latest(subs[i]);
+      if (s != NULL) {
+        if (last[i] != NULL) {
+          pubsub_release(last[i]);
+        }
+        last[i] = s;
+      }
+    }
+    if (last_wake - last_send < pdMS_TO_TICKS(BLE_PERIOD_MS)) {
+      continue;
+    }
+    last_send = last_wake;
+    if (last[0] != NULL) {
+      const imu_sample_t *v = (const imu_sample_t *)last[0]->data;
+      notify_line(line, snprintf(line, sizeof(line), "G %d %d %d\n",
+                                 v->gyro[0] / GYRO_LSB_PER_DPS,
+                                 v->gyro[1] / GYRO_LSB_PER_DPS,
+                                 v->gyro[2] / GYRO_LSB_PER_DPS));
+    }
+    if (last[1] != NULL) {
+      const distance_sample_t *v = (const distance_sample_t *)last[1]->data;
+      notify_line(line, snprintf(line, sizeof(line), "D %.1f\n", v->cm));
+    }
+    if (last[2] != NULL) {
+      const temperature_sample_t *v =
+          (const temperature_sample_t *)last[2]->data;
+      notify_line(line, snprintf(line, sizeof(line), "T %.2f\n", v->celsius));
+    }
+    for (int i = 0; i < 3; i++) {
+      if (last[i] != NULL) {
+        pubsub_release(last[i]);
+        last[i] = NULL;
+      }
+    }
+  }
+}
+
+esp_err_t ble_start(SemaphoreHandle_t ready) {
+  esp_err_t err = nvs_flash_init();
+  if (err == ESP_ERR_NVS_NO_FREE_PAGES ||
+      err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+    ESP_RETURN_ON_ERROR(nvs_flash_erase(), TAG, "nvs");
+    err = nvs_flash_init();
+  }
+  ESP_RETURN_ON_ERROR(err, TAG, "nvs");
+  ESP_RETURN_ON_ERROR(nimble_port_init(), TAG, "nimble");
+  ble_svc_gap_device_name_set(DEVICE_NAME);
+  ble_svc_gap_init();
+  ble_svc_gatt_init();
+  ble_gatts_count_cfg(gatt_svcs);
+  ble_gatts_add_svcs(gatt_svcs);
+  ble_hs_cfg.sync_cb = on_sync;
+  nimble_port_freertos_init(host_task);
+
+  if (xTaskCreatePinnedToCore(ble_task, "ble_out", 3072, ready, 3, NULL, 0) !=
+      pdPASS) {
+    return ESP_ERR_NO_MEM;
+  }
+  return ESP_OK;
+}
@@ -0,0 +1,237 @@
+#include "driver/gpio.h"
+#include "esp_check.h"
+#include "esp_heap_caps.h"
+#include "esp_lcd_ili9341.h"
+#include "esp_lcd_panel_io.h"
+#include "esp_lcd_panel_ops.h"
+#include "esp_lcd_panel_vendor.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "hub.h"
+#include "lvgl.h"
+#include <stdio.h>
+
+// ILI9341 am 8080-Bus mit LVGL, Pins und Panel-Einstellungen wie im
+// display-Projekt
+#define LCD_H_RES 240
+#define LCD_V_RES 320
+#define BUF_LINES 40
+#define PIN_RST 15
+#define PIN_BLK 13
+#define PIN_CS 7
+#define PIN_DC 8
+#define PIN_WR 16
+#define PIN_RD 9
+static const int data_pins[8] = {36, 35, 38, 39, 40, 41, 42, 37};
+
+#define FRAME_MS 10       // lv_timer_handler
+#define VALUES_MS 100     // Messwerte neu setzen
+#define BUS_STATS_MS 1000 // Statistik des Busses
+#define DEPTH 16
+
+static const char *TAG = "display";
+
+static esp_lcd_panel_handle_t panel;
+static lv_disp_draw_buf_t draw_buf;
+
+static void lv_tick_cb(void *arg) { lv_tick_inc(FRAME_MS); }
+
+static void flush_cb(lv_disp_drv_t *drv, const lv_area_t *a, lv_color_t *map) {
+  esp_lcd_panel_draw_bitmap(panel, a->x1, a->y1, a->x2 + 1, a->y2 + 1, map);
+  lv_disp_flush_ready(drv);
+}
+
+static esp_err_t lcd_init(void) {
+  gpio_config_t io = {
+      .pin_bit_mask = 1ULL << PIN_BLK | 1ULL << PIN_RD,
+      .mode = GPIO_MODE_OUTPUT,
+  };
+  ESP_RETURN_ON_ERROR(gpio_config(&io), TAG, "gpio");
+  gpio_set_level(PIN_BLK, 1);
+  gpio_set_level(PIN_RD, 1); // nur schreiben
+
+  size_t buf_bytes = LCD_H_RES * BUF_LINES * sizeof(lv_color_t);
+  lv_color_t *buf_a =
+      heap_caps_malloc(buf_bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA);
+  lv_color_t *buf_b =
+      heap_caps_malloc(buf_bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA);
+  if (!buf_a || !buf_b) {
+    return ESP_ERR_NO_MEM;
+  }
+  lv_init();
+  lv_disp_draw_buf_init(&draw_buf, buf_a, buf_b, LCD_H_RES * BUF_LINES);
+
+  esp_lcd_i80_bus_handle_t bus;
+  esp_lcd_i80_bus_config_t bus_cfg = {
+      .dc_gpio_num = PIN_DC,
+      .wr_gpio_num = PIN_WR,
+      .clk_src = LCD_CLK_SRC_DEFAULT,
+      .data_gpio_nums = {data_pins[0], data_pins[1], data_pins[2],
+                         data_pins[3], data_pins[4], data_pins[5],
+                         data_pins[6], data_pins[7]},
+      .bus_width = 8,
+      .max_transfer_bytes = buf_bytes,
+      .sram_trans_align = 4,
+  };
+  ESP_RETURN_ON_ERROR(esp_lcd_new_i80_bus(&bus_cfg, &bus), TAG, "i80 bus");
+  esp_lcd_panel_io_handle_t io_handle;
+  esp_lcd_panel_io_i80_config_t io_cfg = {
+      .cs_gpio_num = PIN_CS,
+      .pclk_hz = 10 * 1000 * 1000,
+      .trans_queue_depth = 10,
+      .dc_levels = {.dc_data_level = 1},
+      .lcd_cmd_bits = 8,
+      .lcd_param_bits = 8,
+  };
+  ESP_RETURN_ON_ERROR(esp_lcd_new_panel_io_i80(bus, &io_cfg, &io_handle), TAG,
+                      "panel io");
+  esp_lcd_panel_dev_config_t panel_cfg = {
+      .reset_gpio_num = PIN_RST,
+      .rgb_endian = LCD_RGB_ENDIAN_RGB,
+      .bits_per_pixel = 16,
+  };
+  ESP_RETURN_ON_ERROR(esp_lcd_new_panel_ili9341(io_handle, &panel_cfg, &panel),
+                      TAG, "ili9341");
+  ESP_RETURN_ON_ERROR(esp_lcd_panel_reset(panel), TAG, "reset");
+  ESP_RETURN_ON_ERROR(esp_lcd_panel_init(panel), TAG, "init");
+  ESP_RETURN_ON_ERROR(esp_lcd_panel_disp_on_off(panel, true), TAG, "on");
+  ESP_RETURN_ON_ERROR(esp_lcd_panel_mirror(panel, true, false), TAG, "mirror");
+
+  static lv_disp_drv_t drv;
+  lv_disp_drv_init(&drv);
+  drv.hor_res = LCD_H_RES;
+  drv.ver_res = LCD_V_RES;
+  drv.flush_cb = flush_cb;
+  drv.draw_buf = &draw_buf;
+  lv_disp_drv_register(&drv);
+
+  esp_timer_handle_t tick;
+  const esp_timer_create_args_t tick_args = {
+      .callback = lv_tick_cb,
+      .name = "lv_tick",
+  };
+  ESP_RETURN_ON_ERROR(esp_timer_create(&tick_args, &tick), TAG, "tick");
+  return esp_timer_start_periodic(tick, FRAME_MS * 1000);
+}
+
+static lv_obj_t *add_label(lv_coord_t y, lv_color_t color) {
+  lv_obj_t *label = lv_label_create(lv_scr_act());
+  lv_obj_set_style_text_color(label, color, LV_PART_MAIN);
+  lv_obj_align(label, LV_ALIGN_TOP_LEFT, 4, y);
+  lv_label_set_text(label, "-");
+  return label;
+}
+
+// Leert den Ring und behält nur das neueste Sample
+static pubsub_sample_t *latest(pubsub_sub_t *sub) {
+  pubsub_sample_t *last = NULL, *s;
+  while ((s = pubsub_receive(sub)) != NULL) {
+    if (last != NULL) {
+      pubsub_release(last);
+    }
+    last = s;
+  }
+  return last;
+}
+
+// Kurzfassung von pubsub_print_stats für das Display
+static void format_bus_stats(char *buf, size_t len) {
+  size_t n = 0;
+  pubsub_stats_t st;
+  buf[0] = 0;
+  for (size_t i = 0; pubsub_get_stats(i, &st) && n < len; i++) {
+    uint32_t dropped = 0;
+    for (size_t s = 0; s < st.n_subs; s++) {
+      dropped += st.subs[s].dropped;
+    }
+    n += snprintf(&buf[n], len - n, "%s %lu pool %lu/%lu drop %lu\n",
+                  st.name, (unsigned long)st.published,
+                  (unsigned long)st.in_use, (unsigned long)st.pool_size,
+                  (unsigned long)(dropped + st.no_buffer));
+  }
+}
+
+// LVGL ist nicht thread-safe, alles läuft in dieser Task. Die Ringe werden
+// in jedem Frame geleert (DEPTH reicht für 16 ms IMU), die Labels nur alle
+// VALUES_MS neu gesetzt.
+static void display_task(void *arg) {
+  pubsub_sub_t *imu, *distance, *temperature;
+  ESP_ERROR_CHECK(pubsub_subscribe(topic_imu, "lcd", DEPTH, false, &imu));
+  ESP_ERROR_CHECK(
+      pubsub_subscribe(topic_distance, "lcd", DEPTH, false, &distance));
+  ESP_ERROR_CHECK(
+      pubsub_subscribe(topic_temperature, "lcd", DEPTH, false, &temperature));
+  xSemaphoreGive((SemaphoreHandle_t)arg);
+
+  lv_obj_set_style_bg_color(lv_scr_act(), lv_color_black(), LV_PART_MAIN);
+  lv_obj_t *lbl_accel = add_label(4, lv_color_make(255, 0, 0));
+  lv_obj_t *lbl_gyro = add_label(24, lv_color_make(255, 128, 0));
+  lv_obj_t *lbl_distance = add_label(44, lv_color_make(0, 255, 0));
+  lv_obj_t *lbl_temperature = add_label(64, lv_color_make(0, 128, 255));
+  lv_obj_t *lbl_bus = add_label(100, lv_color_white());
+
+  // Neueste Werte, gültig ab dem ersten Sample
+  imu_sample_t last_imu;
+  distance_sample_t last_distance;
+  temperature_sample_t last_temperature;
+  bool has_imu = false, has_distance = false, has_temperature = false;
+
+  static char text[160];
+  int64_t last_values = 0, last_stats = 0;
+  while (1) {
+    pubsub_sample_t *s;
+    if ((s = latest(imu)) != NULL) {
+      last_imu = *(const imu_sample_t *)s->data;
+      has_imu = true;
+      pubsub_release(s);
+    }
+    if ((s = latest(distance)) != NULL) {
+      last_distance = *(const distance_sample_t *)s->data;
+      has_distance = true;
+      pubsub_release(s);
+    }
+    if ((s = latest(temperature)) != NULL) {
+      last_temperature = *(const temperature_sample_t *)s->data;
+      has_temperature = true;
+      pubsub_release(s);
+    }
+
+    int64_t now = esp_timer_get_time();
+    if (now - last_values >= VALUES_MS * 1000LL) {
+      if (has_imu) {
+        lv_label_set_text_fmt(lbl_accel, "Accel %6d %6d %6d",
+                              last_imu.accel[0], last_imu.accel[1],
+                              last_imu.accel[2]);
+        lv_label_set_text_fmt(lbl_gyro, "Gyro  %6d %6d %6d", last_imu.gyro[0],
+                              last_imu.gyro[1], last_imu.gyro[2]);
+      }
+      if (has_distance) {
+        snprintf(text, sizeof(text), "Abstand %.1f cm", last_distance.cm);
+        lv_label_set_text(lbl_distance, text);
+      }
+      if (has_temperature) {
+        snprintf(text, sizeof(text), "Temperatur %.2f C",
+                 last_temperature.celsius);
+        lv_label_set_text(lbl_temperature, text);
+      }
+      last_values = now;
+    }
+    if (now - last_stats >= BUS_STATS_MS * 1000LL) {
+      format_bus_stats(text, sizeof(text));
+      lv_label_set_text(lbl_bus, text);
+      last_stats = now;
+    }
+    lv_timer_handler();
+    vTaskDelay(pdMS_TO_TICKS(FRAME_MS));
+  }
+}
+
+esp_err_t display_start(SemaphoreHandle_t ready) {
+  ESP_RETURN_ON_ERROR(lcd_init(), TAG, "LCD");
+  if (xTaskCreatePinnedToCore(display_task, "lcd_out", 6144, ready, 2, NULL,
+                              0) != pdPASS) {
+    return ESP_ERR_NO_MEM;
+  }
+  return ESP_OK;
+}
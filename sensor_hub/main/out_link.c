@@ -0,0 +1,164 @@
+#include "driver/uart.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "hub.h"
+#include "sms_server.h"
+#include <math.h>
+
+// SMS-Protokoll (components/sms_proto) auf einer eigenen UART, z.B. mit
+// einem USB-UART-Adapter. Der PC abonniert SMS_TOPIC_GYRO, _DISTANCE und
+// _TEMPERATURE mit einem Mindestintervall, der Server drosselt auf diese
+// Rate. Vom Bus wird nur das jeweils neueste Sample gesendet.
+#define LINK_UART UART_NUM_1
+#define LINK_TX_GPIO 17
+#define LINK_RX_GPIO 14
+#define LINK_BAUD 921600
+#define UART_RX_BUF 1024
+#define UART_TX_BUF 4096
+
+// SMS_MIN_INTERVAL_MS ist 5 ms, mehr als ein Sample pro Topic und Runde
+// wird nie gesendet
+#define POLL_MS 10
+#define IMU_DEPTH 32
+#define SLOW_DEPTH 8
+
+static const char *TAG = "link";
+
+static sms_server_t server;
+
+// Ganzer Frame oder gar nichts, ein abgeschnittener Frame würde auch den
+// nächsten auf dem PC zerstören
+static size_t link_send(const void *data, size_t len, void *ctx) {
+  size_t free_bytes = 0;
+  uart_get_tx_buffer_free_size(LINK_UART, &free_bytes);
+  if (free_bytes < len) {
+    return 0;
+  }
+  return uart_write_bytes(LINK_UART, data, len);
+}
+
+// Leert den Ring und behält nur das neueste Sample
+static pubsub_sample_t *latest(pubsub_sub_t *sub) {
+  pubsub_sample_t *last = NULL, *s;
+  while ((s = pubsub_receive(sub)) != NULL) {
+    if (last != NULL) {
+      pubsub_release(last);
+    }
+    last = s;
+  }
+  return last;
+}
+
+static void publish_imu(pubsub_sample_t *s, int64_t now) {
+  const imu_sample_t *imu = (const imu_sample_t *)s->data;
+  uint8_t payload[12];
+  for (int i = 0; i < 3; i++) {
+    sms_put_u16(&payload[2 * i], imu->accel[i]);
+    sms_put_u16(&payload[6 + 2 * i], imu->gyro[i]);
+  }
+  sms_server_publish(&server, SMS_TOPIC_GYRO, payload, sizeof(payload), now);
+}
+
+static void publish_distance(pubsub_sample_t *s, int64_t now) {
+  const distance_sample_t *d = (const distance_sample_t *)s->data;
+  uint8_t payload[3] = {d->sensor};
+  sms_put_u16(&payload[1], lroundf(d->cm * 10.0f));
+  sms_server_publish(&server, SMS_TOPIC_DISTANCE, payload, sizeof(payload),
+                     now);
+}
+
+static void publish_temperature(pubsub_sample_t *s, int64_t now) {
+  const temperature_sample_t *t = (const temperature_sample_t *)s->data;
+  uint8_t payload[3] = {t->sensor};
+  sms_put_u16(&payload[1], (int16_t)lroundf(t->celsius * 100.0f));
+  sms_server_publish(&server, SMS_TOPIC_TEMPERATURE, payload, sizeof(payload),
+                     now);
+}
+
+static void send_latest(pubsub_sub_t *sub, uint8_t topic, int64_t now,
+                        void (*publish)(pubsub_sample_t *, int64_t)) {
+  pubsub_sample_t *s = latest(sub);
+  if (s == NULL) {
+    return;
+  }
+  if (sms_server_due(&server, topic, now)) {
+    publish(s, now);
+  }
+  pubsub_release(s);
+}
+
+// Requests vom PC: Frames zwischen 0x00-Trennern sammeln
+static void poll_requests(void) {
+  static uint8_t frame[SMS_MAX_FRAME];
+  static size_t len;
+  static bool overflow;
+  uint8_t buf[64];
+  int n;
+  while ((n = uart_read_bytes(LINK_UART, buf, sizeof(buf), 0)) > 0) {
+    for (int i = 0; i < n; i++) {
+      if (buf[i] == 0) {
+        if (!overflow) {
+          sms_server_handle_frame(&server, frame, len);
+        }
+        len = 0;
+        overflow = false;
+      } else if (len < sizeof(frame)) {
+        frame[len++] = buf[i];
+      } else {
+        overflow = true;
+      }
+    }
+  }
+}
+
+static void link_task(void *arg) {
+  pubsub_sub_t *imu, *distance, *temperature;
+  ESP_ERROR_CHECK(pubsub_subscribe(topic_imu, "uart", IMU_DEPTH, false, &imu));
+  ESP_ERROR_CHECK(pubsub_subscribe(topic_distance, "uart", SLOW_DEPTH, false,
+                                   &distance));
+  ESP_ERROR_CHECK(pubsub_subscribe(topic_temperature, "uart", SLOW_DEPTH,
+                                   false, &temperature));
+  xSemaphoreGive((SemaphoreHandle_t)arg);
+
+  TickType_t last_wake = xTaskGetTickCount();
+  while (1) {
+    poll_requests();
+    int64_t now = esp_timer_get_time();
+    send_latest(imu, SMS_TOPIC_GYRO, now, publish_imu);
+    send_latest(distance, SMS_TOPIC_DISTANCE, now, publish_distance);
+    send_latest(temperature, SMS_TOPIC_TEMPERATURE, now, publish_temperature);
+    if (sms_server_due(&server, SMS_TOPIC_LINK_STATS, now)) {
+      uint8_t payload[SMS_LINK_STATS_LEN];
+      sms_put_link_stats(payload, &server.stats);
+      sms_server_publish(&server, SMS_TOPIC_LINK_STATS, payload,
+                         sizeof(payload), now);
+    }
+    vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(POLL_MS));
+  }
+}
+
+esp_err_t link_start(SemaphoreHandle_t ready) {
+  uart_config_t config = {
+      .baud_rate = LINK_BAUD,
+      .data_bits = UART_DATA_8_BITS,
+      .parity = UART_PARITY_DISABLE,
+      .stop_bits = UART_STOP_BITS_1,
+      .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+      .source_clk = UART_SCLK_DEFAULT,
+  };
+  ESP_RETURN_ON_ERROR(uart_driver_install(LINK_UART, UART_RX_BUF, UART_TX_BUF,
+                                          0, NULL, 0),
+                      TAG, "driver");
+  ESP_RETURN_ON_ERROR(uart_param_config(LINK_UART, &config), TAG, "config");
+  ESP_RETURN_ON_ERROR(uart_set_pin(LINK_UART, LINK_TX_GPIO, LINK_RX_GPIO,
+                                   UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE),
+                      TAG, "pins");
+  sms_server_init(&server, link_send, NULL, NULL);
+  if (xTaskCreatePinnedToCore(link_task, "link_out", 4096, ready, 4, NULL,
+                              0) != pdPASS) {
+    return ESP_ERR_NO_MEM;
+  }
+  return ESP_OK;
+}
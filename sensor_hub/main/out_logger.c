@@ -0,0 +1,74 @@
+#include "esp_check.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "hub.h"
+#include "sd_card.h"
+#include "sd_logger.h"
+
+#define LOG_PATH SD_MOUNT_POINT "/hub.bin"
+#define LOG_MINUTES 10
+// IMU mit 1 kHz, doppelt gerechnet für Abstand, Temperatur und den Rest
+// des letzten Blocks. Ist die Datei voll, zählt der Logger nur noch
+// Verluste.
+#define LOG_BYTES                                                              \
+  ((uint64_t)LOG_MINUTES * 60 * 1000 *                                         \
+   (SDL_RECORD_HEADER + sizeof(imu_sample_t)) * 2)
+
+// Der Logger schreibt aus einer eigenen Task auf die Karte, die Ringe
+// müssen nur die Zeit bis zum nächsten Aufwachen überbrücken
+#define IMU_DEPTH 64
+#define SLOW_DEPTH 8
+#define POLL_MS 20
+
+enum { STREAM_IMU = 1, STREAM_DISTANCE, STREAM_TEMPERATURE };
+static const char *const stream_names[] = {"imu", "distance", "temp"};
+
+static const char *TAG = "logger";
+
+static sd_logger_t *logger;
+
+static void drain(pubsub_sub_t *sub, uint8_t stream, size_t len) {
+  pubsub_sample_t *s;
+  while ((s = pubsub_receive(sub)) != NULL) {
+    sd_logger_write(logger, stream, s->t_us, s->data, len);
+    pubsub_release(s);
+  }
+}
+
+// sd_logger_write kopiert nur in den Blockpuffer, der Bus-Puffer ist danach
+// sofort wieder frei
+static void logger_task(void *arg) {
+  pubsub_sub_t *imu, *distance, *temperature;
+  ESP_ERROR_CHECK(pubsub_subscribe(topic_imu, "log", IMU_DEPTH, true, &imu));
+  ESP_ERROR_CHECK(
+      pubsub_subscribe(topic_distance, "log", SLOW_DEPTH, true, &distance));
+  ESP_ERROR_CHECK(pubsub_subscribe(topic_temperature, "log", SLOW_DEPTH, true,
+                                   &temperature));
+  xSemaphoreGive((SemaphoreHandle_t)arg);
+
+  while (1) {
+    pubsub_wait(pdMS_TO_TICKS(POLL_MS));
+    drain(imu, STREAM_IMU, sizeof(imu_sample_t));
+    drain(distance, STREAM_DISTANCE, sizeof(distance_sample_t));
+    drain(temperature, STREAM_TEMPERATURE, sizeof(temperature_sample_t));
+  }
+}
+
+esp_err_t logger_start(SemaphoreHandle_t ready) {
+  ESP_RETURN_ON_ERROR(init_sd_card(), TAG, "SD-Karte");
+  sd_logger_config_t cfg = {
+      .base_path = SD_MOUNT_POINT,
+      .path = LOG_PATH,
+      .size = LOG_BYTES,
+      .streams = stream_names,
+      .n_streams = sizeof(stream_names) / sizeof(stream_names[0]),
+  };
+  ESP_RETURN_ON_ERROR(sd_logger_open(&cfg, &logger), TAG, "%s", LOG_PATH);
+  if (xTaskCreatePinnedToCore(logger_task, "log_out", 3072, ready, 5, NULL,
+                              1) != pdPASS) {
+    return ESP_ERR_NO_MEM;
+  }
+  ESP_LOGI(TAG, "Schreibe nach %s", LOG_PATH);
+  return ESP_OK;
+}
@@ -3,6 +3,8 @@
 
 #include "driver/gpio.h"
 #include "driver/gptimer.h"
+#include "driver/uart.h"
+#include "evtrace.h"
 
 #include "host/ble_hs.h"
 #include "nimble/nimble_port.h"
@@ -19,6 +21,14 @@
 // Pin for the signal
 #define SIGNALPIN 4
 
+// CONFIG_EVTRACE_ENABLE (menuconfig) streams the timer interrupts
+// (components/evtrace) to TRACE_UART, e.g. a USB-UART adapter at
+// TRACE_TX_GPIO, to check the jitter of the 20 ms period and the pulse length
+// in Perfetto
+#define TRACE_UART UART_NUM_1
+#define TRACE_TX_GPIO 17
+#define TRACE_BAUD 921600
+
 // UUIDs for services (try out the  other addresses)
 static const ble_uuid128_t UART_SERVICE_UUID =
     BLE_UUID128_INIT(0x6e, 0x40, 0x00, 0x01, 0xb5, 0xa3, 0xf3, 0x93, 0xe0, 0xa9,
@@ -68,7 +78,9 @@ static const struct ble_gatt_svc_def gatt_svcs[] = {
 static bool IRAM_ATTR timer_alarm_off(gptimer_handle_t timer,
                                       const gptimer_alarm_event_data_t *edata,
                                       void *user_data) {
+  EVTRACE_ISR_ENTER("timer_alarm_off");
   gpio_set_level(SIGNALPIN, false);
+  EVTRACE_ISR_EXIT("timer_alarm_off");
   return true;
 }
 
@@ -76,8 +88,10 @@ static bool IRAM_ATTR timer_alarm_off(gptimer_handle_t timer,
 static bool IRAM_ATTR timer_alarm_on(gptimer_handle_t timer,
                                      const gptimer_alarm_event_data_t *edata,
                                      void *user_data) {
+  EVTRACE_ISR_ENTER("timer_alarm_on");
   gpio_set_level(SIGNALPIN, true);
   resetSignalAlarm(signal_length_ticks);
+  EVTRACE_ISR_EXIT("timer_alarm_on");
 
   return true;
 }
@@ -131,6 +145,7 @@ static void setupTimers() {
 
 // resets the signal Alarm
 static void resetSignalAlarm(int alarm_count) {
+  EVTRACE_ISR_ENTER("resetSignalAlarm");
 
   gptimer_stop(timer_signal);
   gptimer_set_raw_count(timer_signal, 0);
@@ -142,6 +157,7 @@ static void resetSignalAlarm(int alarm_count) {
   };
   gptimer_set_alarm_action(timer_signal, &alarm_config_signal);
   gptimer_start(timer_signal);
+  EVTRACE_ISR_EXIT("resetSignalAlarm");
 }
 
 // ble gatt server functions
@@ -225,7 +241,29 @@ static void ble_app_on_sync(void) {
 // the nimble task is blocking, so it runs in its own thread
 static void host_task(void *param) { nimble_port_run(); }
 
+#if CONFIG_EVTRACE_ENABLE
+// sends the trace on its own UART, the console stays on UART0
+static void start_trace(void) {
+  uart_config_t config = {
+      .baud_rate = TRACE_BAUD,
+      .data_bits = UART_DATA_8_BITS,
+      .parity = UART_PARITY_DISABLE,
+      .stop_bits = UART_STOP_BITS_1,
+      .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+      .source_clk = UART_SCLK_DEFAULT,
+  };
+  ESP_ERROR_CHECK(uart_driver_install(TRACE_UART, 256, 8192, 0, NULL, 0));
+  ESP_ERROR_CHECK(uart_param_config(TRACE_UART, &config));
+  ESP_ERROR_CHECK(uart_set_pin(TRACE_UART, TRACE_TX_GPIO, UART_PIN_NO_CHANGE,
+                               UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE));
+  ESP_ERROR_CHECK(evtrace_start(TRACE_UART));
+}
+#endif
+
 void app_main(void) {
+#if CONFIG_EVTRACE_ENABLE
+  start_trace();
+#endif
 
   // set up GPIO Pin
   gpio_set_direction(SIGNALPIN, GPIO_MODE_OUTPUT);
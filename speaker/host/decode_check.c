@@ -0,0 +1,273 @@
+/*
+Host tests for the playback decoders: IMA-ADPCM blocks (main/ima_adpcm.c)
+and the WAV header parser (main/wav_format.c).
+
+  gcc -O2 -Wall -I../main -o decode_check decode_check.c \
+      ../main/ima_adpcm.c ../main/wav_format.c -lm
+  ./decode_check
+
+ADPCM: a reference encoder below produces blocks from a sine sweep. Its
+predictor and step index are the decoder's state machine, so the decoder
+must reproduce the encoder's reconstruction sample for sample. Hand-made
+blocks check the nibble order, the clamping of predictor and step index and
+the rejection of invalid headers.
+
+WAV: PCM and ADPCM headers with extra and odd-length chunks are accepted;
+stereo, 8-bit, data before fmt and truncated buffers are rejected.
+*/
+
+#include "ima_adpcm.h"
+#include "wav_format.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define BLOCK_ALIGN 256
+#define BLOCKS 64
+
+static int failures;
+
+static void check(int ok, const char *what) {
+  if (!ok) {
+    printf("FAIL %s\n", what);
+    failures++;
+  }
+}
+
+// Reference IMA-ADPCM encoder (same tables as the decoder)
+
+static const int16_t step_table[89] = {
+    7,     8,     9,     10,    11,    12,    13,    14,    16,    17,
+    19,    21,    23,    25,    28,    31,    34,    37,    41,    45,
+    50,    55,    60,    66,    73,    80,    88,    97,    107,   118,
+    130,   143,   157,   173,   190,   209,   230,   253,   279,   307,
+    337,   371,   408,   449,   494,   544,   598,   658,   724,   796,
+    876,   963,   1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,
+    2272,  2499,  2749,  3024,  3327,  3660,  4026,  4428,  4871,  5358,
+    5894,  6484,  7132,  7845,  8630,  9493,  10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767};
+
+static const int8_t index_table[16] = {-1, -1, -1, -1, 2, 4, 6, 8,
+                                       -1, -1, -1, -1, 2, 4, 6, 8};
+
+typedef struct {
+  int32_t predictor;
+  int32_t index;
+} enc_state_t;
+
+// Encodes one sample, updates the state like the decoder does and returns
+// the 4-bit code
+static uint8_t encode_sample(enc_state_t *st, int16_t sample) {
+  int32_t step = step_table[st->index];
+  int32_t delta = sample - st->predictor;
+  uint8_t code = 0;
+  if (delta < 0) {
+    code = 8;
+    delta = -delta;
+  }
+  int32_t diff = step >> 3;
+  if (delta >= step) {
+    code |= 4;
+    delta -= step;
+    diff += step;
+  }
+  if (delta >= step >> 1) {
+    code |= 2;
+    delta -= step >> 1;
+    diff += step >> 1;
+  }
+  if (delta >= step >> 2) {
+    code |= 1;
+    diff += step >> 2;
+  }
+  st->predictor += (code & 8) ? -diff : diff;
+  st->predictor = st->predictor > 32767 ? 32767 : st->predictor;
+  st->predictor = st->predictor < -32768 ? -32768 : st->predictor;
+  st->index += index_table[code];
+  st->index = st->index < 0 ? 0 : st->index > 88 ? 88 : st->index;
+  return code;
+}
+
+// Encodes `in` into one block and writes the reconstruction to `recon`
+static void encode_block(enc_state_t *st, const int16_t *in, uint8_t *block,
+                         int16_t *recon) {
+  size_t n = ima_adpcm_samples_per_block(BLOCK_ALIGN);
+  st->predictor = in[0];
+  block[0] = in[0] & 0xFF;
+  block[1] = (uint16_t)in[0] >> 8;
+  block[2] = st->index;
+  block[3] = 0;
+  recon[0] = in[0];
+  for (size_t i = 1; i < n; i += 2) {
+    uint8_t lo = encode_sample(st, in[i]);
+    recon[i] = st->predictor;
+    uint8_t hi = encode_sample(st, in[i + 1]);
+    recon[i + 1] = st->predictor;
+    block[IMA_ADPCM_HEADER_BYTES + (i - 1) / 2] = lo | hi << 4;
+  }
+}
+
+static void test_adpcm_roundtrip(void) {
+  size_t n = ima_adpcm_samples_per_block(BLOCK_ALIGN);
+  static int16_t in[BLOCKS][(BLOCK_ALIGN - 4) * 2 + 1];
+  static int16_t recon[BLOCKS][(BLOCK_ALIGN - 4) * 2 + 1];
+  static int16_t out[(BLOCK_ALIGN - 4) * 2 + 1];
+  uint8_t block[BLOCK_ALIGN];
+  enc_state_t st = {0, 0};
+  double t = 0, signal = 0, noise = 0;
+  size_t mismatches = 0;
+
+  for (int b = 0; b < BLOCKS; b++) {
+    // Sweep from 100 Hz to 4 kHz at 16 kHz, with a loud middle section so
+    // the step index runs up and down
+    for (size_t i = 0; i < n; i++, t += 1.0 / 16000) {
+      double freq = 100 + 3900 * t / 2.0;
+      double amp = b > BLOCKS / 3 && b < 2 * BLOCKS / 3 ? 32000 : 3000;
+      in[b][i] = (int16_t)lrint(amp * sin(2 * M_PI * freq * t));
+    }
+    encode_block(&st, in[b], block, recon[b]);
+    size_t got = ima_adpcm_decode_block(block, BLOCK_ALIGN, out);
+    check(got == n, "adpcm samples per block");
+    for (size_t i = 0; i < n; i++) {
+      mismatches += out[i] != recon[b][i];
+      signal += (double)in[b][i] * in[b][i];
+      noise += (double)(out[i] - in[b][i]) * (out[i] - in[b][i]);
+    }
+  }
+  check(mismatches == 0, "adpcm decoder matches encoder state");
+  double snr = 10 * log10(signal / noise);
+  check(snr > 15, "adpcm SNR"); // 4-bit codes, sweep up to fs/4
+  printf("adpcm: %d blocks, %zu mismatches, SNR %.1f dB\n", BLOCKS,
+         mismatches, snr);
+}
+
+static void test_adpcm_edges(void) {
+  int16_t out[16];
+  // Low nibble first: code 0 leaves the predictor, code 7 adds 7/8 + ... of
+  // step 7 = 0 + 7 + 3 + 1
+  const uint8_t order[] = {0, 0, 0, 0, 0x70};
+  check(ima_adpcm_decode_block(order, sizeof(order), out) == 3 &&
+            out[0] == 0 && out[1] == 0 && out[2] == 11,
+        "adpcm nibble order");
+
+  // Predictor and step index clamp at the top
+  uint8_t loud[4 + 6] = {0xFF, 0x7F, 88, 0};
+  memset(&loud[4], 0x77, 6);
+  size_t n = ima_adpcm_decode_block(loud, sizeof(loud), out);
+  int clamped = n == 13;
+  for (size_t i = 0; i < n; i++) {
+    clamped &= out[i] == 32767;
+  }
+  check(clamped, "adpcm clamp at +32767 and index 88");
+
+  // ... and at the bottom
+  uint8_t quiet[4 + 2] = {0x00, 0x80, 88, 0, 0xFF, 0xFF};
+  n = ima_adpcm_decode_block(quiet, sizeof(quiet), out);
+  check(n == 5 && out[4] == -32768, "adpcm clamp at -32768");
+
+  // Index 0 with code 0 (index - 1) must stay at step 7
+  const uint8_t low[] = {100, 0, 0, 0, 0x00, 0x70};
+  n = ima_adpcm_decode_block(low, sizeof(low), out);
+  check(n == 5 && out[4] == 111, "adpcm index clamp at 0");
+
+  const uint8_t bad_index[] = {0, 0, 89, 0, 0};
+  check(ima_adpcm_decode_block(bad_index, sizeof(bad_index), out) == 0,
+        "adpcm rejects step index > 88");
+  check(ima_adpcm_decode_block(order, IMA_ADPCM_HEADER_BYTES, out) == 0,
+        "adpcm rejects header-only block");
+}
+
+// WAV headers
+
+static size_t put_chunk(uint8_t *p, const char *id, const void *data,
+                        uint32_t len) {
+  memcpy(p, id, 4);
+  p[4] = len & 0xFF;
+  p[5] = len >> 8 & 0xFF;
+  p[6] = len >> 16 & 0xFF;
+  p[7] = len >> 24;
+  memcpy(&p[8], data, len);
+  if (len & 1) {
+    p[8 + len] = 0; // padding byte
+  }
+  return 8 + len + (len & 1);
+}
+
+static size_t make_fmt(uint8_t *f, uint16_t format, uint16_t channels,
+                       uint16_t block_align, uint16_t bits) {
+  const uint32_t rate = 16000;
+  memset(f, 0, 20);
+  f[0] = format;
+  f[2] = channels;
+  memcpy(&f[4], &rate, 4); // host is little endian
+  f[12] = block_align & 0xFF;
+  f[13] = block_align >> 8;
+  f[14] = bits;
+  return format == WAV_FORMAT_IMA_ADPCM ? 20 : 16;
+}
+
+// RIFF header, optional LIST before fmt, optional fact, data of 1000 bytes
+static size_t make_wav(uint8_t *buf, uint16_t format, uint16_t channels,
+                       uint16_t block_align, uint16_t bits, int list,
+                       int data_first) {
+  uint8_t fmt[20];
+  size_t fmt_len = make_fmt(fmt, format, channels, block_align, bits);
+  size_t pos = 12;
+  memcpy(buf, "RIFF\0\0\0\0WAVE", 12);
+  if (list) {
+    pos += put_chunk(&buf[pos], "LIST", "INFOabc", 7); // odd length
+  }
+  if (data_first) {
+    pos += put_chunk(&buf[pos], "data", "", 0);
+  }
+  pos += put_chunk(&buf[pos], "fmt ", fmt, fmt_len);
+  if (format == WAV_FORMAT_IMA_ADPCM) {
+    pos += put_chunk(&buf[pos], "fact", "\x10\x00\x00\x00", 4);
+  }
+  memcpy(&buf[pos], "data\xE8\x03\0\0", 8); // 1000 bytes follow
+  return pos + 8;
+}
+
+static void test_wav_headers(void) {
+  uint8_t buf[256];
+  wav_info_t info;
+  size_t len;
+
+  len = make_wav(buf, WAV_FORMAT_PCM, 1, 2, 16, 0, 0);
+  check(wav_parse_header(buf, len, &info) == 0 &&
+            info.format == WAV_FORMAT_PCM && info.sample_rate == 16000 &&
+            info.data_offset == len && info.data_size == 1000,
+        "wav PCM");
+
+  len = make_wav(buf, WAV_FORMAT_IMA_ADPCM, 1, 256, 4, 1, 0);
+  check(wav_parse_header(buf, len, &info) == 0 &&
+            info.format == WAV_FORMAT_IMA_ADPCM && info.block_align == 256 &&
+            info.data_offset == len,
+        "wav ADPCM with odd LIST and fact chunks");
+
+  len = make_wav(buf, WAV_FORMAT_PCM, 2, 4, 16, 0, 0);
+  check(wav_parse_header(buf, len, &info) != 0, "wav rejects stereo");
+  len = make_wav(buf, WAV_FORMAT_PCM, 1, 1, 8, 0, 0);
+  check(wav_parse_header(buf, len, &info) != 0, "wav rejects 8-bit PCM");
+  len = make_wav(buf, WAV_FORMAT_PCM, 1, 2, 16, 0, 1);
+  check(wav_parse_header(buf, len, &info) != 0,
+        "wav rejects data before fmt");
+  len = make_wav(buf, WAV_FORMAT_IMA_ADPCM, 1, 4, 4, 0, 0);
+  check(wav_parse_header(buf, len, &info) != 0,
+        "wav rejects ADPCM block_align 4");
+  len = make_wav(buf, WAV_FORMAT_PCM, 1, 2, 16, 0, 0);
+  check(wav_parse_header(buf, len - 8, &info) != 0,
+        "wav rejects missing data chunk");
+  check(wav_parse_header(buf, 30, &info) != 0, "wav rejects truncated fmt");
+  memcpy(buf, "RIFX", 4);
+  check(wav_parse_header(buf, len, &info) != 0, "wav rejects RIFX");
+}
+
+int main(void) {
+  test_adpcm_roundtrip();
+  test_adpcm_edges();
+  test_wav_headers();
+  printf("%s\n", failures ? "FAILED" : "ok");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,156 @@
+/*
+Golden-output test and benchmark for the synthesizer (main/synth.c) on the
+host.
+
+  gcc -O2 -Wall -I../main -o synth_check synth_check.c ../main/synth.c -lm
+  ./synth_check                        # compare with synth_golden.h, bench
+  ./synth_check --update > synth_golden.h
+
+The fixed sequence is a short melody on the built-in sequencer plus a chord
+started with synth_note_on in all four waveforms, including note-off and
+release. Every GOLDEN_STRIDE-th output sample and an FNV-1a hash over all
+samples are compared with synth_golden.h; the first differing sample is
+printed. Regenerate the file only after an intended change to the sound.
+
+The benchmark renders BENCH_SECONDS of audio with 1..SYNTH_VOICES sustained
+voices and prints the CPU share of real time and voices per CPU percent.
+The figures are for the host CPU; on the ESP32-S3 main.c logs the same
+ratio while playing.
+*/
+
+#include "synth.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define RATE 16000
+#define GOLDEN_FRAMES 16000 // 1 s
+#define GOLDEN_STRIDE 16
+#define CHUNK 100           // not a multiple of SYNTH_BLOCK
+#define BENCH_SECONDS 20
+
+static const synth_note_t notes[] = {
+    {69, 127, 150, 100}, {72, 100, 150, 100}, {SYNTH_NOTE_REST, 0, 100, 0},
+    {76, 80, 200, 150},  {81, 127, 150, 50},
+};
+
+static const synth_melody_t melody = {
+    .notes = notes,
+    .count = sizeof(notes) / sizeof(notes[0]),
+    .wave = SYNTH_WAVE_TRIANGLE,
+    .adsr = {.attack_ms = 10, .decay_ms = 40, .sustain = 20000,
+             .release_ms = 60},
+    .loop = false,
+};
+
+static const synth_adsr_t chord_adsr = {
+    .attack_ms = 20, .decay_ms = 100, .sustain = 16000, .release_ms = 200};
+
+// Renders the fixed sequence into out[GOLDEN_FRAMES]
+static void render_sequence(int16_t *out) {
+  static synth_t synth;
+  synth_init(&synth, RATE);
+  synth_play(&synth, &melody);
+
+  int chord[SYNTH_WAVE_COUNT];
+  size_t done = 0;
+  while (done < GOLDEN_FRAMES) {
+    if (done == 4000) {
+      for (int w = 0; w < SYNTH_WAVE_COUNT; w++) {
+        chord[w] = synth_note_on(&synth, 48 + 4 * w, 90, w, &chord_adsr);
+      }
+    }
+    if (done == 10000) {
+      for (int w = 0; w < SYNTH_WAVE_COUNT; w++) {
+        synth_note_off(&synth, chord[w]);
+      }
+    }
+    size_t n = GOLDEN_FRAMES - done < CHUNK ? GOLDEN_FRAMES - done : CHUNK;
+    synth_render(&out[done], n, &synth);
+    done += n;
+  }
+}
+
+static uint32_t fnv1a(const int16_t *s, size_t n) {
+  uint32_t h = 2166136261u;
+  for (size_t i = 0; i < n; i++) {
+    h = (h ^ (uint16_t)s[i]) * 16777619u;
+  }
+  return h;
+}
+
+static void print_golden(const int16_t *out) {
+  printf("// Generated by ./synth_check --update, do not edit\n");
+  printf("#define GOLDEN_HASH 0x%08xu\n", (unsigned)fnv1a(out, GOLDEN_FRAMES));
+  printf("static const int16_t golden[] = {");
+  for (size_t i = 0; i < GOLDEN_FRAMES; i += GOLDEN_STRIDE) {
+    printf("%s%d,", i % (8 * GOLDEN_STRIDE) ? " " : "\n    ", out[i]);
+  }
+  printf("\n};\n");
+}
+
+#include "synth_golden.h"
+
+static int compare_golden(const int16_t *out) {
+  size_t count = sizeof(golden) / sizeof(golden[0]);
+  if (count != GOLDEN_FRAMES / GOLDEN_STRIDE) {
+    printf("FAIL golden has %zu samples, expected %d\n", count,
+           GOLDEN_FRAMES / GOLDEN_STRIDE);
+    return 1;
+  }
+  for (size_t i = 0; i < count; i++) {
+    if (out[i * GOLDEN_STRIDE] != golden[i]) {
+      printf("FAIL sample %zu: %d, golden %d\n", i * GOLDEN_STRIDE,
+             out[i * GOLDEN_STRIDE], golden[i]);
+      return 1;
+    }
+  }
+  uint32_t hash = fnv1a(out, GOLDEN_FRAMES);
+  if (hash != GOLDEN_HASH) {
+    printf("FAIL hash 0x%08x, golden 0x%08x\n", (unsigned)hash,
+           (unsigned)GOLDEN_HASH);
+    return 1;
+  }
+  printf("golden ok (%d samples)\n", GOLDEN_FRAMES);
+  return 0;
+}
+
+static double cpu_seconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void bench(void) {
+  static synth_t synth;
+  static int16_t buf[256];
+  const synth_adsr_t hold = {.attack_ms = 1, .decay_ms = 1, .sustain = 32767,
+                             .release_ms = 10};
+  printf("voices  cpu%%     voices/cpu%%\n");
+  for (int voices = 1; voices <= SYNTH_VOICES; voices++) {
+    synth_init(&synth, RATE);
+    for (int v = 0; v < voices; v++) {
+      synth_note_on(&synth, 57 + v, 100, v % SYNTH_WAVE_COUNT, &hold);
+    }
+    long frames = (long)BENCH_SECONDS * RATE;
+    double start = cpu_seconds();
+    for (long done = 0; done < frames; done += 256) {
+      synth_render(buf, 256, &synth);
+    }
+    double pct = 100.0 * (cpu_seconds() - start) / BENCH_SECONDS;
+    printf("%6d  %7.4f  %10.1f\n", voices, pct, voices / pct);
+  }
+}
+
+int main(int argc, char **argv) {
+  static int16_t out[GOLDEN_FRAMES];
+  render_sequence(out);
+  if (argc > 1 && strcmp(argv[1], "--update") == 0) {
+    print_golden(out);
+    return 0;
+  }
+  int failed = compare_golden(out);
+  bench();
+  return failed;
+}
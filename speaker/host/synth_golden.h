@@ -0,0 +1,129 @@
+// Generated by ./synth_check --update, do not edit
+#define GOLDEN_HASH 0x3df0546fu
+static const int16_t golden[] = {
+    0, 0, -845, 435, -103, -666, 2226, -3379,
+    6040, -5427, 4863, -2944, 895, 1023, -3012, 4894,
+    -6642, 7133, -5182, 3374, -1417, -355, 2079, -3928,
+    5538, -7121, 5305, -3648, 1836, -217, -1373, 3060,
+    -4535, 6080, -5330, 3821, -2256, 686, 764, -2294,
+    3629, -5027, 5253, -3896, 2466, -1058, -257, 1540,
+    -2826, 4071, -5079, 3869, -2578, 1327, -157, -1016,
+    2265, -3438, 4608, -4141, 2968, -1797, 546, 624,
+    -1875, 3046, -4219, 4530, -3359, 2187, -938, -235,
+    1406, -2656, 3827, -4922, 3749, -2578, 1327, -157,
+    -1016, 2265, -3438, 4608, -4141, 2968, -1797, 546,
+    624, -1875, 3046, -4219, 4530, -3359, 2187, -938,
+    -235, 1406, -2656, 3827, -4922, 3749, -2492, 1283,
+    -146, -948, 2038, -3094, 3994, -3588, 2473, -1498,
+    437, 499, -1438, 2335, -3094, 3322, -2352, 1531,
+    -625, -157, 890, -1682, 2296, -2953, 2124, -1461,
+    708, -84, -508, 1132, -1604, 2150, -1794, 1286,
+    -719, 218, 229, -688, 1015, -1406, 1359, -1008,
+    583, -250, -55, 328, -532, 765, -820, 624,
+    -1412, 1123, -1669, 1308, -1603, 1161, -1218, 749,
+    -504, -101, 705, -1311, 1877, -2471, 3002, -3584,
+    4079, -4650, 5110, -5576, 5639, -5094, 4449, -3916,
+    3307, -2786, 2211, -1702, 1163, -665, 162, 324,
+    -792, 1266, -1699, 2162, -2559, 3009, -3372, 3810,
+    -4066, 4493, -4093, 3676, -3168, 2763, -2291, 1897,
+    -1460, 1079, -677, 307, 61, -431, 799, -1169,
+    1537, -1907, 2275, -2645, 3013, -3322, 3690, -3814,
+    3444, -3076, 2706, -2338, 1968, -1600, 1230, -862,
+    492, -124, -247, 615, -985, 1353, -1723, 2091,
+    -2461, 2829, -3137, 3506, -3876, 3629, -3261, 2890,
+    -2522, 2152, -1784, 1414, -1046, 676, -308, -62,
+    430, -800, 1168, -1538, 3437, -1185, 965, -5691,
+    -80, -3184, 5501, 4057, 1508, -6768, -4685, 2056,
+    6466, -3804, -4431, 3452, 2404, 5989, -2887, 4647,
+    -10087, -6698, 3498, 14179, 5194, 3288, -7064, -10698,
+    -15226, 5201, 13453, 18173, -12506, -11841, -7823, 4706,
+    4124, 3328, 2450, -806, -7321, 5622, 1618, -830,
+    -8001, 1819, 9125, 2524, -245, 2690, -3286, -14526,
+    -7960, 11007, 12354, 6229, -12938, -8276, -7879, 1651,
+    10393, 9616, -3038, -9079, -5723, 7706, -2384, -9,
+    664, 5093, 205, -2537, 1107, 3080, -5582, -75,
+    -114, 8293, 2934, 3439, -8536, -8766, -8346, 7552,
+    14423, 3057, -9349, -6486, -2988, -3806, -1253, 6658,
+    9661, -1847, -3667, -7728, 830, 715, 5703, 5589,
+    -1818, -6298, 1414, 4990, -2196, -8459, -1384, 3906,
+    7094, -2785, -290, -4099, -4572, -1941, 4350, 6295,
+    2718, -4312, -1527, -6531, -779, 3774, 9178, 2541,
+    -6784, -5673, 3102, 2441, 2947, -2219, 1934, -914,
+    1972, -1428, 549, -5560, -2765, 3071, 4433, 1041,
+    319, -2647, -2122, -7751, 2805, 8117, 6685, -2759,
+    -6893, -3699, 1381, 1110, 9147, 788, -5104, -3202,
+    3478, -3864, 2115, -3675, -1216, 6580, -1114, -3611,
+    5957, -4383, -5610, 543, 5784, 3370, 5988, -4081,
+    -6438, -1717, -873, 6374, 13914, -6459, -6581, -626,
+    -4912, -2568, 3697, 3806, 1678, -11, -10809, 1418,
+    2537, -2359, 1789, 1757, -5611, 1213, 3151, 1479,
+    -5826, -4746, -2186, 10429, 5980, -4048, -2932, -3623,
+    -5994, 8044, 5523, 3628, -1350, -3763, -7505, 2158,
+    -1056, 4283, 7787, -4689, -7906, 3933, 1945, 2031,
+    -3669, -2032, 1211, 6412, 875, -468, -2936, -7351,
+    -655, 12185, 1499, 680, -2903, -4073, -6922, -316,
+    1644, 9898, 1403, -11151, -4621, 2555, -1364, 5557,
+    -959, -2386, -1522, 1774, 2052, 1243, -6589, -3689,
+    5950, 7663, -2985, 2635, -3098, -4613, 411, 2716,
+    6357, 7516, -4906, -7847, -2452, -1401, 2587, 11393,
+    2457, -5159, -3086, -4640, 3477, -156, 588, 2920,
+    2490, -5661, -573, 3174, -1921, -2511, 3828, -2845,
+    4047, 1585, 292, -5223, -6409, -5994, 9615, 8617,
+    -3103, -4511, -3688, -5620, 4555, 1679, 5425, 1821,
+    -5026, -3724, 3031, -1130, 262, 4503, 3450, -5129,
+    1950, 809, 2776, -529, -5700, 957, 8510, 1767,
+    -2110, -3328, -6490, -4606, 7880, 4432, 3622, -4771,
+    -5131, -676, -1034, -1232, 6947, 3378, -1761, -6689,
+    1152, 670, 2395, 427, -753, 314, 1668, 1707,
+    455, -6389, -6579, 737, 10132, 1397, -660, -4857,
+    -2742, -2500, -740, 5998, 10411, -137, -2385, -7610,
+    -5159, -3954, 3500, 12756, 4318, 398, -2309, 2775,
+    -7461, -7864, -3638, 4020, 4740, 4364, 3076, 1349,
+    -8213, -8514, -4932, 5292, 5261, 7939, 2635, -5746,
+    -8810, -1642, 4689, 6338, -5192, -544, 2193, 3747,
+    1930, -556, -3333, -3386, -2663, 2218, 5212, 2381,
+    -2339, 158, -6534, -2210, 136, 5034, 2445, -3917,
+    -1616, 5347, 1447, -922, -6465, -2130, -722, 5106,
+    7962, 3839, -5062, -7034, -3253, -467, 1041, 4942,
+    3211, 1779, -6759, -3706, 34, 1387, -1352, -38,
+    2694, 3696, -16, 360, -5371, -4723, -2335, 6846,
+    8268, 1197, -4508, -3641, -2989, 1473, 1111, 5443,
+    1696, -1261, -4970, 83, -483, 98, 4254, 432,
+    -1098, -3162, 1354, 2520, -1197, -3080, 511, 1573,
+    2913, -947, 501, -2212, -2170, 252, 3198, 2745,
+    699, -1717, -3004, -3348, -135, 3012, 5029, -2074,
+    -3384, -2273, 1443, 1231, -145, -77, 552, -998,
+    1249, -86, 147, -2339, -184, 2109, 1459, -127,
+    505, -518, -851, -2734, 1950, 3337, 2104, -3080,
+    -2150, -1512, 449, 1586, 1566, -104, -1279, -1401,
+    1437, -340, -305, -449, 1182, 595, -565, 14,
+    860, -1004, -598, -474, 1909, 1074, 522, -1810,
+    -1382, -1434, 833, 2202, 879, -1253, -1162, -532,
+    674, -468, 666, 557, 65, -616, -1220, 270,
+    141, 458, 482, -11, -491, 115, 451, -175,
+    -916, -411, 292, 955, -150, -91, -353, -381,
+    -320, 209, 575, 357, -313, -160, -337, -32,
+    85, 382, 162, -196, -185, 62, 59, 58,
+    -41, 14, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0,
+};
@@ -0,0 +1,104 @@
+/*
+Renders a known sample source through wav_render (main/wav_writer.c) on the
+host and reads the file back.
+
+  gcc -O2 -Wall -I../main -o wav_check wav_check.c ../main/wav_writer.c -lm
+  ./wav_check            # writes and checks wav_check.wav
+  ./wav_check out.wav    # same, keeps the file for listening
+
+The source is a 440 Hz sine that stops early, so the checks cover the RIFF
+header fields, little-endian sample order, the chunking inside wav_render
+and the silence that replaces missing samples. Exits with 1 on the first
+mismatch.
+*/
+
+#include "wav_writer.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RATE 16000
+#define FRAMES 1000    // not a multiple of the render chunk
+#define SOURCE_END 700 // the source runs dry here, the rest must be silence
+
+typedef struct {
+  size_t pos;
+} sine_t;
+
+static int16_t sine_at(size_t i) {
+  return (int16_t)lrint(20000.0 * sin(2.0 * M_PI * 440.0 * i / RATE));
+}
+
+// Returns fewer frames than asked once SOURCE_END is reached
+static size_t sine_source(int16_t *dst, size_t frames, void *ctx) {
+  sine_t *s = ctx;
+  size_t n = 0;
+  while (n < frames && s->pos < SOURCE_END) {
+    dst[n++] = sine_at(s->pos++);
+  }
+  return n;
+}
+
+static uint32_t le32(const uint8_t *p) {
+  return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static uint16_t le16(const uint8_t *p) { return p[0] | p[1] << 8; }
+
+static int failures;
+
+static void check(int ok, const char *what) {
+  if (!ok) {
+    printf("FAIL %s\n", what);
+    failures++;
+  }
+}
+
+int main(int argc, char **argv) {
+  const char *path = argc > 1 ? argv[1] : "wav_check.wav";
+  sine_t sine = {0};
+  if (wav_render(path, RATE, FRAMES, sine_source, &sine) != 0) {
+    printf("FAIL wav_render\n");
+    return 1;
+  }
+
+  FILE *fp = fopen(path, "rb");
+  if (!fp) {
+    perror(path);
+    return 1;
+  }
+  static uint8_t file[44 + 2 * FRAMES + 1];
+  size_t len = fread(file, 1, sizeof(file), fp);
+  fclose(fp);
+
+  check(len == 44 + 2 * FRAMES, "file length");
+  check(memcmp(file, "RIFF", 4) == 0 && memcmp(&file[8], "WAVE", 4) == 0,
+        "RIFF/WAVE tags");
+  check(le32(&file[4]) == 36 + 2 * FRAMES, "RIFF size");
+  check(memcmp(&file[12], "fmt ", 4) == 0 && le32(&file[16]) == 16,
+        "fmt chunk");
+  check(le16(&file[20]) == 1 && le16(&file[22]) == 1, "PCM mono");
+  check(le32(&file[24]) == RATE && le32(&file[28]) == 2 * RATE,
+        "sample and byte rate");
+  check(le16(&file[32]) == 2 && le16(&file[34]) == 16, "block align, bits");
+  check(memcmp(&file[36], "data", 4) == 0 && le32(&file[40]) == 2 * FRAMES,
+        "data chunk");
+
+  size_t wrong = 0;
+  for (size_t i = 0; i < FRAMES && 44 + 2 * i + 1 < len; i++) {
+    int16_t want = i < SOURCE_END ? sine_at(i) : 0;
+    if ((int16_t)le16(&file[44 + 2 * i]) != want) {
+      wrong++;
+    }
+  }
+  check(wrong == 0, "samples");
+  if (argc <= 1) {
+    remove(path);
+  }
+
+  printf("%s (%u frames, %zu wrong samples)\n", failures ? "FAILED" : "ok",
+         FRAMES, wrong);
+  return failures ? 1 : 0;
+}
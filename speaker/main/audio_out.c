@@ -0,0 +1,145 @@
+#include "audio_out.h"
+
+#include "driver/i2s_pdm.h"
+#include "esp_check.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define AUDIO_TASK_STACK 4096
+#define AUDIO_TASK_PRIO (configMAX_PRIORITIES - 2)
+#define AUDIO_TASK_CORE 1
+
+static const char *TAG = "audio_out";
+
+static i2s_chan_handle_t tx_chan = NULL;
+static audio_out_config_t cfg;
+static audio_source_cb_t source_cb = NULL;
+static void *source_ctx = NULL;
+static int16_t *render_buf = NULL;
+
+// Werden aus der ISR geschrieben und vom Task gelesen
+static volatile uint32_t buffers_sent = 0;
+static volatile uint32_t underruns = 0;
+static uint32_t short_renders = 0;
+static uint64_t frames_rendered = 0;
+static uint32_t max_render_us = 0;
+static uint64_t render_us_total = 0;
+
+// Ein DMA-Puffer wurde vollständig abgespielt
+static bool IRAM_ATTR on_sent(i2s_chan_handle_t handle, i2s_event_data_t *event,
+                              void *user_ctx) {
+  buffers_sent++;
+  return false;
+}
+
+// Der Treiber hat einen Puffer wiederverwendet, der nicht nachgefüllt wurde.
+// Dank auto_clear wird in diesem Fall Stille statt alter Daten ausgegeben.
+static bool IRAM_ATTR on_send_q_ovf(i2s_chan_handle_t handle,
+                                    i2s_event_data_t *event, void *user_ctx) {
+  underruns++;
+  return false;
+}
+
+// Füllt render_buf komplett, fehlende Samples werden zu Stille
+static void render(void) {
+  int64_t start = esp_timer_get_time();
+  size_t got = source_cb(render_buf, cfg.frames_per_buffer, source_ctx);
+  if (got < cfg.frames_per_buffer) {
+    memset(&render_buf[got], 0,
+           (cfg.frames_per_buffer - got) * sizeof(int16_t));
+    short_renders++;
+  }
+  frames_rendered += cfg.frames_per_buffer;
+
+  uint32_t took = (uint32_t)(esp_timer_get_time() - start);
+  render_us_total += took;
+  if (took > max_render_us) {
+    max_render_us = took;
+  }
+}
+
+static void audio_task(void *arg) {
+  const size_t bytes = cfg.frames_per_buffer * sizeof(int16_t);
+  size_t written;
+
+  while (1) {
+    render();
+    // Blockiert, bis die DMA einen Puffer freigibt
+    i2s_channel_write(tx_chan, render_buf, bytes, &written, portMAX_DELAY);
+  }
+}
+
+esp_err_t audio_out_init(const audio_out_config_t *config) {
+  cfg = *config;
+
+  i2s_chan_config_t chan_cfg =
+      I2S_CHANNEL_DEFAULT_CONFIG(I2S_NUM_0, I2S_ROLE_MASTER);
+  chan_cfg.dma_desc_num = cfg.buffer_count;
+  chan_cfg.dma_frame_num = cfg.frames_per_buffer;
+  chan_cfg.auto_clear = true;
+  ESP_RETURN_ON_ERROR(i2s_new_channel(&chan_cfg, &tx_chan, NULL), TAG,
+                      "i2s_new_channel");
+
+  i2s_pdm_tx_config_t pdm_cfg = {
+      .clk_cfg = I2S_PDM_TX_CLK_DEFAULT_CONFIG(cfg.sample_rate_hz),
+      .slot_cfg = I2S_PDM_TX_SLOT_DEFAULT_CONFIG(I2S_DATA_BIT_WIDTH_16BIT,
+                                                 I2S_SLOT_MODE_MONO),
+      .gpio_cfg =
+          {
+              .clk = I2S_GPIO_UNUSED, // Lautsprecher braucht nur den Bitstrom
+              .dout = cfg.gpio_num,
+          },
+  };
+  ESP_RETURN_ON_ERROR(i2s_channel_init_pdm_tx_mode(tx_chan, &pdm_cfg), TAG,
+                      "pdm tx mode");
+
+  i2s_event_callbacks_t cbs = {
+      .on_sent = on_sent,
+      .on_send_q_ovf = on_send_q_ovf,
+  };
+  ESP_RETURN_ON_ERROR(i2s_channel_register_event_callback(tx_chan, &cbs, NULL),
+                      TAG, "callbacks");
+
+  render_buf = heap_caps_malloc(cfg.frames_per_buffer * sizeof(int16_t),
+                                MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA);
+  ESP_RETURN_ON_FALSE(render_buf, ESP_ERR_NO_MEM, TAG, "render buffer");
+  return ESP_OK;
+}
+
+esp_err_t audio_out_start(audio_source_cb_t source, void *ctx) {
+  source_cb = source;
+  source_ctx = ctx;
+
+  // Alle DMA-Puffer vor dem Start füllen, damit der erste Durchlauf nicht
+  // schon als Unterlauf zählt
+  const size_t bytes = cfg.frames_per_buffer * sizeof(int16_t);
+  for (size_t i = 0; i < cfg.buffer_count; i++) {
+    size_t loaded = 0;
+    render();
+    i2s_channel_preload_data(tx_chan, render_buf, bytes, &loaded);
+    if (loaded < bytes) {
+      break;
+    }
+  }
+
+  ESP_RETURN_ON_ERROR(i2s_channel_enable(tx_chan), TAG, "enable");
+  if (xTaskCreatePinnedToCore(audio_task, "audio_out", AUDIO_TASK_STACK, NULL,
+                              AUDIO_TASK_PRIO, NULL,
+                              AUDIO_TASK_CORE) != pdPASS) {
+    return ESP_ERR_NO_MEM;
+  }
+  return ESP_OK;
+}
+
+void audio_out_get_stats(audio_out_stats_t *stats) {
+  stats->buffers_sent = buffers_sent;
+  stats->underruns = underruns;
+  stats->short_renders = short_renders;
+  stats->frames_rendered = frames_rendered;
+  stats->max_render_us = max_render_us;
+  stats->render_us_total = render_us_total;
+}
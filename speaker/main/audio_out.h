@@ -0,0 +1,33 @@
+#pragma once
+
+#include "audio_source.h"
+#include "esp_err.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Audio-Ausgabe über den I2S-Peripherieblock im PDM-Modus (Delta-Sigma). Der
+// Bitstrom liegt direkt am Lautsprecher-Pin an, die DMA spielt die Puffer ab
+// und die CPU muss nur noch fertige Puffer nachfüllen.
+typedef struct {
+  int gpio_num;             // Datenpin (PDM-Bitstrom)
+  uint32_t sample_rate_hz;  // z.B. 16000
+  size_t frames_per_buffer; // Samples pro DMA-Puffer
+  size_t buffer_count;      // Anzahl DMA-Puffer, 2 = Double Buffering
+} audio_out_config_t;
+
+typedef struct {
+  uint32_t buffers_sent;    // von der DMA fertig abgespielte Puffer
+  uint32_t underruns;       // DMA lief leer, bevor nachgefüllt wurde
+  uint32_t short_renders;   // Quelle lieferte weniger Samples als verlangt
+  uint64_t frames_rendered; // insgesamt gerenderte Samples
+  uint32_t max_render_us;   // längste Renderzeit eines Puffers
+  uint64_t render_us_total; // Summe aller Renderzeiten (für CPU-Last)
+} audio_out_stats_t;
+
+esp_err_t audio_out_init(const audio_out_config_t *config);
+
+// Startet den Nachfüll-Task, der `source` immer dann aufruft, wenn ein
+// DMA-Puffer frei wird.
+esp_err_t audio_out_start(audio_source_cb_t source, void *ctx);
+
+void audio_out_get_stats(audio_out_stats_t *stats);
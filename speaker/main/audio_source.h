@@ -0,0 +1,13 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Signatur einer Sample-Quelle: schreibt bis zu `frames` Mono-Samples
+// (16 bit, signed) nach `dst` und gibt die Anzahl tatsächlich geschriebener
+// Frames zurück. Gibt eine Quelle weniger zurück, füllt der Aufrufer den Rest
+// mit Stille auf.
+//
+// Die Header-Datei hängt bewusst nicht von ESP-IDF ab, damit Quellen (Töne,
+// Synthesizer, Decoder) auch auf dem Host gerendert werden können.
+typedef size_t (*audio_source_cb_t)(int16_t *dst, size_t frames, void *ctx);
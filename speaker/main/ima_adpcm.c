@@ -0,0 +1,61 @@
+#include "ima_adpcm.h"
+
+static const int16_t step_table[89] = {
+    7,     8,     9,     10,    11,    12,    13,    14,    16,    17,
+    19,    21,    23,    25,    28,    31,    34,    37,    41,    45,
+    50,    55,    60,    66,    73,    80,    88,    97,    107,   118,
+    130,   143,   157,   173,   190,   209,   230,   253,   279,   307,
+    337,   371,   408,   449,   494,   544,   598,   658,   724,   796,
+    876,   963,   1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,
+    2272,  2499,  2749,  3024,  3327,  3660,  4026,  4428,  4871,  5358,
+    5894,  6484,  7132,  7845,  8630,  9493,  10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767};
+
+static const int8_t index_table[16] = {-1, -1, -1, -1, 2, 4, 6, 8,
+                                       -1, -1, -1, -1, 2, 4, 6, 8};
+
+size_t ima_adpcm_decode_block(const uint8_t *block, size_t block_align,
+                              int16_t *out) {
+  if (block_align <= IMA_ADPCM_HEADER_BYTES) {
+    return 0;
+  }
+
+  int32_t predictor = (int16_t)(block[0] | (block[1] << 8));
+  int32_t index = block[2];
+  if (index > 88) {
+    return 0;
+  }
+
+  size_t n = 0;
+  out[n++] = (int16_t)predictor;
+
+  for (size_t i = IMA_ADPCM_HEADER_BYTES; i < block_align; i++) {
+    // Zwei Codes pro Byte, niedriges Nibble zuerst
+    for (int shift = 0; shift < 8; shift += 4) {
+      uint8_t code = (block[i] >> shift) & 0x0F;
+      int32_t step = step_table[index];
+
+      // diff = (code + 0.5) * step / 4, ohne Multiplikation
+      int32_t diff = step >> 3;
+      if (code & 4) {
+        diff += step;
+      }
+      if (code & 2) {
+        diff += step >> 1;
+      }
+      if (code & 1) {
+        diff += step >> 2;
+      }
+      predictor += (code & 8) ? -diff : diff;
+      predictor = predictor > 32767 ? 32767 : predictor;
+      predictor = predictor < -32768 ? -32768 : predictor;
+
+      index += index_table[code];
+      index = index < 0 ? 0 : index;
+      index = index > 88 ? 88 : index;
+
+      out[n++] = (int16_t)predictor;
+    }
+  }
+  return n;
+}
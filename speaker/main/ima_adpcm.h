@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Decoder für IMA-ADPCM in WAV-Dateien (Format-Tag 0x0011), nur Mono.
+//
+// Ein Block beginnt mit einem 4-Byte-Header (Startwert int16, Step-Index,
+// reserviert), danach folgen je Byte zwei 4-bit-Codes, niedriges Nibble
+// zuerst. Ein Block der Länge block_align enthält daher
+// (block_align - 4) * 2 + 1 Samples.
+
+#define IMA_ADPCM_HEADER_BYTES 4
+
+static inline size_t ima_adpcm_samples_per_block(size_t block_align) {
+  return (block_align - IMA_ADPCM_HEADER_BYTES) * 2 + 1;
+}
+
+// Dekodiert einen kompletten Block. `out` muss Platz für
+// ima_adpcm_samples_per_block(block_align) Samples haben. Gibt die Anzahl
+// Samples zurück, 0 bei ungültigem Header.
+size_t ima_adpcm_decode_block(const uint8_t *block, size_t block_align,
+                              int16_t *out);
@@ -1,61 +1,125 @@
-#include "driver/gpio.h"
-#include "driver/gptimer.h"
+#include "audio_out.h"
+#include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include <stdbool.h>
-
-#define SPEAKER_PIN 21
-#define DESIRED_FREQ_HZ 100 // Ton
-
-static volatile bool speaker_state = false;
-
-// Gibt true zurück, wenn eine höhere Task aufgeweckt werden muss
-static bool IRAM_ATTR timer_on_alarm_cb(gptimer_handle_t timer,
-                                        const gptimer_alarm_event_data_t *edata,
-                                        void *user_data) {
-  // Lautsprecher-Pin umschalten
-  speaker_state = !speaker_state;
-  gpio_set_level(SPEAKER_PIN, speaker_state);
-  // Keine höhere Task muss aufgeweckt werden
-  return false;
+#include "sd_card.h"
+#include "synth.h"
+#include "wav_player.h"
+#include <string.h>
+
+// GPIO 21 ist jetzt der SCK der SD-Karte (Verdrahtung wie im gif-Projekt)
+#define SPEAKER_PIN 17
+
+// Audio-Parameter: 16 kHz Mono, zwei DMA-Puffer à 256 Samples (16 ms)
+#define SAMPLE_RATE_HZ 16000
+#define FRAMES_PER_BUFFER 256
+#define BUFFER_COUNT 2
+
+static const char *TAG = "speaker";
+
+#define SOUND_PATH SD_MOUNT_POINT "/sound.wav"
+
+static synth_t synth;
+static int16_t synth_buf[FRAMES_PER_BUFFER];
+
+// Alarm: zwei abwechselnde Rechtecktöne, läuft bis er gestoppt wird
+static const synth_note_t alarm_notes[] = {
+    {.note = 81, .velocity = 127, .duration_ms = 250, .gate_ms = 200},
+    {.note = 76, .velocity = 127, .duration_ms = 250, .gate_ms = 200},
+};
+static const synth_melody_t alarm = {
+    .notes = alarm_notes,
+    .count = sizeof(alarm_notes) / sizeof(alarm_notes[0]),
+    .wave = SYNTH_WAVE_SQUARE,
+    .adsr = {.attack_ms = 5, .decay_ms = 20, .sustain = 24000,
+             .release_ms = 30},
+    .loop = true,
+};
+
+// Kurze Melodie (Tonleiter C-Dur aufwärts)
+static const synth_note_t scale_notes[] = {
+    {60, 110, 300, 250}, {62, 110, 300, 250}, {64, 110, 300, 250},
+    {65, 110, 300, 250}, {67, 110, 300, 250}, {69, 110, 300, 250},
+    {71, 110, 300, 250}, {72, 127, 900, 700},
+};
+static const synth_melody_t scale = {
+    .notes = scale_notes,
+    .count = sizeof(scale_notes) / sizeof(scale_notes[0]),
+    .wave = SYNTH_WAVE_TRIANGLE,
+    .adsr = {.attack_ms = 10, .decay_ms = 80, .sustain = 20000,
+             .release_ms = 150},
+    .loop = false,
+};
+
+// Audioquelle: Datei von der SD-Karte plus Synthesizer darüber gemischt
+static size_t mix_render(int16_t *dst, size_t frames, void *ctx) {
+  size_t got = wav_player_render(dst, frames, NULL);
+  memset(&dst[got], 0, (frames - got) * sizeof(int16_t));
+
+  synth_render(synth_buf, frames, &synth);
+  for (size_t i = 0; i < frames; i++) {
+    int32_t s = dst[i] + synth_buf[i];
+    s = s > 32767 ? 32767 : s;
+    s = s < -32768 ? -32768 : s;
+    dst[i] = (int16_t)s;
+  }
+  return frames;
 }
 
 void app_main(void) {
-  // Konfiguriere den Lautsprecher-Pin
-  gpio_reset_pin(SPEAKER_PIN);
-  gpio_set_direction(SPEAKER_PIN, GPIO_MODE_OUTPUT);
-  gpio_set_level(SPEAKER_PIN, 0);
-
-  gptimer_handle_t gptimer = NULL;
-  gptimer_config_t timer_config = {
-      .clk_src = GPTIMER_CLK_SRC_DEFAULT,
-      .direction = GPTIMER_COUNT_UP,
-      .resolution_hz = 1 * 1000 * 1000, // 1 MHz, 1 Tick = 1 µs
+  // Der Ton wird nicht mehr per Timer-Interrupt am Pin erzeugt, sondern als
+  // PCM gerendert und per I2S/PDM mit DMA ausgegeben
+  audio_out_config_t audio_cfg = {
+      .gpio_num = SPEAKER_PIN,
+      .sample_rate_hz = SAMPLE_RATE_HZ,
+      .frames_per_buffer = FRAMES_PER_BUFFER,
+      .buffer_count = BUFFER_COUNT,
   };
-  gptimer_new_timer(&timer_config, &gptimer);
-
-  // Alarm-Konfiguration
-  gptimer_alarm_config_t alarm_config = {
-      .alarm_count =
-          1000000 / (DESIRED_FREQ_HZ * 2), // Halbe Periode in Ticks (µs)
-      .reload_count =
-          0, // Nicht neu laden, da auto_reload in der Hauptkonfig ist
-      .flags.auto_reload_on_alarm = true,
-  };
-  gptimer_set_alarm_action(gptimer, &alarm_config);
+  ESP_ERROR_CHECK(audio_out_init(&audio_cfg));
 
-  // Registriere die Callback-Funktion für den Alarm
-  gptimer_event_callbacks_t cbs = {
-      .on_alarm = timer_on_alarm_cb,
-  };
-  gptimer_register_event_callbacks(gptimer, &cbs, NULL);
+  synth_init(&synth, SAMPLE_RATE_HZ);
+  synth_play(&synth, &scale);
 
-  // Aktiviere und starte den Timer
-  gptimer_enable(gptimer);
-  gptimer_start(gptimer);
+  // Ohne SD-Karte läuft nur der Synthesizer
+  ESP_ERROR_CHECK(wav_player_init(SAMPLE_RATE_HZ));
+  if (init_sd_card() == ESP_OK) {
+    wav_player_play(SOUND_PATH, true);
+  }
+  ESP_ERROR_CHECK(audio_out_start(mix_render, NULL));
 
-  // Endlosschleife, damit das Programm aktiv bleibt
-  while (1) {
+  // Endlosschleife: wechselt alle 5 s zwischen Melodie und Alarm und gibt
+  // einmal pro Sekunde die Statistik aus
+  audio_out_stats_t last = {0};
+  for (int sec = 1;; sec++) {
     vTaskDelay(pdMS_TO_TICKS(1000));
+    if (sec % 5 == 0) {
+      synth_play(&synth, (sec / 5) % 2 ? &alarm : &scale);
+    }
+
+    audio_out_stats_t stats;
+    audio_out_get_stats(&stats);
+    wav_player_stats_t player;
+    wav_player_get_stats(&player);
+
+    // CPU-Last des Renderns in der letzten Sekunde (Renderzeit / Audiozeit)
+    uint64_t frames = stats.frames_rendered - last.frames_rendered;
+    uint64_t render_us = stats.render_us_total - last.render_us_total;
+    float cpu_pct =
+        frames ? 100.0f * render_us * SAMPLE_RATE_HZ / (frames * 1e6f) : 0;
+    int voices = synth_active_voices(&synth);
+    last = stats;
+
+    ESP_LOGI(TAG,
+             "voices=%d cpu=%.2f%% (%.1f voices/%%) underruns=%lu "
+             "max_render=%luus",
+             voices, cpu_pct, cpu_pct > 0 ? voices / cpu_pct : 0,
+             (unsigned long)stats.underruns,
+             (unsigned long)stats.max_render_us);
+    if (player.playing) {
+      ESP_LOGI(TAG, "wav: headroom min=%lums starved=%lu max_read=%luus",
+               (unsigned long)player.min_headroom_ms,
+               (unsigned long)player.starved,
+               (unsigned long)player.max_read_us);
+    }
   }
 }
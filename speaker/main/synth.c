@@ -0,0 +1,240 @@
+#include "synth.h"
+
+#include <math.h>
+#include <string.h>
+
+#define TABLE_SIZE (1 << SYNTH_TABLE_BITS)
+#define ENV_ONE (1 << 24)
+
+enum { STAGE_IDLE, STAGE_ATTACK, STAGE_DECAY, STAGE_SUSTAIN, STAGE_RELEASE };
+
+static int16_t wavetables[SYNTH_WAVE_COUNT][TABLE_SIZE];
+static bool tables_ready = false;
+
+static void build_tables(void) {
+  for (int i = 0; i < TABLE_SIZE; i++) {
+    float x = (float)i / TABLE_SIZE;
+    wavetables[SYNTH_WAVE_SINE][i] =
+        (int16_t)lrintf(32767.0f * sinf(2.0f * (float)M_PI * x));
+    wavetables[SYNTH_WAVE_SQUARE][i] = i < TABLE_SIZE / 2 ? 32767 : -32767;
+    wavetables[SYNTH_WAVE_SAW][i] = (int16_t)lrintf(32767.0f * (2.0f * x - 1));
+    wavetables[SYNTH_WAVE_TRIANGLE][i] = (int16_t)lrintf(
+        32767.0f * (x < 0.5f ? 4.0f * x - 1.0f : 3.0f - 4.0f * x));
+  }
+  tables_ready = true;
+}
+
+static uint32_t ms_to_blocks(const synth_t *synth, uint32_t ms) {
+  uint32_t blocks = ms * synth->sample_rate / 1000 / SYNTH_BLOCK;
+  return blocks ? blocks : 1;
+}
+
+static uint32_t note_to_step(const synth_t *synth, uint8_t note) {
+  float freq = 440.0f * powf(2.0f, (note - 69) / 12.0f);
+  return (uint32_t)(freq / synth->sample_rate * 4294967296.0f);
+}
+
+void synth_init(synth_t *synth, uint32_t sample_rate_hz) {
+  if (!tables_ready) {
+    build_tables();
+  }
+  memset(synth, 0, sizeof(*synth));
+  synth->sample_rate = sample_rate_hz;
+  atomic_init(&synth->pending, NULL);
+  synth->melody_voice = -1;
+  synth->out_pos = SYNTH_BLOCK; // Blockpuffer leer
+}
+
+int synth_note_on(synth_t *synth, uint8_t note, uint8_t velocity,
+                  synth_wave_t wave, const synth_adsr_t *adsr) {
+  int voice = 0;
+  for (int v = 0; v < SYNTH_VOICES; v++) {
+    if (synth->stage[v] == STAGE_IDLE) {
+      voice = v;
+      break;
+    }
+    if (synth->env[v] < synth->env[voice]) {
+      voice = v;
+    }
+  }
+
+  uint32_t attack = ms_to_blocks(synth, adsr->attack_ms);
+  synth->phase[voice] = 0;
+  synth->step[voice] = note_to_step(synth, note);
+  synth->table[voice] = wavetables[wave];
+  synth->velocity[voice] = (int16_t)(velocity * 258); // 127 -> 32766
+  synth->sustain[voice] = (int32_t)adsr->sustain << 9;
+  synth->decay_blocks[voice] = ms_to_blocks(synth, adsr->decay_ms);
+  synth->release_blocks[voice] = ms_to_blocks(synth, adsr->release_ms);
+  synth->env_goal[voice] = ENV_ONE;
+  synth->env_inc[voice] = (ENV_ONE - synth->env[voice]) / (int32_t)attack;
+  synth->stage[voice] = STAGE_ATTACK;
+  return voice;
+}
+
+void synth_note_off(synth_t *synth, int voice) {
+  if (voice < 0 || synth->stage[voice] == STAGE_IDLE) {
+    return;
+  }
+  synth->env_goal[voice] = 0;
+  synth->env_inc[voice] =
+      -synth->env[voice] / (int32_t)synth->release_blocks[voice];
+  if (synth->env_inc[voice] == 0) {
+    synth->env_inc[voice] = -1;
+  }
+  synth->stage[voice] = STAGE_RELEASE;
+}
+
+void synth_play(synth_t *synth, const synth_melody_t *melody) {
+  atomic_store(&synth->pending, melody);
+}
+
+int synth_active_voices(const synth_t *synth) {
+  int n = 0;
+  for (int v = 0; v < SYNTH_VOICES; v++) {
+    n += synth->stage[v] != STAGE_IDLE;
+  }
+  return n;
+}
+
+// Hüllkurve um einen Block weiterschalten
+static void envelope_step(synth_t *synth, int v) {
+  int32_t env = synth->env[v] + synth->env_inc[v];
+  int32_t goal = synth->env_goal[v];
+  bool reached = synth->env_inc[v] >= 0 ? env >= goal : env <= goal;
+  if (!reached) {
+    synth->env[v] = env;
+    return;
+  }
+
+  synth->env[v] = goal;
+  switch (synth->stage[v]) {
+  case STAGE_ATTACK:
+    synth->stage[v] = STAGE_DECAY;
+    synth->env_goal[v] = synth->sustain[v];
+    synth->env_inc[v] =
+        (synth->sustain[v] - ENV_ONE) / (int32_t)synth->decay_blocks[v];
+    if (synth->env_inc[v] == 0) {
+      synth->env_inc[v] = -1;
+    }
+    break;
+  case STAGE_DECAY:
+    synth->stage[v] = STAGE_SUSTAIN;
+    synth->env_inc[v] = 0;
+    break;
+  case STAGE_RELEASE:
+    synth->stage[v] = STAGE_IDLE;
+    synth->env_inc[v] = 0;
+    break;
+  default:
+    break;
+  }
+}
+
+// Sequencer um einen Block weiterschalten
+static void sequencer_step(synth_t *synth) {
+  const synth_melody_t *pending = atomic_load(&synth->pending);
+  if (pending != synth->melody) {
+    synth_note_off(synth, synth->melody_voice);
+    synth->melody_voice = -1;
+    synth->melody = pending;
+    synth->melody_pos = 0;
+    synth->note_blocks_left = 0;
+  }
+
+  const synth_melody_t *m = synth->melody;
+  if (!m) {
+    return;
+  }
+  if (synth->gate_blocks_left > 0 && --synth->gate_blocks_left == 0) {
+    synth_note_off(synth, synth->melody_voice);
+    synth->melody_voice = -1;
+  }
+  if (synth->note_blocks_left > 0 && --synth->note_blocks_left > 0) {
+    return;
+  }
+
+  if (synth->melody_pos >= m->count) {
+    if (!m->loop) {
+      // Nur löschen, wenn inzwischen keine andere Melodie angefordert wurde;
+      // sonst startet die neue im nächsten Block
+      const synth_melody_t *expected = m;
+      atomic_compare_exchange_strong(&synth->pending, &expected, NULL);
+      synth->melody = NULL;
+      return;
+    }
+    synth->melody_pos = 0;
+  }
+
+  const synth_note_t *n = &m->notes[synth->melody_pos++];
+  synth_note_off(synth, synth->melody_voice);
+  synth->melody_voice = -1;
+  synth->note_blocks_left = ms_to_blocks(synth, n->duration_ms);
+  synth->gate_blocks_left = 0;
+  if (n->note != SYNTH_NOTE_REST) {
+    synth->melody_voice =
+        synth_note_on(synth, n->note, n->velocity, m->wave, &m->adsr);
+    synth->gate_blocks_left = ms_to_blocks(synth, n->gate_ms);
+  }
+}
+
+// Rendert einen Block nach synth->out
+static void render_block(synth_t *synth) {
+  int32_t *restrict mix = synth->mix;
+  int16_t *restrict osc = synth->osc;
+  int16_t *restrict out = synth->out;
+
+  sequencer_step(synth);
+  memset(mix, 0, sizeof(synth->mix));
+
+  for (int v = 0; v < SYNTH_VOICES; v++) {
+    if (synth->stage[v] == STAGE_IDLE) {
+      continue;
+    }
+
+    // Oszillator: Tabellenzugriff über die oberen Bits der Phase
+    const int16_t *table = synth->table[v];
+    uint32_t phase = synth->phase[v];
+    const uint32_t step = synth->step[v];
+    for (int i = 0; i < SYNTH_BLOCK; i++) {
+      osc[i] = table[(phase + i * step) >> (32 - SYNTH_TABLE_BITS)];
+    }
+    synth->phase[v] = phase + SYNTH_BLOCK * step;
+
+    // Verstärkung ist innerhalb eines Blocks konstant (Q15)
+    const int32_t gain = ((synth->env[v] >> 9) * synth->velocity[v]) >> 15;
+    for (int i = 0; i < SYNTH_BLOCK; i++) {
+      mix[i] += (osc[i] * gain) >> 15;
+    }
+
+    envelope_step(synth, v);
+  }
+
+  // Mischer: Headroom abziehen und auf 16 bit sättigen
+  for (int i = 0; i < SYNTH_BLOCK; i++) {
+    int32_t s = mix[i] >> SYNTH_MIX_SHIFT;
+    s = s > 32767 ? 32767 : s;
+    s = s < -32768 ? -32768 : s;
+    out[i] = (int16_t)s;
+  }
+  synth->out_pos = 0;
+}
+
+size_t synth_render(int16_t *dst, size_t frames, void *ctx) {
+  synth_t *synth = ctx;
+  size_t done = 0;
+
+  while (done < frames) {
+    if (synth->out_pos == SYNTH_BLOCK) {
+      render_block(synth);
+    }
+    size_t n = SYNTH_BLOCK - synth->out_pos;
+    if (n > frames - done) {
+      n = frames - done;
+    }
+    memcpy(&dst[done], &synth->out[synth->out_pos], n * sizeof(int16_t));
+    synth->out_pos += n;
+    done += n;
+  }
+  return frames;
+}
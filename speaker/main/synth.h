@@ -0,0 +1,104 @@
+#pragma once
+
+#include "audio_source.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Kleiner polyphoner Wavetable-Synthesizer für Melodien und Alarmtöne.
+//
+// Der Zustand aller Stimmen liegt als Structure-of-Arrays vor und gerendert
+// wird blockweise (SYNTH_BLOCK Samples): Hüllkurven werden nur einmal pro
+// Block fortgeschrieben, die inneren Schleifen sind reine int16/int32
+// Multiplizier-Akkumulier-Schleifen ohne Verzweigungen, die der Compiler
+// (bzw. PIE auf dem ESP32-S3) vektorisieren kann.
+
+#define SYNTH_VOICES 8
+#define SYNTH_BLOCK 32      // Samples pro Block (2 ms bei 16 kHz)
+#define SYNTH_TABLE_BITS 8  // 256 Einträge pro Wavetable
+#define SYNTH_MIX_SHIFT 2   // Headroom: 4 Stimmen mit voller Lautstärke
+#define SYNTH_NOTE_REST 0xFF // Pause im Sequencer
+
+typedef enum {
+  SYNTH_WAVE_SINE,
+  SYNTH_WAVE_SQUARE,
+  SYNTH_WAVE_SAW,
+  SYNTH_WAVE_TRIANGLE,
+  SYNTH_WAVE_COUNT
+} synth_wave_t;
+
+typedef struct {
+  uint16_t attack_ms;
+  uint16_t decay_ms;
+  uint16_t sustain; // Q15, 32767 = volle Lautstärke
+  uint16_t release_ms;
+} synth_adsr_t;
+
+// Eine Note im Sequencer
+typedef struct {
+  uint8_t note;         // MIDI-Notennummer (69 = A4 = 440 Hz) oder REST
+  uint8_t velocity;     // 0..127
+  uint16_t duration_ms; // Dauer inklusive Pause bis zur nächsten Note
+  uint16_t gate_ms;     // Nach gate_ms wird die Note losgelassen
+} synth_note_t;
+
+typedef struct {
+  const synth_note_t *notes;
+  size_t count;
+  synth_wave_t wave;
+  synth_adsr_t adsr;
+  bool loop;
+} synth_melody_t;
+
+typedef struct {
+  uint32_t sample_rate;
+
+  // Stimmenzustand (Structure-of-Arrays)
+  uint32_t phase[SYNTH_VOICES];
+  uint32_t step[SYNTH_VOICES];
+  int32_t env[SYNTH_VOICES];      // Hüllkurve, Q24
+  int32_t env_inc[SYNTH_VOICES];  // Änderung pro Block, Q24
+  int32_t env_goal[SYNTH_VOICES]; // Ziel der aktuellen Phase, Q24
+  int32_t sustain[SYNTH_VOICES];  // Q24
+  uint32_t decay_blocks[SYNTH_VOICES];
+  uint32_t release_blocks[SYNTH_VOICES];
+  int16_t velocity[SYNTH_VOICES]; // Q15
+  uint8_t stage[SYNTH_VOICES];
+  const int16_t *table[SYNTH_VOICES];
+
+  // Sequencer
+  // Von synth_play gesetzt, vom Sequencer am Melodieende nur per
+  // Compare-and-swap gelöscht, damit eine neue Anforderung nicht verloren geht
+  _Atomic(const synth_melody_t *) pending;
+  const synth_melody_t *melody;
+  size_t melody_pos;
+  uint32_t note_blocks_left;
+  uint32_t gate_blocks_left;
+  int melody_voice;
+
+  // Blockpuffer
+  int32_t mix[SYNTH_BLOCK] __attribute__((aligned(16)));
+  int16_t osc[SYNTH_BLOCK] __attribute__((aligned(16)));
+  int16_t out[SYNTH_BLOCK] __attribute__((aligned(16)));
+  size_t out_pos; // bereits ausgegebene Samples aus `out`
+} synth_t;
+
+void synth_init(synth_t *synth, uint32_t sample_rate_hz);
+
+// Startet eine Note und gibt die Stimme zurück. Ist keine Stimme frei, wird
+// die leiseste Stimme übernommen.
+int synth_note_on(synth_t *synth, uint8_t note, uint8_t velocity,
+                  synth_wave_t wave, const synth_adsr_t *adsr);
+void synth_note_off(synth_t *synth, int voice);
+
+// Spielt eine Melodie über den eingebauten Sequencer ab (NULL stoppt). Darf
+// aus einem anderen Task aufgerufen werden, die Melodie wird am nächsten
+// Blockanfang übernommen.
+void synth_play(synth_t *synth, const synth_melody_t *melody);
+
+// Anzahl aktuell klingender Stimmen
+int synth_active_voices(const synth_t *synth);
+
+// audio_source_cb_t, ctx ist ein synth_t
+size_t synth_render(int16_t *dst, size_t frames, void *ctx);
@@ -0,0 +1,59 @@
+#include "wav_format.h"
+
+#include <string.h>
+
+static uint16_t get_le16(const uint8_t *p) { return p[0] | (p[1] << 8); }
+
+static uint32_t get_le32(const uint8_t *p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+int wav_parse_header(const uint8_t *buf, size_t len, wav_info_t *info) {
+  if (len < 12 || memcmp(buf, "RIFF", 4) != 0 ||
+      memcmp(&buf[8], "WAVE", 4) != 0) {
+    return -1;
+  }
+
+  memset(info, 0, sizeof(*info));
+  size_t pos = 12;
+  int have_fmt = 0;
+
+  // Chunks durchlaufen, bis der data-Chunk gefunden ist
+  while (pos + 8 <= len) {
+    const uint8_t *chunk = &buf[pos];
+    uint32_t size = get_le32(&chunk[4]);
+
+    if (memcmp(chunk, "fmt ", 4) == 0) {
+      if (size < 16 || pos + 8 + 16 > len) {
+        return -1;
+      }
+      info->format = get_le16(&chunk[8]);
+      info->channels = get_le16(&chunk[10]);
+      info->sample_rate = get_le32(&chunk[12]);
+      info->block_align = get_le16(&chunk[20]);
+      info->bits_per_sample = get_le16(&chunk[22]);
+      have_fmt = 1;
+    } else if (memcmp(chunk, "data", 4) == 0) {
+      if (!have_fmt) {
+        return -1;
+      }
+      info->data_offset = pos + 8;
+      info->data_size = size;
+      break;
+    }
+    // Chunks sind auf gerade Längen aufgefüllt
+    pos += 8 + size + (size & 1);
+  }
+
+  if (!have_fmt || info->data_offset == 0 || info->channels != 1) {
+    return -1;
+  }
+  if (info->format == WAV_FORMAT_PCM && info->bits_per_sample == 16) {
+    return 0;
+  }
+  if (info->format == WAV_FORMAT_IMA_ADPCM && info->bits_per_sample == 4 &&
+      info->block_align > 4) {
+    return 0;
+  }
+  return -1;
+}
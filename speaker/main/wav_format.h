@@ -0,0 +1,22 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define WAV_FORMAT_PCM 0x0001
+#define WAV_FORMAT_IMA_ADPCM 0x0011
+
+typedef struct {
+  uint16_t format;       // WAV_FORMAT_PCM oder WAV_FORMAT_IMA_ADPCM
+  uint16_t channels;
+  uint32_t sample_rate;
+  uint16_t block_align;  // Bytes pro Block (ADPCM) bzw. pro Frame (PCM)
+  uint16_t bits_per_sample;
+  uint32_t data_offset;  // Dateiposition des ersten Sample-Bytes
+  uint32_t data_size;    // Länge des data-Chunks in Bytes
+} wav_info_t;
+
+// Sucht die fmt- und data-Chunks im Dateianfang `buf`. Gibt 0 zurück, wenn
+// beide gefunden wurden und das Format unterstützt wird (Mono, 16-bit PCM
+// oder 4-bit IMA-ADPCM), sonst -1.
+int wav_parse_header(const uint8_t *buf, size_t len, wav_info_t *info);
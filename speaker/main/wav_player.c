@@ -0,0 +1,308 @@
+#include "wav_player.h"
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "ima_adpcm.h"
+#include "ring_buffer.h"
+#include "wav_format.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+
+#define SECTOR_BYTES 512
+#define PATH_MAX_LEN 64
+#define READER_TASK_STACK 4096
+#define READER_TASK_PRIO 5
+#define READER_TASK_CORE 0
+// Wiedergabe startet erst, wenn der Ring zur Hälfte gefüllt ist
+#define PREROLL_BYTES (WAV_PLAYER_RING_BYTES / 2)
+
+static const char *TAG = "wav_player";
+
+typedef struct {
+  char path[PATH_MAX_LEN];
+  bool loop;
+} play_request_t;
+
+static uint32_t output_rate;
+static QueueHandle_t requests;
+static TaskHandle_t reader_task_handle;
+
+static ring_buffer_t ring;
+static uint8_t *ring_mem;
+static uint8_t *chunk_buf; // DMA-fähiger Lesepuffer
+
+// Gemeinsamer Zustand zwischen Reader-Task und Audio-Task
+static atomic_bool active;         // Audio-Task darf aus dem Ring lesen
+static atomic_bool stop_requested; // Audio-Task soll die Wiedergabe beenden
+static atomic_bool eof;            // Reader hat alle Daten in den Ring gelegt
+static wav_info_t info;            // nur gültig, solange active gesetzt ist
+
+// Nur vom Audio-Task verwendet
+static int16_t *block_pcm; // dekodierter ADPCM-Block
+static size_t block_len;
+static size_t block_pos;
+static uint8_t *block_raw; // Block, falls er im Ring umbricht
+
+static wav_player_stats_t stats;
+
+// --- Reader-Task -----------------------------------------------------------
+
+static FILE *file;
+static uint32_t remaining; // noch zu lesende Bytes des data-Chunks
+static uint32_t skip;      // Bytes vor dem data-Chunk im ersten Sektor
+static bool loop_file;
+
+// Positioniert auf den Sektor, in dem der data-Chunk beginnt, damit alle
+// folgenden Lesezugriffe sektor-ausgerichtet sind
+static bool seek_data(void) {
+  uint32_t aligned = info.data_offset & ~(SECTOR_BYTES - 1);
+  skip = info.data_offset - aligned;
+  remaining = info.data_size;
+  return fseek(file, aligned, SEEK_SET) == 0;
+}
+
+static void close_file(void) {
+  if (file) {
+    fclose(file);
+    file = NULL;
+  }
+}
+
+// Wartet, bis der Audio-Task die laufende Wiedergabe beendet hat
+static void stop_playback(void) {
+  if (atomic_load(&active)) {
+    atomic_store(&stop_requested, true);
+    while (atomic_load(&active)) {
+      vTaskDelay(pdMS_TO_TICKS(5));
+    }
+  }
+  close_file();
+}
+
+static bool open_file(const play_request_t *req) {
+  file = fopen(req->path, "rb");
+  if (!file) {
+    ESP_LOGE(TAG, "%s nicht gefunden", req->path);
+    return false;
+  }
+  // Kein stdio-Puffer: die Chunks gehen direkt an FATFS
+  setvbuf(file, NULL, _IONBF, 0);
+
+  size_t n = fread(chunk_buf, 1, WAV_PLAYER_CHUNK_BYTES, file);
+  if (wav_parse_header(chunk_buf, n, &info) != 0) {
+    ESP_LOGE(TAG, "%s: nicht unterstütztes WAV-Format", req->path);
+    close_file();
+    return false;
+  }
+  if (info.sample_rate != output_rate ||
+      (info.format == WAV_FORMAT_IMA_ADPCM &&
+       info.block_align > WAV_PLAYER_MAX_BLOCK_ALIGN)) {
+    ESP_LOGE(TAG, "%s: %lu Hz / Block %u nicht unterstützt", req->path,
+             (unsigned long)info.sample_rate, info.block_align);
+    close_file();
+    return false;
+  }
+
+  ESP_LOGI(TAG, "%s: %s, %lu Hz, %lu Bytes", req->path,
+           info.format == WAV_FORMAT_PCM ? "PCM" : "IMA-ADPCM",
+           (unsigned long)info.sample_rate, (unsigned long)info.data_size);
+  loop_file = req->loop;
+  return seek_data();
+}
+
+// Liest einen Chunk und legt den Teil, der zum data-Chunk gehört, in den Ring
+static void read_chunk(void) {
+  int64_t start = esp_timer_get_time();
+  size_t n = fread(chunk_buf, 1, WAV_PLAYER_CHUNK_BYTES, file);
+  uint32_t took = (uint32_t)(esp_timer_get_time() - start);
+  if (took > stats.max_read_us) {
+    stats.max_read_us = took;
+  }
+  stats.chunks_read++;
+
+  size_t usable = n > skip ? n - skip : 0;
+  if (usable > remaining) {
+    usable = remaining;
+  }
+  ring_write(&ring, &chunk_buf[skip], usable);
+  remaining -= usable;
+  skip = 0;
+
+  if (remaining == 0 || n < WAV_PLAYER_CHUNK_BYTES) {
+    if (loop_file && seek_data()) {
+      return;
+    }
+    atomic_store(&eof, true);
+  }
+}
+
+static void reader_task(void *arg) {
+  play_request_t req;
+
+  while (1) {
+    // Neue Anforderung hat Vorrang, sonst auf Platz im Ring warten
+    TickType_t wait = atomic_load(&active) || file ? 0 : portMAX_DELAY;
+    if (xQueueReceive(requests, &req, wait) == pdTRUE) {
+      stop_playback();
+      atomic_store(&stop_requested, false);
+      if (req.path[0] == '\0' || !open_file(&req)) {
+        continue;
+      }
+      ring_reset(&ring);
+      atomic_store(&eof, false);
+      block_len = block_pos = 0;
+      stats.starved = 0;
+      stats.min_headroom_bytes = WAV_PLAYER_RING_BYTES;
+    }
+    if (!file) {
+      continue;
+    }
+
+    if (!atomic_load(&eof) && ring_free(&ring) >= WAV_PLAYER_CHUNK_BYTES) {
+      read_chunk();
+      if (!atomic_load(&active) &&
+          (ring_used(&ring) >= PREROLL_BYTES || atomic_load(&eof))) {
+        atomic_store(&active, true);
+      }
+      continue;
+    }
+    if (atomic_load(&eof) && !atomic_load(&active)) {
+      // Wiedergabe ist zu Ende
+      close_file();
+      continue;
+    }
+    // Audio-Task meldet sich, sobald er Daten verbraucht hat
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(50));
+  }
+}
+
+// --- Audio-Task ------------------------------------------------------------
+
+static bool decode_next_block(void) {
+  if (ring_used(&ring) < info.block_align) {
+    return false;
+  }
+  size_t contiguous;
+  const uint8_t *src = ring_read_ptr(&ring, &contiguous);
+  if (contiguous < info.block_align) {
+    // Block bricht am Ringende um, einmal umkopieren
+    ring_read(&ring, block_raw, info.block_align);
+    src = block_raw;
+    block_len = ima_adpcm_decode_block(src, info.block_align, block_pcm);
+  } else {
+    block_len = ima_adpcm_decode_block(src, info.block_align, block_pcm);
+    ring_read_commit(&ring, info.block_align);
+  }
+  block_pos = 0;
+  return block_len > 0;
+}
+
+static size_t render_adpcm(int16_t *dst, size_t frames) {
+  size_t done = 0;
+  while (done < frames) {
+    if (block_pos == block_len && !decode_next_block()) {
+      break;
+    }
+    size_t n = block_len - block_pos;
+    if (n > frames - done) {
+      n = frames - done;
+    }
+    memcpy(&dst[done], &block_pcm[block_pos], n * sizeof(int16_t));
+    block_pos += n;
+    done += n;
+  }
+  return done;
+}
+
+static void update_headroom(void) {
+  uint32_t used = ring_used(&ring);
+  if (used < stats.min_headroom_bytes) {
+    stats.min_headroom_bytes = used;
+    // Bytes pro Sekunde: PCM 2 Bytes/Sample, ADPCM block_align pro Block
+    uint64_t bytes_per_s =
+        info.format == WAV_FORMAT_PCM
+            ? 2ull * info.sample_rate
+            : (uint64_t)info.block_align * info.sample_rate /
+                  ima_adpcm_samples_per_block(info.block_align);
+    stats.min_headroom_ms = (uint32_t)(used * 1000ull / bytes_per_s);
+  }
+}
+
+size_t wav_player_render(int16_t *dst, size_t frames, void *ctx) {
+  if (!atomic_load(&active)) {
+    return 0;
+  }
+  if (atomic_load(&stop_requested)) {
+    atomic_store(&active, false);
+    return 0;
+  }
+
+  update_headroom();
+  size_t done;
+  if (info.format == WAV_FORMAT_PCM) {
+    done = ring_read(&ring, dst, frames * sizeof(int16_t)) / sizeof(int16_t);
+  } else {
+    done = render_adpcm(dst, frames);
+  }
+
+  if (done < frames) {
+    if (atomic_load(&eof)) {
+      atomic_store(&active, false); // Datei vollständig abgespielt
+    } else {
+      stats.starved++;
+    }
+  }
+  xTaskNotifyGive(reader_task_handle);
+  return done;
+}
+
+// --- API -------------------------------------------------------------------
+
+esp_err_t wav_player_init(uint32_t output_rate_hz) {
+  output_rate = output_rate_hz;
+
+  ring_mem = heap_caps_malloc(WAV_PLAYER_RING_BYTES, MALLOC_CAP_INTERNAL);
+  chunk_buf = heap_caps_aligned_alloc(4, WAV_PLAYER_CHUNK_BYTES,
+                                      MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA);
+  block_raw = heap_caps_malloc(WAV_PLAYER_MAX_BLOCK_ALIGN, MALLOC_CAP_INTERNAL);
+  block_pcm = heap_caps_malloc(
+      ima_adpcm_samples_per_block(WAV_PLAYER_MAX_BLOCK_ALIGN) * sizeof(int16_t),
+      MALLOC_CAP_INTERNAL);
+  requests = xQueueCreate(2, sizeof(play_request_t));
+  if (!ring_mem || !chunk_buf || !block_raw || !block_pcm || !requests) {
+    return ESP_ERR_NO_MEM;
+  }
+  ring_init(&ring, ring_mem, WAV_PLAYER_RING_BYTES);
+
+  if (xTaskCreatePinnedToCore(reader_task, "wav_reader", READER_TASK_STACK,
+                              NULL, READER_TASK_PRIO, &reader_task_handle,
+                              READER_TASK_CORE) != pdPASS) {
+    return ESP_ERR_NO_MEM;
+  }
+  return ESP_OK;
+}
+
+esp_err_t wav_player_play(const char *path, bool loop) {
+  play_request_t req = {.loop = loop};
+  if (strlen(path) >= sizeof(req.path)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  strcpy(req.path, path);
+  return xQueueSend(requests, &req, 0) == pdTRUE ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+void wav_player_stop(void) {
+  // Leerer Pfad beendet nur die laufende Wiedergabe
+  play_request_t req = {0};
+  xQueueSend(requests, &req, 0);
+}
+
+void wav_player_get_stats(wav_player_stats_t *out) {
+  *out = stats;
+  out->playing = atomic_load(&active);
+}
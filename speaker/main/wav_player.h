@@ -0,0 +1,38 @@
+#pragma once
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Spielt WAV-Dateien (16-bit PCM oder IMA-ADPCM, Mono) von der SD-Karte ab.
+//
+// Ein Hintergrund-Task liest die Datei in sektor-ausgerichteten Chunks in
+// einen Ringpuffer voraus. wav_player_render wird als Audioquelle im
+// Audio-Task aufgerufen, holt die Daten aus dem Ring und dekodiert ADPCM
+// blockweise. Die Füllung des Rings beim Rendern wird als Headroom gemessen.
+
+#define WAV_PLAYER_CHUNK_BYTES 4096      // Lesegröße, Vielfaches von 512
+#define WAV_PLAYER_RING_BYTES (32 * 1024) // Zweierpotenz
+#define WAV_PLAYER_MAX_BLOCK_ALIGN 2048
+
+typedef struct {
+  bool playing;
+  uint32_t chunks_read;
+  uint32_t max_read_us;        // längster einzelner fread
+  uint32_t starved;            // Render-Aufrufe ohne genug Daten im Ring
+  uint32_t min_headroom_bytes; // kleinste Ringfüllung während der Wiedergabe
+  uint32_t min_headroom_ms;    // dieselbe Füllung in Millisekunden Audio
+} wav_player_stats_t;
+
+// output_rate_hz muss der Abtastrate von audio_out entsprechen
+esp_err_t wav_player_init(uint32_t output_rate_hz);
+
+// Startet die Wiedergabe (eine laufende wird abgebrochen)
+esp_err_t wav_player_play(const char *path, bool loop);
+void wav_player_stop(void);
+
+// audio_source_cb_t, ctx wird nicht verwendet
+size_t wav_player_render(int16_t *dst, size_t frames, void *ctx);
+
+void wav_player_get_stats(wav_player_stats_t *stats);
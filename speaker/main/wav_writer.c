@@ -0,0 +1,111 @@
+#include "wav_writer.h"
+
+#include <string.h>
+
+#define WAV_HEADER_BYTES 44
+#define WAV_RENDER_CHUNK 256
+
+static void put_le16(uint8_t *p, uint16_t v) {
+  p[0] = v & 0xFF;
+  p[1] = v >> 8;
+}
+
+static void put_le32(uint8_t *p, uint32_t v) {
+  p[0] = v & 0xFF;
+  p[1] = (v >> 8) & 0xFF;
+  p[2] = (v >> 16) & 0xFF;
+  p[3] = v >> 24;
+}
+
+static int write_header(wav_writer_t *w) {
+  uint8_t h[WAV_HEADER_BYTES];
+  uint16_t block_align = w->channels * sizeof(int16_t);
+
+  memcpy(&h[0], "RIFF", 4);
+  put_le32(&h[4], 36 + w->data_bytes);
+  memcpy(&h[8], "WAVE", 4);
+  memcpy(&h[12], "fmt ", 4);
+  put_le32(&h[16], 16); // Länge des fmt-Chunks
+  put_le16(&h[20], 1);  // PCM
+  put_le16(&h[22], w->channels);
+  put_le32(&h[24], w->sample_rate);
+  put_le32(&h[28], w->sample_rate * block_align);
+  put_le16(&h[32], block_align);
+  put_le16(&h[34], 16);
+  memcpy(&h[36], "data", 4);
+  put_le32(&h[40], w->data_bytes);
+
+  if (fseek(w->fp, 0, SEEK_SET) != 0) {
+    return -1;
+  }
+  return fwrite(h, 1, sizeof(h), w->fp) == sizeof(h) ? 0 : -1;
+}
+
+int wav_writer_open(wav_writer_t *w, const char *path, uint32_t sample_rate,
+                    uint16_t channels) {
+  w->fp = fopen(path, "wb");
+  if (!w->fp) {
+    return -1;
+  }
+  w->sample_rate = sample_rate;
+  w->channels = channels;
+  w->data_bytes = 0;
+  // Platzhalter-Header, die Längen werden in wav_writer_close eingetragen
+  if (write_header(w) != 0) {
+    fclose(w->fp);
+    w->fp = NULL;
+    return -1;
+  }
+  return 0;
+}
+
+int wav_writer_write(wav_writer_t *w, const int16_t *samples, size_t frames) {
+  size_t count = frames * w->channels;
+  uint8_t buf[2 * WAV_RENDER_CHUNK];
+
+  // Samples explizit als Little Endian schreiben, unabhängig vom Host
+  while (count > 0) {
+    size_t n = count < WAV_RENDER_CHUNK ? count : WAV_RENDER_CHUNK;
+    for (size_t i = 0; i < n; i++) {
+      put_le16(&buf[2 * i], (uint16_t)samples[i]);
+    }
+    if (fwrite(buf, 2, n, w->fp) != n) {
+      return -1;
+    }
+    w->data_bytes += n * 2;
+    samples += n;
+    count -= n;
+  }
+  return 0;
+}
+
+int wav_writer_close(wav_writer_t *w) {
+  int ret = write_header(w);
+  if (fclose(w->fp) != 0) {
+    ret = -1;
+  }
+  w->fp = NULL;
+  return ret;
+}
+
+int wav_render(const char *path, uint32_t sample_rate, size_t frames,
+               audio_source_cb_t source, void *ctx) {
+  wav_writer_t w;
+  int16_t chunk[WAV_RENDER_CHUNK];
+
+  if (wav_writer_open(&w, path, sample_rate, 1) != 0) {
+    return -1;
+  }
+  while (frames > 0) {
+    size_t want = frames < WAV_RENDER_CHUNK ? frames : WAV_RENDER_CHUNK;
+    size_t got = source(chunk, want, ctx);
+    // Wie audio_out: fehlende Samples werden zu Stille
+    memset(&chunk[got], 0, (want - got) * sizeof(int16_t));
+    if (wav_writer_write(&w, chunk, want) != 0) {
+      wav_writer_close(&w);
+      return -1;
+    }
+    frames -= want;
+  }
+  return wav_writer_close(&w);
+}
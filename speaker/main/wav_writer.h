@@ -0,0 +1,27 @@
+#pragma once
+
+#include "audio_source.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Minimaler WAV-Schreiber (PCM, 16 bit). Läuft auf dem ESP (z.B. auf die
+// SD-Karte) genauso wie auf dem Host, um die Sample-Pipeline ohne Lautsprecher
+// anhören und vergleichen zu können.
+typedef struct {
+  FILE *fp;
+  uint32_t sample_rate;
+  uint16_t channels;
+  uint32_t data_bytes;
+} wav_writer_t;
+
+// Alle Funktionen geben 0 bei Erfolg und -1 bei einem Fehler zurück.
+int wav_writer_open(wav_writer_t *w, const char *path, uint32_t sample_rate,
+                    uint16_t channels);
+int wav_writer_write(wav_writer_t *w, const int16_t *samples, size_t frames);
+// Trägt die endgültigen Längen in den Header ein und schließt die Datei.
+int wav_writer_close(wav_writer_t *w);
+
+// Rendert `frames` Mono-Samples aus `source` in eine WAV-Datei.
+int wav_render(const char *path, uint32_t sample_rate, size_t frames,
+               audio_source_cb_t source, void *ctx);
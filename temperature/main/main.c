@@ -1,56 +1,78 @@
+#include "binlog.h"
+#include "ds18x20.h"
+#include "esp_err.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "esp_err.h"
+#include "metrics.h"
+#include <inttypes.h>
 #include <onewire_bus.h>
-#include <onewire_device.h>
 #include <stdio.h>
-#include <string.h>
 
 #define ONEWIRE_GPIO 18
+#define MEASURE_PERIOD_MS 2000
+// 9 bit: 0,5 °C in ~94 ms ... 12 bit: 0,0625 °C in 750 ms
+#define SENSOR_RESOLUTION_BITS 10
+#define SET_RESOLUTION_ATTEMPTS 3
+// Alle 10 Messungen (20 s) die 1-Wire-Messwerte ausgeben
+#define METRICS_EVERY 10
 
 onewire_bus_handle_t bus = NULL;
-onewire_device_address_t device_address = 0;
+static ds18x20_t sensors;
 
 void app_main(void) {
+  // Messwerte gehen binär über die Konsolen-UART, die Formatierung
+  // übernimmt components/binlog/host/binlog_decode auf dem PC
+  ESP_ERROR_CHECK(binlog_start(BINLOG_CONSOLE_UART));
+
   // Init bus
   onewire_bus_config_t cfg = {.bus_gpio_num = ONEWIRE_GPIO};
   onewire_bus_rmt_config_t rmt = {.max_rx_bytes = 10};
-  onewire_new_bus_rmt(&cfg, &rmt, &bus);
-
-  // Search device
-  onewire_device_iter_handle_t iter;
-  onewire_device_t dev;
-  onewire_new_device_iter(bus, &iter);
-  while (onewire_device_iter_get_next(iter, &dev) == ESP_OK) {
-    if ((dev.address & 0xFF) == 0x10) {
-      device_address = dev.address;
-      break;
-    }
+  ESP_ERROR_CHECK(onewire_new_bus_rmt(&cfg, &rmt, &bus));
+
+  // Alle Sensoren einmal suchen, die ROM-Codes bleiben gespeichert
+  ESP_ERROR_CHECK(ds18x20_init(&sensors, bus));
+  printf("%d Sensor(en) gefunden\n", (int)sensors.count);
+  // Eine gestörte Übertragung darf den Start nicht abbrechen. Sensoren, bei
+  // denen es nicht klappt, messen mit ihrer bisherigen Auflösung weiter,
+  // convert_all wartet dann entsprechend länger.
+  esp_err_t err = ESP_FAIL;
+  for (int attempt = 0; attempt < SET_RESOLUTION_ATTEMPTS && err != ESP_OK;
+       attempt++) {
+    err = ds18x20_set_resolution_all(&sensors, SENSOR_RESOLUTION_BITS);
+  }
+  if (err != ESP_OK) {
+    printf("Auflösung nicht überall gesetzt (%s)\n", esp_err_to_name(err));
   }
-  onewire_del_device_iter(iter);
 
+  TickType_t last_wake = xTaskGetTickCount();
+  uint32_t measurements = 0;
   while (1) {
-    // Start conversion (broadcast with SKIP ROM)
-    uint8_t cmd[] = {0xCC, 0x44}; // SKIP ROM + CONVERT
-    onewire_bus_reset(bus);
-    onewire_bus_write_bytes(bus, cmd, 2);
-    vTaskDelay(pdMS_TO_TICKS(750));
-
-    // Read scratchpad
-    uint8_t match[9] = {0x55}; // MATCH ROM
-    memcpy(&match[1], &device_address, 8);
-    uint8_t read_cmd = 0xBE;
-    uint8_t data[9] = {0};
-
-    onewire_bus_reset(bus);
-    onewire_bus_write_bytes(bus, match, 9);
-    onewire_bus_write_bytes(bus, &read_cmd, 1);
-    onewire_bus_read_bytes(bus, data, 9);
-
-    int16_t raw = (data[1] << 8) | data[0];
-    float temp = raw / 2.0;
-    printf("%.2f°C\n", temp);
-
-    vTaskDelay(pdMS_TO_TICKS(2000));
+    // Eine Wandlung für alle Sensoren, danach jeden einzeln auslesen
+    if (ds18x20_convert_all(&sensors) == ESP_OK) {
+      ds18x20_read_all(&sensors);
+    }
+
+    for (size_t i = 0; i < sensors.count; i++) {
+      ds18x20_sensor_t *s = &sensors.sensors[i];
+      if (s->valid) {
+        BINLOG("[%d] %.2f°C (read %" PRId64 "us)", (int)i, s->temperature,
+               s->read_latency_us);
+      } else {
+        printf("[%d] Lesefehler\n", (int)i);
+      }
+      if (s->crc_errors || s->bus_errors) {
+        printf("[%d] crc=%lu bus=%lu retries=%lu failed=%lu/%lu\n", (int)i,
+               (unsigned long)s->crc_errors, (unsigned long)s->bus_errors,
+               (unsigned long)s->retries, (unsigned long)s->failures,
+               (unsigned long)s->reads);
+      }
+    }
+    BINLOG("convert %" PRId64 "us", sensors.convert_us);
+    if (++measurements % METRICS_EVERY == 0) {
+      metrics_print(stdout);
+    }
+
+    // Fester Messtakt statt zusätzlicher Pause nach jeder Messung
+    vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(MEASURE_PERIOD_MS));
   }
 }
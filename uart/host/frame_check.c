@@ -0,0 +1,183 @@
+/*
+Host tests for the zero-copy framing in frame_reader.c. Byte streams are
+pushed into a small ring in chunks of every size from 1 byte up and from
+every start position in the ring. Frames are taken out as soon as they are
+complete, like the UART task does.
+
+  gcc -O2 -Wall -I../main -I../../components/ring_buffer -o frame_check \
+      frame_check.c ../main/frame_reader.c \
+      ../../components/ring_buffer/ring_buffer.c
+  ./frame_check
+
+Covered: frames split across reads and across the ring end, back-to-back
+and empty frames, and resynchronisation after garbage in all three modes.
+*/
+
+#include "frame_reader.h"
+#include "ring_buffer.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define RING_SIZE 32
+#define MAX_FRAME 16
+#define MAX_FRAMES 32
+
+typedef struct {
+    size_t count;
+    size_t len[MAX_FRAMES];
+    uint8_t data[MAX_FRAMES][MAX_FRAME];
+    int wrapped;     // frames that came in two parts
+    uint32_t oversized;
+} result_t;
+
+static int failures;
+
+static void check(int ok, const char *what) {
+    if (!ok) {
+        printf("FAIL %s\n", what);
+        failures++;
+    }
+}
+
+// Feeds `stream` in chunks of `chunk` bytes (as far as the ring has room),
+// starting at byte `start` of the ring, and collects every frame
+static void run(frame_mode_t mode, const uint8_t *stream, size_t len,
+                size_t chunk, size_t start, result_t *res) {
+    uint8_t mem[RING_SIZE];
+    ring_buffer_t ring;
+    frame_reader_t reader;
+    ring_init(&ring, mem, sizeof(mem));
+    uint8_t skip[RING_SIZE] = {0};
+    ring_write(&ring, skip, start);
+    ring_read_commit(&ring, start);
+    frame_reader_init(&reader, &ring, mode, MAX_FRAME);
+    memset(res, 0, sizeof(*res));
+
+    size_t pos = 0;
+    while (pos < len) {
+        size_t n = len - pos < chunk ? len - pos : chunk;
+        n = ring_write(&ring, stream + pos, n);
+        pos += n;
+
+        frame_t frame;
+        while (frame_reader_next(&reader, &frame)) {
+            if (res->count < MAX_FRAMES) {
+                res->len[res->count] =
+                    frame_copy(&frame, res->data[res->count], MAX_FRAME);
+                res->wrapped += frame.len[1] > 0;
+                res->count++;
+            }
+            frame_reader_release(&reader, &frame);
+        }
+        if (n == 0 && ring_free(&ring) == 0) {
+            check(0, "reader stalls with a full ring");
+            break;
+        }
+    }
+    res->oversized = reader.oversized;
+}
+
+static int frame_is(const result_t *res, size_t i, const char *text) {
+    size_t n = strlen(text);
+    return i < res->count && res->len[i] == n &&
+           memcmp(res->data[i], text, n) == 0;
+}
+
+// Runs the stream with every chunk size and start position and compares
+// the frames from index `skip` on (frames before it may still carry the
+// tail of garbage)
+static void expect(const char *name, frame_mode_t mode,
+                   const uint8_t *stream, size_t len,
+                   const char *const *frames, size_t count, size_t skip,
+                   int want_oversized) {
+    char what[96];
+    int wrapped = 0;
+    for (size_t chunk = 1; chunk <= len; chunk++) {
+        for (size_t start = 0; start < RING_SIZE; start++) {
+            result_t res;
+            run(mode, stream, len, chunk, start, &res);
+            wrapped += res.wrapped;
+
+            int n = snprintf(what, sizeof(what), "%s, chunk %zu, start %zu: ",
+                             name, chunk, start);
+            int ok = res.count == skip + count;
+            for (size_t i = 0; ok && i < count; i++) {
+                ok = frame_is(&res, skip + i, frames[i]);
+            }
+            snprintf(what + n, sizeof(what) - n, "frames");
+            check(ok, what);
+            snprintf(what + n, sizeof(what) - n, "oversized");
+            check(want_oversized ? res.oversized > 0 : res.oversized == 0,
+                  what);
+        }
+    }
+    snprintf(what, sizeof(what), "%s: some frame crossed the ring end",
+             name);
+    check(wrapped > 0, what);
+}
+
+static void test_lines(void) {
+    static const char stream[] = "hello\r\nworld\n\nab\rc\n0123456789\n"
+                                 "x\n";
+    static const char *const frames[] = {"hello", "world", "", "ab\rc",
+                                         "0123456789", "x"};
+    expect("line", FRAME_MODE_LINE, (const uint8_t *)stream,
+           sizeof(stream) - 1, frames, 6, 0, 0);
+
+    // 40 bytes without a newline: dropped in pieces of MAX_FRAME + 1, the
+    // remainder sticks to the first line, everything after it is clean
+    static const char garbage[] = "gggggggggggggggggggggggggggggggggggggggg"
+                                  "first\nsecond\nthird\n";
+    static const char *const clean[] = {"second", "third"};
+    expect("line garbage", FRAME_MODE_LINE, (const uint8_t *)garbage,
+           sizeof(garbage) - 1, clean, 2, 1, 1);
+}
+
+static void test_cobs(void) {
+    // Leading zero closes whatever was on the line before
+    static const uint8_t stream[] = {0x00, 0x03, 0x11, 0x22, 0x00, 0x00,
+                                     0x02, 0x33, 0x00, 0x01, 0x01, 0x00};
+    static const char *const frames[] = {"", "\x03\x11\x22", "", "\x02\x33",
+                                         "\x01\x01"};
+    expect("cobs", FRAME_MODE_COBS, stream, sizeof(stream), frames, 5, 0,
+           0);
+
+    // A log line without delimiter, then the next frames
+    static const char noise[] = "I (1234) uart: some log output\n";
+    uint8_t buf[64];
+    size_t n = sizeof(noise) - 1;
+    memcpy(buf, noise, n);
+    static const uint8_t tail[] = {0x00, 0x02, 0x44, 0x00, 0x03, 0x55,
+                                   0x66, 0x00};
+    memcpy(buf + n, tail, sizeof(tail));
+    static const char *const clean[] = {"\x02\x44", "\x03\x55\x66"};
+    expect("cobs garbage", FRAME_MODE_COBS, buf, n + sizeof(tail), clean, 2,
+           1, 1);
+}
+
+static void test_length(void) {
+    static const uint8_t stream[] = {3, 0, 'a', 'b', 'c', 0, 0, 5, 0,
+                                     '1', '2', '3', '4', '5', 1, 0, 'z',
+                                     10, 0, '0', '1', '2', '3', '4', '5',
+                                     '6', '7', '8', '9'};
+    static const char *const frames[] = {"abc", "", "12345", "z",
+                                         "0123456789"};
+    expect("length", FRAME_MODE_LENGTH, stream, sizeof(stream), frames, 5,
+           0, 0);
+
+    // Impossible lengths are skipped one byte at a time
+    static const uint8_t garbage[] = {0xFF, 0xFF, 0xFF, 0x40, 2, 0,
+                                      'o', 'k', 3, 0, 'y', 'e', 's'};
+    static const char *const clean[] = {"ok", "yes"};
+    expect("length garbage", FRAME_MODE_LENGTH, garbage, sizeof(garbage),
+           clean, 2, 0, 1);
+}
+
+int main(void) {
+    test_lines();
+    test_cobs();
+    test_length();
+    printf(failures ? "FAILED\n" : "ok\n");
+    return failures ? 1 : 0;
+}
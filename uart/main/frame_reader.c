@@ -0,0 +1,117 @@
+#include "frame_reader.h"
+
+#include <string.h>
+
+void frame_reader_init(frame_reader_t *reader, ring_buffer_t *ring,
+                       frame_mode_t mode, size_t max_frame) {
+    memset(reader, 0, sizeof(*reader));
+    reader->ring = ring;
+    reader->mode = mode;
+    reader->max_frame = max_frame;
+}
+
+// Byte an Position `pos` ab der aktuellen Leseposition
+static uint8_t peek(const ring_buffer_t *ring, size_t pos) {
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    return ring->buf[(tail + pos) & (ring->size - 1)];
+}
+
+// Baut das Slice [offset, offset + length) ab der Leseposition
+static void make_slice(const ring_buffer_t *ring, size_t offset, size_t length,
+                       size_t consumed, frame_t *frame) {
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t start = (tail + offset) & (ring->size - 1);
+    size_t to_end = ring->size - start;
+
+    frame->part[0] = &ring->buf[start];
+    frame->len[0] = length < to_end ? length : to_end;
+    frame->part[1] = ring->buf;
+    frame->len[1] = length - frame->len[0];
+    frame->length = length;
+    frame->consumed = consumed;
+}
+
+static void drop(frame_reader_t *reader, size_t n) {
+    ring_read_commit(reader->ring, n);
+    reader->scanned = 0;
+    reader->oversized++;
+}
+
+static bool next_delimited(frame_reader_t *reader, frame_t *frame,
+                           uint8_t delimiter, bool strip_cr) {
+    size_t used = ring_used(reader->ring);
+
+    // Nur die neu hinzugekommenen Bytes durchsuchen
+    while (reader->scanned < used) {
+        if (peek(reader->ring, reader->scanned) == delimiter) {
+            size_t length = reader->scanned;
+            if (strip_cr && length > 0 &&
+                peek(reader->ring, length - 1) == '\r') {
+                length--;
+            }
+            make_slice(reader->ring, 0, length, reader->scanned + 1, frame);
+            return true;
+        }
+        reader->scanned++;
+        if (reader->scanned > reader->max_frame) {
+            drop(reader, reader->scanned);
+            used = ring_used(reader->ring);
+        }
+    }
+    return false;
+}
+
+static bool next_length(frame_reader_t *reader, frame_t *frame) {
+    size_t used, length;
+    while (1) {
+        used = ring_used(reader->ring);
+        if (used < 2) {
+            return false;
+        }
+        length = peek(reader->ring, 0) | (peek(reader->ring, 1) << 8);
+        if (length <= reader->max_frame) {
+            break;
+        }
+        // Längenfeld ist offensichtlich kaputt, ein Byte weiter aufsetzen.
+        // Nicht abbrechen: dahinter liegen womöglich schon gültige Frames.
+        drop(reader, 1);
+    }
+    if (used < 2 + length) {
+        return false;
+    }
+    make_slice(reader->ring, 2, length, 2 + length, frame);
+    return true;
+}
+
+bool frame_reader_next(frame_reader_t *reader, frame_t *frame) {
+    bool found;
+    switch (reader->mode) {
+    case FRAME_MODE_LINE:
+        found = next_delimited(reader, frame, '\n', true);
+        break;
+    case FRAME_MODE_COBS:
+        found = next_delimited(reader, frame, 0x00, false);
+        break;
+    default:
+        found = next_length(reader, frame);
+        break;
+    }
+    if (found) {
+        reader->frames++;
+    }
+    return found;
+}
+
+void frame_reader_release(frame_reader_t *reader, const frame_t *frame) {
+    ring_read_commit(reader->ring, frame->consumed);
+    reader->scanned = 0;
+}
+
+size_t frame_copy(const frame_t *frame, void *dst, size_t dst_len) {
+    uint8_t *out = dst;
+    size_t n0 = frame->len[0] < dst_len ? frame->len[0] : dst_len;
+    size_t n1 = frame->len[1] < dst_len - n0 ? frame->len[1] : dst_len - n0;
+    memcpy(out, frame->part[0], n0);
+    memcpy(out + n0, frame->part[1], n1);
+    return n0 + n1;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "ring_buffer.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+Zerlegt den Byte-Strom im RX-Ring in Frames, ohne zu kopieren.
+
+Ein Frame ist ein Slice in den Ring: liegt er über dem Pufferende, besteht er
+aus zwei Teilen. Der Frame bleibt gültig, bis er mit frame_reader_release
+freigegeben wird; erst dann darf der Schreiber (ISR) den Platz wiederverwenden.
+
+FRAME_MODE_LINE:   Frames enden mit '\n', ein '\r' davor wird abgeschnitten.
+FRAME_MODE_LENGTH: Jeder Frame beginnt mit einer 16-bit Länge (Little Endian).
+FRAME_MODE_COBS:   Frames enden mit 0x00 (COBS-kodierte Daten enthalten keine
+                   Null). Leere Frames werden ebenfalls geliefert.
+*/
+
+typedef enum {
+    FRAME_MODE_LINE,
+    FRAME_MODE_LENGTH,
+    FRAME_MODE_COBS,
+} frame_mode_t;
+
+typedef struct {
+    const uint8_t *part[2];
+    size_t len[2];
+    size_t length;   // Nutzdaten insgesamt (len[0] + len[1])
+    size_t consumed; // Bytes im Ring inkl. Trenner bzw. Längenfeld
+} frame_t;
+
+typedef struct {
+    ring_buffer_t *ring;
+    frame_mode_t mode;
+    size_t max_frame; // längere Frames werden verworfen
+    size_t scanned;   // bereits nach dem Trenner durchsuchte Bytes
+
+    uint32_t frames;    // ausgelieferte Frames
+    uint32_t oversized; // verworfene, zu lange Frames
+} frame_reader_t;
+
+void frame_reader_init(frame_reader_t *reader, ring_buffer_t *ring,
+                       frame_mode_t mode, size_t max_frame);
+
+// Liefert den nächsten vollständigen Frame, false wenn noch keiner da ist
+bool frame_reader_next(frame_reader_t *reader, frame_t *frame);
+
+// Gibt den Frame im Ring frei
+void frame_reader_release(frame_reader_t *reader, const frame_t *frame);
+
+// Kopiert einen Frame in einen zusammenhängenden Puffer (nur falls nötig)
+size_t frame_copy(const frame_t *frame, void *dst, size_t dst_len);
@@ -1,60 +1,369 @@
 #include "driver/gpio.h"
 #include "driver/uart.h"
-#include "esp_log.h"
+#include "esp_cpu.h"
 #include "esp_intr_alloc.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "evtrace.h"
+#include "frame_reader.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "hal/uart_ll.h"
-#include "soc/uart_struct.h"
+#include "metrics.h"
+#include "ring_buffer.h"
+#include "sms_server.h"
 #include "soc/uart_periph.h"
-#include "string.h"
+#include "soc/uart_struct.h"
+#include <stdio.h>
+#include <string.h>
 
 /*
 This program lets the LED on the ESP32-S3 blink when a message via UART is received.
+
+Commands and telemetry use the binary SMS protocol (components/sms_proto):
+COBS-framed messages with CRC16 and request IDs. The host can switch the LED,
+query link statistics and subscribe to topics with a minimum interval.
+
+The protocol runs on UART1 (TX GPIO 17, RX GPIO 14, same wiring as the link
+in sensor_hub). UART0 stays the console: ESP_LOG/printf output from any task
+or from the bootloader never ends up between the bytes of a COBS frame.
+
+The ISR only drains the RX FIFO into a lock-free SPSC ring and notifies a
+handler task pinned to the same core. All application logic (command parsing,
+LED, replies) runs in that task, so the ISR stays short and bounded.
+
+Received bytes are moved from the RX FIFO into a large ring buffer in bulk.
+A consumer task splits the stream at the 0x00 delimiters into frames that
+point directly into the ring; only complete frames are copied for decoding.
+
+Outgoing data goes into a software TX ring. As much as fits is written to the
+TX FIFO at once, the rest is refilled from the TXFIFO_EMPTY interrupt, so no
+code ever waits for the FIFO to drain.
 */
 
-#define UART_PORT UART_NUM_0
+#define UART_PORT UART_NUM_1
+#define UART_TX_GPIO 17
+#define UART_RX_GPIO 14
 #define LED_GPIO GPIO_NUM_2
 
+// Up to 3 Mbaud work with the thresholds below; 115200 matches the sms_bench
+// call in the README.
+#define UART_BAUD_RATE 115200
+
+#define RX_RING_SIZE (16 * 1024) // power of two
+#define RX_FIFO_FULL_THRESHOLD 96 // of SOC_UART_FIFO_LEN (128)
+#define RX_TIMEOUT_BITS 20        // flush partial FIFO after ~2 idle bytes
+#define MAX_FRAME_LEN SMS_MAX_FRAME
+
+#define TX_RING_SIZE 4096 // power of two
+#define TX_FIFO_EMPTY_THRESHOLD 32 // refill when fewer bytes are left
+
+// The handler task runs on the core that allocates the interrupt (app_main's
+// core), so both use the same cycle counter for latency measurements.
+#define HANDLER_CORE 0
+#define HANDLER_PRIO (configMAX_PRIORITIES - 3)
+
+// Subscriptions are checked at least this often, independent of RX traffic.
+#define PUBLISH_POLL_MS 10
+
+#define METRICS_LOG_EVERY 10 // print all metrics with every 10th report
+
+// CONFIG_EVTRACE_ENABLE (menuconfig) streams ISR and task events
+// (components/evtrace) to a third UART, e.g. a USB-UART adapter at
+// TRACE_TX_GPIO, to see ISR duration and jitter in Perfetto. UART_PORT itself
+// carries the protocol, UART0 the console.
+#define TRACE_UART UART_NUM_2
+#define TRACE_TX_GPIO 16
+#define TRACE_BAUD 921600
+
+// Argument of SMS_CMD_LED
+#define LED_OFF 0
+#define LED_ON 1
+#define LED_TOGGLE 2
+
 static const char *TAG = "uart_interrupt";
-static const char *RESPONSE = "LED toggled!\r\n";
 
-// UART RX interrupt handler
-static void IRAM_ATTR uart_rx_isr(void *arg) {
-    uint8_t dummy;
+static uint8_t rx_ring_mem[RX_RING_SIZE];
+static ring_buffer_t rx_ring;
+static frame_reader_t frames;
+
+static uint8_t tx_ring_mem[TX_RING_SIZE];
+static ring_buffer_t tx_ring;
+// Serializes TX FIFO access between the ISR and tasks calling uart_tx_write.
+static portMUX_TYPE tx_lock = portMUX_INITIALIZER_UNLOCKED;
+static volatile uint32_t tx_dropped = 0; // TX ring full
+
+// ISR duration in CPU cycles (components/metrics)
+static metric_t *isr_cycles;
+
+// Latency from the ISR's notification until the handler task runs
+static TaskHandle_t handler_task;
+static volatile uint32_t notify_cycles = 0; // 0 = nothing pending
+static metric_t *wakeup_cycles;
+
+static sms_server_t server;
+static bool led = false;
+
+// RX statistics, written by the ISR only
+static volatile uint32_t rx_bytes = 0;
+static volatile uint32_t rx_dropped = 0;      // ring full, bytes discarded
+static volatile uint32_t rx_fifo_overflows = 0; // hardware FIFO overflowed
+
+// Moves as much as fits from the TX ring into the TX FIFO. Keeps the
+// TXFIFO_EMPTY interrupt enabled while data is left. Call with tx_lock held.
+static void IRAM_ATTR uart_tx_fill(uart_dev_t *hw) {
+    uint32_t space = uart_ll_get_txfifo_len(hw);
+    while (space > 0) {
+        size_t contiguous;
+        const uint8_t *src = ring_read_ptr(&tx_ring, &contiguous);
+        if (contiguous == 0) {
+            break;
+        }
+        uint32_t n = space < contiguous ? space : contiguous;
+        uart_ll_write_txfifo(hw, src, n);
+        ring_read_commit(&tx_ring, n);
+        space -= n;
+    }
+
+    uart_ll_clr_intsts_mask(hw, UART_INTR_TXFIFO_EMPTY);
+    if (ring_used(&tx_ring) > 0) {
+        uart_ll_ena_intr_mask(hw, UART_INTR_TXFIFO_EMPTY);
+    } else {
+        uart_ll_disable_intr_mask(hw, UART_INTR_TXFIFO_EMPTY);
+    }
+}
+
+// Queues data for transmission and returns immediately. Safe to call from
+// tasks and from the ISR. Returns the number of bytes queued.
+static size_t IRAM_ATTR uart_tx_write(const void *data, size_t len) {
     uart_dev_t *hw = UART_LL_GET_HW(UART_PORT);
+    bool in_isr = xPortInIsrContext();
 
-    // Read all bytes from RX FIFO to clear the interrupt.
-    while (uart_ll_get_rxfifo_len(hw)) {
-        uart_ll_read_rxfifo(hw, &dummy, 1);
+    if (in_isr) {
+        portENTER_CRITICAL_ISR(&tx_lock);
+    } else {
+        portENTER_CRITICAL(&tx_lock);
+    }
+    size_t queued = ring_write(&tx_ring, data, len);
+    uart_tx_fill(hw);
+    if (in_isr) {
+        portEXIT_CRITICAL_ISR(&tx_lock);
+    } else {
+        portEXIT_CRITICAL(&tx_lock);
     }
 
-    // Clear RX FIFO full and timeout interrupt flags.
-    uart_ll_clr_intsts_mask(hw, UART_INTR_RXFIFO_FULL | UART_INTR_RXFIFO_TOUT);
+    if (queued < len) {
+        tx_dropped += len - queued;
+    }
+    return queued;
+}
 
-    // Toggle LED.
-    int current = gpio_get_level(LED_GPIO);
-    gpio_set_level(LED_GPIO, !current);
+// UART RX part of the interrupt handler
+static void IRAM_ATTR uart_rx_isr(uart_dev_t *hw, uint32_t status) {
+    EVTRACE_ISR_ENTER("uart_rx_isr");
+    if (status & UART_INTR_RXFIFO_OVF) {
+        rx_fifo_overflows++;
+    }
 
-    // Send a response message back over UART.
-    for (int i = 0; i < strlen(RESPONSE); i++) {
-        // Wait until there is space in the TX FIFO.
-        while (hw->status.txfifo_cnt >= SOC_UART_FIFO_LEN) {
-            ;
+    // Read the whole RX FIFO directly into the ring (at most two chunks
+    // because of the wrap-around).
+    uint32_t avail = uart_ll_get_rxfifo_len(hw);
+    while (avail > 0) {
+        size_t contiguous;
+        uint8_t *dst = ring_write_ptr(&rx_ring, &contiguous);
+        if (contiguous == 0) {
+            // Consumer is too slow: drop the rest of the FIFO.
+            rx_dropped += avail;
+            uart_ll_rxfifo_rst(hw);
+            break;
         }
-        uart_ll_write_txfifo(hw, (const uint8_t *)&RESPONSE[i], 1);
+        uint32_t n = avail < contiguous ? avail : contiguous;
+        uart_ll_read_rxfifo(hw, dst, n);
+        ring_write_commit(&rx_ring, n);
+        rx_bytes += n;
+        avail -= n;
     }
+
+    // Clear RX FIFO full, timeout and overflow interrupt flags.
+    uart_ll_clr_intsts_mask(hw, UART_INTR_RXFIFO_FULL | UART_INTR_RXFIFO_TOUT |
+                                    UART_INTR_RXFIFO_OVF);
+    EVTRACE_ISR_EXIT("uart_rx_isr");
 }
 
+// UART interrupt handler
+static void IRAM_ATTR uart_isr(void *arg) {
+    EVTRACE_ISR_ENTER("uart_isr");
+    uint32_t start = esp_cpu_get_cycle_count();
+    uart_dev_t *hw = UART_LL_GET_HW(UART_PORT);
+    uint32_t status = uart_ll_get_intsts_mask(hw);
+
+    BaseType_t woken = pdFALSE;
+
+    if (status & (UART_INTR_RXFIFO_FULL | UART_INTR_RXFIFO_TOUT |
+                  UART_INTR_RXFIFO_OVF)) {
+        uart_rx_isr(hw, status);
+        // Everything else happens in the handler task.
+        if (notify_cycles == 0) {
+            notify_cycles = esp_cpu_get_cycle_count() | 1;
+        }
+        vTaskNotifyGiveFromISR(handler_task, &woken);
+    }
+    if (status & UART_INTR_TXFIFO_EMPTY) {
+        portENTER_CRITICAL_ISR(&tx_lock);
+        uart_tx_fill(hw);
+        portEXIT_CRITICAL_ISR(&tx_lock);
+    }
+
+    metrics_record(isr_cycles, esp_cpu_get_cycle_count() - start);
+    EVTRACE_ISR_EXIT("uart_isr");
+
+    portYIELD_FROM_ISR(woken);
+}
+
+// Writes a whole frame to the TX ring or nothing at all. A truncated frame
+// would corrupt the next one on the host side.
+static size_t proto_send(const void *data, size_t len, void *ctx) {
+    if (ring_free(&tx_ring) < len) {
+        tx_dropped += len;
+        return 0;
+    }
+    return uart_tx_write(data, len);
+}
+
+// Application commands; PING, STATS and subscriptions are handled by the
+// server itself.
+static uint8_t proto_command(uint8_t cmd, const uint8_t *arg, size_t arg_len,
+                             uint8_t *reply, size_t *reply_len, void *ctx) {
+    if (cmd != SMS_CMD_LED) {
+        return SMS_ERR_UNKNOWN_CMD;
+    }
+    if (arg_len != 1 || arg[0] > LED_TOGGLE) {
+        return SMS_ERR_BAD_ARG;
+    }
+    led = arg[0] == LED_TOGGLE ? !led : arg[0] == LED_ON;
+    gpio_set_level(LED_GPIO, led);
+    reply[0] = led;
+    *reply_len = 1;
+    return SMS_OK;
+}
+
+// Decodes one received frame. The frame is copied out of the ring because
+// COBS is decoded in place.
+static void handle_frame(const frame_t *frame) {
+    EVTRACE_BEGIN("handle_frame");
+    uint8_t buf[SMS_MAX_FRAME];
+    size_t n = frame_copy(frame, buf, sizeof(buf));
+    sms_server_handle_frame(&server, buf, n);
+    EVTRACE_END("handle_frame");
+}
+
+// Handler task: woken by the ISR, consumes complete frames from the ring and
+// reports throughput once per second.
+static void handler_task_fn(void *arg) {
+    int64_t last_report = esp_timer_get_time();
+    uint32_t last_bytes = 0;
+    uint32_t reports = 0;
+    frame_t frame;
+
+    while (1) {
+        if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(PUBLISH_POLL_MS)) > 0) {
+            uint32_t stamp = notify_cycles;
+            notify_cycles = 0;
+            if (stamp) {
+                metrics_record(wakeup_cycles,
+                               esp_cpu_get_cycle_count() - stamp);
+            }
+        }
+
+        while (frame_reader_next(&frames, &frame)) {
+            handle_frame(&frame);
+            frame_reader_release(&frames, &frame);
+        }
+
+        int64_t now = esp_timer_get_time();
+        if (sms_server_due(&server, SMS_TOPIC_LINK_STATS, now)) {
+            uint8_t payload[SMS_LINK_STATS_LEN];
+            sms_put_link_stats(payload, &server.stats);
+            sms_server_publish(&server, SMS_TOPIC_LINK_STATS, payload,
+                               sizeof(payload), now);
+        }
+
+        if (now - last_report >= 1000000) {
+            uint32_t bytes = rx_bytes;
+            ESP_LOGI(TAG,
+                     "rx %lu B/s, frames=%lu oversized=%lu dropped=%lu "
+                     "fifo_ovf=%lu ring=%u",
+                     (unsigned long)((bytes - last_bytes) * 1000000ull /
+                                     (now - last_report)),
+                     (unsigned long)frames.frames,
+                     (unsigned long)frames.oversized,
+                     (unsigned long)rx_dropped,
+                     (unsigned long)rx_fifo_overflows,
+                     (unsigned)ring_used(&rx_ring));
+            metrics_value_t isr;
+            metrics_snapshot(isr_cycles, &isr);
+            ESP_LOGI(TAG, "isr count=%lu avg=%lu max=%lu cycles, tx_dropped=%lu",
+                     (unsigned long)isr.count,
+                     (unsigned long)(isr.count ? isr.sum / isr.count : 0),
+                     (unsigned long)isr.max, (unsigned long)tx_dropped);
+            ESP_LOGI(TAG, "proto rx=%lu rx_err=%lu tx=%lu tx_drop=%lu "
+                     "rate_limited=%lu",
+                     (unsigned long)server.stats.rx_frames,
+                     (unsigned long)server.stats.rx_errors,
+                     (unsigned long)server.stats.tx_frames,
+                     (unsigned long)server.stats.tx_dropped,
+                     (unsigned long)server.stats.rate_limited);
+            if (++reports % METRICS_LOG_EVERY == 0) {
+                metrics_print(stdout);
+            }
+            last_bytes = bytes;
+            last_report = now;
+        }
+    }
+}
+
+#if CONFIG_EVTRACE_ENABLE
+static void start_trace(void) {
+    uart_config_t config = {
+        .baud_rate = TRACE_BAUD,
+        .data_bits = UART_DATA_8_BITS,
+        .parity    = UART_PARITY_DISABLE,
+        .stop_bits = UART_STOP_BITS_1,
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+        .source_clk = UART_SCLK_DEFAULT,
+    };
+    ESP_ERROR_CHECK(uart_driver_install(TRACE_UART, 256, 8192, 0, NULL, 0));
+    ESP_ERROR_CHECK(uart_param_config(TRACE_UART, &config));
+    ESP_ERROR_CHECK(uart_set_pin(TRACE_UART, TRACE_TX_GPIO, UART_PIN_NO_CHANGE,
+                                 UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE));
+    ESP_ERROR_CHECK(evtrace_start(TRACE_UART));
+}
+#endif
+
 void app_main() {
     uart_dev_t *hw = UART_LL_GET_HW(UART_PORT);
 
+#if CONFIG_EVTRACE_ENABLE
+    start_trace();
+#endif
+
     // Initialize LED GPIO.
     gpio_reset_pin(LED_GPIO);
     gpio_set_direction(LED_GPIO, GPIO_MODE_OUTPUT);
     gpio_set_level(LED_GPIO, 0);
 
-    // Configure UART.
+    isr_cycles = metrics_histogram("uart.isr_cycles", "cyc");
+    wakeup_cycles = metrics_histogram("uart.wakeup_cycles", "cyc");
+
+    ring_init(&rx_ring, rx_ring_mem, RX_RING_SIZE);
+    frame_reader_init(&frames, &rx_ring, FRAME_MODE_COBS, MAX_FRAME_LEN);
+    ring_init(&tx_ring, tx_ring_mem, TX_RING_SIZE);
+    sms_server_init(&server, proto_send, proto_command, NULL);
+
+    // Configure UART. The UART driver is not installed: its own ISR would
+    // compete with ours for the RX FIFO.
     uart_config_t uart_config = {
-        .baud_rate = 115200,
+        .baud_rate = UART_BAUD_RATE,
         .data_bits = UART_DATA_8_BITS,
         .parity    = UART_PARITY_DISABLE,
         .stop_bits = UART_STOP_BITS_1,
@@ -62,18 +371,32 @@ void app_main() {
         .source_clk = UART_SCLK_APB,
     };
     uart_param_config(UART_PORT, &uart_config);
-    uart_driver_install(UART_PORT, 1024, 0, 0, NULL, 0);
+    ESP_ERROR_CHECK(uart_set_pin(UART_PORT, UART_TX_GPIO, UART_RX_GPIO,
+                                 UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE));
 
     // Disable and clear all UART interrupts using driver functions.
     uart_disable_intr_mask(UART_PORT, UART_LL_INTR_MASK);
     uart_clear_intr_status(UART_PORT, UART_LL_INTR_MASK);
 
-    // Clear any pending RX interrupts and enable RX FIFO full and timeout interrupts.
-    uart_ll_clr_intsts_mask(hw, UART_INTR_RXFIFO_FULL | UART_INTR_RXFIFO_TOUT);
-    uart_ll_ena_intr_mask(hw, UART_INTR_RXFIFO_FULL | UART_INTR_RXFIFO_TOUT);
+    // Interrupt when the FIFO is 3/4 full or the line went idle, so the ISR
+    // always moves a large block at once.
+    uart_ll_set_rxfifo_full_thr(hw, RX_FIFO_FULL_THRESHOLD);
+    uart_ll_set_rx_tout(hw, RX_TIMEOUT_BITS);
+    uart_ll_set_txfifo_empty_thr(hw, TX_FIFO_EMPTY_THRESHOLD);
+
+    // Clear any pending RX interrupts and enable RX FIFO full, timeout and overflow interrupts.
+    uint32_t rx_mask = UART_INTR_RXFIFO_FULL | UART_INTR_RXFIFO_TOUT | UART_INTR_RXFIFO_OVF;
+    uart_ll_clr_intsts_mask(hw, rx_mask);
+    uart_ll_ena_intr_mask(hw, rx_mask);
 
     // Register our ISR using esp_intr_alloc with the UART peripheral's IRQ.
-    esp_intr_alloc(uart_periph_signal[UART_PORT].irq, ESP_INTR_FLAG_IRAM, uart_rx_isr, NULL, NULL);
+    // The handler must exist before the first interrupt can notify it.
+    xTaskCreatePinnedToCore(handler_task_fn, "uart_handler", 4096, NULL,
+                            HANDLER_PRIO, &handler_task, HANDLER_CORE);
+
+    // TXFIFO_EMPTY is only enabled while the TX ring holds data.
+    esp_intr_alloc(uart_periph_signal[UART_PORT].irq, ESP_INTR_FLAG_IRAM, uart_isr, NULL, NULL);
+
 
-    ESP_LOGI(TAG, "UART interrupt initialized. Send data to toggle LED.");
+    ESP_LOGI(TAG, "UART interrupt initialized. Waiting for protocol frames.");
 }
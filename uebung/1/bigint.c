@@ -0,0 +1,285 @@
+#include "bigint.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+void bigint_init(bigint_t *a) {
+    a->limb = NULL;
+    a->len = 0;
+    a->cap = 0;
+}
+
+void bigint_free(bigint_t *a) {
+    free(a->limb);
+    bigint_init(a);
+}
+
+static int reserve(bigint_t *a, size_t cap) {
+    if (cap <= a->cap) {
+        return 0;
+    }
+    uint32_t *limb = realloc(a->limb, cap * sizeof(uint32_t));
+    if (!limb) {
+        return -1;
+    }
+    a->limb = limb;
+    a->cap = cap;
+    return 0;
+}
+
+// Länge ohne führende Null-Limbs
+static size_t trim(const uint32_t *a, size_t n) {
+    while (n > 0 && a[n - 1] == 0) {
+        n--;
+    }
+    return n;
+}
+
+int bigint_set_u32(bigint_t *a, uint32_t value) {
+    return bigint_set_u64(a, value);
+}
+
+int bigint_set_u64(bigint_t *a, uint64_t value) {
+    if (reserve(a, 2) < 0) {
+        return -1;
+    }
+    a->limb[0] = (uint32_t)value;
+    a->limb[1] = (uint32_t)(value >> 32);
+    a->len = trim(a->limb, 2);
+    return 0;
+}
+
+int bigint_copy(bigint_t *dst, const bigint_t *src) {
+    if (dst == src) {
+        return 0;
+    }
+    if (reserve(dst, src->len) < 0) {
+        return -1;
+    }
+    if (src->len) {
+        memcpy(dst->limb, src->limb, src->len * sizeof(uint32_t));
+    }
+    dst->len = src->len;
+    return 0;
+}
+
+int bigint_mul_u32(bigint_t *a, uint32_t factor) {
+    if (factor == 0) {
+        a->len = 0;
+        return 0;
+    }
+    uint64_t carry = 0;
+    for (size_t i = 0; i < a->len; i++) {
+        uint64_t t = (uint64_t)a->limb[i] * factor + carry;
+        a->limb[i] = (uint32_t)t;
+        carry = t >> 32;
+    }
+    if (carry) {
+        if (reserve(a, a->len + 1) < 0) {
+            return -1;
+        }
+        a->limb[a->len++] = (uint32_t)carry;
+    }
+    return 0;
+}
+
+// Rechnen auf rohen Limb-Arrays
+
+// r[0..rn) += a[0..an), rn >= an. Gibt den Übertrag aus dem obersten Limb
+// zurück.
+static uint32_t add_to(uint32_t *r, size_t rn, const uint32_t *a, size_t an) {
+    uint64_t carry = 0;
+    size_t i = 0;
+    for (; i < an; i++) {
+        uint64_t t = (uint64_t)r[i] + a[i] + carry;
+        r[i] = (uint32_t)t;
+        carry = t >> 32;
+    }
+    for (; carry && i < rn; i++) {
+        uint64_t t = (uint64_t)r[i] + carry;
+        r[i] = (uint32_t)t;
+        carry = t >> 32;
+    }
+    return (uint32_t)carry;
+}
+
+// r[0..rn) -= a[0..an), rn >= an und r >= a
+static void sub_from(uint32_t *r, size_t rn, const uint32_t *a, size_t an) {
+    uint32_t borrow = 0;
+    size_t i = 0;
+    for (; i < an; i++) {
+        uint64_t t = (uint64_t)r[i] - a[i] - borrow;
+        r[i] = (uint32_t)t;
+        borrow = (t >> 32) ? 1 : 0;
+    }
+    for (; borrow && i < rn; i++) {
+        borrow = r[i] == 0;
+        r[i]--;
+    }
+}
+
+// r = a + b mit Platz für max(an, bn) + 1 Limbs, gibt die Länge zurück
+static size_t add_into(uint32_t *r, const uint32_t *a, size_t an,
+                       const uint32_t *b, size_t bn) {
+    if (an < bn) {
+        const uint32_t *t = a;
+        a = b;
+        b = t;
+        size_t tn = an;
+        an = bn;
+        bn = tn;
+    }
+    memcpy(r, a, an * sizeof(uint32_t));
+    r[an] = add_to(r, an, b, bn);
+    return an + 1;
+}
+
+static void mul_school(uint32_t *r, const uint32_t *a, size_t an,
+                       const uint32_t *b, size_t bn) {
+    memset(r, 0, (an + bn) * sizeof(uint32_t));
+    for (size_t j = 0; j < bn; j++) {
+        uint64_t carry = 0;
+        uint64_t bj = b[j];
+        if (bj == 0) {
+            continue;
+        }
+        for (size_t i = 0; i < an; i++) {
+            uint64_t t = a[i] * bj + r[i + j] + carry;
+            r[i + j] = (uint32_t)t;
+            carry = t >> 32;
+        }
+        r[an + j] = (uint32_t)carry;
+    }
+}
+
+// r[0..an+bn) = a * b; r darf sich mit a und b nicht überlappen
+static int mul_limbs(uint32_t *r, const uint32_t *a, size_t an,
+                     const uint32_t *b, size_t bn) {
+    if (an < bn) {
+        const uint32_t *t = a;
+        a = b;
+        b = t;
+        size_t tn = an;
+        an = bn;
+        bn = tn;
+    }
+    if (bn < BIGINT_KARATSUBA_THRESHOLD) {
+        mul_school(r, a, an, b, bn);
+        return 0;
+    }
+
+    if (2 * bn <= an) {
+        // Sehr ungleiche Längen: a in Stücke der Länge bn zerlegen, jedes
+        // Stück ist wieder ein ausgewogenes Produkt
+        uint32_t *t = malloc(2 * bn * sizeof(uint32_t));
+        if (!t) {
+            return -1;
+        }
+        memset(r, 0, (an + bn) * sizeof(uint32_t));
+        for (size_t off = 0; off < an; off += bn) {
+            size_t n = an - off < bn ? an - off : bn;
+            if (mul_limbs(t, a + off, n, b, bn) < 0) {
+                free(t);
+                return -1;
+            }
+            add_to(r + off, an + bn - off, t, n + bn);
+        }
+        free(t);
+        return 0;
+    }
+
+    // Karatsuba mit a = a1*B^m + a0, b = b1*B^m + b0:
+    // a*b = z2*B^2m + (z1 - z2 - z0)*B^m + z0 mit z1 = (a0+a1)(b0+b1).
+    // Wegen an/2 < bn <= an sind a1 und b1 nicht leer.
+    size_t m = an / 2;
+    const uint32_t *a0 = a, *a1 = a + m, *b0 = b, *b1 = b + m;
+    size_t a0n = trim(a0, m), a1n = an - m;
+    size_t b0n = trim(b0, m), b1n = bn - m;
+
+    size_t san = (a1n > m ? a1n : m) + 1;
+    size_t sbn = (b1n > m ? b1n : m) + 1;
+    uint32_t *sa = malloc((san + sbn + san + sbn) * sizeof(uint32_t));
+    if (!sa) {
+        return -1;
+    }
+    uint32_t *sb = sa + san;
+    uint32_t *z1 = sb + sbn;
+
+    memset(r, 0, (an + bn) * sizeof(uint32_t));
+    if (mul_limbs(r, a0, a0n, b0, b0n) < 0 ||
+        mul_limbs(r + 2 * m, a1, a1n, b1, b1n) < 0) {
+        free(sa);
+        return -1;
+    }
+    san = add_into(sa, a0, a0n, a1, a1n);
+    sbn = add_into(sb, b0, b0n, b1, b1n);
+    san = trim(sa, san);
+    sbn = trim(sb, sbn);
+    if (mul_limbs(z1, sa, san, sb, sbn) < 0) {
+        free(sa);
+        return -1;
+    }
+    size_t z1n = san + sbn;
+    sub_from(z1, z1n, r, a0n + b0n);
+    sub_from(z1, z1n, r + 2 * m, a1n + b1n);
+    add_to(r + m, an + bn - m, z1, trim(z1, z1n));
+    free(sa);
+    return 0;
+}
+
+int bigint_mul(bigint_t *r, const bigint_t *a, const bigint_t *b) {
+    if (a->len == 0 || b->len == 0) {
+        r->len = 0;
+        return 0;
+    }
+    size_t n = a->len + b->len;
+    uint32_t *limb = malloc(n * sizeof(uint32_t));
+    if (!limb || mul_limbs(limb, a->limb, a->len, b->limb, b->len) < 0) {
+        free(limb);
+        return -1;
+    }
+    // Ergebnis erst am Ende übernehmen, r darf a oder b sein
+    free(r->limb);
+    r->limb = limb;
+    r->cap = n;
+    r->len = trim(limb, n);
+    return 0;
+}
+
+int bigint_cmp(const bigint_t *a, const bigint_t *b) {
+    if (a->len != b->len) {
+        return a->len < b->len ? -1 : 1;
+    }
+    for (size_t i = a->len; i-- > 0;) {
+        if (a->limb[i] != b->limb[i]) {
+            return a->limb[i] < b->limb[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+size_t bigint_bits(const bigint_t *a) {
+    if (a->len == 0) {
+        return 0;
+    }
+    size_t bits = (a->len - 1) * 32;
+    for (uint32_t top = a->limb[a->len - 1]; top; top >>= 1) {
+        bits++;
+    }
+    return bits;
+}
+
+int bigint_write_hex(const bigint_t *a, FILE *out) {
+    if (a->len == 0) {
+        return fputs("0", out) < 0 ? -1 : 0;
+    }
+    if (fprintf(out, "%x", a->limb[a->len - 1]) < 0) {
+        return -1;
+    }
+    for (size_t i = a->len - 1; i-- > 0;) {
+        if (fprintf(out, "%08x", a->limb[i]) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,42 @@
+#ifndef BIGINT_H
+#define BIGINT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Vorzeichenlose Ganzzahl beliebiger Größe. Die Limbs liegen little-endian
+// (limb[0] ist das niederwertigste Wort), len zählt nur belegte Limbs, die
+// Null hat len == 0.
+typedef struct {
+    uint32_t *limb;
+    size_t len;
+    size_t cap;
+} bigint_t;
+
+// Ab dieser Länge (in Limbs, beide Faktoren) multipliziert bigint_mul mit
+// Karatsuba statt Schulmethode
+#define BIGINT_KARATSUBA_THRESHOLD 32
+
+void bigint_init(bigint_t *a);
+void bigint_free(bigint_t *a);
+
+// Alle Funktionen mit Rückgabewert int liefern -1, wenn kein Speicher mehr
+// frei ist; das Ziel ist dann unverändert oder null.
+int bigint_set_u32(bigint_t *a, uint32_t value);
+int bigint_set_u64(bigint_t *a, uint64_t value);
+int bigint_copy(bigint_t *dst, const bigint_t *src);
+
+// a *= factor
+int bigint_mul_u32(bigint_t *a, uint32_t factor);
+
+// r = a * b; r darf a oder b sein
+int bigint_mul(bigint_t *r, const bigint_t *a, const bigint_t *b);
+
+int bigint_cmp(const bigint_t *a, const bigint_t *b);
+size_t bigint_bits(const bigint_t *a);
+
+// Schreibt die Zahl hexadezimal ohne Präfix, -1 bei Schreibfehlern
+int bigint_write_hex(const bigint_t *a, FILE *out);
+
+#endif
@@ -0,0 +1,208 @@
+#include "faculty_big.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 20! ist die größte Fakultät, die in 64 Bit passt
+#define SMALL_MAX 20
+
+// Liegt ein m! mit n - m <= NEIGHBOUR_MAX im Cache, wird n! daraus durch
+// Multiplizieren mit m+1, ..., n gebildet statt neu berechnet
+#define NEIGHBOUR_MAX 256
+
+typedef struct {
+    bool used;
+    uint32_t n;
+    bigint_t value;
+} cache_entry_t;
+
+static cache_entry_t cache[FACULTY_CACHE_SLOTS];
+static faculty_cache_stats_t stats;
+
+// Sieb des Eratosthenes, wächst bei Bedarf mit dem größten n
+static uint8_t *composite;
+static uint32_t sieve_max;
+
+static uint64_t small_faculty(uint32_t n) {
+    uint64_t f = 1;
+    for (uint32_t i = 2; i <= n; i++) {
+        f *= i;
+    }
+    return f;
+}
+
+static int sieve(uint32_t n) {
+    if (n <= sieve_max && composite) {
+        return 0;
+    }
+    uint8_t *c = realloc(composite, (size_t)n + 1);
+    if (!c) {
+        return -1;
+    }
+    composite = c;
+    memset(composite, 0, (size_t)n + 1);
+    for (uint64_t i = 2; i * i <= n; i++) {
+        if (!composite[i]) {
+            for (uint64_t j = i * i; j <= n; j += i) {
+                composite[j] = 1;
+            }
+        }
+    }
+    sieve_max = n;
+    return 0;
+}
+
+// Produkt factors[lo..hi) als balancierter Baum
+static int product(bigint_t *r, const uint32_t *factors, size_t lo, size_t hi) {
+    if (hi - lo == 1) {
+        return bigint_set_u32(r, factors[lo]);
+    }
+    if (hi - lo == 2) {
+        return bigint_set_u64(r, (uint64_t)factors[lo] * factors[lo + 1]);
+    }
+    size_t mid = lo + (hi - lo) / 2;
+    bigint_t right;
+    bigint_init(&right);
+    int err = product(r, factors, lo, mid) < 0 ||
+              product(&right, factors, mid, hi) < 0 ||
+              bigint_mul(r, r, &right) < 0;
+    bigint_free(&right);
+    return err ? -1 : 0;
+}
+
+// swing(n) = n! / ((n/2)!)^2 als Produkt von Primzahlpotenzen
+static int swing(bigint_t *r, uint32_t n) {
+    // Je Primzahl höchstens ein Faktor, solange er in 32 Bit passt; kleine
+    // Faktoren werden zusammengefasst, das spart Blätter im Produktbaum.
+    uint32_t *factors = malloc(((size_t)n / 2 + 2) * sizeof(uint32_t));
+    if (!factors) {
+        return -1;
+    }
+    size_t count = 0;
+    uint64_t acc = 1;
+
+    for (uint32_t p = 2; p <= n; p++) {
+        if (composite[p]) {
+            continue;
+        }
+        // Exponent von p in swing(n): Anzahl der ungeraden floor(n / p^k)
+        uint64_t pe = 1;
+        for (uint32_t q = n / p; q > 0; q /= p) {
+            if (q & 1) {
+                pe *= p;
+            }
+        }
+        if (pe == 1) {
+            continue;
+        }
+        if (acc * pe > UINT32_MAX) {
+            factors[count++] = (uint32_t)acc;
+            acc = 1;
+        }
+        acc *= pe;
+    }
+    if (acc > 1 || count == 0) {
+        factors[count++] = (uint32_t)acc;
+    }
+
+    int err = product(r, factors, 0, count);
+    free(factors);
+    return err;
+}
+
+static cache_entry_t *cache_slot(uint32_t n) {
+    return &cache[(n * 2654435761u) % FACULTY_CACHE_SLOTS];
+}
+
+static void cache_store(uint32_t n, const bigint_t *value) {
+    cache_entry_t *e = cache_slot(n);
+    if (e->used) {
+        stats.limbs -= e->value.len;
+    }
+    e->used = false;
+    if (bigint_copy(&e->value, value) == 0) {
+        e->used = true;
+        e->n = n;
+        stats.limbs += e->value.len;
+    }
+}
+
+// Größtes gecachtes m <= n mit n - m <= NEIGHBOUR_MAX, sonst NULL
+static const cache_entry_t *cache_nearest(uint32_t n) {
+    const cache_entry_t *best = NULL;
+    for (size_t i = 0; i < FACULTY_CACHE_SLOTS; i++) {
+        const cache_entry_t *e = &cache[i];
+        if (e->used && e->n <= n && n - e->n <= NEIGHBOUR_MAX &&
+            (!best || e->n > best->n)) {
+            best = e;
+        }
+    }
+    return best;
+}
+
+static int faculty_rec(bigint_t *r, uint32_t n, bool use_cache) {
+    if (n <= SMALL_MAX) {
+        return bigint_set_u64(r, small_faculty(n));
+    }
+    if (use_cache) {
+        const cache_entry_t *e = cache_nearest(n);
+        if (e) {
+            stats.hits++;
+            if (bigint_copy(r, &e->value) < 0) {
+                return -1;
+            }
+            if (e->n == n) {
+                return 0;
+            }
+            for (uint32_t i = e->n + 1; i <= n; i++) {
+                if (bigint_mul_u32(r, i) < 0) {
+                    return -1;
+                }
+            }
+            cache_store(n, r);
+            return 0;
+        }
+        stats.misses++;
+    }
+
+    // Rekursionstiefe nur log2(n)
+    bigint_t s;
+    bigint_init(&s);
+    int err = faculty_rec(r, n / 2, use_cache) < 0 || bigint_mul(r, r, r) < 0 ||
+              swing(&s, n) < 0 || bigint_mul(r, r, &s) < 0;
+    bigint_free(&s);
+    if (err) {
+        return -1;
+    }
+    if (use_cache) {
+        cache_store(n, r);
+    }
+    return 0;
+}
+
+int faculty_big(bigint_t *result, uint32_t n) {
+    if (sieve(n) < 0) {
+        return -1;
+    }
+    return faculty_rec(result, n, true);
+}
+
+int faculty_big_uncached(bigint_t *result, uint32_t n) {
+    if (sieve(n) < 0) {
+        return -1;
+    }
+    return faculty_rec(result, n, false);
+}
+
+void faculty_cache_clear(void) {
+    for (size_t i = 0; i < FACULTY_CACHE_SLOTS; i++) {
+        bigint_free(&cache[i].value);
+        cache[i].used = false;
+    }
+    stats = (faculty_cache_stats_t){0};
+}
+
+faculty_cache_stats_t faculty_cache_stats(void) {
+    return stats;
+}
@@ -0,0 +1,37 @@
+#ifndef FACULTY_BIG_H
+#define FACULTY_BIG_H
+
+#include "bigint.h"
+
+// Exakte Fakultät über den Prime-Swing-Algorithmus (Luschny):
+//
+//   n! = ((n/2)!)^2 * swing(n),   swing(n) = n! / ((n/2)!)^2
+//
+// swing(n) ist ein Produkt von Primzahlpotenzen, deren Exponenten sich direkt
+// aus n ablesen lassen. Die Faktoren werden als balancierter Produktbaum
+// multipliziert (Binary Splitting), damit die großen Multiplikationen
+// gleich lange Operanden haben und Karatsuba greift.
+//
+// Berechnete Ergebnisse landen in einem kleinen Cache. Ein Treffer ist nicht
+// nur derselbe Wert: liegt ein etwas kleineres m! vor, wird n! daraus durch
+// wenige Multiplikationen mit einem Wort gebildet. (n/2)! wird auf dem Weg zu
+// n! ebenfalls gecacht.
+
+#define FACULTY_CACHE_SLOTS 64
+
+typedef struct {
+    uint32_t hits;
+    uint32_t misses;
+    size_t limbs; // belegte Limbs im Cache
+} faculty_cache_stats_t;
+
+// result = n!; gibt -1 zurück, wenn kein Speicher mehr frei ist
+int faculty_big(bigint_t *result, uint32_t n);
+
+// Dasselbe ohne Cache, z.B. für Zeitmessungen
+int faculty_big_uncached(bigint_t *result, uint32_t n);
+
+void faculty_cache_clear(void);
+faculty_cache_stats_t faculty_cache_stats(void);
+
+#endif
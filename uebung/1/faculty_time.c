@@ -0,0 +1,187 @@
+/*
+Zeitmessung der Fakultät (Übung 1, Aufgabe 2).
+
+faculty() aus faculty_iterativly.c und faculty_recusive.c rechnet mit int und
+läuft ab 13! über. Hier rechnen alle Varianten exakt mit bigint_t:
+
+  iterativ   1 * 2 * ... * n, je Schritt eine Multiplikation mit einem Wort
+  rekursiv   dasselbe rekursiv, braucht O(n) Stack
+  swing      Prime-Swing mit Produktbaum und Karatsuba (faculty_big.c),
+             einmal ohne und einmal mit Cache
+
+  gcc -O2 -Wall -o faculty_time faculty_time.c faculty_big.c bigint.c
+  ./faculty_time                    # Tabelle über verschiedene n
+  ./faculty_time 100000 fak.hex     # n! berechnen, hexadezimal in Datei
+
+Die Zeitmessung startet unmittelbar vor und endet unmittelbar nach der
+Rechnung, die Ausgabe gehört nicht dazu.
+*/
+
+#include "bigint.h"
+#include "faculty_big.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Darüber wird der Stack der rekursiven Variante zu knapp
+#define RECURSIVE_MAX_N 20000
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static int faculty_iterative(bigint_t *r, uint32_t n) {
+    if (bigint_set_u32(r, 1) < 0) {
+        return -1;
+    }
+    for (uint32_t i = 2; i <= n; ++i) {
+        if (bigint_mul_u32(r, i) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int faculty_recursive(bigint_t *r, uint32_t n) {
+    if (n <= 1) {
+        return bigint_set_u32(r, 1);
+    }
+    if (faculty_recursive(r, n - 1) < 0) {
+        return -1;
+    }
+    return bigint_mul_u32(r, n);
+}
+
+typedef int (*faculty_fn_t)(bigint_t *r, uint32_t n);
+
+// Misst eine Variante; bei kurzen Laufzeiten wird wiederholt und gemittelt
+static double time_ms(faculty_fn_t fn, bigint_t *r, uint32_t n) {
+    int rounds = 0;
+    double start = now_ms();
+    double elapsed;
+    do {
+        if (fn(r, n) < 0) {
+            return -1;
+        }
+        rounds++;
+        elapsed = now_ms() - start;
+    } while (elapsed < 50 && rounds < 1000);
+    return elapsed / rounds;
+}
+
+static int faculty_swing_cold(bigint_t *r, uint32_t n) {
+    return faculty_big_uncached(r, n);
+}
+
+static void benchmark(void) {
+    static const uint32_t ns[] = {12, 13, 20, 100, 1000, 5000, 10000, 20000,
+                                  50000, 100000};
+
+    printf("%7s %9s %12s %12s %12s %12s  %s\n", "n", "bits", "iter_ms",
+           "rec_ms", "swing_ms", "cached_ms", "check");
+    for (size_t i = 0; i < sizeof(ns) / sizeof(ns[0]); i++) {
+        uint32_t n = ns[i];
+        bigint_t ref, rec, big;
+        bigint_init(&ref);
+        bigint_init(&rec);
+        bigint_init(&big);
+
+        double t_iter = time_ms(faculty_iterative, &ref, n);
+        double t_rec = -1;
+        if (n <= RECURSIVE_MAX_N) {
+            t_rec = time_ms(faculty_recursive, &rec, n);
+        }
+        double t_swing = time_ms(faculty_swing_cold, &big, n);
+        bool ok = bigint_cmp(&ref, &big) == 0 &&
+                  (n > RECURSIVE_MAX_N || bigint_cmp(&ref, &rec) == 0);
+
+        // Cache: beim ersten Aufruf kalt, danach nur noch Kopie
+        faculty_cache_clear();
+        double start = now_ms();
+        faculty_big(&big, n);
+        double t_first = now_ms() - start;
+        double t_cached = time_ms(faculty_big, &big, n);
+        ok = ok && bigint_cmp(&ref, &big) == 0;
+
+        printf("%7lu %9zu %12.3f ", (unsigned long)n, bigint_bits(&ref),
+               t_iter);
+        if (t_rec >= 0) {
+            printf("%12.3f ", t_rec);
+        } else {
+            printf("%12s ", "-");
+        }
+        printf("%12.3f %12.4f  %s (first cached call %.3f ms)\n", t_swing,
+               t_cached, ok ? "ok" : "MISMATCH", t_first);
+
+        bigint_free(&ref);
+        bigint_free(&rec);
+        bigint_free(&big);
+    }
+
+    // Der Cache hilft auch Nachbarn: (n+1)! = n! * (n+1)
+    faculty_cache_clear();
+    bigint_t f;
+    bigint_init(&f);
+    double start = now_ms();
+    for (uint32_t n = 100000; n < 100100; n++) {
+        faculty_big(&f, n);
+    }
+    double t_range = now_ms() - start;
+    faculty_cache_stats_t st = faculty_cache_stats();
+    printf("\n100 consecutive n from 100000: %.1f ms, cache hits=%lu "
+           "misses=%lu, %zu KiB cached\n",
+           t_range, (unsigned long)st.hits, (unsigned long)st.misses,
+           st.limbs * sizeof(uint32_t) / 1024);
+    bigint_free(&f);
+    faculty_cache_clear();
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        benchmark();
+        return 0;
+    }
+
+    char *end;
+    long num = strtol(argv[1], &end, 10);
+    if (*end != '\0' || num < 0 || num > UINT32_MAX) {
+        printf("Invalid input. Please enter a non-negative integer.\n");
+        return 1;
+    }
+
+    bigint_t result;
+    bigint_init(&result);
+    double start = now_ms();
+    int err = faculty_big(&result, (uint32_t)num);
+    double elapsed = now_ms() - start;
+    if (err < 0) {
+        printf("Out of memory.\n");
+        return 1;
+    }
+    printf("Factorial of %ld has %zu bits, computed in %.3f ms\n", num,
+           bigint_bits(&result), elapsed);
+
+    if (argc > 2) {
+        FILE *out = fopen(argv[2], "w");
+        if (!out) {
+            perror(argv[2]);
+            bigint_free(&result);
+            return 1;
+        }
+        int write_err = bigint_write_hex(&result, out) < 0 ||
+                        fputc('\n', out) == EOF;
+        if (fclose(out) != 0 || write_err) {
+            perror(argv[2]);
+            bigint_free(&result);
+            return 1;
+        }
+        printf("Result written to %s\n", argv[2]);
+    }
+
+    bigint_free(&result);
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include "distance_filter.h"
+
+#include <string.h>
+
+// Upper bound for the predicted variance after long gaps, keeps the gain
+// computation inside 64 bits
+#define P_MAX_Q16 (1u << 30)
+
+void distance_filter_default_config(distance_filter_config_t *cfg) {
+  cfg->r_q16 = 225u * Q16_ONE;
+  cfg->q_per_s_q16 = 2000u * Q16_ONE;
+  cfg->outlier_q16 = MM_TO_Q16(50);
+}
+
+void distance_filter_init(distance_filter_t *f,
+                          const distance_filter_config_t *cfg) {
+  memset(f, 0, sizeof(*f));
+  f->cfg = *cfg;
+}
+
+// Replaces the oldest value in the window by `z` and returns the median
+static int32_t median_update(distance_filter_t *f, int32_t z) {
+  int n = f->count;
+
+  if (n == DISTANCE_FILTER_WINDOW) {
+    // Remove the value leaving the window from the sorted array
+    int32_t old = f->raw[f->head];
+    int i = 0;
+    while (f->sorted[i] != old) {
+      i++;
+    }
+    memmove(&f->sorted[i], &f->sorted[i + 1], (n - 1 - i) * sizeof(int32_t));
+    n--;
+  }
+
+  // Insert `z` keeping the array sorted
+  int i = n;
+  while (i > 0 && f->sorted[i - 1] > z) {
+    f->sorted[i] = f->sorted[i - 1];
+    i--;
+  }
+  f->sorted[i] = z;
+  n++;
+
+  f->raw[f->head] = z;
+  f->head = (f->head + 1) % DISTANCE_FILTER_WINDOW;
+  f->count = n;
+  return f->sorted[n / 2];
+}
+
+int32_t distance_filter_update(distance_filter_t *f, int32_t z_q16,
+                               uint32_t now_us) {
+  int32_t m = median_update(f, z_q16);
+  f->samples++;
+
+  int32_t deviation = z_q16 > m ? z_q16 - m : m - z_q16;
+  if (f->count == DISTANCE_FILTER_WINDOW && deviation > f->cfg.outlier_q16) {
+    f->outliers++;
+  }
+
+  if (!f->initialized) {
+    f->initialized = true;
+    f->x_q16 = m;
+    f->p_q16 = f->cfg.r_q16;
+    f->last_us = now_us;
+    return f->x_q16;
+  }
+
+  // Predict: the variance grows with the elapsed time
+  uint32_t dt_us = now_us - f->last_us;
+  f->last_us = now_us;
+  uint64_t p = f->p_q16 + (uint64_t)f->cfg.q_per_s_q16 * dt_us / 1000000u;
+  if (p > P_MAX_Q16) {
+    p = P_MAX_Q16;
+  }
+
+  // Update with the median as measurement
+  uint32_t k_q16 = (uint32_t)((p << 16) / (p + f->cfg.r_q16));
+  f->x_q16 += (int32_t)(((int64_t)k_q16 * (m - f->x_q16)) >> 16);
+  f->p_q16 = (uint32_t)(((uint64_t)(Q16_ONE - k_q16) * p) >> 16);
+  return f->x_q16;
+}
+
+uint32_t speed_of_sound_q16(float temperature_c) {
+  float m_per_s = 331.3f + 0.606f * temperature_c;
+  return (uint32_t)(m_per_s / 1000.0f * Q16_ONE + 0.5f);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Per-sensor distance filter: sliding median followed by a 1D Kalman filter.
+//
+// The median over the last DISTANCE_FILTER_WINDOW readings removes single
+// outliers (crosstalk, missed echoes) before they reach the Kalman filter,
+// which then smooths the remaining noise. The Kalman model is a random walk:
+// the process noise grows with the time since the previous reading, so
+// irregular sampling from the scheduler is handled correctly.
+//
+// Everything runs in integer arithmetic. Distances are millimetres in Q16.16,
+// variances mm^2 in Q16.16. The work per sample is constant: the window is
+// small and fixed, so keeping it sorted costs at most DISTANCE_FILTER_WINDOW
+// moves, plus one 64-bit division for the Kalman gain.
+//
+// Plain C without ESP-IDF dependencies, see host/filter_check.c.
+
+#define DISTANCE_FILTER_WINDOW 5 // odd
+
+#define Q16_ONE 65536
+#define MM_TO_Q16(mm) ((int32_t)((mm) * Q16_ONE))
+#define Q16_TO_MM(q) ((q) / (float)Q16_ONE)
+
+typedef struct {
+  uint32_t r_q16;           // measurement noise, mm^2
+  uint32_t q_per_s_q16;     // process noise per second, mm^2/s
+  int32_t outlier_q16;      // |raw - median| above this counts as outlier
+} distance_filter_config_t;
+
+typedef struct {
+  distance_filter_config_t cfg;
+
+  // Median: raw values in arrival order (ring) and the same values sorted
+  int32_t raw[DISTANCE_FILTER_WINDOW];
+  int32_t sorted[DISTANCE_FILTER_WINDOW];
+  uint8_t count;
+  uint8_t head;
+
+  // Kalman state
+  bool initialized;
+  int32_t x_q16; // estimate
+  uint32_t p_q16; // estimate variance
+  uint32_t last_us;
+
+  uint32_t samples;
+  uint32_t outliers;
+} distance_filter_t;
+
+// r = 15 mm standard deviation, q = 2000 mm^2/s, outliers beyond 50 mm
+void distance_filter_default_config(distance_filter_config_t *cfg);
+
+void distance_filter_init(distance_filter_t *f,
+                          const distance_filter_config_t *cfg);
+
+// Feeds one reading taken at `now_us` and returns the filtered distance
+int32_t distance_filter_update(distance_filter_t *f, int32_t z_q16,
+                               uint32_t now_us);
+
+// Speed of sound in mm/µs as Q16.16 for the given air temperature
+// (331.3 m/s + 0.606 m/s per °C).
+uint32_t speed_of_sound_q16(float temperature_c);
+
+// Distance for an echo pulse width: width * speed / 2
+static inline int32_t echo_width_to_q16(uint32_t width_us, uint32_t speed_q16) {
+  return (int32_t)(((uint64_t)width_us * speed_q16) >> 1);
+}
@@ -1,44 +1,178 @@
+#include "distance_filter.h"
+#include "ds18x20.h"
+#include "echo_capture.h"
+#include "sonar_sched.h"
 #include <driver/gpio.h>
+#include <esp_cpu.h>
 #include <esp_log.h>
 #include <stdint.h>
 #include <esp_timer.h>
 #include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
 #include <freertos/task.h>
+#include <math.h>
 #include <stdio.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <esp_rom_sys.h>
+#include <onewire_bus.h>
+#include <periph_trace.h>
+#include <metrics.h>
+#include <evtrace.h>
 
-#define TRIGGER_GPIO 1
-#define ECHO_GPIO 2
+// The speed of sound follows the air temperature from a DS18x20 on the
+// 1-Wire bus (same wiring as the temperature project). Without sensor the
+// default temperature is used.
+#define ONEWIRE_GPIO 18
+#define TEMPERATURE_PERIOD_MS 2000
+#define TEMPERATURE_RESOLUTION_BITS 9 // 0.5 °C is ~0.1 % speed of sound
+#define DEFAULT_TEMPERATURE_C 20.0f
 
-#define SPEED_OF_SOUND_CM_PER_US 0.0343f // Speed of sound in cm/µs
+// Ranges for the scheduler: readings beyond MAX_RANGE_CM are discarded,
+// objects up to GHOST_RANGE_CM may still echo and set the guard time between
+// pings of sensors that hear each other.
+#define MIN_RANGE_CM 2.0f
+#define MAX_RANGE_CM 400.0f
+#define GHOST_RANGE_CM 600.0f
+
+typedef struct {
+  gpio_num_t trigger;
+  gpio_num_t echo;
+  uint32_t conflicts; // bit mask of sensors that hear this one's pings
+} sensor_pins_t;
+
+// One entry per HC-SR04. Sensors facing away from each other may share a
+// firing slot; list neighbours in `conflicts`. Example for a ring of four:
+//   {GPIO_NUM_1, GPIO_NUM_2, BIT(1) | BIT(3)},  // front
+//   {GPIO_NUM_4, GPIO_NUM_5, BIT(0) | BIT(2)},  // right
+//   {GPIO_NUM_6, GPIO_NUM_7, BIT(1) | BIT(3)},  // back
+//   {GPIO_NUM_8, GPIO_NUM_9, BIT(0) | BIT(2)},  // left
+static const sensor_pins_t sensor_pins[] = {
+    {GPIO_NUM_1, GPIO_NUM_2, 0},
+};
+#define SENSOR_COUNT (sizeof(sensor_pins) / sizeof(sensor_pins[0]))
+
+// Sensor 0 is timed by both methods: the MCPWM capture unit in hardware and
+// the original any-edge GPIO ISR with esp_timer_get_time(). Every
+// STATS_WINDOW readings the spread of both is logged.
+#define ECHO_GPIO (sensor_pins[0].echo)
+#define STATS_WINDOW 50
+
+#define REPORT_PERIOD_US 1000000
+
+// 1 = log every raw reading as "T,<sensor>,<time_us>,<width_us>" for
+// host/filter_check.c
+#define LOG_RAW_TRACE 0
+
+// Marker in the capture queue: the scheduler's wake-up timer expired
+#define SENSOR_WAKEUP 0xFF
+
+// 1 = a task on the same core keeps interrupts masked for LOAD_BLOCK_US out of
+// every LOAD_PERIOD_US, like a busy driver would. Only the GPIO method suffers.
+#define CPU_LOAD_TEST 0
+#define LOAD_BLOCK_US 30
+#define LOAD_PERIOD_US 300
+
+#define SENSOR_CORE 0
+
+// CONFIG_PERIPH_TRACE_ENABLE (menuconfig) streams every trigger, echo edge and
+// 1-Wire transfer to TRACE_UART for replay on the PC (HAL_SIM_REPLAY, see
+// components/periph_trace). Record with e.g. "cat /dev/ttyUSB1 > trace.bin"
+// on a USB-UART adapter at TRACE_TX_GPIO.
+#define TRACE_UART UART_NUM_1
+#define TRACE_TX_GPIO 17
+#define TRACE_BAUD 921600
+
+// CONFIG_EVTRACE_ENABLE (menuconfig) streams ISR and task events to
+// TRACE_UART instead (components/evtrace): duration and jitter of the echo
+// ISRs and the wake-up timer in Perfetto.
+
+#if CONFIG_PERIPH_TRACE_ENABLE && CONFIG_EVTRACE_ENABLE
+#error "CONFIG_PERIPH_TRACE_ENABLE and CONFIG_EVTRACE_ENABLE share TRACE_UART"
+#endif
+
+#if CONFIG_PERIPH_TRACE_ENABLE || CONFIG_EVTRACE_ENABLE
+#include <driver/uart.h>
+#endif
 
 static const char *TAG = "ULTRASONIC";
 
-// volatile is used as these variables are accessed by an ISR
-static volatile int64_t echo_start_time = 0;
-static volatile int64_t echo_end_time = 0;
-static volatile bool pulse_detected = false;
+// Readings from both methods, one entry per echo
+static QueueHandle_t capture_queue; // echo_pulse_t
+static QueueHandle_t gpio_queue;    // gpio_echo_t
+static echo_channel_t echo_channels[SENSOR_COUNT];
+static esp_timer_handle_t wakeup_timer;
+static volatile int64_t wakeup_due_us; // when wakeup_timer should fire
+
+// Shared metrics (components/metrics), logged with the capture statistics
+static metric_t *gpio_edges;
+static metric_t *wakeup_late_us;
+
+// Speed of sound in mm/µs (Q16.16), written by the temperature task
+static volatile uint32_t speed_q16;
+
+// One complete echo as seen by the GPIO ISR. Like echo_pulse_t it carries the
+// sequence number of the ping, so the task never pairs an echo with the wrong
+// trigger.
+typedef struct {
+  uint32_t seq;
+  int64_t start_us;
+  int64_t end_us;
+} gpio_echo_t;
+
+// Sequence number of the last trigger of sensor 0, written by the task
+static _Atomic uint32_t gpio_armed_seq;
+
+// Only used by the ISR
+static bool gpio_high;
+static uint32_t gpio_rise_seq;
+static int64_t gpio_rise_us;
 
 static void IRAM_ATTR gpio_isr_handler(void *arg) {
+  EVTRACE_ISR_ENTER("gpio_isr_handler");
+  int64_t now = esp_timer_get_time();
+  BaseType_t woken = pdFALSE;
+  metrics_inc(gpio_edges);
   if (gpio_get_level(ECHO_GPIO)) {
-    // Rising edge: record the start time
-    echo_start_time = esp_timer_get_time();
-  } else {
-    // Falling edge: record the end time and set the flag
-    echo_end_time = esp_timer_get_time();
-    pulse_detected = true;
+    // Rising edge: remember the start and the ping it belongs to
+    gpio_rise_us = now;
+    gpio_rise_seq = atomic_load_explicit(&gpio_armed_seq, memory_order_acquire);
+    gpio_high = true;
+  } else if (gpio_high) {
+    // Falling edge: hand the whole record to the task
+    gpio_echo_t echo = {
+        .seq = gpio_rise_seq,
+        .start_us = gpio_rise_us,
+        .end_us = now,
+    };
+    gpio_high = false;
+    xQueueSendFromISR(gpio_queue, &echo, &woken);
   }
+  // Before the yield, otherwise the switch to the task lands inside the ISR
+  // span in the trace
+  EVTRACE_ISR_EXIT("gpio_isr_handler");
+  portYIELD_FROM_ISR(woken);
 }
 
 static void ultrasonic_gpio_init(void) {
+  uint64_t trigger_mask = 0;
+  for (size_t i = 0; i < SENSOR_COUNT; i++) {
+    trigger_mask |= 1ULL << sensor_pins[i].trigger;
+  }
   gpio_config_t trig_io_conf = {
-      .pin_bit_mask = (1ULL << TRIGGER_GPIO),
+      .pin_bit_mask = trigger_mask,
       .mode = GPIO_MODE_OUTPUT,
       .intr_type = GPIO_INTR_DISABLE,
   };
   gpio_config(&trig_io_conf);
 
+  // Capture first: gpio_config below keeps the pin routed to MCPWM and only
+  // adds the GPIO interrupt on top.
+  for (size_t i = 0; i < SENSOR_COUNT; i++) {
+    ESP_ERROR_CHECK(echo_capture_add(&echo_channels[i], sensor_pins[i].echo, i,
+                                     capture_queue));
+  }
+
   gpio_config_t echo_io_conf = {
       .pin_bit_mask = (1ULL << ECHO_GPIO),
       .mode = GPIO_MODE_INPUT,
@@ -56,56 +190,367 @@ static void ultrasonic_gpio_init(void) {
   ESP_LOGI(TAG, "GPIOs configured.");
 }
 
-static void send_trigger_pulse(void) {
-  gpio_set_level(TRIGGER_GPIO, 0);
+// Triggers all sensors in `mask` with one common 10 µs pulse
+static void send_trigger_pulse(uint32_t mask) {
+  for (size_t i = 0; i < SENSOR_COUNT; i++) {
+    if (mask & (1u << i)) {
+      gpio_set_level(sensor_pins[i].trigger, 0);
+    }
+  }
   esp_rom_delay_us(2);
-  gpio_set_level(TRIGGER_GPIO, 1);
+  for (size_t i = 0; i < SENSOR_COUNT; i++) {
+    if (mask & (1u << i)) {
+      gpio_set_level(sensor_pins[i].trigger, 1);
+    }
+  }
   esp_rom_delay_us(10);
-  gpio_set_level(TRIGGER_GPIO, 0);
+  for (size_t i = 0; i < SENSOR_COUNT; i++) {
+    if (mask & (1u << i)) {
+      gpio_set_level(sensor_pins[i].trigger, 0);
+    }
+  }
+}
+
+// esp_timer callback: wakes the task for the scheduler's next deadline. Ticks
+// are 10 ms, far too coarse for the guard times.
+static void wakeup_cb(void *arg) {
+  EVTRACE_BEGIN("wakeup_cb");
+  int64_t late = esp_timer_get_time() - wakeup_due_us;
+  metrics_record(wakeup_late_us, late > 0 ? late : 0);
+  EVTRACE_VALUE("timer.wakeup_late_us", late);
+  echo_pulse_t marker = {.sensor = SENSOR_WAKEUP};
+  xQueueSend(capture_queue, &marker, 0);
+  EVTRACE_END("wakeup_cb");
+}
+
+// Running mean and variance (Welford), in µs
+typedef struct {
+  uint32_t n;
+  double mean;
+  double m2;
+  double min;
+  double max;
+} running_stats_t;
+
+static void stats_add(running_stats_t *s, double x) {
+  if (s->n == 0) {
+    s->min = s->max = x;
+  }
+  s->n++;
+  double delta = x - s->mean;
+  s->mean += delta / s->n;
+  s->m2 += delta * (x - s->mean);
+  s->min = x < s->min ? x : s->min;
+  s->max = x > s->max ? x : s->max;
+}
+
+static double stats_stddev(const running_stats_t *s) {
+  return s->n > 1 ? sqrt(s->m2 / (s->n - 1)) : 0.0;
+}
+
+static float width_to_cm(float width_us) {
+  // distance = (duration / 2) * speed_of_sound
+  return (width_us / 2.0f) * (speed_q16 / (10.0f * Q16_ONE));
+}
+
+static void log_stats(const char *name, const running_stats_t *s) {
+  double sd = stats_stddev(s);
+  ESP_LOGI(TAG,
+           "%-7s n=%lu mean=%.2f cm  stddev=%.0f ns (%.2f mm)  "
+           "p-p=%.0f ns",
+           name, (unsigned long)s->n, width_to_cm(s->mean), sd * 1000.0,
+           width_to_cm(sd) * 10.0f, (s->max - s->min) * 1000.0);
+}
+
+#if CPU_LOAD_TEST
+// Delays the GPIO ISR but not the capture hardware. Runs at idle priority, so
+// the idle task still gets its time slices and the watchdog stays quiet.
+static void cpu_load_task(void *arg) {
+  static portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+  while (1) {
+    portENTER_CRITICAL(&lock);
+    esp_rom_delay_us(LOAD_BLOCK_US);
+    portEXIT_CRITICAL(&lock);
+    esp_rom_delay_us(LOAD_PERIOD_US - LOAD_BLOCK_US);
+  }
+}
+#endif
+
+// State shared between the task loop and the reading callback
+typedef struct {
+  running_stats_t capture_stats;
+  running_stats_t gpio_stats;
+  running_stats_t diff_stats; // GPIO minus capture, same echo
+  distance_filter_t filters[SENSOR_COUNT];
+  float raw_cm[SENSOR_COUNT];
+  float filtered_cm[SENSOR_COUNT];
+  uint32_t valid[SENSOR_COUNT];
+
+  // Sequence number of each sensor's last trigger. Echoes tagged with an older
+  // number belong to an earlier ping and are dropped.
+  uint32_t seq[SENSOR_COUNT];
+  uint32_t stale_capture;
+  uint32_t stale_gpio;
+
+  // Filter cost in CPU cycles
+  uint32_t filter_calls;
+  uint32_t filter_cycles_max;
+  uint64_t filter_cycles_total;
+} array_state_t;
+
+static void on_reading(const sonar_reading_t *r, void *ctx) {
+  array_state_t *st = ctx;
+
+  if (r->status == SONAR_NO_ECHO) {
+    ESP_LOGD(TAG, "Sensor %u: no echo", r->sensor);
+    return;
+  }
+  if (r->status == SONAR_TOO_CLOSE) {
+    ESP_LOGD(TAG, "Sensor %u: out of range (%.2f cm)", r->sensor,
+             r->distance_cm);
+    return;
+  }
+#if LOG_RAW_TRACE
+  ESP_LOGI(TAG, "T,%u,%lu,%lu", r->sensor, (unsigned long)r->fired_us,
+           (unsigned long)r->width_us);
+#endif
+
+  int32_t z = echo_width_to_q16(r->width_us, speed_q16);
+  uint32_t start = esp_cpu_get_cycle_count();
+  int32_t filtered = distance_filter_update(&st->filters[r->sensor], z,
+                                            r->fired_us);
+  uint32_t cycles = esp_cpu_get_cycle_count() - start;
+  st->filter_calls++;
+  st->filter_cycles_total += cycles;
+  if (cycles > st->filter_cycles_max) {
+    st->filter_cycles_max = cycles;
+  }
+
+  st->raw_cm[r->sensor] = Q16_TO_MM(z) / 10.0f;
+  st->filtered_cm[r->sensor] = Q16_TO_MM(filtered) / 10.0f;
+  st->valid[r->sensor]++;
+
+  if (r->sensor == 0) {
+    stats_add(&st->capture_stats, r->width_us);
+    gpio_echo_t echo;
+    while (xQueueReceive(gpio_queue, &echo, 0) == pdTRUE) {
+      if (echo.seq != st->seq[0]) {
+        st->stale_gpio++;
+        continue;
+      }
+      int64_t gpio_width_us = echo.end_us - echo.start_us;
+      stats_add(&st->gpio_stats, gpio_width_us);
+      stats_add(&st->diff_stats, gpio_width_us - (double)r->width_us);
+      break;
+    }
+  }
+}
+
+static void log_report(const sonar_sched_t *sched, array_state_t *st,
+                       int64_t elapsed_us) {
+  char line[192];
+  int len = 0;
+  uint32_t valid = 0;
+  uint32_t outliers = 0;
+  for (size_t i = 0; i < SENSOR_COUNT && len < (int)sizeof(line); i++) {
+    len += snprintf(&line[len], sizeof(line) - len, " %.1f (raw %.1f)",
+                    st->filtered_cm[i], st->raw_cm[i]);
+    valid += st->valid[i];
+    outliers += st->filters[i].outliers;
+    st->valid[i] = 0;
+  }
+  ESP_LOGI(TAG, "Distance cm:%s | %.1f readings/s, no_echo=%lu late=%lu "
+           "stray=%lu stale=%lu/%lu",
+           line, valid * 1e6f / elapsed_us, (unsigned long)sched->no_echo,
+           (unsigned long)sched->late, (unsigned long)sched->stray,
+           (unsigned long)st->stale_capture, (unsigned long)st->stale_gpio);
+  ESP_LOGI(TAG, "filter avg=%lu max=%lu cycles, outliers=%lu, c=%.1f m/s",
+           (unsigned long)(st->filter_calls
+                               ? st->filter_cycles_total / st->filter_calls
+                               : 0),
+           (unsigned long)st->filter_cycles_max, (unsigned long)outliers,
+           speed_q16 * 1000.0f / Q16_ONE);
+
+  if (st->capture_stats.n >= STATS_WINDOW) {
+    log_stats("capture", &st->capture_stats);
+    log_stats("gpio", &st->gpio_stats);
+    ESP_LOGI(TAG, "gpio-capture mean=%.2f us stddev=%.2f us, overruns=%lu",
+             st->diff_stats.mean, stats_stddev(&st->diff_stats),
+             (unsigned long)echo_channels[0].overruns);
+    metrics_print(stdout);
+    st->capture_stats = (running_stats_t){0};
+    st->gpio_stats = (running_stats_t){0};
+    st->diff_stats = (running_stats_t){0};
+  }
 }
 
 void ultrasonic_test_task(void *pvParameters) {
   ultrasonic_gpio_init();
 
+  static array_state_t state;
+  sonar_config_t cfg;
+  sonar_config_default(&cfg, SENSOR_COUNT);
+  cfg.min_range_cm = MIN_RANGE_CM;
+  cfg.max_range_cm = MAX_RANGE_CM;
+  cfg.ghost_range_cm = GHOST_RANGE_CM;
+  cfg.speed_cm_per_us = speed_q16 / (10.0f * Q16_ONE);
+  distance_filter_config_t filter_cfg;
+  distance_filter_default_config(&filter_cfg);
+  for (size_t i = 0; i < SENSOR_COUNT; i++) {
+    cfg.conflicts[i] = sensor_pins[i].conflicts;
+    distance_filter_init(&state.filters[i], &filter_cfg);
+  }
+  sonar_config_auto_groups(&cfg);
+  cfg.on_reading = on_reading;
+  cfg.ctx = &state;
+
+  sonar_sched_t sched;
+  if (sonar_sched_init(&sched, &cfg) < 0) {
+    ESP_LOGE(TAG, "Invalid sensor configuration");
+    vTaskDelete(NULL);
+  }
+  ESP_LOGI(TAG, "%u sensors in %u groups, listen %lu us, guard %lu us",
+           (unsigned)SENSOR_COUNT, (unsigned)cfg.group_count,
+           (unsigned long)sched.listen_us, (unsigned long)sched.guard_us);
+
+  int64_t last_report = esp_timer_get_time();
+  uint32_t sched_speed_q16 = speed_q16;
+
   while (1) {
-    // Reset the pulse detection flag
-    pulse_detected = false;
-
-    // Send the trigger pulse to start a measurement
-    send_trigger_pulse();
-
-    // Wait for the pulse to be detected by the ISR.
-    // We add a timeout to prevent the task from blocking forever if no echo is
-    // received. A 100ms timeout is more than enough for the sensor's max range
-    // (e.g., 400cm is ~24ms).
-    vTaskDelay(pdMS_TO_TICKS(100));
-
-    if (pulse_detected) {
-      // Calculate the duration of the pulse in microseconds
-      int64_t pulse_duration_us = echo_end_time - echo_start_time;
-
-      // Calculate the distance in centimeters
-      // distance = (duration / 2) * speed_of_sound
-      float distance_cm = (pulse_duration_us / 2.0f) * SPEED_OF_SOUND_CM_PER_US;
-
-      // Check for valid range
-      if (distance_cm > 2 && distance_cm < 400) {
-        ESP_LOGI(TAG, "Distance: %.2f cm", distance_cm);
-      } else {
-        ESP_LOGI(TAG, "Out of range (%.2f cm)", distance_cm);
+    // Listen window and guard time follow the temperature as well
+    if (speed_q16 != sched_speed_q16) {
+      sched_speed_q16 = speed_q16;
+      sonar_sched_set_speed(&sched, sched_speed_q16 / (10.0f * Q16_ONE));
+    }
+
+    uint32_t wait_us;
+    uint32_t mask =
+        sonar_sched_poll(&sched, (uint32_t)esp_timer_get_time(), &wait_us);
+    if (mask) {
+      // Arm before the trigger, the echo line cannot rise earlier
+      for (size_t i = 0; i < SENSOR_COUNT; i++) {
+        if (mask & (1u << i)) {
+          echo_capture_arm(&echo_channels[i], ++state.seq[i]);
+        }
       }
+      if (mask & 1) {
+        atomic_store_explicit(&gpio_armed_seq, state.seq[0],
+                              memory_order_release);
+      }
+      send_trigger_pulse(mask);
+      continue;
+    }
+
+    // Sleep until an echo ends or the next deadline, whichever comes first
+    esp_timer_stop(wakeup_timer);
+    wakeup_due_us = esp_timer_get_time() + wait_us;
+    esp_timer_start_once(wakeup_timer, wait_us);
+
+    echo_pulse_t pulse;
+    xQueueReceive(capture_queue, &pulse, portMAX_DELAY);
+    if (pulse.sensor == SENSOR_WAKEUP) {
+      // Only there to run the scheduler
+    } else if (pulse.sensor < SENSOR_COUNT &&
+               pulse.seq != state.seq[pulse.sensor]) {
+      // Echo of an earlier ping that ended after the sensor was re-armed
+      state.stale_capture++;
     } else {
-      // This happens if the ISR didn't detect a full pulse within the timeout
-      ESP_LOGW(TAG, "No echo received (timeout).");
+      sonar_sched_echo(&sched, pulse.sensor, (uint32_t)esp_timer_get_time(),
+                       (uint32_t)echo_ticks_to_us(echo_pulse_ticks(&pulse)));
     }
 
-    // Wait for 1 second before the next measurement
-    vTaskDelay(pdMS_TO_TICKS(1000));
+    int64_t now = esp_timer_get_time();
+    if (now - last_report >= REPORT_PERIOD_US) {
+      log_report(&sched, &state, now - last_report);
+      last_report = now;
+    }
   }
 }
 
+// Reads the air temperature and updates the speed of sound
+static void temperature_task(void *arg) {
+  static ds18x20_t ds;
+  onewire_bus_handle_t bus;
+  onewire_bus_config_t bus_cfg = {.bus_gpio_num = ONEWIRE_GPIO};
+  onewire_bus_rmt_config_t rmt_cfg = {.max_rx_bytes = 10};
+
+  if (onewire_new_bus_rmt(&bus_cfg, &rmt_cfg, &bus) != ESP_OK ||
+      ds18x20_init(&ds, bus) != ESP_OK || ds.count == 0) {
+    ESP_LOGW(TAG, "No DS18x20, assuming %.1f °C", DEFAULT_TEMPERATURE_C);
+    vTaskDelete(NULL);
+  }
+  ds18x20_set_resolution_all(&ds, TEMPERATURE_RESOLUTION_BITS);
+
+  TickType_t last_wake = xTaskGetTickCount();
+  while (1) {
+    if (ds18x20_convert_all(&ds) == ESP_OK) {
+      // Mean over all sensors that delivered a valid value
+      ds18x20_read_all(&ds);
+      float sum = 0;
+      int n = 0;
+      for (size_t i = 0; i < ds.count; i++) {
+        if (ds.sensors[i].valid) {
+          sum += ds.sensors[i].temperature;
+          n++;
+        }
+      }
+      if (n > 0) {
+        speed_q16 = speed_of_sound_q16(sum / n);
+      }
+    }
+    vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(TEMPERATURE_PERIOD_MS));
+  }
+}
+
+#if CONFIG_PERIPH_TRACE_ENABLE || CONFIG_EVTRACE_ENABLE
+// Before anything touches a peripheral, so the trace starts with the setup
+static void start_trace(void) {
+  uart_config_t config = {
+      .baud_rate = TRACE_BAUD,
+      .data_bits = UART_DATA_8_BITS,
+      .parity = UART_PARITY_DISABLE,
+      .stop_bits = UART_STOP_BITS_1,
+      .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+      .source_clk = UART_SCLK_DEFAULT,
+  };
+  ESP_ERROR_CHECK(uart_driver_install(TRACE_UART, 256, 8192, 0, NULL, 0));
+  ESP_ERROR_CHECK(uart_param_config(TRACE_UART, &config));
+  ESP_ERROR_CHECK(uart_set_pin(TRACE_UART, TRACE_TX_GPIO, UART_PIN_NO_CHANGE,
+                               UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE));
+#if CONFIG_PERIPH_TRACE_ENABLE
+  ESP_ERROR_CHECK(periph_trace_start_uart(TRACE_UART));
+#else
+  ESP_ERROR_CHECK(evtrace_start(TRACE_UART));
+#endif
+}
+#endif
+
 void app_main(void) {
-  // Create the task that will handle the sensor readings
-  xTaskCreate(ultrasonic_test_task, "ultrasonic_test_task", 4096, NULL, 5,
-              NULL);
-}
\ No newline at end of file
+#if CONFIG_PERIPH_TRACE_ENABLE || CONFIG_EVTRACE_ENABLE
+  start_trace();
+#endif
+  speed_q16 = speed_of_sound_q16(DEFAULT_TEMPERATURE_C);
+  gpio_edges = metrics_counter("gpio.echo_edges", "");
+  wakeup_late_us = metrics_histogram("timer.wakeup_late_us", "us");
+
+  capture_queue = xQueueCreate(4 + 2 * SENSOR_COUNT, sizeof(echo_pulse_t));
+  gpio_queue = xQueueCreate(4, sizeof(gpio_echo_t));
+
+  esp_timer_create_args_t timer_args = {
+      .callback = wakeup_cb,
+      .name = "sonar_wakeup",
+  };
+  ESP_ERROR_CHECK(esp_timer_create(&timer_args, &wakeup_timer));
+
+  // Create the task that will handle the sensor readings. Interrupts are
+  // allocated on the core the task runs on.
+  xTaskCreatePinnedToCore(ultrasonic_test_task, "ultrasonic_test_task", 4096,
+                          NULL, 5, NULL, SENSOR_CORE);
+  // Slow and not time critical, keep it off the sensor core
+  xTaskCreatePinnedToCore(temperature_task, "temperature", 4096, NULL, 3, NULL,
+                          1);
+#if CPU_LOAD_TEST
+  xTaskCreatePinnedToCore(cpu_load_task, "cpu_load", 2048, NULL,
+                          tskIDLE_PRIORITY, NULL, SENSOR_CORE);
+#endif
+}
@@ -0,0 +1,242 @@
+#include "sonar_sched.h"
+
+#include <string.h>
+
+// Extra time before a silent sensor is considered ready again
+#define BUSY_MARGIN_US 1000
+
+static uint32_t round_trip_us(float range_cm, float speed_cm_per_us) {
+  return (uint32_t)(2.0f * range_cm / speed_cm_per_us);
+}
+
+void sonar_config_default(sonar_config_t *cfg, size_t sensor_count) {
+  memset(cfg, 0, sizeof(*cfg));
+  cfg->sensor_count = sensor_count;
+  cfg->min_range_cm = 2.0f;
+  cfg->max_range_cm = 400.0f;
+  cfg->ghost_range_cm = 600.0f;
+  cfg->speed_cm_per_us = 0.0343f;
+  cfg->echo_delay_us = 500;
+  cfg->sensor_timeout_us = 38000;
+}
+
+void sonar_config_auto_groups(sonar_config_t *cfg) {
+  uint32_t all = (1u << cfg->sensor_count) - 1;
+  uint32_t placed = 0;
+
+  cfg->group_count = 0;
+  while (placed != all && cfg->group_count < SONAR_MAX_GROUPS) {
+    uint32_t group = 0;
+    uint32_t blocked = 0;
+    for (size_t i = 0; i < cfg->sensor_count; i++) {
+      uint32_t bit = 1u << i;
+      if ((placed & bit) || (blocked & bit)) {
+        continue;
+      }
+      group |= bit;
+      blocked |= cfg->conflicts[i];
+      // Conflicts are symmetric even if only one direction was given
+      for (size_t j = 0; j < cfg->sensor_count; j++) {
+        if (cfg->conflicts[j] & bit) {
+          blocked |= 1u << j;
+        }
+      }
+    }
+    cfg->groups[cfg->group_count++] = group;
+    placed |= group;
+  }
+}
+
+static void update_times(sonar_sched_t *s) {
+  const sonar_config_t *cfg = &s->cfg;
+  s->listen_us = cfg->echo_delay_us +
+                 round_trip_us(cfg->max_range_cm, cfg->speed_cm_per_us);
+  s->guard_us = cfg->echo_delay_us +
+                round_trip_us(cfg->ghost_range_cm, cfg->speed_cm_per_us);
+}
+
+int sonar_sched_init(sonar_sched_t *s, const sonar_config_t *cfg) {
+  if (cfg->sensor_count == 0 || cfg->sensor_count > SONAR_MAX_SENSORS ||
+      cfg->group_count == 0 || cfg->group_count > SONAR_MAX_GROUPS ||
+      cfg->ghost_range_cm < cfg->max_range_cm || cfg->speed_cm_per_us <= 0) {
+    return -1;
+  }
+
+  memset(s, 0, sizeof(*s));
+  s->cfg = *cfg;
+
+  // Make the relation symmetric and reflexive
+  uint32_t all = (1u << cfg->sensor_count) - 1;
+  for (size_t i = 0; i < cfg->sensor_count; i++) {
+    s->cfg.conflicts[i] |= 1u << i;
+    for (size_t j = 0; j < cfg->sensor_count; j++) {
+      if (cfg->conflicts[j] & (1u << i)) {
+        s->cfg.conflicts[i] |= 1u << j;
+      }
+    }
+    s->cfg.conflicts[i] &= all;
+  }
+
+  uint32_t covered = 0;
+  for (size_t g = 0; g < cfg->group_count; g++) {
+    uint32_t group = cfg->groups[g];
+    if (group == 0 || (group & ~all)) {
+      return -1;
+    }
+    for (size_t i = 0; i < cfg->sensor_count; i++) {
+      if ((group & (1u << i)) && (s->cfg.conflicts[i] & group & ~(1u << i))) {
+        return -1; // two sensors in one group would hear each other
+      }
+    }
+    covered |= group;
+  }
+  if (covered != all) {
+    return -1;
+  }
+
+  update_times(s);
+  return 0;
+}
+
+void sonar_sched_set_speed(sonar_sched_t *s, float speed_cm_per_us) {
+  if (speed_cm_per_us > 0) {
+    s->cfg.speed_cm_per_us = speed_cm_per_us;
+    update_times(s);
+  }
+}
+
+static void emit(sonar_sched_t *s, uint8_t sensor, sonar_status_t status,
+                 uint32_t width_us) {
+  sonar_reading_t r = {
+      .sensor = sensor,
+      .status = status,
+      .fired_us = s->sensors[sensor].fired_us,
+      .width_us = width_us,
+      .distance_cm = width_us * s->cfg.speed_cm_per_us / 2.0f,
+  };
+  if (s->cfg.on_reading) {
+    s->cfg.on_reading(&r, s->cfg.ctx);
+  }
+}
+
+static inline uint32_t min_u32(uint32_t a, uint32_t b) { return a < b ? a : b; }
+
+// Time until `group` may fire, UINT32_MAX while one of its sensors is busy
+// (the echo or the busy timeout triggers the next poll).
+static uint32_t group_wait(const sonar_sched_t *s, uint32_t group,
+                           uint32_t now_us) {
+  uint32_t wait = 0;
+  for (size_t i = 0; i < s->cfg.sensor_count; i++) {
+    if (!(group & (1u << i))) {
+      continue;
+    }
+    if (s->sensors[i].busy) {
+      return UINT32_MAX;
+    }
+    // Neither may a neighbour still be listening, nor may ghosts of its last
+    // ping be on the way.
+    for (size_t c = 0; c < s->cfg.sensor_count; c++) {
+      const sonar_sensor_state_t *st = &s->sensors[c];
+      if (!(s->cfg.conflicts[i] & (1u << c)) || !st->fired_once) {
+        continue;
+      }
+      uint32_t elapsed = now_us - st->fired_us;
+      if (st->listening && elapsed < s->listen_us &&
+          s->listen_us - elapsed > wait) {
+        wait = s->listen_us - elapsed;
+      }
+      if (elapsed < s->guard_us && s->guard_us - elapsed > wait) {
+        wait = s->guard_us - elapsed;
+      }
+    }
+  }
+  return wait;
+}
+
+uint32_t sonar_sched_poll(sonar_sched_t *s, uint32_t now_us,
+                          uint32_t *wait_us) {
+  uint32_t wait = s->cfg.sensor_timeout_us;
+  uint32_t busy_us =
+      s->cfg.echo_delay_us + s->cfg.sensor_timeout_us + BUSY_MARGIN_US;
+
+  for (size_t i = 0; i < s->cfg.sensor_count; i++) {
+    sonar_sensor_state_t *st = &s->sensors[i];
+    uint32_t elapsed = now_us - st->fired_us;
+
+    if (st->listening) {
+      if (elapsed >= s->listen_us) {
+        st->listening = false;
+        s->no_echo++;
+        emit(s, i, SONAR_NO_ECHO, 0);
+      } else {
+        wait = min_u32(wait, s->listen_us - elapsed);
+      }
+    }
+    // Without echo the line stays high until the sensor gives up
+    if (st->busy && !st->listening) {
+      if (elapsed >= busy_us) {
+        st->busy = false;
+      } else {
+        wait = min_u32(wait, busy_us - elapsed);
+      }
+    }
+  }
+
+  uint32_t group = s->cfg.groups[s->next_group];
+  uint32_t group_ready = group_wait(s, group, now_us);
+  if (group_ready == 0) {
+    for (size_t i = 0; i < s->cfg.sensor_count; i++) {
+      if (group & (1u << i)) {
+        s->sensors[i] = (sonar_sensor_state_t){
+            .listening = true,
+            .busy = true,
+            .fired_once = true,
+            .fired_us = now_us,
+        };
+        s->pings++;
+      }
+    }
+    s->next_group = (s->next_group + 1) % s->cfg.group_count;
+    *wait_us = 0;
+    return group;
+  }
+
+  *wait_us = min_u32(wait, group_ready);
+  return 0;
+}
+
+void sonar_sched_echo(sonar_sched_t *s, uint8_t sensor, uint32_t now_us,
+                      uint32_t width_us) {
+  if (sensor >= s->cfg.sensor_count) {
+    s->stray++;
+    return;
+  }
+  sonar_sensor_state_t *st = &s->sensors[sensor];
+
+  if (st->listening) {
+    // An echo cannot be longer than the time since the trigger
+    if (width_us > now_us - st->fired_us) {
+      s->stray++;
+      return;
+    }
+    st->listening = false;
+    st->busy = false;
+
+    float distance_cm = width_us * s->cfg.speed_cm_per_us / 2.0f;
+    if (distance_cm < s->cfg.min_range_cm) {
+      emit(s, sensor, SONAR_TOO_CLOSE, width_us);
+    } else if (distance_cm > s->cfg.max_range_cm) {
+      s->no_echo++;
+      emit(s, sensor, SONAR_NO_ECHO, width_us);
+    } else {
+      s->readings++;
+      emit(s, sensor, SONAR_OK, width_us);
+    }
+  } else if (st->busy) {
+    // Window already closed, the line just went low
+    st->busy = false;
+    s->late++;
+  } else {
+    s->stray++;
+  }
+}
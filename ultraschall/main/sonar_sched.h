@@ -0,0 +1,114 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Firing scheduler for an array of HC-SR04 style ultrasonic sensors.
+//
+// Sensors are fired in groups, one group after the other in a fixed cyclic
+// order. All sensors of a group ping at the same time, so a group must only
+// contain sensors that cannot hear each other.
+//
+// Two times are derived from the configured ranges:
+//  - listen window: round trip to max_range_cm. A reading is reported as soon
+//    as the echo ends; without echo it is closed at the end of the window.
+//  - guard time: round trip to ghost_range_cm. Objects beyond the maximum
+//    range still reflect, so a sensor that can hear a ping (itself or a
+//    neighbour listed in `conflicts`) must not fire again before this time
+//    has passed since that ping.
+//
+// Sensors that do not conflict are never delayed by each other, so the
+// aggregate rate grows with the number of independent groups.
+//
+// The scheduler is plain C without ESP-IDF dependencies and works with a
+// free-running 32-bit microsecond clock supplied by the caller.
+
+#define SONAR_MAX_SENSORS 8
+#define SONAR_MAX_GROUPS SONAR_MAX_SENSORS
+
+typedef enum {
+  SONAR_OK,           // echo within [min_range_cm, max_range_cm]
+  SONAR_TOO_CLOSE,    // echo shorter than min_range_cm
+  SONAR_NO_ECHO,      // listen window closed without echo
+} sonar_status_t;
+
+typedef struct {
+  uint8_t sensor;
+  sonar_status_t status;
+  uint32_t fired_us;  // scheduler clock at the trigger
+  uint32_t width_us;  // echo pulse width, 0 for SONAR_NO_ECHO
+  float distance_cm;
+} sonar_reading_t;
+
+typedef void (*sonar_reading_cb_t)(const sonar_reading_t *reading, void *ctx);
+
+typedef struct {
+  size_t sensor_count;
+  // Firing order: each entry is a bit mask of sensors fired together
+  size_t group_count;
+  uint32_t groups[SONAR_MAX_GROUPS];
+  // conflicts[i]: sensors that can hear pings of sensor i (i itself is
+  // always included)
+  uint32_t conflicts[SONAR_MAX_SENSORS];
+
+  float min_range_cm;
+  float max_range_cm;
+  float ghost_range_cm;  // farthest object that can still cause an echo
+  float speed_cm_per_us;
+  uint32_t echo_delay_us;     // trigger until the echo line goes high
+  uint32_t sensor_timeout_us; // echo line stays high this long without echo
+
+  sonar_reading_cb_t on_reading;
+  void *ctx;
+} sonar_config_t;
+
+typedef struct {
+  bool listening;     // listen window open
+  bool busy;          // echo line may still be high, do not trigger
+  bool fired_once;
+  uint32_t fired_us;
+} sonar_sensor_state_t;
+
+typedef struct {
+  sonar_config_t cfg;
+  uint32_t listen_us;
+  uint32_t guard_us;
+  size_t next_group;
+  sonar_sensor_state_t sensors[SONAR_MAX_SENSORS];
+
+  // Statistics
+  uint32_t pings;    // sensors triggered
+  uint32_t readings; // SONAR_OK readings
+  uint32_t no_echo;
+  uint32_t late;     // echo ended after the listen window
+  uint32_t stray;    // echo from a sensor that was not triggered
+} sonar_sched_t;
+
+// Fills sensible defaults for an HC-SR04: 2..400 cm, ghost range 1.5x the
+// maximum range, 343 m/s, 38 ms sensor timeout. Groups and conflicts are left
+// empty.
+void sonar_config_default(sonar_config_t *cfg, size_t sensor_count);
+
+// Builds groups from the conflict masks (greedy graph colouring). Sensors
+// that do not hear each other end up in the same group.
+void sonar_config_auto_groups(sonar_config_t *cfg);
+
+// Returns -1 if the configuration is inconsistent (a group contains two
+// conflicting sensors, a sensor never fires, ...).
+int sonar_sched_init(sonar_sched_t *s, const sonar_config_t *cfg);
+
+// Updates the speed of sound (e.g. from a temperature reading). The listen
+// window and guard time are recomputed.
+void sonar_sched_set_speed(sonar_sched_t *s, float speed_cm_per_us);
+
+// Closes expired listen windows and returns the mask of sensors to trigger
+// right now (0 if none). `wait_us` receives the time until the next call is
+// due if nothing arrives in between.
+uint32_t sonar_sched_poll(sonar_sched_t *s, uint32_t now_us,
+                          uint32_t *wait_us);
+
+// Reports the falling edge of a sensor's echo line. `width_us` is the
+// measured pulse width.
+void sonar_sched_echo(sonar_sched_t *s, uint8_t sensor, uint32_t now_us,
+                      uint32_t width_us);